@@ -39,10 +39,17 @@ int main() {
 	struct sched_param  thread_sched_param;
 #endif
 
+	/* every mailbox is ready before any task runs, a task may post to or wait
+	 * on its mailbox as soon as it is created */
 	for (uint32_t index = 0; index < ak_thread_table_len; index++) {
 		/* init mailbox */
 		q_msg_init(task_list[index].mailbox);
 
+		/* create queue trigger */
+		pthread_cond_init(&task_list[index].mailbox_cond, NULL);
+	}
+
+	for (uint32_t index = 0; index < ak_thread_table_len; index++) {
 		pthread_attr_init(&(task_list[index].pthread_attr));
 
 #if (AK_PRIORITY_ENABLE == 1)
@@ -65,8 +72,6 @@ int main() {
 #else
 		AK_PRINT("ID:%08x\tCREATE: %s\n",(uint32_t)task_list[index].pthread, task_list[index].info);
 #endif
-		/* create queue trigger */
-		pthread_cond_init(&task_list[index].mailbox_cond, NULL);
 	}
 
 	for (uint32_t index = 0; index < ak_thread_table_len; index++) {
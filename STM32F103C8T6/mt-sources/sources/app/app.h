@@ -14,12 +14,10 @@ using namespace std;
 
 /* Define signal */
 enum {
-    MT_CPU_SERIAL_IF_PURE_MSG_IN = AK_USER_DEFINE_SIG,
-    MT_CPU_SERIAL_IF_PURE_MSG_OUT,
-    MT_CPU_SERIAL_IF_COMMON_MSG_IN,
+    MT_CPU_SERIAL_IF_PURE_MSG_OUT = AK_USER_DEFINE_SIG,
     MT_CPU_SERIAL_IF_COMMON_MSG_OUT,
-    MT_CPU_SERIAL_IF_DYNAMIC_MSG_IN,
     MT_CPU_SERIAL_IF_DYNAMIC_MSG_OUT,
+    MT_CPU_SERIAL_IF_LINK_READY,
 };
 
 /*----------------------------------------------------------------------------*
@@ -30,11 +28,8 @@ enum {
 
 /* Define signal */
 enum {
-    MT_IF_PURE_MSG_IN = AK_USER_DEFINE_SIG,
-    MT_IF_PURE_MSG_OUT,
-    MT_IF_COMMON_MSG_IN,
+    MT_IF_PURE_MSG_OUT = AK_USER_DEFINE_SIG,
     MT_IF_COMMON_MSG_OUT,
-    MT_IF_DYNAMIC_MSG_IN,
     MT_IF_DYNAMIC_MSG_OUT
 };
 
@@ -83,6 +78,9 @@ enum {
     MT_SM_ENABLE_UPDATE_SL_FIRMWARE_RES,
     MT_SM_FIRMWARE_OTA_SL_FAILURE,
     MT_SM_FIRMWARE_OTA_TIMEOUT,
+
+    /* link takes messages again */
+    MT_SM_LINK_READY,
 };
 
 /*----------------------------------------------------------------------------*
@@ -121,10 +119,14 @@ enum {
  *  Note: Message signals
  *----------------------------------------------------------------------------*/
 /* Define timer */
+#define MT_SYSTEM_LINK_STAT_DUMP_INTERVAL   (60000)
+#define MT_SYSTEM_SL_LINK_STAT_TIMEOUT_AFTER    (2000)
 
 /* Define signal */
 enum {
     MT_SYSTEM_GATEWAY_ONLINE_ENTRY = AK_USER_DEFINE_SIG,
+    MT_SYSTEM_LINK_STAT_DUMP,
+    MT_SYSTEM_SL_LINK_STAT,
 };
 
 /*----------------------------------------------------------------------------*
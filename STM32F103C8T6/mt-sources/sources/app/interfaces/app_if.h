@@ -16,11 +16,8 @@ extern "C"
 
 /* Define signal */
 enum {
-    SL_IF_PURE_MSG_IN = AK_USER_DEFINE_SIG,
-    SL_IF_PURE_MSG_OUT,
-    SL_IF_COMMON_MSG_IN	,
+    SL_IF_PURE_MSG_OUT = AK_USER_DEFINE_SIG,
     SL_IF_COMMON_MSG_OUT,
-    SL_IF_DYNAMIC_MSG_IN,
     SL_IF_DYNAMIC_MSG_OUT
 };
 
@@ -36,10 +33,21 @@ enum {
     SL_CPU_SERIAL_IF_PURE_MSG_OUT,
     SL_CPU_SERIAL_IF_COMMON_MSG_OUT,
     SL_CPU_SERIAL_IF_DYNAMIC_MSG_OUT,
-    SL_CPU_SERIAL_IF_PURE_MSG_IN,
-    SL_CPU_SERIAL_IF_COMMON_MSG_IN,
-    SL_CPU_SERIAL_IF_DYNAMIC_MSG_IN,
 };
+/*----------------------------------------------------------------------------*
+ *  DECLARE: SL_TASK_SYSTEM_ID
+ *  Note: Message signals
+ *----------------------------------------------------------------------------*/
+/* Define timer */
+
+/* Define signal */
+enum {
+    SL_SYSTEM_KEEP_ALIVE = AK_USER_DEFINE_SIG,
+    SL_SYSTEM_REBOOT_REQ,
+    SL_SYSTEM_SYNC_INFO_REQ,
+    SL_SYSTEM_LINK_STAT_REQ,
+};
+
 /*----------------------------------------------------------------------------*
  *  DECLARE: SL_TASK_SM_ID
  *  Note: Message signals
@@ -97,6 +105,33 @@ typedef struct t_ManufactureDeviceReport {
     uint8_t status;
 } deviceInfoReport_t;
 
+typedef struct t_LinkStatReport {
+    struct {
+        uint32_t frameSent;
+        uint32_t frameRev;
+        uint32_t byteSent;
+        uint32_t byteRev;
+        uint32_t retransmit;
+        uint32_t fcsErr;
+        uint32_t revDrop;
+        uint32_t sendFail;
+    } phy;
+
+    struct {
+        uint32_t pduSent;
+        uint32_t pduErr;
+        uint32_t pduRev;
+        uint32_t revDrop;
+    } mac;
+
+    struct {
+        uint32_t msgSent;
+        uint32_t msgRev;
+        uint32_t msgOver;
+        uint32_t revErr;
+    } link;
+} linkStatReport_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -20,13 +20,17 @@
 #include "app_data.h"
 #include "task_list.h"
 #include "task_cpu_serial_if.h"
+#include "task_list_if.h"
 
+#include "link.h"
 #include "link_sig.h"
 
 /* Extern variables ----------------------------------------------------------*/
 q_msg_t taskCpuSerialIfMailbox;
 
 /* Private variables ---------------------------------------------------------*/
+/* messages kept while link is full */
+static link_send_q_t cpuSerialIfLinkSendQ;
 
 /* Private function prototypes -----------------------------------------------*/
 
@@ -34,6 +38,9 @@ q_msg_t taskCpuSerialIfMailbox;
 void* TaskCpuSerialIfEntry(void*) {
 	ak_msg_t* msg = AK_MSG_NULL;
 
+	link_route_set(IF_TYPE_CPU_SERIAL_SL, SL_TASK_SM_ID, LINK_CHANNEL_DEFAULT);
+	link_send_q_init(&cpuSerialIfLinkSendQ, MT_TASK_IF_CPU_SERIAL_ID, MT_CPU_SERIAL_IF_LINK_READY);
+
 	wait_all_tasks_started();
 
     APP_PRINT("[STARTED] MT_TASK_IF_CPU_SERIAL_ID Entry\n");
@@ -45,42 +52,26 @@ void* TaskCpuSerialIfEntry(void*) {
 		case MT_CPU_SERIAL_IF_PURE_MSG_OUT: {
 			ak_msg_t* s_msg = ak_memcpy_msg(msg);
 			set_msg_sig(s_msg, GW_LINK_SEND_PURE_MSG);
-			task_post(MT_LINK_ID, s_msg);
+			link_send_q_post(&cpuSerialIfLinkSendQ, s_msg);
 		}
 			break;
 
 		case MT_CPU_SERIAL_IF_COMMON_MSG_OUT: {
 			ak_msg_t* s_msg = ak_memcpy_msg(msg);
 			set_msg_sig(s_msg, GW_LINK_SEND_COMMON_MSG);
-			task_post(MT_LINK_ID, s_msg);
+			link_send_q_post(&cpuSerialIfLinkSendQ, s_msg);
 		}
 			break;
 
 		case MT_CPU_SERIAL_IF_DYNAMIC_MSG_OUT: {
 			ak_msg_t* s_msg = ak_memcpy_msg(msg);
 			set_msg_sig(s_msg, GW_LINK_SEND_DYNAMIC_MSG);
-			task_post(MT_LINK_ID, s_msg);
-		}
-			break;
-
-		case MT_CPU_SERIAL_IF_PURE_MSG_IN: {
-			ak_msg_t* s_msg = ak_memcpy_msg(msg);
-			set_msg_sig(s_msg, MT_IF_PURE_MSG_IN);
-			task_post(MT_TASK_IF_ID, s_msg);
+			link_send_q_post(&cpuSerialIfLinkSendQ, s_msg);
 		}
 			break;
 
-		case MT_CPU_SERIAL_IF_COMMON_MSG_IN: {
-			ak_msg_t* s_msg = ak_memcpy_msg(msg);
-			set_msg_sig(s_msg, MT_IF_COMMON_MSG_IN);
-			task_post(MT_TASK_IF_ID, s_msg);
-		}
-			break;
-
-		case MT_CPU_SERIAL_IF_DYNAMIC_MSG_IN: {
-			ak_msg_t* s_msg = ak_memcpy_msg(msg);
-			set_msg_sig(s_msg, MT_IF_DYNAMIC_MSG_IN);
-			task_post(MT_TASK_IF_ID, s_msg);
+		case MT_CPU_SERIAL_IF_LINK_READY: {
+			link_send_q_flush(&cpuSerialIfLinkSendQ);
 		}
 			break;
 
@@ -55,33 +55,6 @@ void* TaskIfEntry(void*) {
 
 void cpuSerialIfForward(ak_msg_t* msg) {
 	switch (msg->header->sig) {
-	case MT_IF_PURE_MSG_IN:	{
-		ak_msg_t* s_msg = ak_memcpy_msg(msg);
-
-		set_msg_sig(s_msg, s_msg->header->if_sig);
-		set_msg_src_task_id(s_msg, s_msg->header->if_src_task_id);
-		task_post(s_msg->header->if_des_task_id, s_msg);
-	}
-	break;
-
-	case MT_IF_COMMON_MSG_IN: {
-		ak_msg_t* s_msg = ak_memcpy_msg(msg);
-
-		set_msg_sig(s_msg, s_msg->header->if_sig);
-		set_msg_src_task_id(s_msg, s_msg->header->if_src_task_id);
-		task_post(s_msg->header->if_des_task_id, s_msg);
-	}
-	break;
-
-	case MT_IF_DYNAMIC_MSG_IN: {
-		ak_msg_t* s_msg = ak_memcpy_msg(msg);
-
-		set_msg_sig(s_msg, s_msg->header->if_sig);
-		set_msg_src_task_id(s_msg, s_msg->header->if_src_task_id);
-		task_post(s_msg->header->if_des_task_id, s_msg);
-	}
-	break;
-
 	case MT_IF_PURE_MSG_OUT: {
 		ak_msg_t* s_msg = ak_memcpy_msg(msg);
 		task_post(MT_TASK_IF_CPU_SERIAL_ID, s_msg);
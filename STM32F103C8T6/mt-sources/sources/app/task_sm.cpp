@@ -15,6 +15,8 @@
 #include "task_list_if.h"
 #include "task_sm.h"
 
+#include "link.h"
+
 #define TAG "TaskSM"
 
 #define FORWARD_MSG_OUT(i, s, m)     forwardOutside(i, s, m);
@@ -55,6 +57,8 @@ static void mtSmEnableUpdateSlFirmwareRes(ak_msg_t *msg);
 static void mtSmFirmwareOtaFailure(ak_msg_t *msg);
 static void mtSmFirmwareOtaTimeout(ak_msg_t *msg);
 
+static void mtSmLinkReady(ak_msg_t *msg);
+
 static void forwardOutside(uint8_t eId, uint8_t eSig, ak_msg_t *msg); /* Export */
 static void forwardInside(uint8_t iId, uint8_t iSig, ak_msg_t *msg);  /* Import */
 static void setOtaTimStatus(uint8_t state);
@@ -86,6 +90,9 @@ static tsm_t tblSmIdle[] = {
     { MT_SM_START_SL_FRIMWARE_TRANSF_REQ,       MT_SL_IDLE,	    mtSmStartSlFirmwareTransfReq    },
     { MT_SM_START_SL_FRIMWARE_TRANSF_RES,       MT_SL_OTA,	    mtSmStartSlFirmwareTransfRes    },
 
+    /* LINK */
+    { MT_SM_LINK_READY,                         MT_SL_IDLE,	    mtSmLinkReady                   },
+
     /* END */
     { MT_SM_END_OF_TABLE,	                    MT_SL_IDLE,     TSM_FUNCTION_NULL               },
 };
@@ -106,6 +113,8 @@ static tsm_t tblSmFirmwareOta[] = {
     { MT_SM_FIRMWARE_OTA_SL_FAILURE,  	        MT_SL_IDLE,	    mtSmFirmwareOtaFailure          },
     { MT_SM_FIRMWARE_OTA_TIMEOUT,     	        MT_SL_IDLE,	    mtSmFirmwareOtaTimeout          },
 
+    /* LINK */
+    { MT_SM_LINK_READY,                         MT_SL_OTA,	    mtSmLinkReady                   },
 
     /* END */
     { MT_SM_END_OF_TABLE,	                    MT_SL_OTA,      TSM_FUNCTION_NULL               },
@@ -118,6 +127,9 @@ tsm_t* mtStateMachineTbl[] = {
 
 static uint8_t otaTimeoutCtrl = OTA_TIM_UNK;
 
+/* routed messages kept while link is full */
+static link_send_q_t smLinkSendQ;
+
 #define SM_OTA_TIMEOUT_SET()    setOtaTimStatus(OTA_TIM_SET)
 #define SM_OTA_TIMEOUT_CLR()    setOtaTimStatus(OTA_TIM_CLR)
 #define SM_OTA_TIMEOUT_RST()    setOtaTimStatus(OTA_TIM_UNK)
@@ -128,6 +140,8 @@ void* TaskSmEntry(void*) {
 
     APP_PRINT("[STARTED] MT_TASK_SM_ID Entry\n");
 
+    link_send_q_init(&smLinkSendQ, MT_TASK_SM_ID, MT_SM_LINK_READY);
+
     mtStateMachine.on_state = mtStateMachineOnState;
     tsm_init(&mtStateMachine, mtStateMachineTbl, MT_SL_IDLE);
 
@@ -315,6 +329,13 @@ void mtSmFirmwareOtaTimeout(ak_msg_t *msg) {
     APP_DBG_SIG("MT_SM_FIRMWARE_OTA_TIMEOUT\n");
 }
 
+/* Groups functions link ----------------------------------------------------*/
+void mtSmLinkReady(ak_msg_t *msg) {
+    APP_DBG_SIG("MT_SM_LINK_READY\n");
+    (void)msg;
+    link_send_q_flush(&smLinkSendQ);
+}
+
 /*----------------------------------------------------------------------------*/
 void forwardOutside(uint8_t eId, uint8_t eSig, ak_msg_t *msg) {
     ak_msg_t *cpymsg = ak_memcpy_msg(msg);
@@ -324,6 +345,12 @@ void forwardOutside(uint8_t eId, uint8_t eSig, ak_msg_t *msg) {
     set_if_src_type(cpymsg, IF_TYPE_CPU_SERIAL_MT);
     set_if_des_type(cpymsg, IF_TYPE_CPU_SERIAL_SL);
     set_if_sig(cpymsg, eSig);
+    set_msg_src_task_id(cpymsg, MT_TASK_SM_ID);
+
+    /* routed destination skips the interface tasks, kept in order while link is full */
+    if (link_route_post(&smLinkSendQ, cpymsg) != LINK_ROUTE_NONE) {
+        return;
+    }
 
     switch (get_msg_type(cpymsg)) {
     case PURE_MSG_TYPE: {
@@ -345,7 +372,6 @@ void forwardOutside(uint8_t eId, uint8_t eSig, ak_msg_t *msg) {
         break;
     }
 
-    set_msg_src_task_id(cpymsg, MT_TASK_SM_ID);
     task_post(MT_TASK_IF_ID, cpymsg);
 }
 
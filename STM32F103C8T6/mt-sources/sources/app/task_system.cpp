@@ -6,8 +6,10 @@
 #include <sys/socket.h>
 #include <pthread.h>
 #include <sys/un.h>
+#include <time.h>
 
 #include "ak.h"
+#include "timer.h"
 
 #include "firmware.h"
 
@@ -16,8 +18,14 @@
 #include "app_dbg.h"
 #include "app_data.h"
 #include "task_list.h"
+#include "task_list_if.h"
 #include "task_system.h"
 
+#include "link.h"
+#include "link_mac.h"
+#include "link_phy.h"
+#include "link_rpc.h"
+
 #define TAG	"TaskSystem"
 
 /* Extern variables ----------------------------------------------------------*/
@@ -26,9 +34,17 @@ q_msg_t taskSystemMailbox;
 /* Private variables ---------------------------------------------------------*/
 static pthread_t csInterfaceThreadId;
 
+/* previous dump, throughput is the difference over elapsed time */
+static uint32_t linkStatDumpAt;
+static link_phy_stat_t linkStatPhyLast;
+static linkStatReport_t linkStatSlLast;
+
 /* Private function prototypes -----------------------------------------------*/
 static void parserInputCs(uint8_t num);
 static void* csInterfaceCb(void* argv);
+static void linkStatDump(void);
+static void linkStatSlDump(linkStatReport_t* report);
+static uint32_t getMillis(void);
 
 /* Function implementation ---------------------------------------------------*/
 void* TaskSystemEntry(void*) {
@@ -49,9 +65,37 @@ void* TaskSystemEntry(void*) {
             APP_DBG_SIG("MT_SYSTEM_GATEWAY_ONLINE_ENTRY\n");
 			
 			task_post_pure_msg(MT_TASK_SM_ID, MT_SM_GW_REBOOT_NOTIF);
+
+			linkStatDumpAt = getMillis();
+			timer_set(MT_TASK_SYSTEM_ID, MT_SYSTEM_LINK_STAT_DUMP, MT_SYSTEM_LINK_STAT_DUMP_INTERVAL, TIMER_PERIODIC);
         }
         break;
 
+		case MT_SYSTEM_LINK_STAT_DUMP: {
+			APP_DBG_SIG("MT_SYSTEM_LINK_STAT_DUMP\n");
+
+			linkStatDump();
+			/* link full or all calls waiting: asked again at next dump */
+			link_rpc_call(MT_TASK_SYSTEM_ID, MT_SYSTEM_SL_LINK_STAT, IF_TYPE_CPU_SERIAL_SL, SL_TASK_SYSTEM_ID, SL_SYSTEM_LINK_STAT_REQ, NULL, 0, MT_SYSTEM_SL_LINK_STAT_TIMEOUT_AFTER);
+		}
+		break;
+
+		case MT_SYSTEM_SL_LINK_STAT: {
+			APP_DBG_SIG("MT_SYSTEM_SL_LINK_STAT\n");
+
+			link_rpc_header_t header;
+			linkStatReport_t report;
+			uint32_t len = link_rpc_get_data(msg, &header, (uint8_t*)&report, sizeof(linkStatReport_t));
+
+			if (header.status == LINK_RPC_STATUS_TIMEOUT) {
+				APP_DBG(TAG, "sl link statistics timeout");
+			}
+			else if (len == sizeof(linkStatReport_t)) {
+				linkStatSlDump(&report);
+			}
+		}
+		break;
+
 		default:
         break;
 		}
@@ -99,6 +143,7 @@ void parserInputCs(uint8_t num) {
 		APP_PRINT("+ [%d]. Reboot device\r\n", REBOOT_DEVICE);
 		APP_PRINT("+ [%d]. Firmware boot over the air\r\n", FIRMWARE_BOOT_OTA);
 		APP_PRINT("+ [%d]. Firmware application over the air\r\n", FIRMWARE_APP_OTA);
+		APP_PRINT("+ [%d]. Link statistics\r\n", LINK_STAT);
 		APP_PRINT("+------------------------------+\r\n");
 	}
 	break;
@@ -125,9 +170,96 @@ void parserInputCs(uint8_t num) {
 	}
 	break;
 
+	case LINK_STAT: {
+		task_post_pure_msg(MT_TASK_SYSTEM_ID, MT_SYSTEM_LINK_STAT_DUMP);
+	}
+	break;
+
 	default: {
 		APP_PRINT("?????\n");
 	}
 	break;
 	}
+}
+
+void linkStatDump() {
+	link_phy_stat_t phyStat;
+	link_mac_stat_t macStat;
+	link_stat_t linkStat;
+	link_channel_stat_t channelStat;
+
+	link_phy_get_stat(&phyStat);
+	link_mac_get_stat(&macStat);
+	link_get_stat(&linkStat);
+
+	uint32_t now = getMillis();
+	uint32_t elapsed = now - linkStatDumpAt;
+	if (elapsed == 0) {
+		elapsed = 1;
+	}
+
+	APP_PRINT("+------------------------------+\r\n");
+	APP_PRINT("[PHY] SENT: %u frames, %u bytes (%u B/s)\r\n", phyStat.frame_sent, phyStat.byte_sent,
+			  (uint32_t)((uint64_t)(phyStat.byte_sent - linkStatPhyLast.byte_sent) * 1000 / elapsed));
+	APP_PRINT("[PHY] REV: %u frames, %u bytes (%u B/s)\r\n", phyStat.frame_rev, phyStat.byte_rev,
+			  (uint32_t)((uint64_t)(phyStat.byte_rev - linkStatPhyLast.byte_rev) * 1000 / elapsed));
+	APP_PRINT("[PHY] RETRANSMIT: %u, FAST: %u, FAIL: %u\r\n", phyStat.retransmit, phyStat.fast_retransmit, phyStat.send_fail);
+	APP_PRINT("[PHY] FCS ERR: %u, REV TO: %u, REV DROP: %u\r\n", phyStat.fcs_err, phyStat.rev_to, phyStat.rev_drop);
+#if (LINK_PHY_MULTI_DROP == 1)
+	for (uint8_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+		link_phy_stat_t sessionStat;
+		if (link_phy_get_session_stat(i, &sessionStat)) {
+			APP_PRINT("[PHY] STATION %u RTT: %u ms, RTO: %u ms, WINDOW: %u, CAPS: 0x%02X\r\n", sessionStat.station,
+					  sessionStat.srtt, sessionStat.rto, sessionStat.window_size, sessionStat.caps);
+		}
+	}
+#else
+	APP_PRINT("[PHY] RTT: %u ms, RTO: %u ms, WINDOW: %u, CAPS: 0x%02X\r\n", phyStat.srtt, phyStat.rto, phyStat.window_size, phyStat.caps);
+#endif
+	APP_PRINT("[PHY] FEC PARITY: %u, FIXED: %u frames, %u bytes\r\n", phyStat.fec_parity, phyStat.fec_fixed, phyStat.fec_byte);
+#if (LINK_PHY_MULTI_DROP == 1)
+	APP_PRINT("[PHY] POLLS: %u, POLL TO: %u, FOREIGN: %u, DOWN: %u\r\n", phyStat.poll, phyStat.poll_to, phyStat.rev_foreign, phyStat.station_down);
+#endif
+	APP_PRINT("[MAC] SENT: %u, ERR: %u, RETRY: %u, CREDIT BLOCK: %u\r\n", macStat.pdu_sent, macStat.pdu_err, macStat.pdu_retry, macStat.credit_block);
+	APP_PRINT("[MAC] REV: %u, REV TO: %u, REV DROP: %u\r\n", macStat.pdu_rev, macStat.rev_to, macStat.rev_drop);
+	APP_PRINT("[LINK] SENT: %u, REV: %u, REV ERR: %u, OVER: %u\r\n", linkStat.msg_sent, linkStat.msg_rev, linkStat.rev_err, link_send_over_get());
+	APP_PRINT("[LINK] AGGREGATE: %u, LZ: %u, LZ SAVED: %u bytes\r\n", linkStat.agg_pdu, linkStat.lz_pdu, linkStat.lz_saved);
+
+	for (uint8_t channel = 0; channel < LINK_CHANNEL_NUM; channel++) {
+		link_get_channel_stat(channel, &channelStat);
+		APP_PRINT("[LINK] CHANNEL[%u] SENT: %u, ERR: %u, LOST: %u, OVER: %u, HOLD: %u\r\n", channel, channelStat.sent, channelStat.err, channelStat.lost, channelStat.over, channelStat.hold);
+	}
+	APP_PRINT("+------------------------------+\r\n");
+
+	linkStatPhyLast = phyStat;
+	linkStatDumpAt = now;
+}
+
+void linkStatSlDump(linkStatReport_t* report) {
+	APP_PRINT("+------------------------------+\r\n");
+	APP_PRINT("[SL PHY] SENT: %u frames (+%u), %u bytes (+%u)\r\n", report->phy.frameSent, report->phy.frameSent - linkStatSlLast.phy.frameSent,
+			  report->phy.byteSent, report->phy.byteSent - linkStatSlLast.phy.byteSent);
+	APP_PRINT("[SL PHY] REV: %u frames (+%u), %u bytes (+%u)\r\n", report->phy.frameRev, report->phy.frameRev - linkStatSlLast.phy.frameRev,
+			  report->phy.byteRev, report->phy.byteRev - linkStatSlLast.phy.byteRev);
+	APP_PRINT("[SL PHY] RETRANSMIT: %u (+%u), FAIL: %u (+%u)\r\n", report->phy.retransmit, report->phy.retransmit - linkStatSlLast.phy.retransmit,
+			  report->phy.sendFail, report->phy.sendFail - linkStatSlLast.phy.sendFail);
+	APP_PRINT("[SL PHY] FCS ERR: %u (+%u), REV DROP: %u (+%u)\r\n", report->phy.fcsErr, report->phy.fcsErr - linkStatSlLast.phy.fcsErr,
+			  report->phy.revDrop, report->phy.revDrop - linkStatSlLast.phy.revDrop);
+	APP_PRINT("[SL MAC] SENT: %u (+%u), ERR: %u (+%u)\r\n", report->mac.pduSent, report->mac.pduSent - linkStatSlLast.mac.pduSent,
+			  report->mac.pduErr, report->mac.pduErr - linkStatSlLast.mac.pduErr);
+	APP_PRINT("[SL MAC] REV: %u (+%u), REV DROP: %u (+%u)\r\n", report->mac.pduRev, report->mac.pduRev - linkStatSlLast.mac.pduRev,
+			  report->mac.revDrop, report->mac.revDrop - linkStatSlLast.mac.revDrop);
+	APP_PRINT("[SL LINK] SENT: %u (+%u), REV: %u (+%u)\r\n", report->link.msgSent, report->link.msgSent - linkStatSlLast.link.msgSent,
+			  report->link.msgRev, report->link.msgRev - linkStatSlLast.link.msgRev);
+	APP_PRINT("[SL LINK] OVER: %u (+%u), REV ERR: %u (+%u)\r\n", report->link.msgOver, report->link.msgOver - linkStatSlLast.link.msgOver,
+			  report->link.revErr, report->link.revErr - linkStatSlLast.link.revErr);
+	APP_PRINT("+------------------------------+\r\n");
+
+	linkStatSlLast = *report;
+}
+
+uint32_t getMillis() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
 }
\ No newline at end of file
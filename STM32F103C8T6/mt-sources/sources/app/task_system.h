@@ -15,6 +15,7 @@ enum eCsOption {
     REBOOT_DEVICE,
     FIRMWARE_BOOT_OTA,
     FIRMWARE_APP_OTA,
+    LINK_STAT,
 };
 
 /* Typedef -------------------------------------------------------------------*/
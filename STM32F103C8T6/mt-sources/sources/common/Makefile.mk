@@ -6,4 +6,7 @@ OBJ += $(OBJ_DIR)/cmd_line.o
 # OBJ += $(OBJ_DIR)/jsmn.o
 OBJ += $(OBJ_DIR)/firmware.o
 OBJ += $(OBJ_DIR)/fifo.o
+OBJ += $(OBJ_DIR)/crc16.o
+OBJ += $(OBJ_DIR)/cobs.o
+OBJ += $(OBJ_DIR)/rs.o
 # OBJ += $(OBJ_DIR)/utils.o
@@ -0,0 +1,60 @@
+/*------------------------------------------------------------------------/
+/  COBS (Consistent Overhead Byte Stuffing) codec
+/-------------------------------------------------------------------------/
+/ @author: HungPNQ
+/ @date: 19/10/2026
+/-------------------------------------------------------------------------*/
+
+#include <string.h>
+
+#include "cobs.h"
+
+uint32_t cobs_encode(const uint8_t* src, uint32_t len, uint8_t* dst) {
+	uint8_t* code_ptr = dst;
+	uint8_t* out = dst + 1;
+	uint8_t code = 1;
+
+	while (len--) {
+		if (*src == COBS_DELIMITER) {
+			*code_ptr = code;
+			code_ptr = out++;
+			code = 1;
+		}
+		else {
+			*out++ = *src;
+			if (++code == 0xFF) {
+				*code_ptr = code;
+				code_ptr = out++;
+				code = 1;
+			}
+		}
+		src++;
+	}
+	*code_ptr = code;
+
+	return (uint32_t)(out - dst);
+}
+
+uint32_t cobs_decode(uint8_t* buf, uint32_t len) {
+	uint32_t in = 0;
+	uint32_t out = 0;
+
+	while (in < len) {
+		uint8_t code = buf[in++];
+
+		if (code == COBS_DELIMITER || (uint32_t)(code - 1) > len - in) {
+			return 0;
+		}
+
+		/* output never passes input, run is moved down in place */
+		memmove(&buf[out], &buf[in], code - 1);
+		in += code - 1;
+		out += code - 1;
+
+		if (code != 0xFF && in < len) {
+			buf[out++] = 0x00;
+		}
+	}
+
+	return out;
+}
@@ -0,0 +1,44 @@
+/*------------------------------------------------------------------------/
+/  CRC-16/CCITT (poly 0x1021, MSB first)
+/-------------------------------------------------------------------------/
+/ @author: HungPNQ
+/ @date: 19/10/2026
+/-------------------------------------------------------------------------*/
+
+#ifndef __CRC16_H__
+#define __CRC16_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------*
+ *  DECLARE: Public definitions
+ *  Note: CRC16_SLICE_BY_4 adds 1.5KB of tables, ~4x the bytes per cycle of
+ *  the single 512B table from 16 bytes up on the host (mt-sources/test
+ *  crc_bench), default is the single table.
+ *----------------------------------------------------------------------------*/
+#define CRC16_CCITT_INIT		(0xFFFF)
+
+/* Extern variables ----------------------------------------------------------*/
+extern const uint16_t crc16_ccitt_table[256];
+
+/* Function prototypes -------------------------------------------------------*/
+/* byte-wise update, for parsers feeding one byte at a time */
+#define CRC16_CCITT_UPDATE(crc, byte) \
+	((uint16_t)(((crc) << 8) ^ crc16_ccitt_table[(uint8_t)(((crc) >> 8) ^ (byte))]))
+
+extern uint16_t crc16_ccitt(uint16_t crc, const uint8_t* data, uint32_t len);
+
+#if defined(CRC16_SLICE_BY_4)
+extern uint16_t crc16_ccitt_s4(uint16_t crc, const uint8_t* data, uint32_t len);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CRC16_H__ */
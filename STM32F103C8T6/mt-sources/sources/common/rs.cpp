@@ -0,0 +1,265 @@
+/*------------------------------------------------------------------------/
+/  Reed-Solomon codec over GF(256) (poly 0x11D, first root alpha^0)
+/-------------------------------------------------------------------------/
+/ @author: HungPNQ
+/ @date: 19/10/2026
+/-------------------------------------------------------------------------*/
+
+#include <string.h>
+
+#include "rs.h"
+
+/* alpha^i, doubled so a sum of two logs needs no reduction */
+static const uint8_t rs_gf_exp[512] = {
+	0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1D, 0x3A, 0x74, 0xE8, 0xCD, 0x87, 0x13, 0x26,
+	0x4C, 0x98, 0x2D, 0x5A, 0xB4, 0x75, 0xEA, 0xC9, 0x8F, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0,
+	0x9D, 0x27, 0x4E, 0x9C, 0x25, 0x4A, 0x94, 0x35, 0x6A, 0xD4, 0xB5, 0x77, 0xEE, 0xC1, 0x9F, 0x23,
+	0x46, 0x8C, 0x05, 0x0A, 0x14, 0x28, 0x50, 0xA0, 0x5D, 0xBA, 0x69, 0xD2, 0xB9, 0x6F, 0xDE, 0xA1,
+	0x5F, 0xBE, 0x61, 0xC2, 0x99, 0x2F, 0x5E, 0xBC, 0x65, 0xCA, 0x89, 0x0F, 0x1E, 0x3C, 0x78, 0xF0,
+	0xFD, 0xE7, 0xD3, 0xBB, 0x6B, 0xD6, 0xB1, 0x7F, 0xFE, 0xE1, 0xDF, 0xA3, 0x5B, 0xB6, 0x71, 0xE2,
+	0xD9, 0xAF, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0D, 0x1A, 0x34, 0x68, 0xD0, 0xBD, 0x67, 0xCE,
+	0x81, 0x1F, 0x3E, 0x7C, 0xF8, 0xED, 0xC7, 0x93, 0x3B, 0x76, 0xEC, 0xC5, 0x97, 0x33, 0x66, 0xCC,
+	0x85, 0x17, 0x2E, 0x5C, 0xB8, 0x6D, 0xDA, 0xA9, 0x4F, 0x9E, 0x21, 0x42, 0x84, 0x15, 0x2A, 0x54,
+	0xA8, 0x4D, 0x9A, 0x29, 0x52, 0xA4, 0x55, 0xAA, 0x49, 0x92, 0x39, 0x72, 0xE4, 0xD5, 0xB7, 0x73,
+	0xE6, 0xD1, 0xBF, 0x63, 0xC6, 0x91, 0x3F, 0x7E, 0xFC, 0xE5, 0xD7, 0xB3, 0x7B, 0xF6, 0xF1, 0xFF,
+	0xE3, 0xDB, 0xAB, 0x4B, 0x96, 0x31, 0x62, 0xC4, 0x95, 0x37, 0x6E, 0xDC, 0xA5, 0x57, 0xAE, 0x41,
+	0x82, 0x19, 0x32, 0x64, 0xC8, 0x8D, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xDD, 0xA7, 0x53, 0xA6,
+	0x51, 0xA2, 0x59, 0xB2, 0x79, 0xF2, 0xF9, 0xEF, 0xC3, 0x9B, 0x2B, 0x56, 0xAC, 0x45, 0x8A, 0x09,
+	0x12, 0x24, 0x48, 0x90, 0x3D, 0x7A, 0xF4, 0xF5, 0xF7, 0xF3, 0xFB, 0xEB, 0xCB, 0x8B, 0x0B, 0x16,
+	0x2C, 0x58, 0xB0, 0x7D, 0xFA, 0xE9, 0xCF, 0x83, 0x1B, 0x36, 0x6C, 0xD8, 0xAD, 0x47, 0x8E, 0x01,
+	0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1D, 0x3A, 0x74, 0xE8, 0xCD, 0x87, 0x13, 0x26, 0x4C,
+	0x98, 0x2D, 0x5A, 0xB4, 0x75, 0xEA, 0xC9, 0x8F, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0, 0x9D,
+	0x27, 0x4E, 0x9C, 0x25, 0x4A, 0x94, 0x35, 0x6A, 0xD4, 0xB5, 0x77, 0xEE, 0xC1, 0x9F, 0x23, 0x46,
+	0x8C, 0x05, 0x0A, 0x14, 0x28, 0x50, 0xA0, 0x5D, 0xBA, 0x69, 0xD2, 0xB9, 0x6F, 0xDE, 0xA1, 0x5F,
+	0xBE, 0x61, 0xC2, 0x99, 0x2F, 0x5E, 0xBC, 0x65, 0xCA, 0x89, 0x0F, 0x1E, 0x3C, 0x78, 0xF0, 0xFD,
+	0xE7, 0xD3, 0xBB, 0x6B, 0xD6, 0xB1, 0x7F, 0xFE, 0xE1, 0xDF, 0xA3, 0x5B, 0xB6, 0x71, 0xE2, 0xD9,
+	0xAF, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0D, 0x1A, 0x34, 0x68, 0xD0, 0xBD, 0x67, 0xCE, 0x81,
+	0x1F, 0x3E, 0x7C, 0xF8, 0xED, 0xC7, 0x93, 0x3B, 0x76, 0xEC, 0xC5, 0x97, 0x33, 0x66, 0xCC, 0x85,
+	0x17, 0x2E, 0x5C, 0xB8, 0x6D, 0xDA, 0xA9, 0x4F, 0x9E, 0x21, 0x42, 0x84, 0x15, 0x2A, 0x54, 0xA8,
+	0x4D, 0x9A, 0x29, 0x52, 0xA4, 0x55, 0xAA, 0x49, 0x92, 0x39, 0x72, 0xE4, 0xD5, 0xB7, 0x73, 0xE6,
+	0xD1, 0xBF, 0x63, 0xC6, 0x91, 0x3F, 0x7E, 0xFC, 0xE5, 0xD7, 0xB3, 0x7B, 0xF6, 0xF1, 0xFF, 0xE3,
+	0xDB, 0xAB, 0x4B, 0x96, 0x31, 0x62, 0xC4, 0x95, 0x37, 0x6E, 0xDC, 0xA5, 0x57, 0xAE, 0x41, 0x82,
+	0x19, 0x32, 0x64, 0xC8, 0x8D, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xDD, 0xA7, 0x53, 0xA6, 0x51,
+	0xA2, 0x59, 0xB2, 0x79, 0xF2, 0xF9, 0xEF, 0xC3, 0x9B, 0x2B, 0x56, 0xAC, 0x45, 0x8A, 0x09, 0x12,
+	0x24, 0x48, 0x90, 0x3D, 0x7A, 0xF4, 0xF5, 0xF7, 0xF3, 0xFB, 0xEB, 0xCB, 0x8B, 0x0B, 0x16, 0x2C,
+	0x58, 0xB0, 0x7D, 0xFA, 0xE9, 0xCF, 0x83, 0x1B, 0x36, 0x6C, 0xD8, 0xAD, 0x47, 0x8E, 0x01, 0x02
+};
+
+/* log_alpha(i), rs_gf_log[0] is unused */
+static const uint8_t rs_gf_log[256] = {
+	0x00, 0x00, 0x01, 0x19, 0x02, 0x32, 0x1A, 0xC6, 0x03, 0xDF, 0x33, 0xEE, 0x1B, 0x68, 0xC7, 0x4B,
+	0x04, 0x64, 0xE0, 0x0E, 0x34, 0x8D, 0xEF, 0x81, 0x1C, 0xC1, 0x69, 0xF8, 0xC8, 0x08, 0x4C, 0x71,
+	0x05, 0x8A, 0x65, 0x2F, 0xE1, 0x24, 0x0F, 0x21, 0x35, 0x93, 0x8E, 0xDA, 0xF0, 0x12, 0x82, 0x45,
+	0x1D, 0xB5, 0xC2, 0x7D, 0x6A, 0x27, 0xF9, 0xB9, 0xC9, 0x9A, 0x09, 0x78, 0x4D, 0xE4, 0x72, 0xA6,
+	0x06, 0xBF, 0x8B, 0x62, 0x66, 0xDD, 0x30, 0xFD, 0xE2, 0x98, 0x25, 0xB3, 0x10, 0x91, 0x22, 0x88,
+	0x36, 0xD0, 0x94, 0xCE, 0x8F, 0x96, 0xDB, 0xBD, 0xF1, 0xD2, 0x13, 0x5C, 0x83, 0x38, 0x46, 0x40,
+	0x1E, 0x42, 0xB6, 0xA3, 0xC3, 0x48, 0x7E, 0x6E, 0x6B, 0x3A, 0x28, 0x54, 0xFA, 0x85, 0xBA, 0x3D,
+	0xCA, 0x5E, 0x9B, 0x9F, 0x0A, 0x15, 0x79, 0x2B, 0x4E, 0xD4, 0xE5, 0xAC, 0x73, 0xF3, 0xA7, 0x57,
+	0x07, 0x70, 0xC0, 0xF7, 0x8C, 0x80, 0x63, 0x0D, 0x67, 0x4A, 0xDE, 0xED, 0x31, 0xC5, 0xFE, 0x18,
+	0xE3, 0xA5, 0x99, 0x77, 0x26, 0xB8, 0xB4, 0x7C, 0x11, 0x44, 0x92, 0xD9, 0x23, 0x20, 0x89, 0x2E,
+	0x37, 0x3F, 0xD1, 0x5B, 0x95, 0xBC, 0xCF, 0xCD, 0x90, 0x87, 0x97, 0xB2, 0xDC, 0xFC, 0xBE, 0x61,
+	0xF2, 0x56, 0xD3, 0xAB, 0x14, 0x2A, 0x5D, 0x9E, 0x84, 0x3C, 0x39, 0x53, 0x47, 0x6D, 0x41, 0xA2,
+	0x1F, 0x2D, 0x43, 0xD8, 0xB7, 0x7B, 0xA4, 0x76, 0xC4, 0x17, 0x49, 0xEC, 0x7F, 0x0C, 0x6F, 0xF6,
+	0x6C, 0xA1, 0x3B, 0x52, 0x29, 0x9D, 0x55, 0xAA, 0xFB, 0x60, 0x86, 0xB1, 0xBB, 0xCC, 0x3E, 0x5A,
+	0xCB, 0x59, 0x5F, 0xB0, 0x9C, 0xA9, 0xA0, 0x51, 0x0B, 0xF5, 0x16, 0xEB, 0x7A, 0x75, 0x2C, 0xD7,
+	0x4F, 0xAE, 0xD5, 0xE9, 0xE6, 0xE7, 0xAD, 0xE8, 0x74, 0xD6, 0xF4, 0xEA, 0xA8, 0x50, 0x58, 0xAF
+};
+
+static inline uint8_t rs_gf_mul(uint8_t a, uint8_t b) {
+	if (a == 0 || b == 0) {
+		return 0;
+	}
+	return rs_gf_exp[rs_gf_log[a] + rs_gf_log[b]];
+}
+
+static inline uint8_t rs_gf_div(uint8_t a, uint8_t b) {
+	if (a == 0) {
+		return 0;
+	}
+	return rs_gf_exp[rs_gf_log[a] + 255 - rs_gf_log[b]];
+}
+
+/* alpha^-e, e in [0, 254] */
+static inline uint8_t rs_gf_inv_pow(uint32_t e) {
+	return rs_gf_exp[255 - e];
+}
+
+/* poly[i] is the coefficient of x^i */
+static uint8_t rs_poly_eval(const uint8_t* poly, uint8_t deg, uint8_t x) {
+	uint8_t y = poly[deg];
+
+	while (deg--) {
+		y = rs_gf_mul(y, x) ^ poly[deg];
+	}
+	return y;
+}
+
+/* gen(x) = (x + alpha^0)(x + alpha^1)...(x + alpha^(nroots - 1)) */
+static void rs_generator(uint8_t* gen, uint8_t nroots) {
+	memset(gen, 0, nroots + 1);
+	gen[0] = 1;
+
+	for (uint8_t i = 0; i < nroots; i++) {
+		for (uint8_t j = i + 1; j > 0; j--) {
+			gen[j] = gen[j - 1] ^ rs_gf_mul(gen[j], rs_gf_exp[i]);
+		}
+		gen[0] = rs_gf_mul(gen[0], rs_gf_exp[i]);
+	}
+}
+
+void rs_encode(const uint8_t* data, uint32_t len, uint8_t* parity, uint8_t nroots) {
+	uint8_t gen[RS_PARITY_MAX + 1];
+
+	if (nroots == 0) {
+		return;
+	}
+	rs_generator(gen, nroots);
+	memset(parity, 0, nroots);
+
+	/* remainder of data(x) * x^nroots by gen(x), highest degree first */
+	for (uint32_t i = 0; i < len; i++) {
+		uint8_t fb = data[i] ^ parity[0];
+
+		for (uint8_t j = 0; j < nroots - 1; j++) {
+			parity[j] = parity[j + 1] ^ rs_gf_mul(fb, gen[nroots - 1 - j]);
+		}
+		parity[nroots - 1] = rs_gf_mul(fb, gen[0]);
+	}
+}
+
+int32_t rs_decode(uint8_t* data, uint32_t len, uint8_t* parity, uint8_t nroots) {
+	uint8_t synd[RS_PARITY_MAX];
+	uint8_t lambda[RS_PARITY_MAX + 1];
+	uint8_t prev[RS_PARITY_MAX + 1];
+	uint8_t omega[RS_PARITY_MAX];
+	uint8_t err_deg[RS_PARITY_MAX / 2];
+	uint8_t err_val[RS_PARITY_MAX / 2];
+	uint32_t n = len + nroots;
+	uint8_t has_err = 0;
+
+	if (nroots == 0) {
+		return 0;
+	}
+
+	/* syndromes, S_i = c(alpha^i) */
+	for (uint8_t i = 0; i < nroots; i++) {
+		uint8_t x = rs_gf_exp[i];
+		uint8_t s = 0;
+
+		for (uint32_t k = 0; k < len; k++) {
+			s = rs_gf_mul(s, x) ^ data[k];
+		}
+		for (uint8_t k = 0; k < nroots; k++) {
+			s = rs_gf_mul(s, x) ^ parity[k];
+		}
+		synd[i] = s;
+		has_err |= s;
+	}
+
+	if (!has_err) {
+		return 0;
+	}
+
+	/* error locator lambda(x), Berlekamp-Massey */
+	uint8_t L = 0;
+	uint8_t m = 1;
+	uint8_t b = 1;
+
+	memset(lambda, 0, sizeof(lambda));
+	memset(prev, 0, sizeof(prev));
+	lambda[0] = 1;
+	prev[0] = 1;
+
+	for (uint8_t r = 0; r < nroots; r++) {
+		uint8_t d = synd[r];
+
+		for (uint8_t i = 1; i <= L; i++) {
+			d ^= rs_gf_mul(lambda[i], synd[r - i]);
+		}
+
+		if (d == 0) {
+			m++;
+			continue;
+		}
+
+		uint8_t t[RS_PARITY_MAX + 1];
+		uint8_t coef = rs_gf_div(d, b);
+
+		memcpy(t, lambda, nroots + 1);
+		for (uint8_t i = 0; i + m <= nroots; i++) {
+			lambda[i + m] ^= rs_gf_mul(coef, prev[i]);
+		}
+
+		if (2 * L <= r) {
+			L = r + 1 - L;
+			memcpy(prev, t, nroots + 1);
+			b = d;
+			m = 1;
+		}
+		else {
+			m++;
+		}
+	}
+
+	if (2 * L > nroots) {
+		return -1;
+	}
+
+	/* error positions, roots alpha^-deg of lambda(x) within the shortened codeword */
+	uint8_t err_cnt = 0;
+
+	for (uint32_t deg = 0; deg < n; deg++) {
+		if (rs_poly_eval(lambda, L, rs_gf_inv_pow(deg)) == 0) {
+			if (err_cnt == L) {
+				return -1;
+			}
+			err_deg[err_cnt++] = (uint8_t)deg;
+		}
+	}
+
+	if (err_cnt != L) {
+		return -1;
+	}
+
+	/* error values, Forney: e = X * omega(X^-1) / lambda'(X^-1) */
+	for (uint8_t k = 0; k < nroots; k++) {
+		uint8_t o = 0;
+
+		for (uint8_t i = 0; i <= k && i <= L; i++) {
+			o ^= rs_gf_mul(synd[k - i], lambda[i]);
+		}
+		omega[k] = o;
+	}
+
+	for (uint8_t j = 0; j < err_cnt; j++) {
+		uint8_t x_inv = rs_gf_inv_pow(err_deg[j]);
+		uint8_t x_inv2 = rs_gf_mul(x_inv, x_inv);
+		uint8_t num = rs_gf_mul(rs_gf_exp[err_deg[j]], rs_poly_eval(omega, nroots - 1, x_inv));
+		uint8_t den = 0;
+		uint8_t x_pow = 1;
+
+		for (uint8_t i = 1; i <= L; i += 2) {
+			den ^= rs_gf_mul(lambda[i], x_pow);
+			x_pow = rs_gf_mul(x_pow, x_inv2);
+		}
+
+		if (den == 0) {
+			return -1;
+		}
+		err_val[j] = rs_gf_div(num, den);
+	}
+
+	/* only a decodable word is touched */
+	for (uint8_t j = 0; j < err_cnt; j++) {
+		uint32_t pos = n - 1 - err_deg[j];
+
+		if (pos < len) {
+			data[pos] ^= err_val[j];
+		}
+		else {
+			parity[pos - len] ^= err_val[j];
+		}
+	}
+
+	return err_cnt;
+}
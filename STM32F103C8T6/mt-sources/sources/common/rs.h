@@ -0,0 +1,39 @@
+/*------------------------------------------------------------------------/
+/  Reed-Solomon codec over GF(256) (poly 0x11D, first root alpha^0)
+/-------------------------------------------------------------------------/
+/ @author: HungPNQ
+/ @date: 19/10/2026
+/-------------------------------------------------------------------------*/
+
+#ifndef __RS_H__
+#define __RS_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------*
+ *  DECLARE: Public definitions
+ *  Note: codeword is data followed by nroots parity bytes, at most
+ *  RS_CODEWORD_SIZE_MAX bytes (shortened code). Up to nroots / 2 byte errors
+ *  anywhere in the codeword are corrected.
+ *----------------------------------------------------------------------------*/
+#define RS_CODEWORD_SIZE_MAX	(255)
+#define RS_PARITY_MAX			(32)
+
+/* Function prototypes -------------------------------------------------------*/
+/* compute nroots parity bytes of len data bytes, len + nroots <= RS_CODEWORD_SIZE_MAX */
+extern void rs_encode(const uint8_t* data, uint32_t len, uint8_t* parity, uint8_t nroots);
+
+/* correct data and parity in place, return number of corrected bytes, -1 when
+ * errors are beyond correction (buffers are left untouched then) */
+extern int32_t rs_decode(uint8_t* data, uint32_t len, uint8_t* parity, uint8_t nroots);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RS_H__ */
@@ -1,3 +1,5 @@
+-include sources/networks/net/link/hal/Makefile.mk
+
 CXXFLAGS	+= -I./sources/networks/net/link
 
 VPATH += sources/networks/net/link
@@ -6,3 +8,5 @@ OBJ += $(OBJ_DIR)/link.o
 OBJ += $(OBJ_DIR)/link_mac.o
 OBJ += $(OBJ_DIR)/link_phy.o
 OBJ += $(OBJ_DIR)/link_data.o
+OBJ += $(OBJ_DIR)/link_lz.o
+OBJ += $(OBJ_DIR)/link_rpc.o
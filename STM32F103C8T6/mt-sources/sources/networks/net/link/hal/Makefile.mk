@@ -0,0 +1,8 @@
+CXXFLAGS	+= -I./sources/networks/net/link/hal
+
+VPATH += sources/networks/net/link/hal
+
+OBJ += $(OBJ_DIR)/link_hal.o
+OBJ += $(OBJ_DIR)/link_hal_serial.o
+OBJ += $(OBJ_DIR)/link_hal_pty.o
+OBJ += $(OBJ_DIR)/link_hal_loopback.o
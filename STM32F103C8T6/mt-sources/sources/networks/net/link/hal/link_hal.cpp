@@ -0,0 +1,88 @@
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "sys_dbg.h"
+
+#include "link_hal.h"
+
+#define LINK_HAL_RX_BUFFER_SIZE		4096
+
+static const link_hal_transport_t* link_hal_transport;
+static pf_link_hal_rev_block plink_hal_rev_block;
+static pthread_t link_hal_rx_thread;
+
+static void* link_hal_rx_thread_handler(void*);
+
+void link_hal_reg_rev_block(pf_link_hal_rev_block f_rev_block) {
+	if (f_rev_block != ((pf_link_hal_rev_block)0)) {
+		plink_hal_rev_block = f_rev_block;
+	}
+	else {
+		FATAL("LINK_HAL", 0x01);
+	}
+}
+
+int link_hal_open(const char* path) {
+	const link_hal_transport_t* transport = &link_hal_transport_serial;
+
+	if (path == NULL) {
+		return -1;
+	}
+
+	if (strncmp(path, LINK_HAL_PATH_LOOPBACK_A, strlen(LINK_HAL_PATH_LOOPBACK_A)) == 0) {
+		transport = &link_hal_transport_loopback_a;
+	}
+	else if (strncmp(path, LINK_HAL_PATH_LOOPBACK_B, strlen(LINK_HAL_PATH_LOOPBACK_B)) == 0) {
+		transport = &link_hal_transport_loopback_b;
+	}
+	else if (strncmp(path, LINK_HAL_PATH_LOOPBACK, strlen(LINK_HAL_PATH_LOOPBACK)) == 0) {
+		transport = &link_hal_transport_loopback;
+	}
+	else if (strcmp(path, LINK_HAL_PATH_PTY) == 0) {
+		transport = &link_hal_transport_pty;
+	}
+
+	if (transport->open(path) < 0) {
+		return -1;
+	}
+
+	link_hal_transport = transport;
+	pthread_create(&link_hal_rx_thread, NULL, link_hal_rx_thread_handler, NULL);
+	return 0;
+}
+
+const char* link_hal_name() {
+	return (link_hal_transport != NULL) ? link_hal_transport->name : "none";
+}
+
+void link_hal_write_block(uint8_t* data, uint32_t len) {
+	/* no transport is a wire not plugged, peer sees nothing */
+	if (link_hal_transport == NULL) {
+		return;
+	}
+
+	while (len) {
+		int32_t ret = link_hal_transport->write_block(data, len);
+
+		if (ret < 0) {
+			FATAL("LINK_HAL", 0x02);
+		}
+		data += ret;
+		len -= ret;
+	}
+}
+
+void* link_hal_rx_thread_handler(void*) {
+	static uint8_t link_hal_rx_buffer[LINK_HAL_RX_BUFFER_SIZE];
+
+	while (1) {
+		int32_t len = link_hal_transport->read_block(link_hal_rx_buffer, LINK_HAL_RX_BUFFER_SIZE);
+
+		if (len > 0 && plink_hal_rev_block != ((pf_link_hal_rev_block)0)) {
+			plink_hal_rev_block(link_hal_rx_buffer, len);
+		}
+	}
+
+	return (void*)0;
+}
@@ -0,0 +1,48 @@
+#ifndef __LINK_HAL_H__
+#define __LINK_HAL_H__
+
+#include <stdint.h>
+
+#define LINK_HAL_HANDLED	1
+#define LINK_HAL_IGNORED	0
+
+/* transport is chosen by link_hal_open() from the device path:
+ *   "loopback[:delay,loss,corrupt,rate]"	in memory, written bytes come back after
+ *											delay ms, loss and corrupt per million bytes,
+ *											rate bytes per second (0 unlimited)
+ *   "loopback-a[:delay,loss,corrupt,rate]"	one end of the line made by link_hal_loopback_pair(),
+ *   "loopback-b[:delay,loss,corrupt,rate]"	bytes written by one end are read by the other
+ *   "pty"									new pseudo terminal, peer opens its slave
+ *   any other path							serial device, 115200 8N1 raw */
+#define LINK_HAL_PATH_LOOPBACK		"loopback"
+#define LINK_HAL_PATH_LOOPBACK_A	"loopback-a"
+#define LINK_HAL_PATH_LOOPBACK_B	"loopback-b"
+#define LINK_HAL_PATH_PTY			"pty"
+
+typedef struct {
+	const char* name;
+	int (*open)(const char* path);
+	int32_t (*write_block)(uint8_t* data, uint32_t len);
+	int32_t (*read_block)(uint8_t* data, uint32_t size); /* wait for data, 0 when nothing came */
+} link_hal_transport_t;
+
+typedef void (*pf_link_hal_rev_block)(uint8_t* data, uint32_t len);
+
+extern const link_hal_transport_t link_hal_transport_serial;
+extern const link_hal_transport_t link_hal_transport_pty;
+extern const link_hal_transport_t link_hal_transport_loopback;
+extern const link_hal_transport_t link_hal_transport_loopback_a;
+extern const link_hal_transport_t link_hal_transport_loopback_b;
+
+/* shared line of the loopback ends, made before fork() so one process opens
+ * "loopback-a" and the other "loopback-b" */
+extern int link_hal_loopback_pair();
+
+/* f_rev_block is called from the receive thread started by link_hal_open() */
+extern void link_hal_reg_rev_block(pf_link_hal_rev_block f_rev_block);
+
+extern int link_hal_open(const char* path);
+extern const char* link_hal_name();
+extern void link_hal_write_block(uint8_t* data, uint32_t len);
+
+#endif //__LINK_HAL_H__
@@ -0,0 +1,238 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "link_hal.h"
+
+/* bytes on the way, a full line drops what is written, or holds the writer
+ * when the line has a rate like a uart does */
+#define LINK_HAL_LOOPBACK_BUF_SIZE		8192
+
+/* one direction of the line, written by one end and read by the other */
+typedef struct {
+	uint8_t buf[LINK_HAL_LOOPBACK_BUF_SIZE];
+	uint32_t due[LINK_HAL_LOOPBACK_BUF_SIZE]; /* ms, when each byte comes out */
+	uint32_t head;
+	uint32_t len;
+	uint64_t busy; /* ns, when the last written byte is out of the sender */
+
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+} link_hal_loopback_line_t;
+
+/* single ended line, written bytes come back to the writer */
+static link_hal_loopback_line_t link_hal_loopback_echo;
+
+/* both directions of a pair, shared with the peer process after fork() */
+static link_hal_loopback_line_t* link_hal_loopback_pair_line;
+
+static link_hal_loopback_line_t* link_hal_loopback_tx;
+static link_hal_loopback_line_t* link_hal_loopback_rx;
+
+/* applied to the bytes this end writes */
+static uint32_t link_hal_loopback_delay; /* ms */
+static uint32_t link_hal_loopback_loss; /* per million bytes */
+static uint32_t link_hal_loopback_corrupt; /* per million bytes */
+static uint32_t link_hal_loopback_rate; /* bytes per second, 0 unlimited */
+static unsigned int link_hal_loopback_seed = 1;
+
+static int link_hal_loopback_open(const char* path);
+static int link_hal_loopback_a_open(const char* path);
+static int link_hal_loopback_b_open(const char* path);
+static int32_t link_hal_loopback_write_block(uint8_t* data, uint32_t len);
+static int32_t link_hal_loopback_read_block(uint8_t* data, uint32_t size);
+static void link_hal_loopback_line_init(link_hal_loopback_line_t* line, int pshared);
+static void link_hal_loopback_param(const char* path);
+static uint64_t link_hal_loopback_nanos();
+static uint32_t link_hal_loopback_millis();
+static uint8_t link_hal_loopback_chance(uint32_t ppm);
+
+const link_hal_transport_t link_hal_transport_loopback = {
+	"loopback",
+	link_hal_loopback_open,
+	link_hal_loopback_write_block,
+	link_hal_loopback_read_block
+};
+
+const link_hal_transport_t link_hal_transport_loopback_a = {
+	"loopback-a",
+	link_hal_loopback_a_open,
+	link_hal_loopback_write_block,
+	link_hal_loopback_read_block
+};
+
+const link_hal_transport_t link_hal_transport_loopback_b = {
+	"loopback-b",
+	link_hal_loopback_b_open,
+	link_hal_loopback_write_block,
+	link_hal_loopback_read_block
+};
+
+int link_hal_loopback_pair() {
+	if (link_hal_loopback_pair_line != NULL) {
+		return 0;
+	}
+
+	void* mem = mmap(NULL, 2 * sizeof(link_hal_loopback_line_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (mem == MAP_FAILED) {
+		return -1;
+	}
+
+	link_hal_loopback_pair_line = (link_hal_loopback_line_t*)mem;
+	link_hal_loopback_line_init(&link_hal_loopback_pair_line[0], PTHREAD_PROCESS_SHARED);
+	link_hal_loopback_line_init(&link_hal_loopback_pair_line[1], PTHREAD_PROCESS_SHARED);
+	return 0;
+}
+
+int link_hal_loopback_open(const char* path) {
+	link_hal_loopback_line_init(&link_hal_loopback_echo, PTHREAD_PROCESS_PRIVATE);
+	link_hal_loopback_tx = &link_hal_loopback_echo;
+	link_hal_loopback_rx = &link_hal_loopback_echo;
+	link_hal_loopback_param(path);
+	return 0;
+}
+
+int link_hal_loopback_a_open(const char* path) {
+	if (link_hal_loopback_pair_line == NULL) {
+		return -1;
+	}
+
+	link_hal_loopback_tx = &link_hal_loopback_pair_line[0];
+	link_hal_loopback_rx = &link_hal_loopback_pair_line[1];
+	link_hal_loopback_param(path);
+	return 0;
+}
+
+int link_hal_loopback_b_open(const char* path) {
+	if (link_hal_loopback_pair_line == NULL) {
+		return -1;
+	}
+
+	link_hal_loopback_tx = &link_hal_loopback_pair_line[1];
+	link_hal_loopback_rx = &link_hal_loopback_pair_line[0];
+	link_hal_loopback_param(path);
+
+	/* both processes start from the same seed, keep their faults apart */
+	link_hal_loopback_seed = 2;
+	return 0;
+}
+
+int32_t link_hal_loopback_write_block(uint8_t* data, uint32_t len) {
+	link_hal_loopback_line_t* line = link_hal_loopback_tx;
+
+	pthread_mutex_lock(&line->mutex);
+
+	uint32_t due = link_hal_loopback_millis() + link_hal_loopback_delay;
+
+	for (uint32_t i = 0; i < len; i++) {
+		uint8_t c = data[i];
+
+		while (link_hal_loopback_rate != 0 && line->len >= LINK_HAL_LOOPBACK_BUF_SIZE) {
+			pthread_cond_broadcast(&line->cond);
+			pthread_cond_wait(&line->cond, &line->mutex);
+		}
+
+		if (link_hal_loopback_rate != 0) {
+			/* each byte takes its time on the line after the one before */
+			uint64_t now = link_hal_loopback_nanos();
+
+			line->busy = ((line->busy > now) ? line->busy : now) + 1000000000 / link_hal_loopback_rate;
+			due = (uint32_t)(line->busy / 1000000) + link_hal_loopback_delay;
+		}
+
+		if (link_hal_loopback_chance(link_hal_loopback_loss) || line->len >= LINK_HAL_LOOPBACK_BUF_SIZE) {
+			continue;
+		}
+
+		if (link_hal_loopback_chance(link_hal_loopback_corrupt)) {
+			c ^= (uint8_t)(1 << (rand_r(&link_hal_loopback_seed) & 0x07));
+		}
+
+		uint32_t tail = (line->head + line->len) % LINK_HAL_LOOPBACK_BUF_SIZE;
+		line->buf[tail] = c;
+		line->due[tail] = due;
+		line->len++;
+	}
+
+	pthread_cond_broadcast(&line->cond);
+	pthread_mutex_unlock(&line->mutex);
+	return len;
+}
+
+int32_t link_hal_loopback_read_block(uint8_t* data, uint32_t size) {
+	link_hal_loopback_line_t* line = link_hal_loopback_rx;
+	uint32_t len = 0;
+
+	pthread_mutex_lock(&line->mutex);
+
+	while (line->len == 0) {
+		pthread_cond_wait(&line->cond, &line->mutex);
+	}
+
+	uint32_t now = link_hal_loopback_millis();
+	int32_t wait = (int32_t)(line->due[line->head] - now);
+
+	if (wait > 0) {
+		/* written bytes are in order of due time, nothing else comes earlier */
+		pthread_mutex_unlock(&line->mutex);
+		usleep(wait * 1000);
+		return 0;
+	}
+
+	while (len < size && line->len > 0 && (int32_t)(line->due[line->head] - now) <= 0) {
+		data[len++] = line->buf[line->head];
+		line->head = (line->head + 1) % LINK_HAL_LOOPBACK_BUF_SIZE;
+		line->len--;
+	}
+
+	/* room for a writer held by a full line */
+	pthread_cond_broadcast(&line->cond);
+	pthread_mutex_unlock(&line->mutex);
+	return len;
+}
+
+void link_hal_loopback_line_init(link_hal_loopback_line_t* line, int pshared) {
+	pthread_mutexattr_t mutex_attr;
+	pthread_condattr_t cond_attr;
+
+	pthread_mutexattr_init(&mutex_attr);
+	pthread_mutexattr_setpshared(&mutex_attr, pshared);
+	pthread_mutex_init(&line->mutex, &mutex_attr);
+	pthread_mutexattr_destroy(&mutex_attr);
+
+	pthread_condattr_init(&cond_attr);
+	pthread_condattr_setpshared(&cond_attr, pshared);
+	pthread_cond_init(&line->cond, &cond_attr);
+	pthread_condattr_destroy(&cond_attr);
+
+	line->head = 0;
+	line->len = 0;
+	line->busy = 0;
+}
+
+void link_hal_loopback_param(const char* path) {
+	const char* param = strchr(path, ':');
+
+	if (param != NULL) {
+		sscanf(param + 1, "%u,%u,%u,%u", &link_hal_loopback_delay, &link_hal_loopback_loss, &link_hal_loopback_corrupt, &link_hal_loopback_rate);
+	}
+}
+
+uint64_t link_hal_loopback_nanos() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+uint32_t link_hal_loopback_millis() {
+	return (uint32_t)(link_hal_loopback_nanos() / 1000000);
+}
+
+uint8_t link_hal_loopback_chance(uint32_t ppm) {
+	return ppm != 0 && (uint32_t)(rand_r(&link_hal_loopback_seed) % 1000000) < ppm;
+}
@@ -0,0 +1,71 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+
+#include "sys_dbg.h"
+
+#include "link_hal.h"
+
+static int link_hal_pty_fd = -1;
+static int link_hal_pty_slave_fd = -1;
+
+static int link_hal_pty_open(const char* path);
+static int32_t link_hal_pty_write_block(uint8_t* data, uint32_t len);
+static int32_t link_hal_pty_read_block(uint8_t* data, uint32_t size);
+
+const link_hal_transport_t link_hal_transport_pty = {
+	"pty",
+	link_hal_pty_open,
+	link_hal_pty_write_block,
+	link_hal_pty_read_block
+};
+
+int link_hal_pty_open(const char* path) {
+	struct termios options;
+	(void)path;
+
+	link_hal_pty_fd = posix_openpt(O_RDWR | O_NOCTTY);
+	if (link_hal_pty_fd < 0) {
+		return link_hal_pty_fd;
+	}
+
+	if (grantpt(link_hal_pty_fd) < 0 || unlockpt(link_hal_pty_fd) < 0) {
+		close(link_hal_pty_fd);
+		link_hal_pty_fd = -1;
+		return -1;
+	}
+
+	/* slave is held open, master reads do not fail while peer is away */
+	link_hal_pty_slave_fd = open(ptsname(link_hal_pty_fd), O_RDWR | O_NOCTTY);
+	if (link_hal_pty_slave_fd < 0) {
+		close(link_hal_pty_fd);
+		link_hal_pty_fd = -1;
+		return -1;
+	}
+
+	tcgetattr(link_hal_pty_slave_fd, &options);
+	cfmakeraw(&options);
+	if (tcsetattr(link_hal_pty_slave_fd, TCSANOW, &options) != 0) {
+		SYS_DBG("error in tcsetattr()\n");
+	}
+
+	printf("[LINK_HAL] pty peer: %s\n", ptsname(link_hal_pty_fd));
+	return 0;
+}
+
+int32_t link_hal_pty_write_block(uint8_t* data, uint32_t len) {
+	return write(link_hal_pty_fd, data, len);
+}
+
+int32_t link_hal_pty_read_block(uint8_t* data, uint32_t size) {
+	int32_t len = read(link_hal_pty_fd, data, size);
+
+	if (len < 0) {
+		usleep(100000);
+		return 0;
+	}
+	return len;
+}
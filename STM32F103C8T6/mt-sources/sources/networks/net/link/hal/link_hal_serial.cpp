@@ -0,0 +1,69 @@
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+
+#include "sys_dbg.h"
+
+#include "link_hal.h"
+
+static int link_hal_serial_fd = -1;
+
+static int link_hal_serial_open(const char* path);
+static int32_t link_hal_serial_write_block(uint8_t* data, uint32_t len);
+static int32_t link_hal_serial_read_block(uint8_t* data, uint32_t size);
+
+const link_hal_transport_t link_hal_transport_serial = {
+	"serial",
+	link_hal_serial_open,
+	link_hal_serial_write_block,
+	link_hal_serial_read_block
+};
+
+int link_hal_serial_open(const char* path) {
+	struct termios options;
+
+	link_hal_serial_fd = open(path, O_RDWR | O_NOCTTY | O_NDELAY);
+	if (link_hal_serial_fd < 0) {
+		return link_hal_serial_fd;
+	}
+
+	fcntl(link_hal_serial_fd, F_SETFL, 0);
+
+	/* get current status */
+	tcgetattr(link_hal_serial_fd, &options);
+
+	cfsetispeed(&options, B115200);
+	cfsetospeed(&options, B115200);
+
+	/* No parity (8N1) */
+	options.c_cflag &= ~PARENB;
+	options.c_cflag &= ~CSTOPB;
+	options.c_cflag &= ~CSIZE;
+	options.c_cflag |= CS8;
+
+	options.c_cflag |= (CLOCAL | CREAD);
+	options.c_cflag &= ~CRTSCTS;
+
+	cfmakeraw(&options);
+
+	tcflush(link_hal_serial_fd, TCIFLUSH);
+	if (tcsetattr(link_hal_serial_fd, TCSANOW, &options) != 0) {
+		SYS_DBG("error in tcsetattr()\n");
+	}
+	return 0;
+}
+
+int32_t link_hal_serial_write_block(uint8_t* data, uint32_t len) {
+	return write(link_hal_serial_fd, data, len);
+}
+
+int32_t link_hal_serial_read_block(uint8_t* data, uint32_t size) {
+	int32_t len = read(link_hal_serial_fd, data, size);
+
+	if (len < 0) {
+		usleep(100000);
+		return 0;
+	}
+	return len;
+}
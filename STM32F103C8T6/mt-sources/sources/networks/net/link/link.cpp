@@ -1,5 +1,7 @@
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 
 #include "app.h"
 #include "app_if.h"
@@ -19,6 +21,8 @@
 #include "link_data.h"
 #include "link_mac.h"
 #include "link_phy.h"
+#include "link_lz.h"
+#include "link_rpc.h"
 
 static fsm_t fsm_link;
 static void fsm_link_state_init(ak_msg_t* msg);
@@ -26,6 +30,98 @@ static void fsm_link_state_handle(ak_msg_t* msg);
 
 static void task_link(ak_msg_t* msg);
 
+/* send messages waiting for a free pdu, one queue per channel. Kept as copies
+ * since the posted one is freed */
+static q_msg_t link_send_hold_q[LINK_CHANNEL_NUM];
+static uint32_t link_send_hold_len; /* all channels */
+static uint32_t link_send_over;
+
+/* messages taken by link_send_post(), still in the mailbox. Counted with the
+ * held ones so senders see LINK_SEND_STATUS_FULL before they overrun */
+static uint32_t link_send_posted;
+
+/* senders waiting for link to take messages again, set by link_send_wait() */
+typedef struct {
+	uint32_t task_id;
+	uint8_t sig;
+} link_send_waiter_t;
+
+static link_send_waiter_t link_send_waiter[LINK_SEND_WAIT_MAX];
+static uint8_t link_send_waiter_len;
+
+/* pdus given up by mac, sent again on GW_LINK_SEND_RETRY_TO */
+static link_pdu_t* link_send_retry_head;
+static link_pdu_t* link_send_retry_tail;
+
+/* channel of a destination task, set by link_set_channel() */
+typedef struct {
+	uint32_t task_id;
+	uint8_t channel;
+} link_channel_map_t;
+
+static pthread_mutex_t mt_link_channel;
+static link_channel_map_t link_channel_map[LINK_CHANNEL_MAP_SIZE];
+static uint8_t link_channel_map_len;
+
+/* remote route of a destination, set by link_route_set() */
+typedef struct {
+	uint8_t if_type;
+	uint8_t task_id;
+	uint8_t channel;
+} link_route_t;
+
+static link_route_t link_route_table[LINK_ROUTE_TABLE_SIZE];
+static uint8_t link_route_table_len;
+
+/* bus station of an interface, set by link_station_set() */
+typedef struct {
+	uint8_t if_type;
+	uint32_t station;
+} link_station_map_t;
+
+static link_station_map_t link_station_map[LINK_STATION_MAP_SIZE];
+static uint8_t link_station_map_len;
+
+static link_channel_stat_t link_channel_stat[LINK_CHANNEL_NUM];
+
+#define LINK_CHANNEL_STAT_SENT		(0)
+#define LINK_CHANNEL_STAT_ERR		(1)
+#define LINK_CHANNEL_STAT_LOST		(2)
+static link_stat_t link_stat;
+
+/* small messages of the normal channel packed into one pdu while an earlier
+ * pdu is on the way, only with a peer which negotiated LINK_PHY_CAP_LINK_AGGREGATE */
+#define LINK_FRAME_COMMON_MSG_LEN(data_len)		(sizeof(ak_msg_common_if_t) - AK_COMMON_MSG_DATA_SIZE + (data_len))
+#define LINK_FRAME_DYNAMIC_MSG_LEN(data_len)	(sizeof(ak_msg_if_header_t) + sizeof(uint32_t) + (data_len))
+
+static link_pdu_t* link_send_agg_pdu; /* to a single station */
+static uint8_t link_send_agg_cnt;
+static uint8_t link_send_pdu_pending; /* pdus given to mac, not answered yet */
+
+/* pdu coded before sending or decoded after receiving, only with a peer
+ * which negotiated LINK_PHY_CAP_LINK_LZ */
+static link_frame_t link_lz_frame;
+
+static uint8_t link_route_find(uint8_t if_type, uint8_t task_id);
+static uint8_t link_send_channel(ak_msg_t* msg);
+static uint32_t link_send_station(ak_msg_t* msg);
+static uint8_t link_send_msg(ak_msg_t* msg, uint8_t channel);
+static void link_send_frame(ak_msg_t* msg, link_frame_t* link_frame);
+static void link_send_pdu(link_pdu_t* link_pdu);
+static uint8_t link_send_agg_put(ak_msg_t* msg, uint32_t station);
+static void link_send_agg_flush();
+static void link_send_lz(link_pdu_t* link_pdu);
+static uint32_t link_rev_lz(link_frame_t* link_frame, uint32_t len);
+static void link_rev_frame(link_frame_t* link_frame, uint32_t len, uint32_t station);
+static void link_rev_post(ak_msg_t* msg, uint32_t station);
+static void link_send_hold(ak_msg_t* msg, uint8_t channel);
+static void link_send_release();
+static uint8_t link_send_pending_status();
+static void link_send_wake();
+static void link_send_retry(link_pdu_t* link_pdu);
+static void link_send_pdu_end(uint32_t pdu_id);
+static void link_channel_stat_inc(uint32_t pdu_id, uint8_t stat);
+
 void task_link(ak_msg_t* msg) {
 	fsm_dispatch(&fsm_link, msg);
 }
@@ -44,6 +140,26 @@ void fsm_link_state_init(ak_msg_t* msg) {
 		/* link protocol data unit pool initial */
 		link_pdu_init();
 
+		/* frame buffer pool shared by mac/phy */
+		link_fbuf_init();
+
+		pthread_mutex_lock(&mt_link_channel);
+		for (uint8_t channel = 0; channel < LINK_CHANNEL_NUM; channel++) {
+			q_msg_init(&link_send_hold_q[channel]);
+			memset(&link_channel_stat[channel], 0, sizeof(link_channel_stat_t));
+		}
+		link_send_hold_len = 0;
+		link_send_over = 0;
+		link_send_posted = 0;
+		link_send_waiter_len = 0;
+		pthread_mutex_unlock(&mt_link_channel);
+		memset((uint8_t*)&link_stat, 0, sizeof(link_stat_t));
+
+		link_send_retry_head = LINK_PDU_NULL;
+		link_send_retry_tail = LINK_PDU_NULL;
+		link_send_agg_pdu = LINK_PDU_NULL;
+		link_send_pdu_pending = 0;
+
 		/* request lower layer init */
 		task_post_pure_msg(MT_LINK_MAC_ID, GW_LINK_MAC_INIT);
 	}
@@ -70,151 +186,91 @@ void fsm_link_state_init(ak_msg_t* msg) {
 
 void fsm_link_state_handle(ak_msg_t* msg) {
 	switch (msg->header->sig) {
-	case GW_LINK_SEND_PURE_MSG: {
-//		APP_DBG_SIG("GW_LINK_SEND_PURE_MSG\n");
-		link_pdu_t* link_pdu = link_pdu_malloc();
+	case GW_LINK_SEND_PURE_MSG:
+	case GW_LINK_SEND_COMMON_MSG:
+	case GW_LINK_SEND_DYNAMIC_MSG:
+	case GW_LINK_SEND_DATA: {
+//		APP_DBG_SIG("GW_LINK_SEND_MSG\n");
+		uint8_t channel = link_send_channel(msg);
 
-		if (link_pdu == LINK_PDU_NULL) {
-			task_post_pure_msg(MT_LINK_ID, GW_LINK_SEND_HANDLE_PDU_FULL);
+		/* keep sending order inside a channel */
+		if (q_msg_available(&link_send_hold_q[channel]) || !link_send_msg(msg, channel)) {
+			link_send_hold(msg, channel);
 		}
-		else {
-			ak_msg_pure_if_t if_msg;
-			if_msg.header.src_task_id = msg->header->if_src_task_id;
-			if_msg.header.des_task_id = msg->header->if_des_task_id;
-			if_msg.header.type = get_msg_type(msg);
-			if_msg.header.if_src_type = msg->header->if_src_type;
-			if_msg.header.if_des_type = msg->header->if_des_type;
-			if_msg.header.sig = msg->header->if_sig;
-
-			link_frame_t link_frame;
-			link_frame.header.src_addr = if_msg.header.src_task_id;
-			link_frame.header.des_addr = if_msg.header.des_task_id;
-			link_frame.header.type = LINK_FRAME_TYPE_PURE_MSG;
-			link_frame.header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
-			link_frame.header.len = sizeof(ak_msg_pure_if_t);
-			memcpy(link_frame.data, (uint8_t*)&if_msg, link_frame.header.len);
-
-			link_pdu->len = sizeof(link_frame_header_t) + link_frame.header.len;
-			memcpy(link_pdu->payload, (uint8_t*)&link_frame, link_pdu->len);
 
-			uint32_t link_pdu_id = link_pdu->id;
-			task_post_common_msg(MT_LINK_MAC_ID, GW_LINK_MAC_FRAME_SEND_REQ, (uint8_t*)&link_pdu_id, sizeof(uint32_t));
+		/* counted as held now or sent */
+		pthread_mutex_lock(&mt_link_channel);
+		if (link_send_posted > 0) {
+			link_send_posted--;
 		}
+		pthread_mutex_unlock(&mt_link_channel);
+
+		link_send_wake();
 	}
 		break;
 
-	case GW_LINK_SEND_COMMON_MSG: {
-//		APP_DBG_SIG("GW_LINK_SEND_COMMON_MSG\n");
-		link_pdu_t* link_pdu = link_pdu_malloc();
-
-		if (link_pdu == LINK_PDU_NULL) {
-			task_post_pure_msg(MT_LINK_ID, GW_LINK_SEND_HANDLE_PDU_FULL);
-		}
-		else {
-			ak_msg_common_if_t if_msg;
-			if_msg.header.src_task_id = msg->header->if_src_task_id;
-			if_msg.header.des_task_id = msg->header->if_des_task_id;
-			if_msg.header.type = get_msg_type(msg);
-			if_msg.header.if_src_type = msg->header->if_src_type;
-			if_msg.header.if_des_type = msg->header->if_des_type;
-			if_msg.header.sig = msg->header->if_sig;
-			if_msg.len = get_data_len_common_msg(msg);
-			memcpy(if_msg.data, get_data_common_msg(msg), if_msg.len);
-
-			link_frame_t link_frame;
-			link_frame.header.src_addr = if_msg.header.src_task_id;
-			link_frame.header.des_addr = if_msg.header.des_task_id;
-			link_frame.header.type = LINK_FRAME_TYPE_COMMON_MSG;
-			link_frame.header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
-			link_frame.header.len = sizeof(ak_msg_common_if_t);
-			memcpy(link_frame.data, (uint8_t*)&if_msg, link_frame.header.len);
-
-			link_pdu->len = sizeof(link_frame_header_t) + link_frame.header.len;
-			memcpy(link_pdu->payload, (uint8_t*)&link_frame, link_pdu->len);
+	case GW_LINK_SEND_HANDLE_PDU_FULL: {
+//		APP_DBG_SIG("GW_LINK_SEND_HANDLE_PDU_FULL\n");
+		link_send_release();
+		link_send_wake();
+	}
+		break;
 
-			uint32_t link_pdu_id = link_pdu->id;
-			task_post_common_msg(MT_LINK_MAC_ID, GW_LINK_MAC_FRAME_SEND_REQ, (uint8_t*)&link_pdu_id, sizeof(uint32_t));
-		}
+	case GW_LINK_SEND_DONE: {
+//		APP_DBG_SIG("GW_LINK_SEND_DONE\n");
+		uint32_t* link_pdu_send_done = (uint32_t*)get_data_common_msg(msg);
+		link_channel_stat_inc(*link_pdu_send_done, LINK_CHANNEL_STAT_SENT);
+		link_send_pdu_end(*link_pdu_send_done);
 	}
 		break;
 
-	case GW_LINK_SEND_DYNAMIC_MSG: {
-//		APP_DBG_SIG("GW_LINK_SEND_DYNAMIC_MSG\n");
-		link_pdu_t* link_pdu = link_pdu_malloc();
+	case GW_LINK_SEND_ERR: {
+//		APP_DBG_SIG("GW_LINK_SEND_ERR\n");
+		uint32_t* link_pdu_send_err = (uint32_t*)get_data_common_msg(msg);
+		link_pdu_t* link_pdu = link_pdu_get(*link_pdu_send_err);
 
-		if (link_pdu == LINK_PDU_NULL) {
-			task_post_pure_msg(MT_LINK_ID, GW_LINK_SEND_HANDLE_PDU_FULL);
+		/* multi-drop: a station given up would hold the pdu pool for the others */
+		if (link_phy_get_station_down(link_pdu->station)) {
+			link_channel_stat_inc(*link_pdu_send_err, LINK_CHANNEL_STAT_LOST);
+			link_send_pdu_end(*link_pdu_send_err);
+			break;
 		}
-		else {
-			ak_msg_dynamic_if_t if_msg;
-			if_msg.header.src_task_id = msg->header->if_src_task_id;
-			if_msg.header.des_task_id = msg->header->if_des_task_id;
-			if_msg.header.type = get_msg_type(msg);
-			if_msg.header.if_src_type = msg->header->if_src_type;
-			if_msg.header.if_des_type = msg->header->if_des_type;
-			if_msg.header.sig = msg->header->if_sig;
-			if_msg.len = get_data_len_dynamic_msg(msg);
-
-			link_frame_t link_frame;
-			link_frame.header.src_addr = if_msg.header.src_task_id;
-			link_frame.header.des_addr = if_msg.header.des_task_id;
-			link_frame.header.type = LINK_FRAME_TYPE_DYNAMIC_MSG;
-			link_frame.header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
-			link_frame.header.len = sizeof(ak_msg_if_header_t) + sizeof(uint32_t) + if_msg.len;
-			memcpy(&link_frame.data[0], (uint8_t*)&if_msg, sizeof(ak_msg_if_header_t) + sizeof(uint32_t));
-			get_data_dynamic_msg(msg, (uint8_t*)&link_frame.data[sizeof(ak_msg_if_header_t) + sizeof(uint32_t)], if_msg.len);
-
-			link_pdu->len = sizeof(link_frame_header_t) + link_frame.header.len;
-			memcpy(link_pdu->payload, (uint8_t*)&link_frame, link_pdu->len);
+		link_channel_stat_inc(*link_pdu_send_err, LINK_CHANNEL_STAT_ERR);
 
-			uint32_t link_pdu_id = link_pdu->id;
-			task_post_common_msg(MT_LINK_MAC_ID, GW_LINK_MAC_FRAME_SEND_REQ, (uint8_t*)&link_pdu_id, sizeof(uint32_t));
-		}
+		/* pdu stays pending, peer gets it once it answers again */
+		link_send_retry(link_pdu);
 	}
 		break;
 
-	case GW_LINK_SEND_DATA: {
-//		APP_DBG_SIG("GW_LINK_SEND_DATA\n");
-		link_pdu_t* link_pdu = link_pdu_malloc();
-
-		if (link_pdu == LINK_PDU_NULL) {
-			task_post_pure_msg(MT_LINK_ID, GW_LINK_SEND_HANDLE_PDU_FULL);
-		}
-		else {
-			link_frame_t link_frame;
-			link_frame.header.src_addr = link_get_src_addr();
-			link_frame.header.des_addr = link_get_des_addr();
-			link_frame.header.type = LINK_FRAME_TYPE_DATA;
-			link_frame.header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
-			link_frame.header.len = get_data_len_common_msg(msg);
-			memcpy(link_frame.data, get_data_common_msg(msg), link_frame.header.len);
-
-			link_pdu->len = sizeof(link_frame_header_t) + link_frame.header.len;
+	case GW_LINK_SEND_RETRY_TO: {
+		LINK_DBG_SIG("GW_LINK_SEND_RETRY_TO\n");
+		while (link_send_retry_head != LINK_PDU_NULL) {
+			link_pdu_t* link_pdu = link_send_retry_head;
+			link_send_retry_head = link_pdu->next;
 
+			/* already coded, only mac sends it again */
 			uint32_t link_pdu_id = link_pdu->id;
 			task_post_common_msg(MT_LINK_MAC_ID, GW_LINK_MAC_FRAME_SEND_REQ, (uint8_t*)&link_pdu_id, sizeof(uint32_t));
 		}
+		link_send_retry_tail = LINK_PDU_NULL;
 	}
 		break;
 
-	case GW_LINK_SEND_HANDLE_PDU_FULL: {
-//		APP_DBG_SIG("GW_LINK_SEND_HANDLE_PDU_FULL\n");
+	case GW_LINK_SEND_AGG_TO: {
+		LINK_DBG_SIG("GW_LINK_SEND_AGG_TO\n");
+		link_send_agg_flush();
 	}
 		break;
 
-	case GW_LINK_SEND_DONE: {
-//		APP_DBG_SIG("GW_LINK_SEND_DONE\n");
-		uint32_t* link_pdu_send_done = (uint32_t*)get_data_common_msg(msg);
-		link_pdu_free(*link_pdu_send_done);
+	case GW_LINK_RPC_RES: {
+		LINK_DBG_SIG("GW_LINK_RPC_RES\n");
+		link_rpc_rev(msg);
 	}
 		break;
 
-	case GW_LINK_SEND_ERR: {
-//		APP_DBG_SIG("GW_LINK_SEND_ERR\n");
-		uint32_t* link_pdu_send_err = (uint32_t*)get_data_common_msg(msg);
-		link_pdu_free(*link_pdu_send_err);
-
-		/* TODO: handle ERROR */
+	case GW_LINK_RPC_TICK: {
+		LINK_DBG_SIG("GW_LINK_RPC_TICK\n");
+		link_rpc_tick();
 	}
 		break;
 
@@ -223,73 +279,737 @@ void fsm_link_state_handle(ak_msg_t* msg) {
 		uint32_t* rev_pdu_id = (uint32_t*)get_data_common_msg(msg);
 		link_pdu_t* link_pdu = link_pdu_get(*rev_pdu_id);
 		link_frame_t* link_frame = (link_frame_t*)link_pdu->payload;
+		uint32_t len = link_pdu->len;
+
+		if (len >= sizeof(link_frame_header_t) && link_frame->header.sub_type == LINK_FRAME_SUB_TYPE_LZ) {
+			len = link_rev_lz(link_frame, len);
+			link_frame = &link_lz_frame;
+		}
+
+		if (len > 0) {
+			link_rev_frame(link_frame, len, link_pdu->station);
+		}
+
+		link_pdu_free(*rev_pdu_id);
+
+		/* receive pdu is back, mac advertises it to peer */
+		task_post_pure_msg(MT_LINK_MAC_ID, GW_LINK_MAC_REV_PDU_FREE);
+	}
+		break;
+
+	default:
+		break;
+	}
+}
+
+uint8_t link_send_status() {
+	pthread_mutex_lock(&mt_link_channel);
+	uint8_t status = link_send_pending_status();
+	pthread_mutex_unlock(&mt_link_channel);
+
+	return status;
+}
+
+uint32_t link_send_over_get() {
+	return link_send_over;
+}
+
+uint8_t link_send_post(ak_msg_t* msg) {
+	pthread_mutex_lock(&mt_link_channel);
+	uint8_t status = link_send_pending_status();
+	if (status == LINK_SEND_STATUS_FULL) {
+		pthread_mutex_unlock(&mt_link_channel);
+		return status;
+	}
+	link_send_posted++;
+	pthread_mutex_unlock(&mt_link_channel);
+
+	task_post(MT_LINK_ID, msg);
+	return status;
+}
 
-		switch (link_frame->header.type) {
-		case LINK_FRAME_TYPE_PURE_MSG: {
-			ak_msg_pure_if_t* if_msg = (ak_msg_pure_if_t*)link_frame->data;
+void link_send_post_over(ak_msg_t* msg) {
+	pthread_mutex_lock(&mt_link_channel);
+	link_send_posted++;
+	pthread_mutex_unlock(&mt_link_channel);
 
-			ak_msg_t* s_msg = get_pure_msg();
-			set_if_src_task_id(s_msg, if_msg->header.src_task_id);
-			set_if_des_task_id(s_msg, if_msg->header.des_task_id);
-			set_if_src_type(s_msg, if_msg->header.if_src_type);
-			set_if_des_type(s_msg, if_msg->header.if_des_type);
-			set_if_sig(s_msg, if_msg->header.sig);
+	task_post(MT_LINK_ID, msg);
+}
+
+void link_send_wait(uint32_t task_id, uint8_t sig) {
+	/* registered under the lock wake takes, no wakeup is lost in between */
+	pthread_mutex_lock(&mt_link_channel);
+	if (link_send_pending_status() != LINK_SEND_STATUS_FULL) {
+		pthread_mutex_unlock(&mt_link_channel);
+		task_post_pure_msg(task_id, sig);
+		return;
+	}
 
-			set_msg_sig(s_msg, MT_CPU_SERIAL_IF_PURE_MSG_IN);
-			task_post(MT_TASK_IF_CPU_SERIAL_ID, s_msg);
+	for (uint8_t i = 0; i < link_send_waiter_len; i++) {
+		if (link_send_waiter[i].task_id == task_id) {
+			link_send_waiter[i].sig = sig;
+			pthread_mutex_unlock(&mt_link_channel);
+			return;
 		}
-			break;
+	}
 
-		case LINK_FRAME_TYPE_COMMON_MSG: {
-			ak_msg_common_if_t* if_msg = (ak_msg_common_if_t*)link_frame->data;
+	if (link_send_waiter_len >= LINK_SEND_WAIT_MAX) {
+		pthread_mutex_unlock(&mt_link_channel);
+		FATAL("LINK", 0x09);
+	}
+	link_send_waiter[link_send_waiter_len].task_id = task_id;
+	link_send_waiter[link_send_waiter_len].sig = sig;
+	link_send_waiter_len++;
+	pthread_mutex_unlock(&mt_link_channel);
+}
+
+void link_send_q_init(link_send_q_t* send_q, uint32_t task_id, uint8_t sig) {
+	q_msg_init(&send_q->q);
+	send_q->task_id = task_id;
+	send_q->sig = sig;
+}
+
+uint8_t link_send_q_post(link_send_q_t* send_q, ak_msg_t* msg) {
+	/* behind kept ones, sending order stays */
+	if (q_msg_available(&send_q->q)) {
+		q_msg_put(&send_q->q, msg);
+		return LINK_SEND_STATUS_FULL;
+	}
 
-			ak_msg_t* s_msg = get_common_msg();
-			set_if_src_task_id(s_msg, if_msg->header.src_task_id);
-			set_if_des_task_id(s_msg, if_msg->header.des_task_id);
-			set_if_src_type(s_msg, if_msg->header.if_src_type);
-			set_if_des_type(s_msg, if_msg->header.if_des_type);
-			set_if_sig(s_msg, if_msg->header.sig);
-			set_if_data_common_msg(s_msg, if_msg->data, if_msg->len);
+	uint8_t status = link_send_post(msg);
+	if (status == LINK_SEND_STATUS_FULL) {
+		q_msg_put(&send_q->q, msg);
+		link_send_wait(send_q->task_id, send_q->sig);
+	}
+	return status;
+}
 
-			set_msg_sig(s_msg, MT_CPU_SERIAL_IF_COMMON_MSG_IN);
-			task_post(MT_TASK_IF_CPU_SERIAL_ID, s_msg);
+void link_send_q_flush(link_send_q_t* send_q) {
+	while (q_msg_available(&send_q->q)) {
+		/* place is taken before the message leaves the queue */
+		pthread_mutex_lock(&mt_link_channel);
+		if (link_send_pending_status() == LINK_SEND_STATUS_FULL) {
+			pthread_mutex_unlock(&mt_link_channel);
+			link_send_wait(send_q->task_id, send_q->sig);
+			return;
 		}
-			break;
+		link_send_posted++;
+		pthread_mutex_unlock(&mt_link_channel);
+
+		task_post(MT_LINK_ID, q_msg_get(&send_q->q));
+	}
+}
+
+void link_set_channel(uint8_t if_des_task_id, uint8_t channel) {
+	if (channel >= LINK_CHANNEL_NUM) {
+		FATAL("LINK", 0x04);
+	}
+
+	pthread_mutex_lock(&mt_link_channel);
+	for (uint8_t i = 0; i < link_channel_map_len; i++) {
+		if (link_channel_map[i].task_id == if_des_task_id) {
+			link_channel_map[i].channel = channel;
+			pthread_mutex_unlock(&mt_link_channel);
+			return;
+		}
+	}
+
+	if (link_channel_map_len >= LINK_CHANNEL_MAP_SIZE) {
+		pthread_mutex_unlock(&mt_link_channel);
+		FATAL("LINK", 0x05);
+	}
+	link_channel_map[link_channel_map_len].task_id = if_des_task_id;
+	link_channel_map[link_channel_map_len].channel = channel;
+	link_channel_map_len++;
+	pthread_mutex_unlock(&mt_link_channel);
+}
+
+void link_route_set(uint8_t if_des_type, uint8_t if_des_task_id, uint8_t channel) {
+	if (channel >= LINK_CHANNEL_NUM && channel != LINK_CHANNEL_DEFAULT) {
+		FATAL("LINK", 0x06);
+	}
+
+	pthread_mutex_lock(&mt_link_channel);
+	uint8_t i = link_route_find(if_des_type, if_des_task_id);
+	if (i < link_route_table_len) {
+		link_route_table[i].channel = channel;
+		pthread_mutex_unlock(&mt_link_channel);
+		return;
+	}
+
+	if (link_route_table_len >= LINK_ROUTE_TABLE_SIZE) {
+		pthread_mutex_unlock(&mt_link_channel);
+		FATAL("LINK", 0x07);
+	}
+	link_route_table[link_route_table_len].if_type = if_des_type;
+	link_route_table[link_route_table_len].task_id = if_des_task_id;
+	link_route_table[link_route_table_len].channel = channel;
+	link_route_table_len++;
+	pthread_mutex_unlock(&mt_link_channel);
+}
+
+void link_station_set(uint8_t if_type, uint32_t station) {
+	pthread_mutex_lock(&mt_link_channel);
+	for (uint8_t i = 0; i < link_station_map_len; i++) {
+		if (link_station_map[i].if_type == if_type) {
+			link_station_map[i].station = station;
+			pthread_mutex_unlock(&mt_link_channel);
+			return;
+		}
+	}
+
+	if (link_station_map_len >= LINK_STATION_MAP_SIZE) {
+		pthread_mutex_unlock(&mt_link_channel);
+		FATAL("LINK", 0x08);
+	}
+	link_station_map[link_station_map_len].if_type = if_type;
+	link_station_map[link_station_map_len].station = station;
+	link_station_map_len++;
+	pthread_mutex_unlock(&mt_link_channel);
+}
+
+uint8_t link_route_post(link_send_q_t* send_q, ak_msg_t* msg) {
+	pthread_mutex_lock(&mt_link_channel);
+	uint8_t routed = (link_route_find(msg->header->if_des_type, msg->header->if_des_task_id) < link_route_table_len);
+	pthread_mutex_unlock(&mt_link_channel);
+
+	if (!routed) {
+		return LINK_ROUTE_NONE;
+	}
+
+	switch (get_msg_type(msg)) {
+	case PURE_MSG_TYPE:
+		set_msg_sig(msg, GW_LINK_SEND_PURE_MSG);
+		break;
+
+	case COMMON_MSG_TYPE:
+		set_msg_sig(msg, GW_LINK_SEND_COMMON_MSG);
+		break;
+
+	case DYNAMIC_MSG_TYPE:
+		set_msg_sig(msg, GW_LINK_SEND_DYNAMIC_MSG);
+		break;
+
+	default:
+		return LINK_ROUTE_NONE;
+	}
 
-		case LINK_FRAME_TYPE_DYNAMIC_MSG: {
-			ak_msg_dynamic_if_t* if_msg = (ak_msg_dynamic_if_t*)link_frame->data;
+	return link_send_q_post(send_q, msg);
+}
 
-			ak_msg_t* s_msg = get_dynamic_msg();
-			set_if_src_task_id(s_msg, if_msg->header.src_task_id);
-			set_if_des_task_id(s_msg, if_msg->header.des_task_id);
-			set_if_src_type(s_msg, if_msg->header.if_src_type);
-			set_if_des_type(s_msg, if_msg->header.if_des_type);
-			set_if_sig(s_msg, if_msg->header.sig);
-			set_if_data_dynamic_msg(s_msg, (uint8_t*)&link_frame->data[sizeof(ak_msg_if_header_t) + sizeof(uint32_t)], if_msg->len);
+void link_get_channel_stat(uint8_t channel, link_channel_stat_t* stat) {
+	if (channel < LINK_CHANNEL_NUM) {
+		pthread_mutex_lock(&mt_link_channel);
+		*stat = link_channel_stat[channel];
+		pthread_mutex_unlock(&mt_link_channel);
+	}
+}
 
-			set_msg_sig(s_msg, MT_CPU_SERIAL_IF_DYNAMIC_MSG_IN);
-			task_post(MT_TASK_IF_CPU_SERIAL_ID, s_msg);
+void link_get_stat(link_stat_t* stat) {
+	*stat = link_stat;
+}
+
+void link_channel_stat_inc(uint32_t pdu_id, uint8_t stat) {
+	uint8_t channel = link_pdu_get(pdu_id)->channel;
+
+	pthread_mutex_lock(&mt_link_channel);
+	switch (stat) {
+	case LINK_CHANNEL_STAT_SENT:
+		link_channel_stat[channel].sent++;
+		break;
+
+	case LINK_CHANNEL_STAT_ERR:
+		link_channel_stat[channel].err++;
+		break;
+
+	default:
+		link_channel_stat[channel].lost++;
+		break;
+	}
+	pthread_mutex_unlock(&mt_link_channel);
+}
+
+uint8_t link_route_find(uint8_t if_type, uint8_t task_id) {
+	uint8_t i = 0;
+
+	while (i < link_route_table_len && (link_route_table[i].if_type != if_type || link_route_table[i].task_id != task_id)) {
+		i++;
+	}
+	return i;
+}
+
+uint8_t link_send_channel(ak_msg_t* msg) {
+	uint8_t channel = (msg->header->sig == GW_LINK_SEND_DYNAMIC_MSG) ? LINK_CHANNEL_BULK : LINK_CHANNEL_NORMAL;
+
+	if (msg->header->sig != GW_LINK_SEND_DATA) {
+		pthread_mutex_lock(&mt_link_channel);
+		for (uint8_t i = 0; i < link_channel_map_len; i++) {
+			if (link_channel_map[i].task_id == msg->header->if_des_task_id) {
+				channel = link_channel_map[i].channel;
+				break;
+			}
+		}
+
+		uint8_t i = link_route_find(msg->header->if_des_type, msg->header->if_des_task_id);
+		if (i < link_route_table_len && link_route_table[i].channel != LINK_CHANNEL_DEFAULT) {
+			channel = link_route_table[i].channel;
 		}
+		pthread_mutex_unlock(&mt_link_channel);
+	}
+
+	return channel;
+}
+
+uint32_t link_send_station(ak_msg_t* msg) {
+	uint32_t station = LINK_PHY_ADDR_PEER;
+
+	pthread_mutex_lock(&mt_link_channel);
+	for (uint8_t i = 0; i < link_station_map_len; i++) {
+		if (link_station_map[i].if_type == msg->header->if_des_type) {
+			station = link_station_map[i].station;
 			break;
+		}
+	}
+	pthread_mutex_unlock(&mt_link_channel);
+
+	return station;
+}
+
+uint8_t link_send_msg(ak_msg_t* msg, uint8_t channel) {
+	uint32_t station = link_send_station(msg);
+
+	if (channel == LINK_CHANNEL_NORMAL && link_send_agg_put(msg, station)) {
+		return 1;
+	}
+
+	/* nothing overtakes packed messages, urgent one does not wait behind them */
+	link_send_agg_flush();
+
+	/* bulk transfer leaves some pdus to the other channels */
+	if (channel == LINK_CHANNEL_BULK && link_pdu_tx_available() <= LINK_PDU_TX_BULK_RESERVE) {
+		return 0;
+	}
+
+	link_pdu_t* link_pdu = link_pdu_malloc();
+
+	if (link_pdu == LINK_PDU_NULL) {
+		return 0;
+	}
+	link_pdu->channel = channel;
+	link_pdu->station = station;
+
+	/* link frame is built in place */
+	link_frame_t* link_frame = (link_frame_t*)link_pdu->payload;
+	link_send_frame(msg, link_frame);
+	link_pdu->len = sizeof(link_frame_header_t) + link_frame->header.len;
+
+	link_send_pdu(link_pdu);
+	return 1;
+}
+
+void link_send_frame(ak_msg_t* msg, link_frame_t* link_frame) {
+	link_stat.msg_sent++;
+
+	switch (msg->header->sig) {
+	case GW_LINK_SEND_PURE_MSG: {
+		ak_msg_pure_if_t* if_msg = (ak_msg_pure_if_t*)link_frame->data;
+		if_msg->header.src_task_id = msg->header->if_src_task_id;
+		if_msg->header.des_task_id = msg->header->if_des_task_id;
+		if_msg->header.type = get_msg_type(msg);
+		if_msg->header.if_src_type = msg->header->if_src_type;
+		if_msg->header.if_des_type = msg->header->if_des_type;
+		if_msg->header.sig = msg->header->if_sig;
+
+		link_frame->header.src_addr = if_msg->header.src_task_id;
+		link_frame->header.des_addr = if_msg->header.des_task_id;
+		link_frame->header.type = LINK_FRAME_TYPE_PURE_MSG;
+		link_frame->header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
+		link_frame->header.len = sizeof(ak_msg_pure_if_t);
+	}
+		break;
+
+	case GW_LINK_SEND_COMMON_MSG: {
+		ak_msg_common_if_t* if_msg = (ak_msg_common_if_t*)link_frame->data;
+		if_msg->header.src_task_id = msg->header->if_src_task_id;
+		if_msg->header.des_task_id = msg->header->if_des_task_id;
+		if_msg->header.type = get_msg_type(msg);
+		if_msg->header.if_src_type = msg->header->if_src_type;
+		if_msg->header.if_des_type = msg->header->if_des_type;
+		if_msg->header.sig = msg->header->if_sig;
+		if_msg->len = get_data_len_common_msg(msg);
+		memcpy(if_msg->data, get_data_common_msg(msg), if_msg->len);
+
+		link_frame->header.src_addr = if_msg->header.src_task_id;
+		link_frame->header.des_addr = if_msg->header.des_task_id;
+		link_frame->header.type = LINK_FRAME_TYPE_COMMON_MSG;
+		link_frame->header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
+		link_frame->header.len = sizeof(ak_msg_common_if_t);
+	}
+		break;
+
+	case GW_LINK_SEND_DYNAMIC_MSG: {
+		ak_msg_dynamic_if_t* if_msg = (ak_msg_dynamic_if_t*)link_frame->data;
+		if_msg->header.src_task_id = msg->header->if_src_task_id;
+		if_msg->header.des_task_id = msg->header->if_des_task_id;
+		if_msg->header.type = get_msg_type(msg);
+		if_msg->header.if_src_type = msg->header->if_src_type;
+		if_msg->header.if_des_type = msg->header->if_des_type;
+		if_msg->header.sig = msg->header->if_sig;
+		if_msg->len = get_data_len_dynamic_msg(msg);
+
+		link_frame->header.src_addr = if_msg->header.src_task_id;
+		link_frame->header.des_addr = if_msg->header.des_task_id;
+		link_frame->header.type = LINK_FRAME_TYPE_DYNAMIC_MSG;
+		link_frame->header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
+		link_frame->header.len = LINK_FRAME_DYNAMIC_MSG_LEN(if_msg->len);
+
+		get_data_dynamic_msg(msg, (uint8_t*)&link_frame->data[sizeof(ak_msg_if_header_t) + sizeof(uint32_t)], if_msg->len);
+	}
+		break;
+
+	default: { /* GW_LINK_SEND_DATA */
+		link_frame->header.src_addr = link_get_src_addr();
+		link_frame->header.des_addr = link_get_des_addr();
+		link_frame->header.type = LINK_FRAME_TYPE_DATA;
+		link_frame->header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
+		link_frame->header.len = get_data_len_common_msg(msg);
+		memcpy(link_frame->data, get_data_common_msg(msg), link_frame->header.len);
+	}
+		break;
+	}
+}
+
+void link_send_pdu(link_pdu_t* link_pdu) {
+	link_send_lz(link_pdu);
+	link_send_pdu_pending++;
+
+	uint32_t link_pdu_id = link_pdu->id;
+	task_post_common_msg(MT_LINK_MAC_ID, GW_LINK_MAC_FRAME_SEND_REQ, (uint8_t*)&link_pdu_id, sizeof(uint32_t));
+}
+
+uint8_t link_send_agg_put(ak_msg_t* msg, uint32_t station) {
+	uint32_t record_len = sizeof(link_frame_header_t);
+
+	switch (msg->header->sig) {
+	case GW_LINK_SEND_PURE_MSG:
+		record_len += sizeof(ak_msg_pure_if_t);
+		break;
+
+	case GW_LINK_SEND_COMMON_MSG:
+		/* unused data bytes are not sent */
+		record_len += LINK_FRAME_COMMON_MSG_LEN(get_data_len_common_msg(msg));
+		break;
+
+	default:
+		return 0;
+	}
 
-		case LINK_FRAME_TYPE_DATA: {
+	if (!(link_phy_get_caps(station) & LINK_PHY_CAP_LINK_AGGREGATE)) {
+		return 0;
+	}
 
+	if (link_send_agg_pdu != LINK_PDU_NULL && (link_send_agg_pdu->station != station || \
+											   link_send_agg_pdu->len + record_len > LINK_PDU_BUF_SIZE)) {
+		link_send_agg_flush();
+	}
+
+	if (link_send_agg_pdu == LINK_PDU_NULL) {
+		/* idle link sends at once */
+		if (link_send_pdu_pending == 0) {
+			return 0;
 		}
+
+		link_send_agg_pdu = link_pdu_malloc();
+		if (link_send_agg_pdu == LINK_PDU_NULL) {
+			return 0;
+		}
+		link_send_agg_pdu->channel = LINK_CHANNEL_NORMAL;
+		link_send_agg_pdu->station = station;
+		link_send_agg_pdu->len = sizeof(link_frame_header_t);
+		link_send_agg_cnt = 0;
+
+		link_frame_t* link_frame = (link_frame_t*)link_send_agg_pdu->payload;
+		link_frame->header.src_addr = link_get_src_addr();
+		link_frame->header.des_addr = link_get_des_addr();
+		link_frame->header.type = LINK_FRAME_TYPE_AGGREGATE;
+		link_frame->header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
+		link_frame->header.len = 0;
+
+		timer_set(MT_LINK_ID, GW_LINK_SEND_AGG_TO, LINK_SEND_AGG_INTERVAL, TIMER_ONE_SHOT);
+	}
+
+	link_frame_t* record = (link_frame_t*)&link_send_agg_pdu->payload[link_send_agg_pdu->len];
+	link_send_frame(msg, record);
+	record->header.len = record_len - sizeof(link_frame_header_t);
+
+	link_send_agg_pdu->len += record_len;
+	((link_frame_t*)link_send_agg_pdu->payload)->header.len = link_send_agg_pdu->len - sizeof(link_frame_header_t);
+	link_send_agg_cnt++;
+	return 1;
+}
+
+void link_send_agg_flush() {
+	link_pdu_t* link_pdu = link_send_agg_pdu;
+
+	if (link_pdu == LINK_PDU_NULL) {
+		return;
+	}
+	link_send_agg_pdu = LINK_PDU_NULL;
+	timer_remove_attr(MT_LINK_ID, GW_LINK_SEND_AGG_TO);
+
+	/* lone message goes as a plain frame */
+	if (link_send_agg_cnt == 1) {
+		link_pdu->len -= sizeof(link_frame_header_t);
+		memmove(link_pdu->payload, &link_pdu->payload[sizeof(link_frame_header_t)], link_pdu->len);
+	}
+	else {
+		link_stat.agg_pdu++;
+	}
+
+	link_send_pdu(link_pdu);
+}
+
+void link_send_lz(link_pdu_t* link_pdu) {
+	link_frame_t* link_frame = (link_frame_t*)link_pdu->payload;
+
+	if (!(link_phy_get_caps(link_pdu->station) & LINK_PHY_CAP_LINK_LZ) || link_frame->header.len < LINK_LZ_MIN_LEN) {
+		return;
+	}
+
+	/* incompressible data is sent raw */
+	uint32_t lz_len = link_lz_compress(link_frame->data, link_frame->header.len, link_lz_frame.data, link_frame->header.len - 1);
+	if (lz_len == 0) {
+		return;
+	}
+
+	link_stat.lz_pdu++;
+	link_stat.lz_saved += link_frame->header.len - lz_len;
+
+	memcpy(link_frame->data, link_lz_frame.data, lz_len);
+	link_frame->header.sub_type = LINK_FRAME_SUB_TYPE_LZ;
+	link_frame->header.len = lz_len;
+	link_pdu->len = sizeof(link_frame_header_t) + lz_len;
+}
+
+uint32_t link_rev_lz(link_frame_t* link_frame, uint32_t len) {
+	uint32_t lz_len = len - sizeof(link_frame_header_t);
+
+	if (link_frame->header.len < lz_len) {
+		lz_len = link_frame->header.len;
+	}
+
+	uint32_t data_len = link_lz_decompress(link_frame->data, lz_len, link_lz_frame.data, LINK_DATA_BUF_SIZE);
+	if (data_len == 0) {
+		LINK_DBG("[LINK] lz pdu malformed, drop\n");
+		link_stat.rev_err++;
+		return 0;
+	}
+
+	link_lz_frame.header = link_frame->header;
+	link_lz_frame.header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
+	link_lz_frame.header.len = data_len;
+	return sizeof(link_frame_header_t) + data_len;
+}
+
+void link_rev_frame(link_frame_t* link_frame, uint32_t len, uint32_t station) {
+	/* lengths inside the frame come from peer, data is never read past the received bytes */
+	uint32_t data_len = (len > sizeof(link_frame_header_t)) ? len - sizeof(link_frame_header_t) : 0;
+
+	if (data_len > link_frame->header.len) {
+		data_len = link_frame->header.len;
+	}
+
+	switch (link_frame->header.type) {
+	case LINK_FRAME_TYPE_PURE_MSG: {
+		ak_msg_pure_if_t* if_msg = (ak_msg_pure_if_t*)link_frame->data;
+		if (data_len < sizeof(ak_msg_pure_if_t)) {
+			link_stat.rev_err++;
 			break;
+		}
+
+		ak_msg_t* s_msg = get_pure_msg();
+		set_if_src_task_id(s_msg, if_msg->header.src_task_id);
+		set_if_des_task_id(s_msg, if_msg->header.des_task_id);
+		set_if_src_type(s_msg, if_msg->header.if_src_type);
+		set_if_des_type(s_msg, if_msg->header.if_des_type);
+		set_if_sig(s_msg, if_msg->header.sig);
+
+		link_rev_post(s_msg, station);
+	}
+		break;
 
-		default:
+	case LINK_FRAME_TYPE_COMMON_MSG: {
+		ak_msg_common_if_t* if_msg = (ak_msg_common_if_t*)link_frame->data;
+		if (data_len < LINK_FRAME_COMMON_MSG_LEN(0) || if_msg->len > AK_COMMON_MSG_DATA_SIZE || data_len < LINK_FRAME_COMMON_MSG_LEN(if_msg->len)) {
+			link_stat.rev_err++;
 			break;
 		}
 
-		link_pdu_free(*rev_pdu_id);
+		ak_msg_t* s_msg = get_common_msg();
+		set_if_src_task_id(s_msg, if_msg->header.src_task_id);
+		set_if_des_task_id(s_msg, if_msg->header.des_task_id);
+		set_if_src_type(s_msg, if_msg->header.if_src_type);
+		set_if_des_type(s_msg, if_msg->header.if_des_type);
+		set_if_sig(s_msg, if_msg->header.sig);
+		set_if_data_common_msg(s_msg, if_msg->data, if_msg->len);
+
+		link_rev_post(s_msg, station);
+	}
+		break;
+
+	case LINK_FRAME_TYPE_DYNAMIC_MSG: {
+		ak_msg_dynamic_if_t* if_msg = (ak_msg_dynamic_if_t*)link_frame->data;
+		if (data_len < LINK_FRAME_DYNAMIC_MSG_LEN(0) || if_msg->len > data_len - LINK_FRAME_DYNAMIC_MSG_LEN(0)) {
+			link_stat.rev_err++;
+			break;
+		}
+
+		ak_msg_t* s_msg = get_dynamic_msg();
+		set_if_src_task_id(s_msg, if_msg->header.src_task_id);
+		set_if_des_task_id(s_msg, if_msg->header.des_task_id);
+		set_if_src_type(s_msg, if_msg->header.if_src_type);
+		set_if_des_type(s_msg, if_msg->header.if_des_type);
+		set_if_sig(s_msg, if_msg->header.sig);
+		set_if_data_dynamic_msg(s_msg, (uint8_t*)&link_frame->data[LINK_FRAME_DYNAMIC_MSG_LEN(0)], if_msg->len);
+
+		link_rev_post(s_msg, station);
+	}
+		break;
+
+	case LINK_FRAME_TYPE_DATA: {
+
+	}
+		break;
+
+	case LINK_FRAME_TYPE_AGGREGATE: {
+		/* packed frames in sending order, a truncated one ends the pdu */
+		uint32_t offset = 0;
+
+		while (offset + sizeof(link_frame_header_t) <= data_len) {
+			link_frame_t* record = (link_frame_t*)&link_frame->data[offset];
+			uint32_t record_len = sizeof(link_frame_header_t) + record->header.len;
+
+			if (offset + record_len > data_len || record->header.type == LINK_FRAME_TYPE_AGGREGATE) {
+				link_stat.rev_err++;
+				break;
+			}
+			link_rev_frame(record, record_len, station);
+			offset += record_len;
+		}
 	}
 		break;
 
 	default:
+		link_stat.rev_err++;
 		break;
 	}
 }
 
+void link_rev_post(ak_msg_t* msg, uint32_t station) {
+	/* straight to the local task, interface tasks only carry the sending side */
+	if (msg->header->if_des_task_id >= MT_TASK_LIST_LEN) {
+		ak_msg_free(msg);
+		link_stat.rev_err++;
+		return;
+	}
+
+	/* sender is known by its bus address, not by the type it wrote */
+	pthread_mutex_lock(&mt_link_channel);
+	for (uint8_t i = 0; i < link_station_map_len; i++) {
+		if (link_station_map[i].station == station) {
+			set_if_src_type(msg, link_station_map[i].if_type);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&mt_link_channel);
+
+	set_msg_sig(msg, msg->header->if_sig);
+	set_msg_src_task_id(msg, msg->header->if_src_task_id);
+	task_post(msg->header->if_des_task_id, msg);
+	link_stat.msg_rev++;
+}
+
+void link_send_hold(ak_msg_t* msg, uint8_t channel) {
+	q_msg_put(&link_send_hold_q[channel], ak_memcpy_msg(msg));
+
+	pthread_mutex_lock(&mt_link_channel);
+	if (link_send_hold_len >= LINK_SEND_HOLD_MAX) {
+		/* sender ignored LINK_SEND_STATUS_FULL, held all the same */
+		link_send_over++;
+		link_channel_stat[channel].over++;
+		LINK_DBG("[LINK] send hold full, over sig %d\n", msg->header->sig);
+	}
+	link_send_hold_len++;
+	link_channel_stat[channel].hold++;
+	pthread_mutex_unlock(&mt_link_channel);
+}
+
+void link_send_release() {
+	/* highest priority channel takes free pdus first */
+	for (uint8_t channel = 0; channel < LINK_CHANNEL_NUM; channel++) {
+		while (q_msg_available(&link_send_hold_q[channel]) && link_send_msg(link_send_hold_q[channel].head, channel)) {
+			ak_msg_free(q_msg_get(&link_send_hold_q[channel]));
+
+			pthread_mutex_lock(&mt_link_channel);
+			link_send_hold_len--;
+			link_channel_stat[channel].hold--;
+			pthread_mutex_unlock(&mt_link_channel);
+		}
+	}
+}
+
+/* called with mt_link_channel locked */
+uint8_t link_send_pending_status() {
+	uint32_t pending_len = link_send_hold_len + link_send_posted;
+
+	if (pending_len >= LINK_SEND_HOLD_MAX) {
+		return LINK_SEND_STATUS_FULL;
+	}
+	else if (link_send_hold_len > 0) {
+		return LINK_SEND_STATUS_HOLD;
+	}
+	return LINK_SEND_STATUS_READY;
+}
+
+void link_send_wake() {
+	pthread_mutex_lock(&mt_link_channel);
+	if (link_send_waiter_len == 0 || link_send_pending_status() == LINK_SEND_STATUS_FULL) {
+		pthread_mutex_unlock(&mt_link_channel);
+		return;
+	}
+
+	for (uint8_t i = 0; i < link_send_waiter_len; i++) {
+		task_post_pure_msg(link_send_waiter[i].task_id, link_send_waiter[i].sig);
+	}
+	link_send_waiter_len = 0;
+	pthread_mutex_unlock(&mt_link_channel);
+}
+
+void link_send_pdu_end(uint32_t pdu_id) {
+	link_pdu_free(pdu_id);
+	link_send_pdu_pending--;
+
+	/* link is free again, packed messages go now */
+	link_send_agg_flush();
+
+	if (link_send_hold_len > 0) {
+		task_post_pure_msg(MT_LINK_ID, GW_LINK_SEND_HANDLE_PDU_FULL);
+	}
+}
+
+void link_send_retry(link_pdu_t* link_pdu) {
+	link_pdu->next = LINK_PDU_NULL;
+
+	if (link_send_retry_tail == LINK_PDU_NULL) {
+		link_send_retry_head = link_pdu;
+		timer_set(MT_LINK_ID, GW_LINK_SEND_RETRY_TO, LINK_SEND_RETRY_INTERVAL, TIMER_ONE_SHOT);
+	}
+	else {
+		link_send_retry_tail->next = link_pdu;
+	}
+	link_send_retry_tail = link_pdu;
+}
+
 /* PORTING */
 q_msg_t taskLinkMailbox;
 
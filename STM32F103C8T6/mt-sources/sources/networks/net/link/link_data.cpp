@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <stddef.h>
+#include <string.h>
 #include <pthread.h>
 
 #include "ak.h"
@@ -13,59 +15,95 @@
 static uint32_t mac_src_add = 0xFFFFFFFF;
 static uint32_t mac_des_add = 0xFFFFFFFF;
 
+#define LINK_PDU_TX_POOL_SIZE	(LINK_PDU_POOL_SIZE - LINK_PDU_RX_POOL_SIZE)
+
+static_assert(LINK_PDU_RX_POOL_SIZE > 0 && LINK_PDU_TX_POOL_SIZE > 0, "LINK_PDU_RX_POOL_SIZE out of range");
+
+/* pdu id below LINK_PDU_TX_POOL_SIZE belongs to send pool, others to receive pool */
 static link_pdu_t* free_link_pdu_pool;
+static link_pdu_t* free_link_pdu_rx_pool;
+static uint32_t free_link_pdu_tx_pool_available;
+static uint32_t free_link_pdu_rx_pool_available;
 static link_pdu_t link_pdu_pool[LINK_PDU_POOL_SIZE];
 
+static link_fbuf_t* free_link_fbuf_pool;
+static link_fbuf_t link_fbuf_pool[LINK_FBUF_POOL_SIZE];
+static uint32_t link_fbuf_pool_used;
+static uint32_t link_fbuf_pool_used_max;
+
 static pthread_mutex_t mt_link_pdu_pool;
+static pthread_mutex_t mt_link_fbuf_pool;
 static pthread_mutex_t mt_link_addr;
 
 static void link_pdu_fatal(const char* s, uint8_t c);
+static link_pdu_t* link_pdu_alloc(link_pdu_t** free_pool);
+static void link_pdu_release(link_pdu_t* link_pdu);
 
 /* link pdu function */
 void link_pdu_init() {
 	LINK_DBG_DATA("[LINK_DATA] link_pdu_init(%d)\n", LINK_PDU_POOL_SIZE);
 	pthread_mutex_lock(&mt_link_pdu_pool);
-	free_link_pdu_pool = (link_pdu_t*)link_pdu_pool;
+	free_link_pdu_pool = (link_pdu_t*)&link_pdu_pool[0];
+	free_link_pdu_rx_pool = (link_pdu_t*)&link_pdu_pool[LINK_PDU_TX_POOL_SIZE];
 	for (uint32_t i = 0; i < LINK_PDU_POOL_SIZE; i++) {
 		link_pdu_pool[i].id = i;
 		link_pdu_pool[i].is_used = 0;
 
-		if (i == (LINK_PDU_POOL_SIZE - 1)) {
+		if (i == (LINK_PDU_TX_POOL_SIZE - 1) || i == (LINK_PDU_POOL_SIZE - 1)) {
 			link_pdu_pool[i].next = LINK_PDU_NULL;
 		}
 		else {
 			link_pdu_pool[i].next = (link_pdu_t*)&link_pdu_pool[i + 1];
 		}
 	}
+	free_link_pdu_tx_pool_available = LINK_PDU_TX_POOL_SIZE;
+	free_link_pdu_rx_pool_available = LINK_PDU_RX_POOL_SIZE;
 	pthread_mutex_unlock(&mt_link_pdu_pool);
 }
 
 link_pdu_t* link_pdu_malloc() {
 	pthread_mutex_lock(&mt_link_pdu_pool);
-	link_pdu_t* allocate_msg = free_link_pdu_pool;
-	if (allocate_msg == LINK_PDU_NULL) {
-		pthread_mutex_unlock(&mt_link_pdu_pool);
-		LINK_DBG_DATA("[LINK_DATA] LINK_PDU_NULL == link_pdu_malloc()\n");
-		return allocate_msg;
+	link_pdu_t* allocate_msg = link_pdu_alloc(&free_link_pdu_pool);
+	if (allocate_msg != LINK_PDU_NULL) {
+		free_link_pdu_tx_pool_available--;
 	}
-	else {
-		allocate_msg->is_used = 1;
-		free_link_pdu_pool = free_link_pdu_pool->next;
+	pthread_mutex_unlock(&mt_link_pdu_pool);
+	return allocate_msg;
+}
+
+uint32_t link_pdu_tx_available() {
+	uint32_t available;
+	pthread_mutex_lock(&mt_link_pdu_pool);
+	available = free_link_pdu_tx_pool_available;
+	pthread_mutex_unlock(&mt_link_pdu_pool);
+	return available;
+}
+
+link_pdu_t* link_pdu_rx_malloc() {
+	pthread_mutex_lock(&mt_link_pdu_pool);
+	link_pdu_t* allocate_msg = link_pdu_alloc(&free_link_pdu_rx_pool);
+	if (allocate_msg != LINK_PDU_NULL) {
+		free_link_pdu_rx_pool_available--;
 	}
 	pthread_mutex_unlock(&mt_link_pdu_pool);
-	LINK_DBG_DATA("[LINK_DATA] link_pdu_malloc(%d)\n", allocate_msg->id);
 	return allocate_msg;
 }
 
+uint32_t link_pdu_rx_available() {
+	uint32_t available;
+	pthread_mutex_lock(&mt_link_pdu_pool);
+	available = free_link_pdu_rx_pool_available;
+	pthread_mutex_unlock(&mt_link_pdu_pool);
+	return available;
+}
+
 void link_pdu_free(link_pdu_t* link_pdu) {
-	LINK_DBG_DATA("[LINK_DATA] link_pdu_free(%d)\n", link_pdu->id);
 	pthread_mutex_lock(&mt_link_pdu_pool);
 	if ((link_pdu != LINK_PDU_NULL) && \
 			(link_pdu->id < LINK_PDU_POOL_SIZE) && \
 			link_pdu->is_used) {
-		link_pdu->is_used = 0;
-		link_pdu->next = free_link_pdu_pool;
-		free_link_pdu_pool = link_pdu;
+		LINK_DBG_DATA("[LINK_DATA] link_pdu_free(%d)\n", link_pdu->id);
+		link_pdu_release(link_pdu);
 	}
 	else {
 		link_pdu_fatal("LINK_PDU", 0x04);
@@ -92,9 +130,7 @@ void link_pdu_free(uint32_t pdu_id) {
 	LINK_DBG_DATA("[LINK_DATA] link_pdu_free(%d)\n", pdu_id);
 	pthread_mutex_lock(&mt_link_pdu_pool);
 	if (pdu_id < LINK_PDU_POOL_SIZE && link_pdu_pool[pdu_id].is_used) {
-		link_pdu_pool[pdu_id].is_used = 0;
-		link_pdu_pool[pdu_id].next = free_link_pdu_pool;
-		free_link_pdu_pool = &link_pdu_pool[pdu_id];
+		link_pdu_release(&link_pdu_pool[pdu_id]);
 	}
 	else {
 		link_pdu_fatal("LINK_PDU", 0x02);
@@ -102,6 +138,193 @@ void link_pdu_free(uint32_t pdu_id) {
 	pthread_mutex_unlock(&mt_link_pdu_pool);
 }
 
+/* called with mt_link_pdu_pool locked */
+link_pdu_t* link_pdu_alloc(link_pdu_t** free_pool) {
+	link_pdu_t* allocate_msg = *free_pool;
+	if (allocate_msg == LINK_PDU_NULL) {
+		LINK_DBG_DATA("[LINK_DATA] LINK_PDU_NULL == link_pdu_malloc()\n");
+		return allocate_msg;
+	}
+
+	allocate_msg->is_used = 1;
+	allocate_msg->station = LINK_PHY_ADDR_PEER;
+	*free_pool = allocate_msg->next;
+	LINK_DBG_DATA("[LINK_DATA] link_pdu_malloc(%d)\n", allocate_msg->id);
+	return allocate_msg;
+}
+
+/* called with mt_link_pdu_pool locked, pdu goes back to the pool it was taken from */
+void link_pdu_release(link_pdu_t* link_pdu) {
+	link_pdu->is_used = 0;
+	if (link_pdu->id < LINK_PDU_TX_POOL_SIZE) {
+		link_pdu->next = free_link_pdu_pool;
+		free_link_pdu_pool = link_pdu;
+		free_link_pdu_tx_pool_available++;
+	}
+	else {
+		link_pdu->next = free_link_pdu_rx_pool;
+		free_link_pdu_rx_pool = link_pdu;
+		free_link_pdu_rx_pool_available++;
+	}
+}
+
+/* link frame buffer function */
+void link_fbuf_init() {
+	LINK_DBG_DATA("[LINK_DATA] link_fbuf_init()\n");
+	pthread_mutex_lock(&mt_link_fbuf_pool);
+	free_link_fbuf_pool = (link_fbuf_t*)link_fbuf_pool;
+	for (uint32_t i = 0; i < LINK_FBUF_POOL_SIZE; i++) {
+		link_fbuf_pool[i].id = i;
+		link_fbuf_pool[i].ref = 0;
+
+		if (i == (LINK_FBUF_POOL_SIZE - 1)) {
+			link_fbuf_pool[i].next = LINK_FBUF_NULL;
+		}
+		else {
+			link_fbuf_pool[i].next = (link_fbuf_t*)&link_fbuf_pool[i + 1];
+		}
+	}
+	link_fbuf_pool_used = 0;
+	link_fbuf_pool_used_max = 0;
+	pthread_mutex_unlock(&mt_link_fbuf_pool);
+}
+
+link_fbuf_t* link_fbuf_malloc(uint16_t headroom) {
+	if (headroom > LINK_FBUF_SIZE) {
+		FATAL("LINK_FBUF", 0x01);
+	}
+
+	pthread_mutex_lock(&mt_link_fbuf_pool);
+	link_fbuf_t* allocate_fbuf = free_link_fbuf_pool;
+	if (allocate_fbuf == LINK_FBUF_NULL) {
+		pthread_mutex_unlock(&mt_link_fbuf_pool);
+		LINK_DBG_DATA("[LINK_DATA] LINK_FBUF_NULL == link_fbuf_malloc()\n");
+		return allocate_fbuf;
+	}
+	else {
+		allocate_fbuf->ref = 1;
+		allocate_fbuf->head = headroom;
+		allocate_fbuf->len = 0;
+		allocate_fbuf->station = LINK_PHY_ADDR_PEER;
+		free_link_fbuf_pool = free_link_fbuf_pool->next;
+
+		link_fbuf_pool_used++;
+		if (link_fbuf_pool_used >= link_fbuf_pool_used_max) {
+			link_fbuf_pool_used_max = link_fbuf_pool_used;
+		}
+	}
+	pthread_mutex_unlock(&mt_link_fbuf_pool);
+	return allocate_fbuf;
+}
+
+link_fbuf_t* link_fbuf_get(uint32_t fbuf_id) {
+	link_fbuf_t* link_fbuf = LINK_FBUF_NULL;
+	pthread_mutex_lock(&mt_link_fbuf_pool);
+	if ((fbuf_id < LINK_FBUF_POOL_SIZE) && \
+			link_fbuf_pool[fbuf_id].ref) {
+		link_fbuf = (link_fbuf_t*)&link_fbuf_pool[fbuf_id];
+	}
+	else {
+		FATAL("LINK_FBUF", 0x02);
+	}
+	pthread_mutex_unlock(&mt_link_fbuf_pool);
+	return link_fbuf;
+}
+
+void link_fbuf_ref(link_fbuf_t* link_fbuf) {
+	pthread_mutex_lock(&mt_link_fbuf_pool);
+	if ((link_fbuf != LINK_FBUF_NULL) && link_fbuf->ref) {
+		link_fbuf->ref++;
+	}
+	else {
+		FATAL("LINK_FBUF", 0x03);
+	}
+	pthread_mutex_unlock(&mt_link_fbuf_pool);
+}
+
+void link_fbuf_free(link_fbuf_t* link_fbuf) {
+	pthread_mutex_lock(&mt_link_fbuf_pool);
+	if ((link_fbuf != LINK_FBUF_NULL) && \
+			(link_fbuf->id < LINK_FBUF_POOL_SIZE) && \
+			link_fbuf->ref) {
+		if (--link_fbuf->ref == 0) {
+			link_fbuf->next = free_link_fbuf_pool;
+			free_link_fbuf_pool = link_fbuf;
+
+			link_fbuf_pool_used--;
+		}
+	}
+	else {
+		FATAL("LINK_FBUF", 0x04);
+	}
+	pthread_mutex_unlock(&mt_link_fbuf_pool);
+}
+
+uint8_t* link_fbuf_data(link_fbuf_t* link_fbuf) {
+	return &link_fbuf->buf[link_fbuf->head];
+}
+
+uint8_t* link_fbuf_push(link_fbuf_t* link_fbuf, uint16_t len) {
+	if (len > link_fbuf->head) {
+		FATAL("LINK_FBUF", 0x05);
+	}
+	link_fbuf->head -= len;
+	link_fbuf->len += len;
+	return &link_fbuf->buf[link_fbuf->head];
+}
+
+uint8_t* link_fbuf_pull(link_fbuf_t* link_fbuf, uint16_t len) {
+	if (len > link_fbuf->len) {
+		FATAL("LINK_FBUF", 0x06);
+	}
+	link_fbuf->head += len;
+	link_fbuf->len -= len;
+	return &link_fbuf->buf[link_fbuf->head];
+}
+
+uint8_t* link_fbuf_put(link_fbuf_t* link_fbuf, uint16_t len) {
+	uint8_t* tail = &link_fbuf->buf[link_fbuf->head + link_fbuf->len];
+	if (link_fbuf->head + link_fbuf->len + len > LINK_FBUF_SIZE) {
+		FATAL("LINK_FBUF", 0x07);
+	}
+	link_fbuf->len += len;
+	return tail;
+}
+
+void link_fbuf_post(uint32_t des_task_id, uint32_t sig, link_fbuf_t* link_fbuf) {
+#if (LINK_FBUF_COPY)
+	task_post_dynamic_msg(des_task_id, sig, (uint8_t*)link_fbuf, offsetof(link_fbuf_t, buf) + link_fbuf->head + link_fbuf->len);
+#else
+	uint32_t fbuf_id = link_fbuf->id;
+	task_post_common_msg(des_task_id, sig, (uint8_t*)&fbuf_id, sizeof(uint32_t));
+#endif
+}
+
+link_fbuf_t* link_fbuf_msg(ak_msg_t* msg) {
+#if (LINK_FBUF_COPY)
+	/* the buffer stays held while in flight, the frame is copied back into it */
+	link_fbuf_t* copy = (link_fbuf_t*)msg->header->payload;
+	link_fbuf_t* link_fbuf = link_fbuf_get(copy->id);
+	link_fbuf->head = copy->head;
+	link_fbuf->len = copy->len;
+	link_fbuf->station = copy->station;
+	memcpy(&link_fbuf->buf[link_fbuf->head], &copy->buf[copy->head], copy->len);
+	return link_fbuf;
+#else
+	uint32_t fbuf_id;
+	memcpy(&fbuf_id, get_data_common_msg(msg), sizeof(uint32_t));
+	return link_fbuf_get(fbuf_id);
+#endif
+}
+
+uint32_t get_link_fbuf_pool_used() {
+	return link_fbuf_pool_used;
+}
+
+uint32_t get_link_fbuf_pool_used_max() {
+	return link_fbuf_pool_used_max;
+}
+
 /* link address utilities */
 void link_set_src_addr(uint32_t addr) {
 	LINK_DBG_DATA("[LINK_DATA] link_set_src_addr(%d)\n", addr);
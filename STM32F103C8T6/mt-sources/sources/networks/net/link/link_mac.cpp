@@ -14,11 +14,16 @@
 
 #include"fifo.h"
 
+#include "link.h"
 #include "link_sig.h"
 #include "link_phy.h"
 #include "link_mac.h"
 
 #define LINK_PDU_ID_BUF_SIZE	LINK_PDU_POOL_SIZE
+#define LINK_MAC_CHANNEL_NONE	(0xFF)
+#define LINK_MAC_REV_CTX_SIZE	LINK_PDU_RX_POOL_SIZE /* a context holds one receive pdu */
+#define LINK_MAC_REV_CTX_NULL	((link_mac_rev_ctx_t*)0)
+#define LINK_MAC_PEER_NULL		((link_mac_peer_t*)0)
 
 typedef enum {
 	/* private */
@@ -27,54 +32,124 @@ typedef enum {
 	/* pulic */
 	MAC_FRAME_TYPE_REQ,
 
-} phy_frame_type_e;
+	/* private */
+	MAC_FRAME_TYPE_CREDIT, /* flow control, data: [receive limit, first unfinished sending sequence] */
+} mac_frame_type_e;
 
 typedef enum {
 	/* private */
 	MAC_FRAME_SUB_TYPE_NONE,
 
 	/* pulic */
+	MAC_FRAME_SUB_TYPE_CREDIT_ADV = 0x01, /* flag: receive limit is valid */
+	MAC_FRAME_SUB_TYPE_CREDIT_REQ = 0x02, /* flag: peer answers with its receive limit */
 } mac_frame_sub_type_e;
 
 static uint8_t link_mac_frame_cals_checksum(link_mac_frame_t* mac_frame);
-static uint16_t link_mac_frame_cals_datalen(link_mac_frame_t* mac_frame, uint32_t pdu_data_len);
 
-typedef enum {
-	LINK_MAC_SEND_STATE_IDLE,
-	LINK_MAC_SEND_STATE_SENDING
-} link_mac_send_state_e;
+/* mac sending declare, one queue and one pdu in progress per link channel.
+ * Channels share the pdu sequence space of their peer, a pdu takes its sequence
+ * when it is started */
+typedef struct {
+	uint32_t pdu_id_buf[LINK_PDU_ID_BUF_SIZE];
+	fifo_t pdu_id_fifo;
+	link_pdu_t* pdu; /* LINK_PDU_NULL when channel is idle */
+	uint8_t retry_counter;
 
-static link_mac_send_state_e link_mac_send_state;
-static void link_mac_send_state_set(link_mac_send_state_e);
-static link_mac_send_state_e link_mac_send_state_get();
+	/* header of the fragment being sent, data is taken from the pdu per fragment */
+	link_mac_frame_header_t frame;
+	uint16_t frame_data_size; /* fragment payload, fixed per pdu transmission */
+} link_mac_channel_t;
 
-static uint8_t link_mac_pdu_sending_sequence;
-static link_pdu_t* link_mac_pdu_sending;
-static uint8_t link_mac_pdu_sending_retry_counter;
+static link_mac_channel_t link_mac_channel[LINK_CHANNEL_NUM];
 
-static link_mac_frame_t link_mac_frame_send;
+/* one phy request is outstanding per peer, answer is SEND_DONE or SEND_ERR of its station */
+typedef enum {
+	LINK_MAC_PHY_REQ_NONE,
+	LINK_MAC_PHY_REQ_DATA,
+	LINK_MAC_PHY_REQ_CREDIT
+} link_mac_phy_req_e;
+
+/* no frame buffer, sending resumes on GW_LINK_MAC_SEND_RESUME */
+static uint8_t link_mac_fbuf_wait;
+
+/* sequence and flow control state per peer station, one peer point-to-point.
+ * Credit based flow control only with a peer which negotiated LINK_PHY_CAP_MAC_CREDIT.
+ * Limit is in the sender pdu sequence space: receiver advertises last started
+ * sequence + 1 + free receive pdus, sender starts a pdu while its sequence is
+ * below the limit. Both sides re-learn the other after a phy sync.
+ * Fragments of pdus on different channels are interleaved, only with a peer
+ * which negotiated LINK_PHY_CAP_MAC_INTERLEAVE. Otherwise a started pdu is
+ * sent to its end and channel priority applies between pdus to that peer */
+typedef struct {
+	uint8_t used;
+	uint32_t addr; /* bus address, LINK_PHY_ADDR_PEER point-to-point */
+	uint8_t sending_sequence;
+	uint8_t receiving_sequence; /* last pdu started by peer */
+	uint8_t rx_sequence_valid; /* receiving_sequence is last pdu started by peer */
+	uint8_t rx_limit_sent;
+	uint8_t credit_en;
+	uint8_t interleave_en;
+	uint8_t credit_send; /* pending credit frame flags, MAC_FRAME_SUB_TYPE_CREDIT_xxx */
+	uint8_t tx_limit;
+	uint8_t tx_limit_valid;
+	uint8_t tx_blocked; /* pdu queued without credit, peer is probed on timeout */
+	uint8_t phy_req; /* link_mac_phy_req_e, a slow station does not hold the others */
+	uint8_t channel_sending; /* channel of LINK_MAC_PHY_REQ_DATA */
+} link_mac_peer_t;
+
+static link_mac_peer_t link_mac_peer[LINK_PHY_SESSION_NUM];
+
+static void link_mac_peer_init(link_mac_peer_t* peer, uint32_t addr);
+static link_mac_peer_t* link_mac_peer_find(uint32_t addr);
+static link_mac_peer_t* link_mac_peer_get(uint32_t addr);
+static void link_mac_peer_synced(link_mac_peer_t* peer);
+static uint8_t link_mac_peer_sending(link_mac_peer_t* peer);
+
+static uint16_t link_mac_frame_cals_datalen(link_mac_channel_t* channel);
 
 uint32_t link_mac_frame_send_to_interval;
 uint32_t link_mac_frame_rev_to_interval;
 
-static void link_mac_frame_send_end();
-static void link_mac_frame_send_req();
-
-/* mac receiving declare */
-typedef enum {
-	LINK_MAC_REV_STATE_IDLE,
-	LINK_MAC_REV_STATE_RECEIVING
-} link_mac_rev_state_e;
-
-static link_mac_rev_state_e link_mac_rev_state;
-static void link_mac_rev_state_set(link_mac_rev_state_e);
-static link_mac_rev_state_e link_mac_rev_state_get();
-
-static uint8_t link_mac_pdu_receiving_sequence;
-static link_pdu_t* link_mac_pdu_receiving;
-
-static uint32_t link_pdu_id_buf[LINK_PDU_ID_BUF_SIZE];
-static fifo_t link_pdu_id_fifo;
+static void link_mac_frame_send_end(link_mac_channel_t* channel);
+static void link_mac_frame_send_req(link_mac_channel_t* channel);
+static void link_mac_frame_send_fragmentation(link_mac_channel_t* channel);
+
+/* mac receiving declare, one reassembly context per pdu in progress keyed by
+ * (source station, sequence). Contexts time out independently on a common tick. */
+typedef struct {
+	link_pdu_t* pdu; /* LINK_PDU_NULL when context is free */
+	uint32_t station;
+	uint8_t seq_num;
+	uint8_t fidx_next; /* fragments come in order, after a gap sender restarts from 0 */
+	uint16_t data_size; /* fragment payload of the sender */
+	uint32_t to; /* ms left before context is given up */
+	uint32_t start; /* start order, oldest is given up first */
+} link_mac_rev_ctx_t;
+
+static link_mac_rev_ctx_t link_mac_rev_ctx[LINK_MAC_REV_CTX_SIZE];
+static uint8_t link_mac_rev_ctx_used;
+static uint32_t link_mac_rev_ctx_start;
+
+static link_mac_rev_ctx_t* link_mac_rev_ctx_find(uint32_t station, uint8_t seq_num);
+static link_mac_rev_ctx_t* link_mac_rev_ctx_alloc(uint32_t station, uint8_t seq_num);
+static void link_mac_rev_ctx_frame(link_mac_rev_ctx_t* ctx, link_mac_frame_t* mac_frame);
+static void link_mac_rev_ctx_release(link_mac_rev_ctx_t* ctx);
+static void link_mac_rev_ctx_abort(link_mac_rev_ctx_t* ctx);
+
+static void link_mac_send_next();
+static uint8_t link_mac_send_select();
+static void link_mac_send_start(uint8_t channel_id, link_mac_peer_t* peer);
+static uint8_t link_mac_send_oldest_sequence(link_mac_peer_t* peer);
+static void link_mac_send_fbuf_wait();
+static void link_mac_rev_abort(uint32_t station, uint8_t seq_num);
+static uint8_t link_mac_rx_limit(link_mac_peer_t* peer);
+static void link_mac_credit_update();
+static void link_mac_credit_unblock(link_mac_peer_t* peer);
+
+static link_mac_stat_t link_mac_stat;
+static void link_mac_credit_send_req(link_mac_peer_t* peer);
+static void link_mac_credit_rev(link_mac_peer_t* peer, link_mac_frame_t* mac_frame);
 
 fsm_t fsm_link_mac;
 
@@ -96,17 +171,28 @@ void fsm_link_mac_state_init(ak_msg_t* msg) {
 	case GW_LINK_MAC_PHY_LAYER_STARTED: {
 		LINK_DBG_SIG("GW_LINK_MAC_PHY_LAYER_STARTED\n");
 		/* init mac layer */
-		fifo_init(&link_pdu_id_fifo, link_pdu_id_buf, LINK_PDU_ID_BUF_SIZE, sizeof(uint32_t));
+		for (uint32_t i = 0; i < LINK_CHANNEL_NUM; i++) {
+			fifo_init(&link_mac_channel[i].pdu_id_fifo, link_mac_channel[i].pdu_id_buf, LINK_PDU_ID_BUF_SIZE, sizeof(uint32_t));
+			link_mac_channel[i].pdu = LINK_PDU_NULL;
+		}
 
-		/* init mac sequence */
-		link_mac_pdu_sending_sequence = (uint8_t)rand();
-		link_mac_pdu_receiving_sequence = (uint8_t)rand();
+		/* init mac sequence, no flow control until peer answered sync */
+		for (uint32_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+			link_mac_peer[i].used = 0;
+		}
+		link_mac_peer_init(&link_mac_peer[0], LINK_PHY_ADDR_PEER);
 
 		/* init seding/receiving state */
-		link_mac_send_state_set(LINK_MAC_SEND_STATE_IDLE);
-		link_mac_rev_state_set(LINK_MAC_REV_STATE_IDLE);
+		link_mac_fbuf_wait = 0;
+
+		for (uint32_t i = 0; i < LINK_MAC_REV_CTX_SIZE; i++) {
+			link_mac_rev_ctx[i].pdu = LINK_PDU_NULL;
+		}
+		link_mac_rev_ctx_used = 0;
 
-		uint32_t link_phy_get_send_frame = link_phy_get_send_frame_to();
+		memset(&link_mac_stat, 0, sizeof(link_mac_stat_t));
+
+		uint32_t link_phy_get_send_frame = link_phy_get_send_frame_to(LINK_PHY_ADDR_PEER);
 
 		link_mac_frame_send_to_interval = 2 * link_phy_get_send_frame;
 		link_mac_frame_rev_to_interval = 2 * link_phy_get_send_frame;
@@ -129,166 +215,235 @@ void fsm_link_mac_state_handle(ak_msg_t* msg) {
 		uint32_t pdu_id;
 		memcpy(&pdu_id, get_data_common_msg(msg), sizeof(uint32_t));
 
-		if (link_mac_send_state_get() == LINK_MAC_SEND_STATE_IDLE) {
-			link_mac_send_state_set(LINK_MAC_SEND_STATE_SENDING);
-			task_post_common_msg(MT_LINK_MAC_ID, GW_LINK_MAC_FRAME_SEND_START, (uint8_t*)&pdu_id, sizeof(uint32_t));
+		uint8_t channel = link_pdu_get(pdu_id)->channel;
+		if (channel >= LINK_CHANNEL_NUM) {
+			channel = LINK_CHANNEL_NORMAL;
 		}
-		else {
-			if (fifo_is_full(&link_pdu_id_fifo)) {
-				FATAL("LINK_MAC", 0x03);
-			}
-			else {
-				fifo_put(&link_pdu_id_fifo, (uint8_t*)&pdu_id);
-			}
-		}
-	}
-		break;
-
-	case GW_LINK_MAC_FRAME_SEND_START: {
-		LINK_DBG_SIG("GW_LINK_MAC_FRAME_SEND_START\n");
-		uint32_t pdu_id;
-		memcpy(&pdu_id, get_data_common_msg(msg), sizeof(uint32_t));
-
-		if (link_mac_send_state_get() == LINK_MAC_SEND_STATE_SENDING) {
-			link_mac_pdu_sending_retry_counter = 0;
 
-			link_mac_pdu_sending = link_pdu_get(pdu_id);
-
-			link_mac_frame_send.header.des_addr = link_get_des_addr();
-			link_mac_frame_send.header.src_addr = link_get_src_addr();
-			link_mac_frame_send.header.type = MAC_FRAME_TYPE_REQ;
-			link_mac_frame_send.header.sub_type = MAC_FRAME_SUB_TYPE_NONE;
-			link_mac_frame_send.header.seq_num = link_mac_pdu_sending_sequence++;
-			link_mac_frame_send.header.fnum = (link_mac_pdu_sending->len / LINK_MAC_FRAME_DATA_SIZE) + \
-					((link_mac_pdu_sending->len % LINK_MAC_FRAME_DATA_SIZE) > 0);
-
-			link_mac_frame_send.header.fidx = 0;
-			link_mac_frame_send.header.len = link_mac_frame_cals_datalen(&link_mac_frame_send, link_mac_pdu_sending->len);
-			memcpy(link_mac_frame_send.data, (uint8_t*)&link_mac_pdu_sending->payload[link_mac_frame_send.header.fidx * LINK_MAC_FRAME_DATA_SIZE], link_mac_frame_send.header.len);
-			link_mac_frame_send.header.fcs = link_mac_frame_cals_checksum(&link_mac_frame_send);
-
-			link_mac_frame_send_req();
-		}
-		else {
-			FATAL("LINK_MAC", 0x04);
+		/* one slot per link pdu, cannot overflow */
+		if (fifo_is_full(&link_mac_channel[channel].pdu_id_fifo)) {
+			FATAL("LINK_MAC", 0x03);
 		}
+		fifo_put(&link_mac_channel[channel].pdu_id_fifo, (uint8_t*)&pdu_id);
+		link_mac_send_next();
 	}
 		break;
 
 	case GW_LINK_MAC_FRAME_SEND_DONE: {
 		LINK_DBG_SIG("GW_LINK_MAC_FRAME_SEND_DONE\n");
-		if (link_mac_send_state_get() == LINK_MAC_SEND_STATE_SENDING) {
-			if (++link_mac_frame_send.header.fidx < link_mac_frame_send.header.fnum) {
-				link_mac_frame_send.header.len = link_mac_frame_cals_datalen(&link_mac_frame_send, link_mac_pdu_sending->len);
-				memcpy(link_mac_frame_send.data, (uint8_t*)&link_mac_pdu_sending->payload[link_mac_frame_send.header.fidx * LINK_MAC_FRAME_DATA_SIZE], link_mac_frame_send.header.len);
-				link_mac_frame_send.header.fcs = link_mac_frame_cals_checksum(&link_mac_frame_send);
+		uint32_t station;
+		memcpy(&station, get_data_common_msg(msg), sizeof(uint32_t));
+
+		/* entry is not recycled while its request is outstanding */
+		link_mac_peer_t* peer = link_mac_peer_find(station);
+		if (peer == LINK_MAC_PEER_NULL) {
+			link_mac_send_next();
+			break;
+		}
 
-				link_mac_frame_send_req();
-			}
-			else {
-				uint32_t link_pdu_send_done = link_mac_pdu_sending->id;
+		if (peer->phy_req == LINK_MAC_PHY_REQ_DATA) {
+			link_mac_channel_t* channel = &link_mac_channel[peer->channel_sending];
+			peer->phy_req = LINK_MAC_PHY_REQ_NONE;
+
+			if (++channel->frame.fidx >= channel->frame.fnum) {
+				uint32_t link_pdu_send_done = channel->pdu->id;
 				task_post_common_msg(MT_LINK_ID, GW_LINK_SEND_DONE, (uint8_t*)&link_pdu_send_done, sizeof(uint32_t));
 
 				/* send link pdu completed */
-				link_mac_frame_send_end();
+				link_mac_frame_send_end(channel);
+				link_mac_stat.pdu_sent++;
 			}
 		}
+		else {
+			peer->phy_req = LINK_MAC_PHY_REQ_NONE;
+		}
+		link_mac_send_next();
 	}
 		break;
 
 	case GW_LINK_MAC_FRAME_SEND_ERR: {
 		LINK_DBG_SIG("GW_LINK_MAC_FRAME_SEND_ERR\n");
-		if (link_mac_pdu_sending_retry_counter >= LINK_MAC_PDU_SENDING_RETRY_COUNTER_MAX) {
-			uint32_t send_pdu_err = link_mac_pdu_sending->id;
-			task_post_common_msg(MT_LINK_ID, GW_LINK_SEND_ERR, (uint8_t*)&send_pdu_err, sizeof(uint32_t));
+		uint32_t station;
+		memcpy(&station, get_data_common_msg(msg), sizeof(uint32_t));
 
-			/* mac frame send false */
-			link_mac_frame_send_end();
+		link_mac_peer_t* peer = link_mac_peer_find(station);
+		if (peer == LINK_MAC_PEER_NULL) {
+			link_mac_send_next();
+			break;
 		}
-		else {
-			/* retry sending PDU */
-			link_mac_frame_send.header.fidx = 0;
-			link_mac_frame_send.header.len = link_mac_frame_cals_datalen(&link_mac_frame_send, link_mac_pdu_sending->len);
-			memcpy(link_mac_frame_send.data, (uint8_t*)&link_mac_pdu_sending->payload[link_mac_frame_send.header.fidx * LINK_MAC_FRAME_DATA_SIZE], link_mac_frame_send.header.len);
-			link_mac_frame_send.header.fcs = link_mac_frame_cals_checksum(&link_mac_frame_send);
 
-			link_mac_frame_send_req();
+		if (peer->phy_req == LINK_MAC_PHY_REQ_DATA) {
+			link_mac_channel_t* channel = &link_mac_channel[peer->channel_sending];
+			peer->phy_req = LINK_MAC_PHY_REQ_NONE;
+
+			if (channel->retry_counter >= LINK_MAC_PDU_SENDING_RETRY_COUNTER_MAX) {
+				uint32_t send_pdu_err = channel->pdu->id;
+				task_post_common_msg(MT_LINK_ID, GW_LINK_SEND_ERR, (uint8_t*)&send_pdu_err, sizeof(uint32_t));
+
+				/* mac frame send false */
+				link_mac_frame_send_end(channel);
+				link_mac_stat.pdu_err++;
+			}
+			else {
+				link_mac_stat.pdu_retry++;
+				/* retry sending PDU, frame size may have been re-negotiated */
+				link_mac_frame_send_fragmentation(channel);
+			}
+			channel->retry_counter++;
+		}
+		else {
+			/* credit frame lost, a blocked peer probes again */
+			peer->phy_req = LINK_MAC_PHY_REQ_NONE;
 		}
-		link_mac_pdu_sending_retry_counter++;
+		link_mac_send_next();
 	}
 		break;
 
 	case GW_LINK_MAC_FRAME_REV: {
 		LINK_DBG_SIG("GW_LINK_MAC_FRAME_REV\n");
-		link_mac_frame_t link_mac_frame_rev;
-		memcpy(&link_mac_frame_rev, get_data_common_msg(msg), sizeof(link_mac_frame_t));
+		/* phy header is already stripped, mac frame is read in place */
+		link_fbuf_t* fbuf = link_fbuf_msg(msg);
+		link_mac_frame_t* link_mac_frame_rev = (link_mac_frame_t*)link_fbuf_data(fbuf);
+
+		/* phy checked its own length only, mac length is not read past it */
+		if (fbuf->len < LINK_MAC_FRAME_HEADER_SIZE || link_mac_frame_rev->header.len > fbuf->len - LINK_MAC_FRAME_HEADER_SIZE) {
+			LINK_DBG("[MAC] frame length %d malformed, drop\n", fbuf->len);
+			link_mac_stat.rev_drop++;
+			link_fbuf_free(fbuf);
+			break;
+		}
 
-		if (link_mac_rev_state_get() == LINK_MAC_REV_STATE_IDLE) {
-			if (link_mac_pdu_receiving_sequence != link_mac_frame_rev.header.seq_num) {
-				link_mac_rev_state_set(LINK_MAC_REV_STATE_RECEIVING);
+		/* sequence space is the one of the sending station */
+		uint32_t station = fbuf->station;
+		link_mac_peer_t* peer = link_mac_peer_get(station);
 
-				/* update receive pdu sequence number */
-				link_mac_pdu_receiving_sequence = link_mac_frame_rev.header.seq_num;
+		if (peer == LINK_MAC_PEER_NULL) {
+			LINK_DBG("[MAC] no peer entry for station %d, drop\n", station);
+			link_mac_stat.rev_drop++;
+			link_fbuf_free(fbuf);
+			break;
+		}
 
-				link_mac_pdu_receiving = link_pdu_malloc();
+		if (link_mac_frame_rev->header.type == MAC_FRAME_TYPE_CREDIT) {
+			link_mac_credit_rev(peer, link_mac_frame_rev);
+			link_fbuf_free(fbuf);
+			break;
+		}
 
-				link_mac_pdu_receiving->len = link_mac_frame_rev.header.len;
-				memcpy(&link_mac_pdu_receiving->payload[link_mac_frame_rev.header.fidx * LINK_MAC_FRAME_DATA_SIZE], link_mac_frame_rev.data, link_mac_frame_rev.header.len);
+		uint8_t seq_num = link_mac_frame_rev->header.seq_num;
+		link_mac_rev_ctx_t* ctx = link_mac_rev_ctx_find(station, seq_num);
+
+		if (ctx == LINK_MAC_REV_CTX_NULL) {
+			if (peer->rx_sequence_valid && \
+					(peer->receiving_sequence == seq_num || \
+					 (peer->interleave_en && (int8_t)(seq_num - peer->receiving_sequence) < 0))) {
+				/* duplicate of a pdu already delivered or given up, interleaving
+				 * peer starts pdus in sequence order */
+				link_fbuf_free(fbuf);
+				break;
 			}
-		}
-		else if (link_mac_pdu_receiving_sequence == link_mac_frame_rev.header.seq_num &&
-				 link_mac_rev_state_get() == LINK_MAC_REV_STATE_RECEIVING) {
-			link_mac_pdu_receiving->len += link_mac_frame_rev.header.len;
-			memcpy(&link_mac_pdu_receiving->payload[link_mac_frame_rev.header.fidx * LINK_MAC_FRAME_DATA_SIZE], link_mac_frame_rev.data, link_mac_frame_rev.header.len);
-		}
 
-		if (link_mac_pdu_receiving_sequence == link_mac_frame_rev.header.seq_num &&
-				link_mac_rev_state_get() == LINK_MAC_REV_STATE_RECEIVING) {
+			/* update receive pdu sequence number */
+			peer->receiving_sequence = seq_num;
+			peer->rx_sequence_valid = 1;
 
-			if (link_mac_frame_rev.header.fidx == (link_mac_frame_rev.header.fnum - 1)) { /* the last frame */
-				link_mac_rev_state_set(LINK_MAC_REV_STATE_IDLE);
-				timer_remove_attr(MT_LINK_MAC_ID, GW_LINK_MAC_FRAME_REV_TO);
+			/* pdu is only taken from its first fragment */
+			if (link_mac_frame_rev->header.fidx == 0) {
+				ctx = link_mac_rev_ctx_alloc(station, seq_num);
 
-				uint32_t rev_pdu = link_mac_pdu_receiving->id;
-				task_post_common_msg(MT_LINK_ID, GW_LINK_REV_MSG, (uint8_t*)&rev_pdu, sizeof(uint32_t));
-			}
-			else {
-				timer_set(MT_LINK_MAC_ID, GW_LINK_MAC_FRAME_REV_TO, link_mac_frame_rev_to_interval, TIMER_ONE_SHOT);
+				if (ctx == LINK_MAC_REV_CTX_NULL) {
+					/* only a peer without credit overruns receive pool */
+					LINK_DBG("[MAC] receive pool full, drop pdu %d\n", seq_num);
+					link_mac_stat.rev_drop++;
+				}
 			}
 		}
+		else if (!peer->rx_sequence_valid) {
+			peer->receiving_sequence = seq_num;
+			peer->rx_sequence_valid = 1;
+		}
+
+		if (ctx != LINK_MAC_REV_CTX_NULL) {
+			link_mac_rev_ctx_frame(ctx, link_mac_frame_rev);
+		}
+
+		link_fbuf_free(fbuf);
 	}
 		break;
 
 	case GW_LINK_MAC_FRAME_REV_TO: {
 		LINK_DBG_SIG("GW_LINK_MAC_FRAME_REV_TO\n");
-		if (link_mac_rev_state_get() == LINK_MAC_REV_STATE_RECEIVING) {
-			link_mac_rev_state_set(LINK_MAC_REV_STATE_IDLE);
-			link_pdu_free(link_mac_pdu_receiving->id);
+		uint8_t aborted = 0;
+
+		for (uint32_t i = 0; i < LINK_MAC_REV_CTX_SIZE; i++) {
+			link_mac_rev_ctx_t* ctx = &link_mac_rev_ctx[i];
+			if (ctx->pdu == LINK_PDU_NULL) {
+				continue;
+			}
+
+			if (ctx->to <= LINK_MAC_TICK_INTERVAL) {
+				link_mac_rev_ctx_abort(ctx);
+				link_mac_stat.rev_to++;
+				aborted = 1;
+			}
+			else {
+				ctx->to -= LINK_MAC_TICK_INTERVAL;
+			}
+		}
+
+		if (aborted) {
+			link_mac_credit_update();
 		}
 	}
 		break;
 
-	default:
+	case GW_LINK_MAC_REV_PDU_FREE: {
+		LINK_DBG_SIG("GW_LINK_MAC_REV_PDU_FREE\n");
+		link_mac_credit_update();
+	}
 		break;
+
+	case GW_LINK_MAC_PHY_SYNCED: {
+		LINK_DBG_SIG("GW_LINK_MAC_PHY_SYNCED\n");
+		uint32_t station;
+		memcpy(&station, get_data_common_msg(msg), sizeof(uint32_t));
+
+		/* a peer entry made later takes the negotiated values then */
+		link_mac_peer_t* peer = link_mac_peer_find(station);
+		if (peer != LINK_MAC_PEER_NULL) {
+			link_mac_peer_synced(peer);
+		}
+		link_mac_send_next();
 	}
-}
+		break;
 
-void link_mac_send_state_set(link_mac_send_state_e state) {
-	link_mac_send_state = state;
-	LINK_DBG("[MAC] link_mac_send_state_set -> %d\n", state);
-}
+	case GW_LINK_MAC_CREDIT_TO: {
+		LINK_DBG_SIG("GW_LINK_MAC_CREDIT_TO\n");
+		for (uint32_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+			link_mac_peer_t* peer = &link_mac_peer[i];
 
-link_mac_send_state_e link_mac_send_state_get() {
-	return link_mac_send_state;
-}
+			if (peer->used && peer->tx_blocked) {
+				/* advertisement may be lost, ask peer for its limit */
+				peer->tx_blocked = 0;
+				peer->credit_send |= MAC_FRAME_SUB_TYPE_CREDIT_REQ;
+			}
+		}
+		link_mac_send_next();
+	}
+		break;
 
-void link_mac_rev_state_set(link_mac_rev_state_e state) {
-	link_mac_rev_state = state;
-	LINK_DBG("[MAC] link_mac_rev_state_set -> %d\n", state);
-}
+	case GW_LINK_MAC_SEND_RESUME: {
+		LINK_DBG_SIG("GW_LINK_MAC_SEND_RESUME\n");
+		if (link_mac_fbuf_wait) {
+			link_mac_fbuf_wait = 0;
+			link_mac_send_next();
+		}
+	}
+		break;
 
-link_mac_rev_state_e link_mac_rev_state_get() {
-	return link_mac_rev_state;
+	default:
+		break;
+	}
 }
 
 uint8_t link_mac_frame_cals_checksum(link_mac_frame_t* mac_frame) {
@@ -296,7 +451,7 @@ uint8_t link_mac_frame_cals_checksum(link_mac_frame_t* mac_frame) {
 	uint8_t ret_check_sum = 0;
 
 	/* cals checksum of header frame */
-	for (uint32_t i = 0; i < (sizeof(link_mac_frame_t) - sizeof(uint8_t)); i++) {
+	for (uint32_t i = 0; i < (sizeof(link_mac_frame_header_t) - sizeof(uint8_t)); i++) {
 		ret_check_sum ^= *(frame_header + i);
 	}
 
@@ -308,32 +463,506 @@ uint8_t link_mac_frame_cals_checksum(link_mac_frame_t* mac_frame) {
 	return (uint8_t)ret_check_sum;
 }
 
-uint16_t link_mac_frame_cals_datalen(link_mac_frame_t* mac_frame, uint32_t pdu_data_len) {
-	uint16_t ret_len = pdu_data_len - (mac_frame->header.fidx * LINK_MAC_FRAME_DATA_SIZE);
-	if (ret_len <= LINK_MAC_FRAME_DATA_SIZE) {
+uint16_t link_mac_frame_cals_datalen(link_mac_channel_t* channel) {
+	uint16_t ret_len = channel->pdu->len - (channel->frame.fidx * channel->frame_data_size);
+	if (ret_len <= channel->frame_data_size) {
 		return ret_len;
 	}
-	return ((uint16_t)LINK_MAC_FRAME_DATA_SIZE);
+	return channel->frame_data_size;
+}
+
+void link_mac_frame_send_fragmentation(link_mac_channel_t* channel) {
+	/* follow frame size negotiated by phy, pdu is sent from its first fragment */
+	channel->frame_data_size = link_phy_get_frame_data_size(channel->pdu->station) - LINK_MAC_FRAME_HEADER_SIZE;
+	channel->frame.fnum = (channel->pdu->len / channel->frame_data_size) + \
+			((channel->pdu->len % channel->frame_data_size) > 0);
+	channel->frame.fidx = 0;
 }
 
-void link_mac_frame_send_end() {
-	if (fifo_availble(&link_pdu_id_fifo)) {
-		uint32_t link_pdu_send;
-		fifo_get(&link_pdu_id_fifo, (uint8_t*)&link_pdu_send);
-		task_post_common_msg(MT_LINK_MAC_ID, GW_LINK_MAC_FRAME_SEND_START, (uint8_t*)&link_pdu_send, sizeof(uint32_t));
+void link_mac_frame_send_end(link_mac_channel_t* channel) {
+	channel->pdu = LINK_PDU_NULL;
+}
+
+void link_mac_frame_send_req(link_mac_channel_t* channel) {
+	if (channel->pdu != LINK_PDU_NULL) {
+		/* leave room for phy header, it is prepended in place by phy */
+		link_fbuf_t* fbuf = link_fbuf_malloc(LINK_PHY_FRAME_HEADER_SIZE + LINK_MAC_FRAME_HEADER_SIZE);
+
+		if (fbuf == LINK_FBUF_NULL) {
+			link_mac_send_fbuf_wait();
+			return;
+		}
+		/* peer entry is held by the pdu in progress */
+		link_mac_peer_t* peer = link_mac_peer_find(channel->pdu->station);
+		peer->phy_req = LINK_MAC_PHY_REQ_DATA;
+		peer->channel_sending = (uint8_t)(channel - link_mac_channel);
+		fbuf->station = channel->pdu->station;
+
+		channel->frame.len = link_mac_frame_cals_datalen(channel);
+		memcpy(link_fbuf_put(fbuf, channel->frame.len),
+				(uint8_t*)&channel->pdu->payload[channel->frame.fidx * channel->frame_data_size],
+				channel->frame.len);
+
+		link_mac_frame_t* mac_frame = (link_mac_frame_t*)link_fbuf_push(fbuf, LINK_MAC_FRAME_HEADER_SIZE);
+		mac_frame->header = channel->frame;
+		mac_frame->header.fcs = link_mac_frame_cals_checksum(mac_frame);
+
+		link_fbuf_post(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_SEND_REQ, fbuf);
 	}
 	else {
-		link_mac_send_state_set(LINK_MAC_SEND_STATE_IDLE);
+		FATAL("LINK_MAC", 0x01);
+	}
+}
+
+void link_mac_send_start(uint8_t channel_id, link_mac_peer_t* peer) {
+	link_mac_channel_t* channel = &link_mac_channel[channel_id];
+
+	uint32_t pdu_id;
+	fifo_get(&channel->pdu_id_fifo, (uint8_t*)&pdu_id);
+
+	channel->retry_counter = 0;
+	channel->pdu = link_pdu_get(pdu_id);
+
+	channel->frame.des_addr = link_get_des_addr();
+	channel->frame.src_addr = link_get_src_addr();
+	channel->frame.type = MAC_FRAME_TYPE_REQ;
+	channel->frame.sub_type = MAC_FRAME_SUB_TYPE_NONE;
+	channel->frame.seq_num = peer->sending_sequence++;
+	link_mac_frame_send_fragmentation(channel);
+}
+
+void link_mac_send_next() {
+	if (link_mac_fbuf_wait) {
+		return;
+	}
+
+	/* credit goes first, it unblocks the peer */
+	for (uint32_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+		link_mac_peer_t* peer = &link_mac_peer[i];
+
+		if (peer->used && peer->phy_req == LINK_MAC_PHY_REQ_NONE && peer->credit_send != MAC_FRAME_SUB_TYPE_NONE) {
+			link_mac_credit_send_req(peer);
+			if (link_mac_fbuf_wait) {
+				return;
+			}
+		}
+	}
+
+	/* every peer without an outstanding request gets its next fragment */
+	while (!link_mac_fbuf_wait) {
+		uint8_t channel = link_mac_send_select();
+		if (channel == LINK_MAC_CHANNEL_NONE) {
+			break;
+		}
+		link_mac_frame_send_req(&link_mac_channel[channel]);
+	}
+}
+
+uint8_t link_mac_send_select() {
+	/* next fragment is taken from the highest priority channel with work for a
+	 * peer without an outstanding request, a new pdu is only started beside
+	 * another one to the same peer when interleaving */
+	for (uint8_t i = 0; i < LINK_CHANNEL_NUM; i++) {
+		link_mac_channel_t* channel = &link_mac_channel[i];
+
+		if (channel->pdu != LINK_PDU_NULL) {
+			if (link_mac_peer_find(channel->pdu->station)->phy_req == LINK_MAC_PHY_REQ_NONE) {
+				return i;
+			}
+			continue;
+		}
+
+		if (!fifo_availble(&channel->pdu_id_fifo)) {
+			continue;
+		}
+
+		link_pdu_t* pdu = link_pdu_get(channel->pdu_id_buf[channel->pdu_id_fifo.head_index]);
+		link_mac_peer_t* peer = link_mac_peer_get(pdu->station);
+
+		/* every peer entry is busy with another station, pdu waits for one */
+		if (peer == LINK_MAC_PEER_NULL || peer->phy_req != LINK_MAC_PHY_REQ_NONE || \
+				(!peer->interleave_en && link_mac_peer_sending(peer))) {
+			continue;
+		}
+
+		if (peer->credit_en && (!peer->tx_limit_valid || \
+								(int8_t)(peer->tx_limit - peer->sending_sequence) <= 0)) {
+			if (!peer->tx_blocked) {
+				peer->tx_blocked = 1;
+				link_mac_stat.credit_block++;
+				timer_set(MT_LINK_MAC_ID, GW_LINK_MAC_CREDIT_TO, link_mac_frame_send_to_interval, TIMER_ONE_SHOT);
+			}
+
+			/* no pdu to this peer starts without credit, started ones go on */
+			continue;
+		}
+
+		link_mac_send_start(i, peer);
+		return i;
+	}
+
+	return LINK_MAC_CHANNEL_NONE;
+}
+
+uint8_t link_mac_send_oldest_sequence(link_mac_peer_t* peer) {
+	uint8_t seq_num = peer->sending_sequence;
+
+	for (uint32_t i = 0; i < LINK_CHANNEL_NUM; i++) {
+		link_mac_channel_t* channel = &link_mac_channel[i];
+		if (channel->pdu != LINK_PDU_NULL && channel->pdu->station == peer->addr && \
+				(int8_t)(channel->frame.seq_num - seq_num) < 0) {
+			seq_num = channel->frame.seq_num;
+		}
+	}
+	return seq_num;
+}
+
+void link_mac_send_fbuf_wait() {
+	/* pool is held by receiving side, sending waits instead of using a pdu retry */
+	link_mac_fbuf_wait = 1;
+	timer_set(MT_LINK_MAC_ID, GW_LINK_MAC_SEND_RESUME, LINK_MAC_TICK_INTERVAL, TIMER_ONE_SHOT);
+}
+
+void link_mac_rev_abort(uint32_t station, uint8_t seq_num) {
+	/* peer gave up every pdu before its first unfinished one */
+	for (uint32_t i = 0; i < LINK_MAC_REV_CTX_SIZE; i++) {
+		link_mac_rev_ctx_t* ctx = &link_mac_rev_ctx[i];
+		if (ctx->pdu != LINK_PDU_NULL && ctx->station == station && (int8_t)(ctx->seq_num - seq_num) < 0) {
+			link_mac_rev_ctx_abort(ctx);
+		}
 	}
 }
 
-void link_mac_frame_send_req() {
-	if (link_mac_send_state_get() == LINK_MAC_SEND_STATE_SENDING) {
-		task_post_common_msg(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_SEND_REQ, (uint8_t*)&link_mac_frame_send, sizeof(link_mac_frame_t));
+link_mac_rev_ctx_t* link_mac_rev_ctx_find(uint32_t station, uint8_t seq_num) {
+	for (uint32_t i = 0; i < LINK_MAC_REV_CTX_SIZE; i++) {
+		link_mac_rev_ctx_t* ctx = &link_mac_rev_ctx[i];
+		if (ctx->pdu != LINK_PDU_NULL && ctx->station == station && ctx->seq_num == seq_num) {
+			return ctx;
+		}
+	}
+	return LINK_MAC_REV_CTX_NULL;
+}
+
+link_mac_rev_ctx_t* link_mac_rev_ctx_alloc(uint32_t station, uint8_t seq_num) {
+	link_mac_rev_ctx_t* ctx = LINK_MAC_REV_CTX_NULL;
+	link_mac_rev_ctx_t* oldest = LINK_MAC_REV_CTX_NULL;
+
+	for (uint32_t i = 0; i < LINK_MAC_REV_CTX_SIZE; i++) {
+		if (link_mac_rev_ctx[i].pdu == LINK_PDU_NULL) {
+			ctx = &link_mac_rev_ctx[i];
+		}
+		else if (link_mac_rev_ctx[i].station == station && \
+				 (oldest == LINK_MAC_REV_CTX_NULL || (int32_t)(link_mac_rev_ctx[i].start - oldest->start) < 0)) {
+			oldest = &link_mac_rev_ctx[i];
+		}
+	}
+
+	link_pdu_t* pdu = (ctx != LINK_MAC_REV_CTX_NULL) ? link_pdu_rx_malloc() : LINK_PDU_NULL;
+
+	if (pdu == LINK_PDU_NULL) {
+		/* source starts a new pdu while out of room, its oldest one is left behind */
+		if (oldest == LINK_MAC_REV_CTX_NULL) {
+			return LINK_MAC_REV_CTX_NULL;
+		}
+		link_mac_rev_ctx_abort(oldest);
+
+		ctx = oldest;
+		pdu = link_pdu_rx_malloc();
+		if (pdu == LINK_PDU_NULL) {
+			return LINK_MAC_REV_CTX_NULL;
+		}
+	}
+
+	ctx->pdu = pdu;
+	ctx->pdu->station = station;
+	ctx->station = station;
+	ctx->seq_num = seq_num;
+	ctx->fidx_next = 0;
+	ctx->to = link_mac_frame_rev_to_interval;
+	ctx->start = link_mac_rev_ctx_start++;
+
+	if (link_mac_rev_ctx_used++ == 0) {
+		timer_set(MT_LINK_MAC_ID, GW_LINK_MAC_FRAME_REV_TO, LINK_MAC_TICK_INTERVAL, TIMER_PERIODIC);
+	}
+	return ctx;
+}
+
+void link_mac_rev_ctx_frame(link_mac_rev_ctx_t* ctx, link_mac_frame_t* mac_frame) {
+	/* sender restarts a pdu from its first fragment, maybe with another fragment size */
+	if (mac_frame->header.fidx == 0) {
+		ctx->fidx_next = 0;
+	}
+
+	if (mac_frame->header.fidx != ctx->fidx_next || mac_frame->header.fidx >= mac_frame->header.fnum) {
+		return;
+	}
+
+	/* every fragment but the last is full, its length is the sender fragment size */
+	if (mac_frame->header.fidx + 1 < mac_frame->header.fnum) {
+		ctx->data_size = mac_frame->header.len;
+	}
+
+	uint32_t offset = mac_frame->header.fidx * ctx->data_size;
+	if (mac_frame->header.len > LINK_MAC_FRAME_DATA_SIZE || offset + mac_frame->header.len > LINK_PDU_BUF_SIZE) {
+		LINK_DBG("[MAC] pdu %d overflow, drop\n", ctx->seq_num);
+		link_mac_rev_ctx_abort(ctx);
+		link_mac_credit_update();
+		return;
+	}
+
+	memcpy(&ctx->pdu->payload[offset], mac_frame->data, mac_frame->header.len);
+	ctx->pdu->len = offset + mac_frame->header.len;
+
+	if (++ctx->fidx_next == mac_frame->header.fnum) { /* the last frame */
+		uint32_t rev_pdu = ctx->pdu->id;
+		link_mac_rev_ctx_release(ctx);
+		link_mac_stat.pdu_rev++;
+		task_post_common_msg(MT_LINK_ID, GW_LINK_REV_MSG, (uint8_t*)&rev_pdu, sizeof(uint32_t));
 	}
 	else {
-		FATAL("LINK_MAC", 0x01);
+		/* follow phy adaptive timeout */
+		link_mac_frame_rev_to_interval = 2 * link_phy_get_send_frame_to(ctx->station);
+		ctx->to = link_mac_frame_rev_to_interval;
+	}
+}
+
+void link_mac_rev_ctx_release(link_mac_rev_ctx_t* ctx) {
+	ctx->pdu = LINK_PDU_NULL;
+
+	if (--link_mac_rev_ctx_used == 0) {
+		timer_remove_attr(MT_LINK_MAC_ID, GW_LINK_MAC_FRAME_REV_TO);
+	}
+}
+
+void link_mac_rev_ctx_abort(link_mac_rev_ctx_t* ctx) {
+	uint32_t pdu_id = ctx->pdu->id;
+	link_mac_rev_ctx_release(ctx);
+	link_pdu_free(pdu_id);
+	link_mac_stat.rev_drop++;
+}
+
+void link_mac_get_stat(link_mac_stat_t* stat) {
+	memcpy(stat, &link_mac_stat, sizeof(link_mac_stat_t));
+}
+
+void link_mac_peer_init(link_mac_peer_t* peer, uint32_t addr) {
+	peer->used = 1;
+	peer->addr = addr;
+	peer->sending_sequence = (uint8_t)rand();
+	peer->receiving_sequence = (uint8_t)rand();
+	peer->rx_sequence_valid = 0;
+	peer->credit_en = 0;
+	peer->interleave_en = 0;
+	peer->credit_send = MAC_FRAME_SUB_TYPE_NONE;
+	peer->tx_limit_valid = 0;
+	peer->tx_blocked = 0;
+	peer->phy_req = LINK_MAC_PHY_REQ_NONE;
+	peer->channel_sending = LINK_MAC_CHANNEL_NONE;
+}
+
+link_mac_peer_t* link_mac_peer_find(uint32_t addr) {
+	for (uint32_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+		if (link_mac_peer[i].used && link_mac_peer[i].addr == addr) {
+			return &link_mac_peer[i];
+		}
+	}
+	return LINK_MAC_PEER_NULL;
+}
+
+link_mac_peer_t* link_mac_peer_get(uint32_t addr) {
+	link_mac_peer_t* peer = link_mac_peer_find(addr);
+	if (peer != LINK_MAC_PEER_NULL) {
+		return peer;
+	}
+
+	/* free entry, or one of a station with nothing in progress */
+	for (uint32_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+		link_mac_peer_t* entry = &link_mac_peer[i];
+
+		if (!entry->used) {
+			peer = entry;
+			break;
+		}
+
+		if (peer == LINK_MAC_PEER_NULL && !link_mac_peer_sending(entry) && !entry->tx_blocked && \
+				entry->credit_send == MAC_FRAME_SUB_TYPE_NONE && entry->phy_req == LINK_MAC_PHY_REQ_NONE) {
+			uint8_t receiving = 0;
+			for (uint32_t j = 0; j < LINK_MAC_REV_CTX_SIZE; j++) {
+				if (link_mac_rev_ctx[j].pdu != LINK_PDU_NULL && link_mac_rev_ctx[j].station == entry->addr) {
+					receiving = 1;
+				}
+			}
+
+			if (!receiving) {
+				peer = entry;
+			}
+		}
+	}
+
+	if (peer != LINK_MAC_PEER_NULL) {
+		link_mac_peer_init(peer, addr);
+
+		/* phy of this station may already be synced */
+		link_mac_peer_synced(peer);
+	}
+	return peer;
+}
+
+void link_mac_peer_synced(link_mac_peer_t* peer) {
+	uint8_t caps = link_phy_get_caps(peer->addr);
+	peer->credit_en = (caps & LINK_PHY_CAP_MAC_CREDIT) ? 1 : 0;
+	peer->credit_send = MAC_FRAME_SUB_TYPE_NONE;
+	peer->tx_limit_valid = 0;
+
+	if (peer->interleave_en && !(caps & LINK_PHY_CAP_MAC_INTERLEAVE)) {
+		/* peer receives one pdu at a time, started pdus are sent again from the beginning */
+		for (uint32_t i = 0; i < LINK_CHANNEL_NUM; i++) {
+			if (link_mac_channel[i].pdu != LINK_PDU_NULL && link_mac_channel[i].pdu->station == peer->addr) {
+				link_mac_frame_send_fragmentation(&link_mac_channel[i]);
+			}
+		}
+	}
+	peer->interleave_en = (peer->credit_en && (caps & LINK_PHY_CAP_MAC_INTERLEAVE)) ? 1 : 0;
+
+	if (peer->credit_en) {
+		/* peer may have restarted, exchange sequence and limit again */
+		peer->rx_sequence_valid = 0;
+		peer->credit_send = MAC_FRAME_SUB_TYPE_CREDIT_REQ;
+	}
+	else if (peer->tx_blocked) {
+		link_mac_credit_unblock(peer);
+	}
+}
+
+uint8_t link_mac_peer_sending(link_mac_peer_t* peer) {
+	for (uint32_t i = 0; i < LINK_CHANNEL_NUM; i++) {
+		if (link_mac_channel[i].pdu != LINK_PDU_NULL && link_mac_channel[i].pdu->station == peer->addr) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+uint8_t link_mac_rx_limit(link_mac_peer_t* peer) {
+	/* receive pool is shared by the peers, credits still open to the others are kept */
+	int32_t credit = (int32_t)link_pdu_rx_available();
+
+	for (uint32_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+		link_mac_peer_t* other = &link_mac_peer[i];
+
+		if (other != peer && other->used && other->credit_en && other->rx_sequence_valid) {
+			int8_t open = (int8_t)(other->rx_limit_sent - other->receiving_sequence - 1);
+			credit -= (open > 0) ? open : 0;
+		}
+	}
+
+	if (credit > LINK_PDU_RX_POOL_SIZE / LINK_PHY_SESSION_NUM) {
+		credit = LINK_PDU_RX_POOL_SIZE / LINK_PHY_SESSION_NUM;
+	}
+	return peer->receiving_sequence + 1 + ((credit > 0) ? credit : 0);
+}
+
+void link_mac_credit_update() {
+	for (uint32_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+		link_mac_peer_t* peer = &link_mac_peer[i];
+
+		if (peer->used && peer->credit_en && peer->rx_sequence_valid && link_mac_rx_limit(peer) != peer->rx_limit_sent) {
+			peer->credit_send |= MAC_FRAME_SUB_TYPE_CREDIT_ADV;
+		}
+	}
+	link_mac_send_next();
+}
+
+void link_mac_credit_unblock(link_mac_peer_t* peer) {
+	peer->tx_blocked = 0;
+
+	/* probe timer is common to all peers */
+	for (uint32_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+		if (link_mac_peer[i].used && link_mac_peer[i].tx_blocked) {
+			return;
+		}
+	}
+	timer_remove_attr(MT_LINK_MAC_ID, GW_LINK_MAC_CREDIT_TO);
+}
+
+void link_mac_credit_send_req(link_mac_peer_t* peer) {
+	/* limit is unknown until peer sequence is learned */
+	uint8_t sub_type = peer->credit_send & MAC_FRAME_SUB_TYPE_CREDIT_REQ;
+	if (peer->rx_sequence_valid) {
+		sub_type |= MAC_FRAME_SUB_TYPE_CREDIT_ADV;
+	}
+	peer->credit_send = MAC_FRAME_SUB_TYPE_NONE;
+
+	if (sub_type == MAC_FRAME_SUB_TYPE_NONE) {
+		return;
+	}
+
+	link_fbuf_t* fbuf = link_fbuf_malloc(LINK_PHY_FRAME_HEADER_SIZE + LINK_MAC_FRAME_HEADER_SIZE);
+
+	if (fbuf == LINK_FBUF_NULL) {
+		peer->credit_send = sub_type;
+		link_mac_send_fbuf_wait();
+		return;
+	}
+	peer->phy_req = LINK_MAC_PHY_REQ_CREDIT;
+	fbuf->station = peer->addr;
+
+	/* limit is taken when frame is built, a later change is sent afterwards */
+	uint8_t* data = link_fbuf_put(fbuf, 2);
+	peer->rx_limit_sent = link_mac_rx_limit(peer);
+	data[0] = (sub_type & MAC_FRAME_SUB_TYPE_CREDIT_ADV) ? peer->rx_limit_sent : 0;
+	data[1] = link_mac_send_oldest_sequence(peer);
+
+	link_mac_frame_t* mac_frame = (link_mac_frame_t*)link_fbuf_push(fbuf, LINK_MAC_FRAME_HEADER_SIZE);
+	mac_frame->header.des_addr = link_get_des_addr();
+	mac_frame->header.src_addr = link_get_src_addr();
+	mac_frame->header.type = MAC_FRAME_TYPE_CREDIT;
+	mac_frame->header.sub_type = sub_type;
+	mac_frame->header.seq_num = 0;
+	mac_frame->header.fnum = 1;
+	mac_frame->header.fidx = 0;
+	mac_frame->header.len = 2;
+	mac_frame->header.fcs = link_mac_frame_cals_checksum(mac_frame);
+
+	link_fbuf_post(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_SEND_REQ, fbuf);
+}
+
+void link_mac_credit_rev(link_mac_peer_t* peer, link_mac_frame_t* mac_frame) {
+	if (!peer->credit_en || mac_frame->header.len < 2) {
+		return;
+	}
+
+	/* learn peer sequence, its first unfinished pdu is received from the beginning */
+	if (!peer->rx_sequence_valid) {
+		uint8_t seq_num = mac_frame->data[1];
+
+		link_mac_rev_abort(peer->addr, seq_num);
+		peer->receiving_sequence = seq_num - 1;
+
+		for (uint32_t i = 0; i < LINK_MAC_REV_CTX_SIZE; i++) {
+			link_mac_rev_ctx_t* ctx = &link_mac_rev_ctx[i];
+			if (ctx->pdu != LINK_PDU_NULL && ctx->station == peer->addr && \
+					(int8_t)(ctx->seq_num - peer->receiving_sequence) > 0) {
+				peer->receiving_sequence = ctx->seq_num;
+			}
+		}
+		peer->rx_limit_sent = peer->receiving_sequence + 1; /* nothing granted in this sequence space yet */
+		peer->rx_sequence_valid = 1;
+	}
+
+	if (mac_frame->header.sub_type & MAC_FRAME_SUB_TYPE_CREDIT_ADV) {
+		peer->tx_limit = mac_frame->data[0];
+		peer->tx_limit_valid = 1;
+
+		if (peer->tx_blocked && (int8_t)(peer->tx_limit - peer->sending_sequence) > 0) {
+			link_mac_credit_unblock(peer);
+		}
+	}
+
+	if (mac_frame->header.sub_type & MAC_FRAME_SUB_TYPE_CREDIT_REQ) {
+		peer->credit_send |= MAC_FRAME_SUB_TYPE_CREDIT_ADV;
 	}
+	link_mac_send_next();
 }
 
 /* PORTING */
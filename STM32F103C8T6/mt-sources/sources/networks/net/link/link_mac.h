@@ -24,10 +24,22 @@ typedef struct {
 	uint8_t data[LINK_MAC_FRAME_DATA_SIZE];
 } __AK_PACKETED link_mac_frame_t;
 
+typedef struct {
+	uint32_t pdu_sent; /* pdu delivered to peer */
+	uint32_t pdu_err; /* pdu given up after retries */
+	uint32_t pdu_retry;
+	uint32_t pdu_rev; /* pdu reassembled and passed to link */
+	uint32_t rev_to; /* reassembly timed out */
+	uint32_t rev_drop; /* pdu or malformed frame dropped while receiving, timeout included */
+	uint32_t credit_block; /* sending stopped for lack of credit */
+} link_mac_stat_t;
+
 extern fsm_t fsm_link_mac;
 extern void fsm_link_mac_state_init(ak_msg_t*);
 extern void fsm_link_mac_state_handle(ak_msg_t*);
 
+extern void link_mac_get_stat(link_mac_stat_t* stat);
+
 extern q_msg_t taskLinkMacMailbox;
 extern void* TaskLinkMacEntry(void*);
 
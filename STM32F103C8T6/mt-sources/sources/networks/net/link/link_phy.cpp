@@ -5,6 +5,7 @@
 #include <string.h>
 #include <pthread.h>
 #include <sys/time.h>
+#include <time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/signal.h>
@@ -26,12 +27,15 @@
 
 #include "sys_dbg.h"
 
+#include "crc16.h"
+#include "cobs.h"
+#include "rs.h"
+
 #include "link_config.h"
 #include "link_sig.h"
 #include "link_phy.h"
-
-#define LINK_HAL_HANDLED	1
-#define LINK_HAL_IGNORED	0
+#include "link_data.h"
+#include "link_hal.h"
 
 typedef enum {
 	/* private */
@@ -40,13 +44,29 @@ typedef enum {
 
 	/* pulic */
 	PHY_FRAME_TYPE_REQ, /* request frame (require target response) */
+
+	/* private */
+	PHY_FRAME_TYPE_SYNC, /* link negotiation, data: [window size, sending base sequence, fcs algorithm, frame data size, framing, capabilities, fec parity] */
+	PHY_FRAME_TYPE_POLL, /* multi-drop: master grants a station its turn, the station ends it */
 } phy_frame_type_e;
 
+#define PHY_FRAME_TYPE_MASK			(0x3F)
+#define PHY_FRAME_TYPE_FCS_CRC16	(0x80) /* fcs byte unused, CRC-16 trailer follows data */
+#define PHY_FRAME_TYPE_ACK_CUM		(0x40) /* REQ frame, sub_type: next expected sequence, all before it are received */
+
 typedef enum {
 	/* private */
 	PHY_FRAME_SUB_TYPE_NACK_TO = 0x01,
 	PHY_FRAME_SUB_TYPE_NACK_ERR,
 
+	PHY_FRAME_SUB_TYPE_ACK_CUM = 0x01, /* data[0]: next expected sequence, all before it are received */
+
+	PHY_FRAME_SUB_TYPE_SYNC_REQ = 0x01,
+	PHY_FRAME_SUB_TYPE_SYNC_RES,
+
+	PHY_FRAME_SUB_TYPE_POLL_REQ = 0x01,
+	PHY_FRAME_SUB_TYPE_POLL_END,
+
 	/* pulic */
 } phy_frame_sub_type_e;
 
@@ -59,29 +79,167 @@ typedef enum {
 	PARSER_STATE_SEQ_NUM,
 	PARSER_STATE_LEN,
 	PARSER_STATE_DATA,
-	PARSER_STATE_FCS
+	PARSER_STATE_FCS,
+	PARSER_STATE_CRC,
+	PARSER_STATE_COBS /* stuffed frame, collected up to the delimiter */
 } link_phy_frame_parser_state_e;
 
-/* sending data manager */
-#define LINK_PHY_SEND_STATE_IDLE		0
-#define LINK_PHY_SEND_STATE_SENDING		1
-static uint8_t link_phy_send_state = LINK_PHY_SEND_STATE_IDLE;
-static void link_phy_send_state_set(uint8_t);
-static uint8_t link_phy_send_state_get();
+#if (LINK_PHY_WINDOW_SIZE == 0) || (LINK_PHY_WINDOW_SIZE > 8) || (LINK_PHY_WINDOW_SIZE & (LINK_PHY_WINDOW_SIZE - 1))
+#error "LINK_PHY_WINDOW_SIZE must be a power of two in range [1, 8]"
+#endif
 
-/* retry counter */
-static uint8_t retry_counter_send;
+#define LINK_PHY_WINDOW_IDX(seq)			((seq) & (LINK_PHY_WINDOW_SIZE - 1))
+#define LINK_PHY_SEQ_OFFSET(seq, base)		((uint8_t)((uint8_t)(seq) - (uint8_t)(base)))
+
+/* sending window manager */
+#define LINK_PHY_SLOT_FREE		0
+#define LINK_PHY_SLOT_SENT		1
+#define LINK_PHY_SLOT_ACKED		2
+
+static_assert(LINK_PHY_FRAME_SIZE <= LINK_FBUF_SIZE, "link frame buffer can not hold a phy frame");
+static_assert(COBS_ENCODED_SIZE_MAX(LINK_PHY_FRAME_SIZE) <= LINK_FBUF_SIZE, "link frame buffer can not hold a stuffed phy frame");
+static_assert(LINK_PHY_FRAME_DATA_SIZE >= LINK_PHY_FRAME_DATA_SIZE_LEGACY && LINK_PHY_FRAME_DATA_SIZE <= 0xFF,
+			  "LINK_PHY_FRAME_DATA_SIZE_MAX must be in range [LINK_PHY_FRAME_DATA_SIZE_LEGACY, 255]");
+
+/* fec: one Reed-Solomon codeword per started block of frame and trailer, the
+ * parity of all codewords follows the trailer in codeword order */
+#define LINK_PHY_FEC_BLOCK_SIZE(parity)		(RS_CODEWORD_SIZE_MAX - (parity))
+#define LINK_PHY_FEC_SIZE(len, parity)		(((len) + LINK_PHY_FEC_BLOCK_SIZE(parity) - 1) / LINK_PHY_FEC_BLOCK_SIZE(parity) * (parity))
+#define LINK_PHY_FEC_SIZE_MAX				LINK_PHY_FEC_SIZE(LINK_PHY_FRAME_SIZE, LINK_PHY_FEC_PARITY)
+
+static_assert(LINK_PHY_FEC_PARITY <= RS_PARITY_MAX, "LINK_PHY_FEC_PARITY must be in range [0, 32]");
+static_assert(COBS_ENCODED_SIZE_MAX(LINK_PHY_FRAME_SIZE + LINK_PHY_FEC_SIZE_MAX) <= LINK_FBUF_SIZE, "link frame buffer can not hold a stuffed phy frame with fec parity");
+
+typedef struct {
+	link_fbuf_t* fbuf; /* header prepended in place, released when slid out */
+	uint8_t state;
+	uint8_t retry;
+	uint32_t sent_at; /* ms */
+	uint32_t rto; /* ms, doubled on each timeout of this frame */
+	uint8_t held; /* multi-drop: not written yet, goes after the turn */
+} link_phy_send_slot_t;
+
+typedef struct {
+	link_fbuf_t* fbuf; /* LINK_FBUF_NULL when empty */
+} link_phy_rev_slot_t;
+
+/* link session with one peer: windows, sequences, negotiated values and round
+ * trip estimate. A point-to-point link has one, a multi-drop master one per
+ * station it exchanges data with */
+typedef struct {
+	uint8_t used;
+	uint32_t addr; /* bus address of the peer */
+
+	/* sending window manager */
+	link_phy_send_slot_t send_window[LINK_PHY_WINDOW_SIZE];
+	uint8_t send_base; /* oldest unacknowledged sequence */
+	uint8_t send_next; /* next sequence to be sent */
+	uint8_t send_done_pending; /* window full, SEND_DONE to MAC is deferred */
+	uint8_t send_err_pending; /* window flushed, next SEND_REQ is answered with SEND_ERR */
+
+	/* receiving window manager */
+	link_phy_rev_slot_t rev_window[LINK_PHY_WINDOW_SIZE];
+	uint8_t rev_base; /* next in-order sequence expected */
+	uint8_t rev_synced; /* peer sending base is known */
+	uint8_t rev_nack_sent;
+	uint8_t rev_ack_pending; /* in-order frames not acknowledged yet, see LINK_PHY_CAP_ACK_PIGGYBACK */
+
+	/* negotiated window, stop-and-wait (1) until peer answered sync */
+	uint8_t window_size;
+	uint8_t sync_retry;
+	uint8_t sync_wait; /* sync request not answered, retried on GW_LINK_PHY_SYNC_TO */
+	uint8_t sync_pending; /* multi-drop: PHY_FRAME_SUB_TYPE_SYNC_xxx to send after the turn, 0 if none */
+
+	/* multi-drop: turns not ended in a row, the station is given up at LINK_PHY_POLL_MISS_MAX */
+	uint8_t poll_miss;
+	uint8_t down;
+	uint8_t down_skip; /* turns left out before it is polled again */
+
+	/* negotiated frame payload, legacy size until peer answered sync */
+	uint8_t frame_data_size;
+
+	/* negotiated framing, SOF framing until peer answered sync */
+	uint8_t framing;
+
+	/* negotiated capabilities, none until peer answered sync */
+	uint8_t caps;
+
+	/* negotiated frame check, XOR-8 until peer answered sync */
+	uint8_t fcs_algo;
+
+	/* round trip estimation (Jacobson/Karels), srtt scaled by 8, rttvar by 4 */
+	uint32_t srtt;
+	uint32_t rttvar;
+	uint32_t rto;
+	uint32_t rtt_last;
+} link_phy_session_t;
+
+#define LINK_PHY_SESSION_NULL		((link_phy_session_t*)0)
+
+static link_phy_session_t link_phy_session[LINK_PHY_SESSION_NUM];
+
+/* negotiated fec parity bytes per codeword, none until peer answered sync.
+ * Frames are decoded before their sender is known, stations of a bus offer the same */
+static uint8_t link_phy_fec_parity;
+
+/* encoded bytes of the stuffed frame being collected */
+#define LINK_PHY_REV_COBS_DROP		(0xFFFF) /* overrun or no buffer, wait for next delimiter */
+#define LINK_PHY_REV_COBS_SKIP		(0xFFFE) /* frame for another station, wait for next delimiter */
+static uint16_t link_phy_rev_cobs_len;
+
+/* bus address, both ends of a point-to-point link use LINK_PHY_ADDR_MASTER */
+static uint32_t link_phy_addr = LINK_PHY_ADDR_MASTER;
+
+/* multi-drop: a polled station holds the bus, frames written meanwhile wait for the end of its turn */
+static uint8_t link_phy_poll_turn;
+
+/* multi-drop: polling schedule, a station listed n times gets n turns per cycle */
+static pthread_mutex_t mt_link_phy_poll_schedule;
+static uint32_t link_phy_poll_schedule[LINK_PHY_POLL_SCHEDULE_SIZE];
+static uint8_t link_phy_poll_len;
+static uint8_t link_phy_poll_idx;
+static uint8_t link_phy_poll_wrap; /* turn in progress is the last of the cycle */
+static uint8_t link_phy_poll_busy; /* data went either way in this cycle */
+static uint32_t link_phy_poll_addr; /* station holding the turn */
+
+/* multi-drop: frame being received is for another station, its payload is not buffered */
+static uint8_t link_phy_rev_skip;
+#if (LINK_PHY_MULTI_DROP == 1)
+static uint8_t link_phy_rev_addr_len; /* decoded bytes of a stuffed frame, up to the destination address */
+static uint32_t link_phy_rev_addr;
+static uint8_t link_phy_rev_cobs_code;
+static uint8_t link_phy_rev_cobs_run;
+#endif
 
-/* sequence number */
-static uint8_t link_phy_send_seq_num;
-static uint8_t link_phy_rev_seq_num;
+/* running CRC-16 of a SOF framed frame being received */
+static uint16_t link_phy_rev_crc;
+static uint16_t link_phy_rev_crc_trailer;
+
+/* traffic and error counters of all sessions, see link_phy_stat_t */
+static uint32_t link_phy_retransmit;
+static uint32_t link_phy_fast_retransmit;
+
+static uint32_t link_phy_frame_sent;
+static uint32_t link_phy_frame_rev;
+static uint32_t link_phy_byte_sent;
+static uint32_t link_phy_byte_rev;
+static uint32_t link_phy_fcs_err;
+static uint32_t link_phy_rev_to;
+static uint32_t link_phy_rev_drop;
+static uint32_t link_phy_send_fail;
+static uint32_t link_phy_fec_fixed;
+static uint32_t link_phy_fec_byte;
+static uint32_t link_phy_rev_foreign;
+static uint32_t link_phy_poll;
+static uint32_t link_phy_poll_to;
+static uint32_t link_phy_station_down;
 
 /* link physic max retry */
 static uint8_t link_phy_max_retry_val;
 
-/* static physic frame object */
-static link_phy_frame_t send_link_phy_frame;
-static link_phy_frame_t rev_link_phy_frame;
+/* frame being parsed, kept across aborted frames and handed over on completion */
+static link_fbuf_t* rev_link_phy_fbuf;
+static link_phy_frame_t* rev_link_phy_frame;
 
 /* receive frame parser state */
 static pthread_mutex_t mt_link_phy_frame_parser_state_revc;
@@ -95,40 +253,86 @@ fsm_t fsm_link_phy;
 
 /* write data to physical layer declare function */
 static void link_phy_frame_write_block(uint8_t* data, uint32_t data_len);
-static void link_phy_frame_write(link_phy_frame_t* frame);
+static void link_phy_frame_write(link_phy_session_t* session, link_phy_frame_t* frame);
+static void link_phy_frame_write_cobs(link_phy_frame_t* frame, uint8_t* crc_trailer);
+static uint32_t link_phy_frame_fec_encode(uint8_t* frame, uint32_t len);
+static void link_phy_frame_write_ctrl(link_phy_session_t* session, uint8_t type, uint8_t sub_type, uint8_t seq_num, uint8_t* data, uint8_t len);
 
 /* receive byte calback function */
 uint8_t gw_link_phy_frame_rev_byte(uint8_t c);
 
 static uint8_t link_phy_frame_cals_checksum(link_phy_frame_t* phy_frame);
+static void link_phy_frame_rev_end(uint8_t fcs_ok);
+static void link_phy_frame_rev_cobs_byte(uint8_t c);
+static void link_phy_frame_rev_cobs_end();
+static uint32_t link_phy_frame_fec_decode(uint8_t* frame, uint32_t len);
+#if (LINK_PHY_MULTI_DROP == 1)
+static void link_phy_frame_rev_cobs_addr(uint8_t c);
+static void link_phy_frame_rev_addr_check(uint32_t des_addr);
+#endif
 
-static void link_phy_frame_send_max_retry();
-static void link_phy_frame_send();
+/* link sessions */
+static void link_phy_session_init(link_phy_session_t* session, uint32_t addr);
+static link_phy_session_t* link_phy_session_find(uint32_t addr);
+static link_phy_session_t* link_phy_session_get(uint32_t addr);
+static void link_phy_session_gc();
+
+/* sliding window */
+static uint8_t link_phy_send_window_used(link_phy_session_t* session);
+static uint8_t link_phy_send_window_busy();
+static void link_phy_send_window_slot_send(link_phy_session_t* session, link_phy_send_slot_t* slot);
+static void link_phy_send_window_ack(link_phy_session_t* session, uint8_t seq_num);
+static void link_phy_send_window_ack_cum(link_phy_session_t* session, uint8_t next_seq_num);
+static void link_phy_send_window_slide(link_phy_session_t* session);
+static void link_phy_send_window_acked(link_phy_session_t* session, link_phy_send_slot_t* slot);
+static void link_phy_send_window_retry(link_phy_session_t* session, link_phy_send_slot_t* slot, uint8_t is_timeout);
+static void link_phy_rtt_sample(link_phy_session_t* session, uint32_t rtt);
+static uint32_t link_phy_millis();
+static void link_phy_rev_window_reset(link_phy_session_t* session, uint8_t base);
+static void link_phy_rev_window_req(link_phy_session_t* session, link_fbuf_t* fbuf);
+static void link_phy_rev_deliver(link_phy_session_t* session, link_fbuf_t* fbuf);
+static void link_phy_rev_ack_delay(link_phy_session_t* session);
+static void link_phy_rev_ack_send(link_phy_session_t* session);
+static void link_phy_rev_ack_clear(link_phy_session_t* session);
+static void link_phy_sync_set_window(link_phy_session_t* session, uint8_t peer_window);
+static void link_phy_sync_set_fcs(link_phy_session_t* session, link_phy_frame_t* sync_frame);
+static void link_phy_sync_set_frame_data_size(link_phy_session_t* session, link_phy_frame_t* sync_frame);
+static void link_phy_sync_set_framing(link_phy_session_t* session, link_phy_frame_t* sync_frame);
+static void link_phy_sync_set_caps(link_phy_session_t* session, link_phy_frame_t* sync_frame);
+static void link_phy_sync_set_fec(link_phy_session_t* session, link_phy_frame_t* sync_frame);
+static void link_phy_sync_req(link_phy_session_t* session);
+static void link_phy_sync_res(link_phy_session_t* session);
+static void link_phy_sync_done(link_phy_session_t* session);
+static void link_phy_send_answer(uint32_t station, uint8_t sig);
+static void link_phy_send_window_flush(link_phy_session_t* session);
+
+/* multi-drop bus access */
+static uint8_t link_phy_tx_allowed();
+static void link_phy_tx_flush(link_phy_session_t* session);
+static void link_phy_poll_req();
+static void link_phy_poll_turn_end();
+static uint8_t link_phy_poll_cycle_end();
+static void link_phy_poll_miss(link_phy_session_t* session);
+static void link_phy_station_give_up(link_phy_session_t* session);
+
+static void link_phy_frame_send_max_retry(link_phy_session_t* session);
 
 q_msg_t taskLinkPhyMailbox;
 
-/* serail interface */
-#define LINK_PHY_RX_THREAD_BUFFER_SIZE		4096
-
-static int link_phy_fd;
-static pthread_t link_phy_rx_thread;
-static int link_phy_open_dev(const char* devpath);
-static void* link_phy_rx_thread_handler(void*);
-static void link_phy_rev_frame_parser(uint8_t* data, uint8_t len);
+static void link_phy_rev_frame_parser(uint8_t* data, uint32_t len);
+static uint32_t link_phy_frame_rev_cobs_block(uint8_t* data, uint32_t len);
 static void link_phy_rev_frame_start_to();
 static void link_phy_rev_frame_clear_to();
 
-static bool comport_is_opened = false;
-
 void* TaskLinkPhyEntry(void*) {
 	char *path_tty = filePathRetStr(SERIAL_PORT_INTERFACE);
-	if (link_phy_open_dev(path_tty) < 0) {
+
+	link_hal_reg_rev_block(link_phy_rev_frame_parser);
+	if (link_hal_open(path_tty) < 0) {
 		APP_PRINT("Cannot open %s !\n", path_tty);
 	}
 	else {
-		APP_PRINT("Opened %s success !\n", path_tty);
-		comport_is_opened = true;
-		pthread_create(&link_phy_rx_thread, NULL, link_phy_rx_thread_handler, NULL);
+		APP_PRINT("Opened %s (%s) success !\n", path_tty, link_hal_name());
 	}
 
 	wait_all_tasks_started();
@@ -148,107 +352,277 @@ void* TaskLinkPhyEntry(void*) {
 	}
 }
 
-void* link_phy_rx_thread_handler(void*) {
-	LINK_DBG("link_phy_rx_thread_handler entry successed!\n");
-	static uint8_t __rx_thread_handler_buffer[LINK_PHY_RX_THREAD_BUFFER_SIZE];
-	static uint32_t __rx_thread_len;
+void link_phy_rev_frame_parser(uint8_t* data, uint32_t len) {
+	uint32_t i = 0;
 
-	while(1) {
-		__rx_thread_len = read(link_phy_fd, __rx_thread_handler_buffer, LINK_PHY_RX_THREAD_BUFFER_SIZE);
-		if (__rx_thread_len > 0) {
-			link_phy_rev_frame_parser(__rx_thread_handler_buffer, __rx_thread_len);
+	while (i < len) {
+		/* body of a stuffed frame is taken up to the delimiter at once */
+		uint32_t span = link_phy_frame_rev_cobs_block(data + i, len - i);
+		if (span) {
+			i += span;
+			continue;
 		}
-	}
 
-	return (void*)0;
+		if (gw_link_phy_frame_rev_byte(*(data + i)) == LINK_HAL_IGNORED) {
+			RAW_DBG("%c", *(data + i));
+			if (link_phy_frame_parser_state_revc_get() != PARSER_STATE_SOF) {
+				link_phy_frame_parser_state_revc_set(PARSER_STATE_SOF);
+				timer_remove_attr(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_REV_TO);
+			}
+		}
+		i++;
+	}
 }
 
-int link_phy_open_dev(const char* devpath) {
-	struct termios options;
-	LINK_DBG("[LINK_PHY][link_phy_open_dev] devpath: %s\n", devpath);
+uint32_t link_phy_frame_rev_cobs_block(uint8_t* data, uint32_t len) {
+	/* first byte takes the buffer and starts the timer, overrun is handled per byte */
+	if (link_phy_frame_parser_state_revc_get() != PARSER_STATE_COBS ||
+			link_phy_rev_cobs_len == 0 || link_phy_rev_cobs_len >= LINK_FBUF_SIZE) {
+		return 0;
+	}
+
+#if (LINK_PHY_MULTI_DROP == 1)
+	/* destination address is decoded per byte */
+	if (link_phy_rev_addr_len <= sizeof(uint32_t)) {
+		return 0;
+	}
+#endif
+
+	uint8_t* delimiter = (uint8_t*)memchr(data, COBS_DELIMITER, len);
+	uint32_t span = delimiter ? (uint32_t)(delimiter - data) : len;
 
-	link_phy_fd = open(devpath, O_RDWR | O_NOCTTY | O_NDELAY);
-	if (link_phy_fd < 0) {
-		return link_phy_fd;
+	if (span > (uint32_t)(LINK_FBUF_SIZE - link_phy_rev_cobs_len)) {
+		return 0;
 	}
-	else {
-		fcntl(link_phy_fd, F_SETFL, 0);
 
-		/* get current status */
-		tcgetattr(link_phy_fd, &options);
+	memcpy((uint8_t*)rev_link_phy_frame + link_phy_rev_cobs_len, data, span);
+	link_phy_rev_cobs_len += span;
+	return span;
+}
 
-		cfsetispeed(&options, B115200);
-		cfsetospeed(&options, B115200);
+void task_link_phy(ak_msg_t* msg) {
+	fsm_dispatch(&fsm_link_phy, msg);
+}
 
-		/* No parity (8N1) */
-		options.c_cflag &= ~PARENB;
-		options.c_cflag &= ~CSTOPB;
-		options.c_cflag &= ~CSIZE;
-		options.c_cflag |= CS8;
+void link_phy_frame_write_block(uint8_t* data, uint32_t data_len) {
+	link_hal_write_block(data, data_len);
+}
 
-		options.c_cflag |= (CLOCAL | CREAD);
-		options.c_cflag     &=  ~CRTSCTS;
+uint32_t link_phy_get_send_frame_to(uint32_t station) {
+	link_phy_session_t* session = link_phy_session_find(station);
 
-		cfmakeraw(&options);
+	/* worst case before SEND_ERR: every try times out with backoff */
+	uint32_t ret = 0;
+	uint32_t rto = (session != LINK_PHY_SESSION_NULL) ? session->rto : LINK_PHY_RTO_INIT;
 
-		tcflush(link_phy_fd, TCIFLUSH);
-		if (tcsetattr (link_phy_fd, TCSANOW, &options) != 0) {
-			SYS_DBG("error in tcsetattr()\n");
-		}
+	for (uint8_t i = 0; i <= link_phy_max_retry_val; i++) {
+		ret += rto;
+		rto = (rto < LINK_PHY_RTO_MAX / 2) ? (rto << 1) : LINK_PHY_RTO_MAX;
 	}
-	return 0;
+	return ret;
 }
 
-void link_phy_rev_frame_parser(uint8_t* data, uint8_t len) {
-	for (uint32_t i = 0; i < len; i++) {
-		if (gw_link_phy_frame_rev_byte(*(data + i)) == LINK_HAL_IGNORED) {
-			RAW_DBG("%c", *(data + i));
-			if (link_phy_frame_parser_state_revc_get() != PARSER_STATE_SOF) {
-				link_phy_frame_parser_state_revc_set(PARSER_STATE_SOF);
-				timer_remove_attr(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_REV_TO);
-			}
+uint8_t link_phy_get_frame_data_size(uint32_t station) {
+	link_phy_session_t* session = link_phy_session_find(station);
+	return (session != LINK_PHY_SESSION_NULL) ? session->frame_data_size : LINK_PHY_FRAME_DATA_SIZE_LEGACY;
+}
+
+uint8_t link_phy_get_caps(uint32_t station) {
+	link_phy_session_t* session = link_phy_session_find(station);
+	return (session != LINK_PHY_SESSION_NULL) ? session->caps : 0;
+}
+
+void link_phy_poll_set(const uint32_t* schedule, uint8_t len) {
+	if (len > LINK_PHY_POLL_SCHEDULE_SIZE) {
+		FATAL("LINK_PHY", 0x05);
+	}
+
+	/* a session is kept with each polled station */
+	uint8_t stations = 0;
+	for (uint8_t i = 0; i < len; i++) {
+		uint8_t j = 0;
+		while (j < i && schedule[j] != schedule[i]) {
+			j++;
 		}
+		stations += (j == i);
 	}
+	if (stations > LINK_PHY_SESSION_NUM) {
+		FATAL("LINK_PHY", 0x06);
+	}
+
+	pthread_mutex_lock(&mt_link_phy_poll_schedule);
+	memcpy(link_phy_poll_schedule, schedule, len * sizeof(uint32_t));
+	link_phy_poll_len = len;
+	link_phy_poll_idx = 0;
+	pthread_mutex_unlock(&mt_link_phy_poll_schedule);
+
+#if (LINK_PHY_MULTI_DROP == 1)
+	/* restarts polling stopped by an empty schedule, ignored during a turn */
+	task_post_pure_msg(MT_LINK_PHY_ID, GW_LINK_PHY_POLL_REQ);
+#endif
 }
 
-void task_link_phy(ak_msg_t* msg) {
-	fsm_dispatch(&fsm_link_phy, msg);
+uint8_t link_phy_get_station_down(uint32_t station) {
+	link_phy_session_t* session = link_phy_session_find(station);
+	return (session != LINK_PHY_SESSION_NULL) ? session->down : 0;
 }
 
-void link_phy_send_state_set(uint8_t state) {
-	link_phy_send_state = state;
-	LINK_DBG("[PHY] link_phy_send_state -> %d\n", state);
+void link_phy_get_stat(link_phy_stat_t* stat) {
+	memset(stat, 0, sizeof(link_phy_stat_t));
+
+	/* negotiated values are of the first session */
+	for (uint8_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+		if (link_phy_get_session_stat(i, stat)) {
+			break;
+		}
+	}
+
+	stat->retransmit = link_phy_retransmit;
+	stat->fast_retransmit = link_phy_fast_retransmit;
+	stat->frame_sent = link_phy_frame_sent;
+	stat->frame_rev = link_phy_frame_rev;
+	stat->byte_sent = link_phy_byte_sent;
+	stat->byte_rev = link_phy_byte_rev;
+	stat->fcs_err = link_phy_fcs_err;
+	stat->rev_to = link_phy_rev_to;
+	stat->rev_drop = link_phy_rev_drop;
+	stat->send_fail = link_phy_send_fail;
+	stat->fec_fixed = link_phy_fec_fixed;
+	stat->fec_byte = link_phy_fec_byte;
+	stat->rev_foreign = link_phy_rev_foreign;
+	stat->poll = link_phy_poll;
+	stat->poll_to = link_phy_poll_to;
+	stat->station_down = link_phy_station_down;
+	stat->fec_parity = link_phy_fec_parity;
 }
 
-uint8_t link_phy_send_state_get() {
-	return link_phy_send_state;
+uint8_t link_phy_get_session_stat(uint8_t idx, link_phy_stat_t* stat) {
+	if (idx >= LINK_PHY_SESSION_NUM || !link_phy_session[idx].used) {
+		return 0;
+	}
+
+	link_phy_session_t* session = &link_phy_session[idx];
+	stat->station = session->addr;
+	stat->srtt = session->srtt >> 3;
+	stat->rttvar = session->rttvar >> 2;
+	stat->rto = session->rto;
+	stat->rtt_last = session->rtt_last;
+	stat->window_size = session->window_size;
+	stat->fcs_algo = session->fcs_algo;
+	stat->frame_data_size = session->frame_data_size;
+	stat->framing = session->framing;
+	stat->caps = session->caps;
+	return 1;
 }
 
-void link_phy_frame_write_block(uint8_t* data, uint32_t data_len) {
-	int ret =  write(link_phy_fd, (uint8_t*)data, data_len);
+uint32_t link_phy_millis() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+void link_phy_frame_write(link_phy_session_t* session, link_phy_frame_t* frame) {
+	uint8_t crc_trailer[2];
+	uint8_t crc_en = (session->fcs_algo == LINK_PHY_FCS_CRC16) &&
+					 ((frame->header.type & PHY_FRAME_TYPE_MASK) != PHY_FRAME_TYPE_SYNC);
+	uint8_t cobs_en = crc_en && (session->framing == LINK_PHY_FRAMING_COBS);
+
+	/* fcs is applied on the wire, a retransmitted slot follows the current algorithm */
+	if (crc_en) {
+		frame->header.type |= PHY_FRAME_TYPE_FCS_CRC16;
+		frame->header.fcs = 0;
+		uint16_t crc = crc16_ccitt(CRC16_CCITT_INIT, (uint8_t*)frame, sizeof(link_phy_frame_header_t) + frame->header.len);
+		crc_trailer[0] = (uint8_t)(crc >> 8);
+		crc_trailer[1] = (uint8_t)crc;
+	}
+	else {
+		frame->header.type &= ~PHY_FRAME_TYPE_FCS_CRC16;
+		frame->header.fcs = link_phy_frame_cals_checksum(frame);
+	}
+
+	if (cobs_en) {
+		link_phy_frame_write_cobs(frame, crc_trailer);
+		return;
+	}
+
+	pthread_mutex_lock(&mt_link_phy_frame_write);
+	/* write frame header */
+	link_phy_frame_write_block((uint8_t*)frame, sizeof(link_phy_frame_header_t));
 
-	if (ret < 0) {
-		FATAL("LK_PHY", 0x05);
+	/* write frame data */
+	if (frame->header.len > 0) {
+		link_phy_frame_write_block((uint8_t*)frame->data, frame->header.len);
 	}
+
+	if (crc_en) {
+		link_phy_frame_write_block(crc_trailer, sizeof(crc_trailer));
+	}
+	pthread_mutex_unlock(&mt_link_phy_frame_write);
 }
 
-uint32_t link_phy_get_send_frame_to() {
-	uint32_t ret = ((link_phy_max_retry_val + 1) * LINK_PHY_FRAME_SEND_TO_INTERVAL);
-	return ret;
+void link_phy_frame_write_cobs(link_phy_frame_t* frame, uint8_t* crc_trailer) {
+	uint8_t wire[COBS_ENCODED_SIZE_MAX(LINK_PHY_FRAME_SIZE + LINK_PHY_FEC_SIZE_MAX) + 2];
+	uint32_t len = LINK_PHY_FRAME_HEADER_SIZE + frame->header.len;
+
+	/* trailer is stuffed with the frame, data has room for it */
+	frame->data[frame->header.len] = crc_trailer[0];
+	frame->data[frame->header.len + 1] = crc_trailer[1];
+	len += LINK_PHY_FRAME_TRAILER_SIZE;
+	len += link_phy_frame_fec_encode((uint8_t*)frame, len);
+
+	/* leading delimiter terminates any garbage pending at the receiver */
+	wire[0] = COBS_DELIMITER;
+	len = cobs_encode((uint8_t*)frame, len, &wire[1]) + 1;
+	wire[len++] = COBS_DELIMITER;
+
+	link_phy_frame_write_block(wire, len);
 }
 
-void link_phy_frame_write(link_phy_frame_t* frame) {
-	if (comport_is_opened) {
-        pthread_mutex_lock(&mt_link_phy_frame_write);
-		/* write frame header */
-		link_phy_frame_write_block((uint8_t*)frame, sizeof(link_phy_frame_header_t));
+uint32_t link_phy_frame_fec_encode(uint8_t* frame, uint32_t len) {
+	uint8_t parity_len = link_phy_fec_parity;
+	uint32_t block_size = LINK_PHY_FEC_BLOCK_SIZE(parity_len);
+
+	/* parity goes after the trailer: a frame buffer is sized for it and
+	 * control frames leave most of their data room unused */
+	uint8_t* parity = frame + len;
+
+	if (parity_len == 0) {
+		return 0;
+	}
+
+	for (uint32_t i = 0; i < len; i += block_size) {
+		uint32_t block = (len - i < block_size) ? len - i : block_size;
+		rs_encode(frame + i, block, parity, parity_len);
+		parity += parity_len;
+	}
+
+	return (uint32_t)(parity - (frame + len));
+}
 
-		/* write frame data */
-		if (frame->header.len > 0) {
-			link_phy_frame_write_block((uint8_t*)frame->data, frame->header.len);
+void link_phy_frame_write_ctrl(link_phy_session_t* session, uint8_t type, uint8_t sub_type, uint8_t seq_num, uint8_t* data, uint8_t len) {
+	if (!link_phy_tx_allowed()) {
+		/* during a turn: sync is answered fresh and acknowledgement goes cumulative after it */
+		if (type == PHY_FRAME_TYPE_SYNC) {
+			session->sync_pending = sub_type;
+		}
+		else if ((type == PHY_FRAME_TYPE_ACK || type == PHY_FRAME_TYPE_NACK) && !session->rev_ack_pending) {
+			session->rev_ack_pending = 1;
 		}
-		pthread_mutex_unlock(&mt_link_phy_frame_write);
+		return;
+	}
+
+	link_phy_frame_t ctrl_frame;
+	ctrl_frame.header.sof = LINK_PHY_SOF;
+	ctrl_frame.header.des_addr = session->addr;
+	ctrl_frame.header.src_addr = link_phy_addr;
+	ctrl_frame.header.type = type;
+	ctrl_frame.header.sub_type = sub_type;
+	ctrl_frame.header.seq_num = seq_num;
+	ctrl_frame.header.len = len;
+	if (len) {
+		memcpy(ctrl_frame.data, data, len);
 	}
+	link_phy_frame_write(session, &ctrl_frame);
 }
 
 uint8_t link_phy_frame_cals_checksum(link_phy_frame_t* phy_frame) {
@@ -273,15 +647,36 @@ void fsm_link_phy_state_init(ak_msg_t* msg) {
 	case GW_LINK_PHY_INIT: {
 		LINK_DBG_SIG("GW_LINK_PHY_INIT\n");
 
-		/* private object init */
-		link_phy_send_state_set(LINK_PHY_SEND_STATE_IDLE);
-		retry_counter_send = 0;
-
-		link_phy_send_seq_num = (uint8_t)rand();
-		link_phy_rev_seq_num = (uint8_t)rand();
-
-		send_link_phy_frame.header.sof = LINK_PHY_SOF;
-		rev_link_phy_frame.header.sof = LINK_PHY_SOF;
+		/* private object init, pool was made again by link init and
+		 * frames held by sessions of the last run are gone */
+		for (uint8_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+			link_phy_session[i].used = 0;
+		}
+		link_phy_fec_parity = 0;
+
+		link_phy_retransmit = 0;
+		link_phy_fast_retransmit = 0;
+		link_phy_frame_sent = 0;
+		link_phy_frame_rev = 0;
+		link_phy_byte_sent = 0;
+		link_phy_byte_rev = 0;
+		link_phy_fcs_err = 0;
+		link_phy_rev_to = 0;
+		link_phy_rev_drop = 0;
+		link_phy_send_fail = 0;
+		link_phy_fec_fixed = 0;
+		link_phy_fec_byte = 0;
+		link_phy_rev_foreign = 0;
+		link_phy_poll = 0;
+		link_phy_poll_to = 0;
+		link_phy_station_down = 0;
+
+		link_phy_poll_turn = 0;
+		link_phy_poll_busy = 0;
+
+		rev_link_phy_fbuf = LINK_FBUF_NULL;
+		link_phy_rev_cobs_len = 0;
+		link_phy_rev_skip = 0;
 
 		link_phy_frame_parser_state_revc = PARSER_STATE_SOF;
 
@@ -289,6 +684,21 @@ void fsm_link_phy_state_init(ak_msg_t* msg) {
 
 		FSM_TRAN(&fsm_link_phy, fsm_link_phy_state_handle);
 
+#if (LINK_PHY_MULTI_DROP == 1)
+		/* session of a station is made when it is polled first,
+		 * schedule set before link start is kept */
+		if (link_phy_poll_len == 0) {
+			uint32_t station = LINK_PHY_ADDR_PEER;
+			link_phy_poll_set(&station, 1);
+		}
+		else {
+			task_post_pure_msg(MT_LINK_PHY_ID, GW_LINK_PHY_POLL_REQ);
+		}
+#else
+		/* negotiate window with peer, stop-and-wait until answered */
+		link_phy_session_get(LINK_PHY_ADDR_PEER);
+#endif
+
 		task_post_pure_msg(MT_LINK_MAC_ID, GW_LINK_MAC_PHY_LAYER_STARTED);
 	}
 		break;
@@ -302,92 +712,221 @@ void fsm_link_phy_state_handle(ak_msg_t* msg) {
 	switch (msg->header->sig) {
 	case GW_LINK_PHY_FRAME_SEND_REQ: {
 		LINK_DBG_SIG("GW_LINK_PHY_FRAME_SEND_REQ\n");
-		if (link_phy_send_state_get() == LINK_PHY_SEND_STATE_IDLE) {
-			/* sending frame packed */
-			send_link_phy_frame.header.type = (uint8_t)PHY_FRAME_TYPE_REQ;
-			send_link_phy_frame.header.sub_type = 0;
-			send_link_phy_frame.header.seq_num = ++link_phy_send_seq_num;
-			send_link_phy_frame.header.len = get_data_len_common_msg(msg);
-			if (send_link_phy_frame.header.len > LINK_PHY_FRAME_SIZE) {
-				FATAL("LK_PHY", 0x01);
-			}
+		link_fbuf_t* fbuf = link_fbuf_msg(msg);
+		if (fbuf->len > LINK_PHY_FRAME_DATA_SIZE) {
+			FATAL("LK_PHY", 0x01);
+		}
+
+		/* multi-drop: station is not polled, no session to send on, or it is given up */
+		link_phy_session_t* session = link_phy_session_get(fbuf->station);
+		if (session == LINK_PHY_SESSION_NULL || session->down) {
+			link_phy_send_answer(fbuf->station, GW_LINK_MAC_FRAME_SEND_ERR);
+			link_fbuf_free(fbuf);
+			break;
+		}
+
+		/* a frame of the previous request was lost, report it against this one.
+		 * A frame fragmented before the peer re-synced to a smaller size is
+		 * refused the same way, MAC restarts the pdu with the new size */
+		if (session->send_err_pending || fbuf->len > session->frame_data_size) {
+			session->send_err_pending = 0;
+			link_fbuf_free(fbuf);
+			link_phy_send_answer(session->addr, GW_LINK_MAC_FRAME_SEND_ERR);
+			break;
+		}
 
-			get_data_common_msg(msg, send_link_phy_frame.data, send_link_phy_frame.header.len);
-			send_link_phy_frame.header.fcs = link_phy_frame_cals_checksum((link_phy_frame_t*)&send_link_phy_frame);
+		/* MAC only sends to a station after its SEND_DONE, so a slot is free unless window shrank on re-sync */
+		if (link_phy_send_window_used(session) >= LINK_PHY_WINDOW_SIZE) {
+			FATAL("LK_PHY", 0x02);
+		}
 
-			retry_counter_send = 0;
-			link_phy_send_state_set(LINK_PHY_SEND_STATE_SENDING);
+		uint8_t window_busy = link_phy_send_window_busy();
+		uint8_t seq_num = session->send_next++;
+		link_phy_send_slot_t* slot = &session->send_window[LINK_PHY_WINDOW_IDX(seq_num)];
+
+		/* sending frame packed, slot takes over the buffer reference */
+		uint8_t len = (uint8_t)fbuf->len;
+		link_phy_frame_t* frame = (link_phy_frame_t*)link_fbuf_push(fbuf, LINK_PHY_FRAME_HEADER_SIZE);
+		frame->header.sof = LINK_PHY_SOF;
+		frame->header.des_addr = session->addr;
+		frame->header.src_addr = link_phy_addr;
+		frame->header.type = (uint8_t)PHY_FRAME_TYPE_REQ;
+		frame->header.sub_type = 0;
+		frame->header.seq_num = seq_num;
+		frame->header.len = len;
+
+		slot->fbuf = fbuf;
+		slot->state = LINK_PHY_SLOT_SENT;
+		slot->retry = 0;
+		slot->rto = session->rto;
+		slot->held = 0;
+		link_phy_send_window_slot_send(session, slot);
+		link_phy_frame_sent++;
+		link_phy_poll_busy = 1;
+		link_phy_byte_sent += len;
+
+		/* one retransmit timer for the windows of all sessions */
+		if (!window_busy) {
+			timer_set(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_SEND_TO, LINK_PHY_WINDOW_TICK_INTERVAL, TIMER_PERIODIC);
+		}
 
-			link_phy_frame_send();
+		/* MAC may push next frame while window is open */
+		if (link_phy_send_window_used(session) < session->window_size) {
+			link_phy_send_answer(session->addr, GW_LINK_MAC_FRAME_SEND_DONE);
 		}
 		else {
-			FATAL("LK_PHY", 0x02);
+			session->send_done_pending = 1;
 		}
 	}
 		break;
 
 	case GW_LINK_PHY_FRAME_SEND_TO: {
 		LINK_DBG_SIG("GW_LINK_PHY_FRAME_SEND_TO\n");
-		if (retry_counter_send >= link_phy_max_retry_val) {
-			link_phy_frame_send_max_retry();
-		}
-		else {
-			link_phy_frame_send();
+		uint32_t now = link_phy_millis();
+
+		for (uint8_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+			link_phy_session_t* session = &link_phy_session[i];
+			if (!session->used) {
+				continue;
+			}
+
+			for (uint8_t seq_num = session->send_base; seq_num != session->send_next; seq_num++) {
+				link_phy_send_slot_t* slot = &session->send_window[LINK_PHY_WINDOW_IDX(seq_num)];
+
+				if (slot->state == LINK_PHY_SLOT_SENT && !slot->held && (uint32_t)(now - slot->sent_at) >= slot->rto) {
+					link_phy_send_window_retry(session, slot, 1);
+
+					/* window was flushed */
+					if (link_phy_send_window_used(session) == 0) {
+						break;
+					}
+				}
+			}
 		}
-		retry_counter_send++;
 	}
 		break;
 
 	case GW_LINK_PHY_FRAME_REV: {
 		LINK_DBG_SIG("GW_LINK_PHY_FRAME_REV\n");
-		link_phy_frame_t* link_frame_rev = (link_phy_frame_t*)get_data_common_msg(msg);
+		link_fbuf_t* fbuf = link_fbuf_msg(msg);
+		link_phy_frame_t* link_frame_rev = (link_phy_frame_t*)link_fbuf_data(fbuf);
+
+		/* multi-drop: a station takes part in the link once it is polled, before
+		 * that only its end of turn is taken */
+		link_phy_session_t* session = link_phy_session_find(link_frame_rev->header.src_addr);
+		if (session == LINK_PHY_SESSION_NULL &&
+				(link_frame_rev->header.type & PHY_FRAME_TYPE_MASK) != PHY_FRAME_TYPE_POLL) {
+			link_phy_rev_foreign++;
+			link_fbuf_free(fbuf);
+			break;
+		}
 
-		switch (link_frame_rev->header.type) {
-		case PHY_FRAME_TYPE_REQ: {
-			if (link_phy_rev_seq_num != link_frame_rev->header.seq_num) {
-				link_phy_rev_seq_num = link_frame_rev->header.seq_num;
-			}
+		/* once CRC-16 is agreed, data frames protected by XOR-8 only are not trusted.
+		 * A poll may come before the master got the sync answer it is polled for */
+		if (session != LINK_PHY_SESSION_NULL && session->fcs_algo == LINK_PHY_FCS_CRC16 &&
+				!(link_frame_rev->header.type & PHY_FRAME_TYPE_FCS_CRC16) &&
+				link_frame_rev->header.type != PHY_FRAME_TYPE_SYNC &&
+				link_frame_rev->header.type != PHY_FRAME_TYPE_POLL) {
+			link_fbuf_free(fbuf);
+			break;
+		}
 
-			/* respond ack */
-			link_phy_frame_t link_phy_frame_ack;
-			link_phy_frame_ack.header.sof = LINK_PHY_SOF;
-			link_phy_frame_ack.header.des_addr = link_frame_rev->header.src_addr;
-			link_phy_frame_ack.header.src_addr = link_frame_rev->header.des_addr;
-			link_phy_frame_ack.header.type = PHY_FRAME_TYPE_ACK;
-			link_phy_frame_ack.header.sub_type = 0;
-			link_phy_frame_ack.header.seq_num = link_frame_rev->header.seq_num;
-			link_phy_frame_ack.header.len = 0;
-			link_phy_frame_ack.header.fcs = link_phy_frame_cals_checksum((link_phy_frame_t*)&link_phy_frame_ack);
-			link_phy_frame_write(&link_phy_frame_ack);
+		switch (link_frame_rev->header.type & PHY_FRAME_TYPE_MASK) {
+		case PHY_FRAME_TYPE_REQ: {
+			LINK_DBG("PHY_FRAME_TYPE_REQ\n");
+			link_phy_poll_busy = 1;
 
-			task_post_common_msg(MT_LINK_MAC_ID, GW_LINK_MAC_FRAME_REV, (uint8_t*)link_frame_rev->data, link_frame_rev->header.len);
+			/* acknowledgement of reverse traffic rides in the header */
+			if (link_frame_rev->header.type & PHY_FRAME_TYPE_ACK_CUM) {
+				link_phy_send_window_ack_cum(session, link_frame_rev->header.sub_type);
+				link_phy_send_window_slide(session);
+			}
+			link_phy_rev_window_req(session, fbuf);
 		}
 			break;
 
 		case PHY_FRAME_TYPE_ACK: {
-			if (link_phy_send_state_get() == LINK_PHY_SEND_STATE_SENDING) {
-				if (link_phy_send_seq_num == link_frame_rev->header.seq_num) {
-					timer_remove_attr(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_SEND_TO);
-					link_phy_send_state_set(LINK_PHY_SEND_STATE_IDLE);
-					task_post_pure_msg(MT_LINK_MAC_ID, GW_LINK_MAC_FRAME_SEND_DONE);
-				}
+			LINK_DBG("PHY_FRAME_TYPE_ACK\n");
+			if (link_frame_rev->header.sub_type == PHY_FRAME_SUB_TYPE_ACK_CUM && link_frame_rev->header.len >= 1) {
+				link_phy_send_window_ack_cum(session, link_frame_rev->data[0]);
 			}
+			link_phy_send_window_ack(session, link_frame_rev->header.seq_num);
+			link_phy_send_window_slide(session);
 		}
 			break;
 
 		case PHY_FRAME_TYPE_NACK: {
-			if (link_phy_send_state_get() == LINK_PHY_SEND_STATE_SENDING) {
-				if (link_phy_send_seq_num == link_frame_rev->header.seq_num) {
-					timer_remove_attr(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_SEND_TO);
+			LINK_DBG("PHY_FRAME_TYPE_NACK\n");
+			uint8_t seq_num = link_frame_rev->header.seq_num;
 
-					if (retry_counter_send >= link_phy_max_retry_val) {
-						link_phy_frame_send_max_retry();
-					}
-					else {
-						link_phy_frame_send();
+			if (LINK_PHY_SEQ_OFFSET(seq_num, session->send_base) < link_phy_send_window_used(session)) {
+				link_phy_send_slot_t* slot = &session->send_window[LINK_PHY_WINDOW_IDX(seq_num)];
+
+				if (slot->state == LINK_PHY_SLOT_SENT) {
+					link_phy_send_window_retry(session, slot, 0);
+				}
+			}
+		}
+			break;
+
+		case PHY_FRAME_TYPE_SYNC: {
+			LINK_DBG("PHY_FRAME_TYPE_SYNC\n");
+			if (link_frame_rev->header.len < 2) {
+				break;
+			}
+
+			if (link_frame_rev->header.sub_type == PHY_FRAME_SUB_TYPE_SYNC_REQ) {
+				/* peer (re)started, restart receiving from its announced base */
+				link_phy_rev_window_reset(session, link_frame_rev->data[1]);
+				session->rev_synced = 1;
+
+				link_phy_sync_res(session);
+			}
+			else if (link_frame_rev->header.sub_type == PHY_FRAME_SUB_TYPE_SYNC_RES) {
+				/* peer base lags the frames delivered but not acknowledged yet,
+				 * they are acknowledged now instead of being received again */
+				if (session->rev_synced && LINK_PHY_SEQ_OFFSET(session->rev_base, link_frame_rev->data[1]) <= LINK_PHY_WINDOW_SIZE) {
+					session->rev_ack_pending = 1;
+					link_phy_rev_ack_send(session);
+				}
+				else {
+					link_phy_rev_window_reset(session, link_frame_rev->data[1]);
+					session->rev_synced = 1;
+				}
+			}
+			else {
+				break;
+			}
+
+			link_phy_sync_done(session);
+			link_phy_sync_set_window(session, link_frame_rev->data[0]);
+			link_phy_sync_set_fcs(session, link_frame_rev);
+			link_phy_sync_set_frame_data_size(session, link_frame_rev);
+			link_phy_sync_set_framing(session, link_frame_rev);
+			link_phy_sync_set_caps(session, link_frame_rev);
+			link_phy_sync_set_fec(session, link_frame_rev);
+
+			/* mac flow control restarts with the link to this station */
+			uint32_t station = session->addr;
+			task_post_common_msg(MT_LINK_MAC_ID, GW_LINK_MAC_PHY_SYNCED, (uint8_t*)&station, sizeof(uint32_t));
+		}
+			break;
+
+		case PHY_FRAME_TYPE_POLL: {
+			LINK_DBG("PHY_FRAME_TYPE_POLL\n");
+			if (link_frame_rev->header.sub_type == PHY_FRAME_SUB_TYPE_POLL_END &&
+					link_phy_poll_turn && link_frame_rev->header.src_addr == link_phy_poll_addr) {
+				/* a station given up is back, it may have restarted meanwhile */
+				if (session != LINK_PHY_SESSION_NULL) {
+					session->poll_miss = 0;
+					if (session->down) {
+						session->down = 0;
+						session->window_size = 1;
+						session->sync_retry = 0;
+						session->sync_pending = PHY_FRAME_SUB_TYPE_SYNC_REQ;
 					}
-					retry_counter_send++;
 				}
+				link_phy_poll_turn_end();
 			}
 		}
 			break;
@@ -395,30 +934,79 @@ void fsm_link_phy_state_handle(ak_msg_t* msg) {
 		default:
 			break;
 		}
+
+		link_fbuf_free(fbuf);
 	}
 		break;
 
 	case GW_LINK_PHY_FRAME_REV_CS_ERR: {
 		LINK_DBG_SIG("GW_LINK_PHY_FRAME_REV_CS_ERR\n");
-		link_phy_frame_t* link_frame_rev = (link_phy_frame_t*)get_data_common_msg(msg);
-
-		/* respond non-ack */
-		link_phy_frame_t link_phy_frame_non_ack;
-		link_phy_frame_non_ack.header.sof = LINK_PHY_SOF;
-		link_phy_frame_non_ack.header.des_addr = link_frame_rev->header.src_addr;
-		link_phy_frame_non_ack.header.src_addr = link_frame_rev->header.des_addr;
-		link_phy_frame_non_ack.header.type = PHY_FRAME_TYPE_NACK;
-		link_phy_frame_non_ack.header.sub_type = 0;
-		link_phy_frame_non_ack.header.seq_num = link_frame_rev->header.seq_num;
-		link_phy_frame_non_ack.header.len = 0;
-		link_phy_frame_non_ack.header.fcs = link_phy_frame_cals_checksum((link_phy_frame_t*)&link_phy_frame_non_ack);
-		link_phy_frame_write(&link_phy_frame_non_ack);
+		link_fbuf_t* fbuf = link_fbuf_msg(msg);
+		link_phy_frame_t* st_link_frame_rev = (link_phy_frame_t*)link_fbuf_data(fbuf);
+
+		/* respond non-ack, unless sender address is not one of the sessions */
+		link_phy_session_t* session = link_phy_session_find(st_link_frame_rev->header.src_addr);
+		if (session != LINK_PHY_SESSION_NULL) {
+			link_phy_frame_write_ctrl(session, PHY_FRAME_TYPE_NACK, PHY_FRAME_SUB_TYPE_NACK_ERR, st_link_frame_rev->header.seq_num, NULL, 0);
+		}
+		link_fbuf_free(fbuf);
 	}
 		break;
 
 	case GW_LINK_PHY_FRAME_REV_TO: {
 		LINK_DBG_SIG("GW_LINK_PHY_FRAME_REV_TO\n");
 		link_phy_frame_parser_state_revc_set(PARSER_STATE_SOF);
+		link_phy_rev_to++;
+	}
+		break;
+
+	case GW_LINK_PHY_ACK_DELAY_TO: {
+		LINK_DBG_SIG("GW_LINK_PHY_ACK_DELAY_TO\n");
+		/* no reverse traffic to carry it */
+		for (uint8_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+			if (link_phy_session[i].used && link_phy_session[i].rev_ack_pending) {
+				link_phy_rev_ack_send(&link_phy_session[i]);
+			}
+		}
+	}
+		break;
+
+	case GW_LINK_PHY_POLL_REQ: {
+		LINK_DBG_SIG("GW_LINK_PHY_POLL_REQ\n");
+		link_phy_poll_req();
+	}
+		break;
+
+	case GW_LINK_PHY_POLL_TO: {
+		LINK_DBG_SIG("GW_LINK_PHY_POLL_TO\n");
+		/* station absent, poll or end of turn lost */
+		link_phy_poll_to++;
+
+		link_phy_session_t* session = link_phy_session_find(link_phy_poll_addr);
+		if (session != LINK_PHY_SESSION_NULL) {
+			link_phy_poll_miss(session);
+		}
+		link_phy_poll_turn_end();
+	}
+		break;
+
+	case GW_LINK_PHY_SYNC_TO: {
+		LINK_DBG_SIG("GW_LINK_PHY_SYNC_TO\n");
+		/* legacy peer does not answer, keep stop-and-wait */
+		for (uint8_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+			link_phy_session_t* session = &link_phy_session[i];
+			if (!session->used || !session->sync_wait) {
+				continue;
+			}
+
+			if (session->sync_retry < link_phy_max_retry_val) {
+				session->sync_retry++;
+				link_phy_sync_req(session);
+			}
+			else {
+				session->sync_wait = 0;
+			}
+		}
 	}
 		break;
 
@@ -427,15 +1015,808 @@ void fsm_link_phy_state_handle(ak_msg_t* msg) {
 	}
 }
 
-void link_phy_frame_send_max_retry() {
-	link_phy_send_state_set(LINK_PHY_SEND_STATE_IDLE);
-	task_post_pure_msg(MT_LINK_MAC_ID, GW_LINK_MAC_FRAME_SEND_ERR);
+void link_phy_session_init(link_phy_session_t* session, uint32_t addr) {
+	session->used = 1;
+	session->addr = addr;
+
+	session->send_base = (uint8_t)rand();
+	session->send_next = session->send_base;
+	session->send_done_pending = 0;
+	session->send_err_pending = 0;
+
+	for (uint8_t i = 0; i < LINK_PHY_WINDOW_SIZE; i++) {
+		session->send_window[i].fbuf = LINK_FBUF_NULL;
+		session->send_window[i].state = LINK_PHY_SLOT_FREE;
+		session->rev_window[i].fbuf = LINK_FBUF_NULL;
+	}
+
+	session->rev_base = (uint8_t)rand();
+	session->rev_synced = 0;
+	session->rev_nack_sent = 0;
+	session->rev_ack_pending = 0;
+
+	session->window_size = 1;
+	session->sync_retry = 0;
+	session->sync_wait = 0;
+	session->sync_pending = 0;
+	session->poll_miss = 0;
+	session->down = 0;
+	session->down_skip = 0;
+	session->frame_data_size = LINK_PHY_FRAME_DATA_SIZE_LEGACY;
+	session->framing = LINK_PHY_FRAMING_SOF;
+	session->caps = 0;
+	session->fcs_algo = LINK_PHY_FCS_XOR8;
+
+	session->srtt = 0;
+	session->rttvar = 0;
+	session->rto = LINK_PHY_RTO_INIT;
+	session->rtt_last = 0;
+}
+
+link_phy_session_t* link_phy_session_find(uint32_t addr) {
+#if (LINK_PHY_MULTI_DROP == 1)
+	for (uint8_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+		if (link_phy_session[i].used && link_phy_session[i].addr == addr) {
+			return &link_phy_session[i];
+		}
+	}
+	return LINK_PHY_SESSION_NULL;
+#else
+	/* one peer, whatever address it writes */
+	(void)addr;
+	return link_phy_session[0].used ? &link_phy_session[0] : LINK_PHY_SESSION_NULL;
+#endif
 }
 
-void link_phy_frame_send() {
-	if (link_phy_send_state_get() == LINK_PHY_SEND_STATE_SENDING) {
-		link_phy_frame_write(&send_link_phy_frame);
-		timer_set(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_SEND_TO, LINK_PHY_FRAME_SEND_TO_INTERVAL, TIMER_ONE_SHOT);
+link_phy_session_t* link_phy_session_get(uint32_t addr) {
+	link_phy_session_t* session = link_phy_session_find(addr);
+	if (session != LINK_PHY_SESSION_NULL) {
+		return session;
+	}
+
+	for (uint8_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+		if (!link_phy_session[i].used) {
+			session = &link_phy_session[i];
+			link_phy_session_init(session, addr);
+
+			/* negotiate window with peer, stop-and-wait until answered */
+			link_phy_sync_req(session);
+			return session;
+		}
+	}
+	return LINK_PHY_SESSION_NULL;
+}
+
+uint8_t link_phy_send_window_used(link_phy_session_t* session) {
+	return LINK_PHY_SEQ_OFFSET(session->send_next, session->send_base);
+}
+
+uint8_t link_phy_send_window_busy() {
+	for (uint8_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+		if (link_phy_session[i].used && link_phy_send_window_used(&link_phy_session[i])) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+void link_phy_send_window_slot_send(link_phy_session_t* session, link_phy_send_slot_t* slot) {
+	link_phy_frame_t* frame = (link_phy_frame_t*)link_fbuf_data(slot->fbuf);
+
+	/* retransmission timer starts when the frame is really on the bus */
+	if (!link_phy_tx_allowed()) {
+		slot->held = 1;
+		return;
+	}
+	slot->held = 0;
+
+	/* every data frame carries the current receiving base, also on retransmission */
+	if ((session->caps & LINK_PHY_CAP_ACK_PIGGYBACK) && session->rev_synced) {
+		frame->header.type |= PHY_FRAME_TYPE_ACK_CUM;
+		frame->header.sub_type = session->rev_base;
+
+		if (session->rev_ack_pending) {
+			link_phy_rev_ack_clear(session);
+		}
+	}
+	else {
+		frame->header.type &= ~PHY_FRAME_TYPE_ACK_CUM;
+		frame->header.sub_type = 0;
+	}
+
+	link_phy_frame_write(session, frame);
+	slot->sent_at = link_phy_millis();
+}
+
+void link_phy_send_window_ack(link_phy_session_t* session, uint8_t seq_num) {
+	if (LINK_PHY_SEQ_OFFSET(seq_num, session->send_base) < link_phy_send_window_used(session)) {
+		link_phy_send_slot_t* slot = &session->send_window[LINK_PHY_WINDOW_IDX(seq_num)];
+
+		link_phy_send_window_acked(session, slot);
+	}
+}
+
+void link_phy_send_window_ack_cum(link_phy_session_t* session, uint8_t next_seq_num) {
+	uint8_t acked = LINK_PHY_SEQ_OFFSET(next_seq_num, session->send_base);
+
+	if (acked <= link_phy_send_window_used(session)) {
+		for (uint8_t i = 0; i < acked; i++) {
+			link_phy_send_window_acked(session, &session->send_window[LINK_PHY_WINDOW_IDX((uint8_t)(session->send_base + i))]);
+		}
+	}
+}
+
+void link_phy_send_window_slide(link_phy_session_t* session) {
+	uint8_t released = 0;
+
+	while (session->send_base != session->send_next &&
+		   session->send_window[LINK_PHY_WINDOW_IDX(session->send_base)].state == LINK_PHY_SLOT_ACKED) {
+		link_phy_send_slot_t* slot = &session->send_window[LINK_PHY_WINDOW_IDX(session->send_base)];
+		link_fbuf_free(slot->fbuf);
+		slot->fbuf = LINK_FBUF_NULL;
+		slot->state = LINK_PHY_SLOT_FREE;
+		session->send_base++;
+		released = 1;
+	}
+
+	if (!released) {
+		return;
+	}
+
+	if (!link_phy_send_window_busy()) {
+		timer_remove_attr(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_SEND_TO);
+	}
+
+	if (session->send_done_pending && link_phy_send_window_used(session) < session->window_size) {
+		session->send_done_pending = 0;
+		link_phy_send_answer(session->addr, GW_LINK_MAC_FRAME_SEND_DONE);
+	}
+}
+
+void link_phy_send_window_acked(link_phy_session_t* session, link_phy_send_slot_t* slot) {
+	if (slot->state == LINK_PHY_SLOT_SENT) {
+		slot->state = LINK_PHY_SLOT_ACKED;
+
+		/* Karn: a retransmitted frame gives an ambiguous sample */
+		if (slot->retry == 0) {
+			link_phy_rtt_sample(session, link_phy_millis() - slot->sent_at);
+		}
+	}
+}
+
+void link_phy_send_window_retry(link_phy_session_t* session, link_phy_send_slot_t* slot, uint8_t is_timeout) {
+	if (slot->retry >= link_phy_max_retry_val) {
+		link_phy_frame_send_max_retry(session);
+	}
+	else {
+		if (is_timeout) {
+			/* exponential backoff, kept until next valid sample */
+			slot->rto = (slot->rto < LINK_PHY_RTO_MAX / 2) ? (slot->rto << 1) : LINK_PHY_RTO_MAX;
+			session->rto = (session->rto < LINK_PHY_RTO_MAX / 2) ? (session->rto << 1) : LINK_PHY_RTO_MAX;
+			link_phy_retransmit++;
+		}
+		else {
+			link_phy_fast_retransmit++;
+		}
+
+		slot->retry++;
+		link_phy_send_window_slot_send(session, slot);
+	}
+}
+
+void link_phy_rtt_sample(link_phy_session_t* session, uint32_t rtt) {
+	session->rtt_last = rtt;
+
+	if (session->srtt == 0) {
+		/* first measurement: SRTT = R, RTTVAR = R/2 (bit 0 marks a 0 ms sample as valid) */
+		session->srtt = (rtt << 3) | 1;
+		session->rttvar = rtt << 1;
+	}
+	else {
+		/* SRTT += (R - SRTT) / 8, RTTVAR += (|R - SRTT| - RTTVAR) / 4 */
+		int32_t delta = (int32_t)rtt - (int32_t)(session->srtt >> 3);
+		session->srtt = (uint32_t)((int32_t)session->srtt + delta);
+		if (session->srtt == 0) {
+			session->srtt = 1;
+		}
+
+		if (delta < 0) {
+			delta = -delta;
+		}
+		delta -= (int32_t)(session->rttvar >> 2);
+		session->rttvar = (uint32_t)((int32_t)session->rttvar + delta);
+	}
+
+	/* RTO = SRTT + max(G, 4 * RTTVAR) */
+	uint32_t var = (session->rttvar > LINK_PHY_WINDOW_TICK_INTERVAL) ? session->rttvar : LINK_PHY_WINDOW_TICK_INTERVAL;
+	uint32_t rto = (session->srtt >> 3) + var;
+
+	if (rto < LINK_PHY_RTO_MIN) {
+		rto = LINK_PHY_RTO_MIN;
+	}
+	else if (rto > LINK_PHY_RTO_MAX) {
+		rto = LINK_PHY_RTO_MAX;
+	}
+	session->rto = rto;
+}
+
+void link_phy_rev_window_reset(link_phy_session_t* session, uint8_t base) {
+	session->rev_base = base;
+	session->rev_nack_sent = 0;
+
+	if (session->rev_ack_pending) {
+		link_phy_rev_ack_clear(session);
+	}
+
+	for (uint8_t i = 0; i < LINK_PHY_WINDOW_SIZE; i++) {
+		if (session->rev_window[i].fbuf != LINK_FBUF_NULL) {
+			link_fbuf_free(session->rev_window[i].fbuf);
+			session->rev_window[i].fbuf = LINK_FBUF_NULL;
+		}
+	}
+}
+
+void link_phy_rev_window_req(link_phy_session_t* session, link_fbuf_t* fbuf) {
+	link_phy_frame_t* frame = (link_phy_frame_t*)link_fbuf_data(fbuf);
+	uint8_t seq_num = frame->header.seq_num;
+
+	/* legacy peer, no sequence agreement: deliver as stop-and-wait */
+	if (!session->rev_synced) {
+		link_phy_frame_write_ctrl(session, PHY_FRAME_TYPE_ACK, 0, seq_num, NULL, 0);
+		link_fbuf_ref(fbuf);
+		link_phy_rev_deliver(session, fbuf);
+		return;
+	}
+
+	if (LINK_PHY_SEQ_OFFSET(seq_num, session->rev_base) < LINK_PHY_WINDOW_SIZE) {
+		link_phy_rev_slot_t* slot = &session->rev_window[LINK_PHY_WINDOW_IDX(seq_num)];
+
+		if (slot->fbuf == LINK_FBUF_NULL) {
+			link_fbuf_ref(fbuf);
+			slot->fbuf = fbuf;
+		}
+
+		/* deliver in-order run to higher layer, slot reference moves with it */
+		while (session->rev_window[LINK_PHY_WINDOW_IDX(session->rev_base)].fbuf != LINK_FBUF_NULL) {
+			slot = &session->rev_window[LINK_PHY_WINDOW_IDX(session->rev_base)];
+			link_phy_rev_deliver(session, slot->fbuf);
+			slot->fbuf = LINK_FBUF_NULL;
+			session->rev_base++;
+			session->rev_nack_sent = 0;
+		}
+
+		/* hole in front of this frame, ask for it once instead of waiting sender timeout */
+		if (LINK_PHY_SEQ_OFFSET(seq_num, session->rev_base) < LINK_PHY_WINDOW_SIZE) {
+			if (!session->rev_nack_sent) {
+				session->rev_nack_sent = 1;
+				link_phy_frame_write_ctrl(session, PHY_FRAME_TYPE_NACK, PHY_FRAME_SUB_TYPE_NACK_TO, session->rev_base, NULL, 0);
+			}
+		}
+		else if (session->caps & LINK_PHY_CAP_ACK_PIGGYBACK) {
+			/* delivered in order, cumulative ack is enough */
+			link_phy_rev_ack_delay(session);
+			return;
+		}
+	}
+	else if (LINK_PHY_SEQ_OFFSET(session->rev_base, seq_num) > LINK_PHY_WINDOW_SIZE) {
+		/* neither new nor recently delivered */
+		return;
+	}
+
+	/* selective ack of this frame + cumulative ack of everything delivered */
+	link_phy_frame_write_ctrl(session, PHY_FRAME_TYPE_ACK, PHY_FRAME_SUB_TYPE_ACK_CUM, seq_num, &session->rev_base, 1);
+
+	if (session->rev_ack_pending) {
+		link_phy_rev_ack_clear(session);
+	}
+}
+
+void link_phy_rev_ack_delay(link_phy_session_t* session) {
+	/* wait for a data frame to peer, a streaming peer still gets an ack every few frames */
+	if (++session->rev_ack_pending >= LINK_PHY_ACK_DELAY_FRAMES) {
+		link_phy_rev_ack_send(session);
+	}
+	else if (session->rev_ack_pending == 1) {
+		timer_set(MT_LINK_PHY_ID, GW_LINK_PHY_ACK_DELAY_TO, LINK_PHY_ACK_DELAY_INTERVAL, TIMER_ONE_SHOT);
+	}
+}
+
+void link_phy_rev_ack_send(link_phy_session_t* session) {
+	/* stays pending until the turn is over */
+	if (!link_phy_tx_allowed()) {
+		return;
+	}
+
+	uint8_t last_seq_num = session->rev_base - 1;
+	link_phy_frame_write_ctrl(session, PHY_FRAME_TYPE_ACK, PHY_FRAME_SUB_TYPE_ACK_CUM, last_seq_num, &session->rev_base, 1);
+
+	link_phy_rev_ack_clear(session);
+}
+
+void link_phy_rev_ack_clear(link_phy_session_t* session) {
+	session->rev_ack_pending = 0;
+
+	/* delay timer is common to all sessions */
+	for (uint8_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+		if (link_phy_session[i].used && link_phy_session[i].rev_ack_pending) {
+			return;
+		}
+	}
+	timer_remove_attr(MT_LINK_PHY_ID, GW_LINK_PHY_ACK_DELAY_TO);
+}
+
+void link_phy_rev_deliver(link_phy_session_t* session, link_fbuf_t* fbuf) {
+	/* header bytes stay readable for the caller, only the data offset moves */
+	link_phy_frame_t* frame = (link_phy_frame_t*)link_fbuf_data(fbuf);
+	uint8_t len = frame->header.len;
+
+	link_fbuf_pull(fbuf, LINK_PHY_FRAME_HEADER_SIZE);
+	fbuf->len = len;
+	fbuf->station = session->addr;
+
+	link_phy_frame_rev++;
+	link_phy_byte_rev += len;
+
+	link_fbuf_post(MT_LINK_MAC_ID, GW_LINK_MAC_FRAME_REV, fbuf);
+}
+
+void link_phy_sync_set_window(link_phy_session_t* session, uint8_t peer_window) {
+	uint8_t window = (peer_window < LINK_PHY_WINDOW_SIZE) ? peer_window : LINK_PHY_WINDOW_SIZE;
+	session->window_size = (window > 0) ? window : 1;
+	LINK_DBG("[PHY] window size -> %d\n", session->window_size);
+
+	if (session->send_done_pending && link_phy_send_window_used(session) < session->window_size) {
+		session->send_done_pending = 0;
+		link_phy_send_answer(session->addr, GW_LINK_MAC_FRAME_SEND_DONE);
+	}
+}
+
+void link_phy_sync_set_fcs(link_phy_session_t* session, link_phy_frame_t* sync_frame) {
+	/* peer without fcs field only knows XOR-8 */
+	uint8_t peer_algo = (sync_frame->header.len >= 3) ? sync_frame->data[2] : LINK_PHY_FCS_XOR8;
+	session->fcs_algo = (peer_algo < LINK_PHY_FCS_ALGO) ? peer_algo : LINK_PHY_FCS_ALGO;
+	LINK_DBG("[PHY] fcs algorithm -> %d\n", session->fcs_algo);
+}
+
+void link_phy_sync_set_frame_data_size(link_phy_session_t* session, link_phy_frame_t* sync_frame) {
+	/* peer without size field parses frames into an AK common message */
+	uint8_t peer_size = (sync_frame->header.len >= 4) ? sync_frame->data[3] : LINK_PHY_FRAME_DATA_SIZE_LEGACY;
+	uint8_t size = (peer_size < LINK_PHY_FRAME_DATA_SIZE) ? peer_size : LINK_PHY_FRAME_DATA_SIZE;
+	session->frame_data_size = (size > LINK_PHY_FRAME_DATA_SIZE_LEGACY) ? size : LINK_PHY_FRAME_DATA_SIZE_LEGACY;
+	LINK_DBG("[PHY] frame data size -> %d\n", session->frame_data_size);
+}
+
+void link_phy_sync_set_framing(link_phy_session_t* session, link_phy_frame_t* sync_frame) {
+	/* peer without framing field only parses SOF framing */
+	uint8_t peer_framing = (sync_frame->header.len >= 5) ? sync_frame->data[4] : LINK_PHY_FRAMING_SOF;
+	session->framing = (peer_framing < LINK_PHY_FRAMING) ? peer_framing : LINK_PHY_FRAMING;
+	LINK_DBG("[PHY] framing -> %d\n", session->framing);
+}
+
+void link_phy_sync_set_caps(link_phy_session_t* session, link_phy_frame_t* sync_frame) {
+	/* peer without capability field has none */
+	uint8_t peer_caps = (sync_frame->header.len >= 6) ? sync_frame->data[5] : 0;
+	session->caps = peer_caps & LINK_PHY_CAPS;
+	LINK_DBG("[PHY] capabilities -> 0x%02X\n", session->caps);
+}
+
+void link_phy_sync_set_fec(link_phy_session_t* session, link_phy_frame_t* sync_frame) {
+	/* peer without fec field sends no parity, parity is only stuffed with the frame */
+	uint8_t peer_parity = (sync_frame->header.len >= 7) ? sync_frame->data[6] : 0;
+	link_phy_fec_parity = (peer_parity < LINK_PHY_FEC_PARITY) ? peer_parity : LINK_PHY_FEC_PARITY;
+	if (session->framing != LINK_PHY_FRAMING_COBS) {
+		link_phy_fec_parity = 0;
+	}
+	LINK_DBG("[PHY] fec parity -> %d\n", link_phy_fec_parity);
+}
+
+void link_phy_sync_req(link_phy_session_t* session) {
+	uint8_t sync_req[7] = { LINK_PHY_WINDOW_SIZE, session->send_base, LINK_PHY_FCS_ALGO, LINK_PHY_FRAME_DATA_SIZE, LINK_PHY_FRAMING, LINK_PHY_CAPS, LINK_PHY_FEC_PARITY };
+	link_phy_frame_write_ctrl(session, PHY_FRAME_TYPE_SYNC, PHY_FRAME_SUB_TYPE_SYNC_REQ, 0, sync_req, sizeof(sync_req));
+	session->sync_wait = 1;
+	timer_set(MT_LINK_PHY_ID, GW_LINK_PHY_SYNC_TO, LINK_PHY_FRAME_SEND_TO_INTERVAL, TIMER_ONE_SHOT);
+}
+
+void link_phy_sync_res(link_phy_session_t* session) {
+	uint8_t sync_res[7] = { LINK_PHY_WINDOW_SIZE, session->send_base, LINK_PHY_FCS_ALGO, LINK_PHY_FRAME_DATA_SIZE, LINK_PHY_FRAMING, LINK_PHY_CAPS, LINK_PHY_FEC_PARITY };
+	link_phy_frame_write_ctrl(session, PHY_FRAME_TYPE_SYNC, PHY_FRAME_SUB_TYPE_SYNC_RES, 0, sync_res, sizeof(sync_res));
+}
+
+void link_phy_sync_done(link_phy_session_t* session) {
+	session->sync_wait = 0;
+
+	/* retry timer is common to all sessions */
+	for (uint8_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+		if (link_phy_session[i].used && link_phy_session[i].sync_wait) {
+			return;
+		}
+	}
+	timer_remove_attr(MT_LINK_PHY_ID, GW_LINK_PHY_SYNC_TO);
+}
+
+uint8_t link_phy_tx_allowed() {
+	return !link_phy_poll_turn;
+}
+
+void link_phy_tx_flush(link_phy_session_t* session) {
+	uint8_t sync_pending = session->sync_pending;
+	session->sync_pending = 0;
+
+	if (sync_pending == PHY_FRAME_SUB_TYPE_SYNC_REQ) {
+		link_phy_sync_req(session);
+	}
+	else if (sync_pending == PHY_FRAME_SUB_TYPE_SYNC_RES) {
+		link_phy_sync_res(session);
+	}
+
+	for (uint8_t seq_num = session->send_base; seq_num != session->send_next; seq_num++) {
+		link_phy_send_slot_t* slot = &session->send_window[LINK_PHY_WINDOW_IDX(seq_num)];
+
+		if (slot->state == LINK_PHY_SLOT_SENT && slot->held) {
+			link_phy_send_window_slot_send(session, slot);
+		}
+	}
+
+	/* data frames above carried it when piggyback is agreed */
+	if (session->rev_ack_pending) {
+		if (session->rev_synced) {
+			link_phy_rev_ack_send(session);
+		}
+		else {
+			link_phy_rev_ack_clear(session);
+		}
+	}
+}
+
+void link_phy_poll_req() {
+	uint32_t station;
+	link_phy_session_t* session;
+
+	if (link_phy_poll_turn) {
+		return;
+	}
+
+	while (1) {
+		pthread_mutex_lock(&mt_link_phy_poll_schedule);
+		if (link_phy_poll_len == 0) {
+			pthread_mutex_unlock(&mt_link_phy_poll_schedule);
+			return;
+		}
+		if (link_phy_poll_idx >= link_phy_poll_len) {
+			link_phy_poll_idx = 0;
+		}
+		station = link_phy_poll_schedule[link_phy_poll_idx++];
+		link_phy_poll_wrap = (link_phy_poll_idx == link_phy_poll_len);
+		pthread_mutex_unlock(&mt_link_phy_poll_schedule);
+
+		/* a station given up does not hold the bus for a turn timeout every cycle */
+		session = link_phy_session_find(station);
+		if (session == LINK_PHY_SESSION_NULL || !session->down || session->down_skip == 0) {
+			break;
+		}
+		session->down_skip--;
+
+		if (link_phy_poll_wrap && link_phy_poll_cycle_end()) {
+			return;
+		}
+	}
+
+	/* a station polled first gets its sync request right before */
+	session = link_phy_session_get(station);
+	if (session == LINK_PHY_SESSION_NULL) {
+		link_phy_session_gc();
+		session = link_phy_session_get(station);
+	}
+	if (session == LINK_PHY_SESSION_NULL) {
+		FATAL("LINK_PHY", 0x07);
+	}
+
+	link_phy_frame_write_ctrl(session, PHY_FRAME_TYPE_POLL, PHY_FRAME_SUB_TYPE_POLL_REQ, 0, NULL, 0);
+	link_phy_poll_addr = station;
+	link_phy_poll_turn = 1;
+	link_phy_poll++;
+
+	timer_set(MT_LINK_PHY_ID, GW_LINK_PHY_POLL_TO, LINK_PHY_POLL_TURN_TO_INTERVAL, TIMER_ONE_SHOT);
+}
+
+void link_phy_poll_turn_end() {
+	timer_remove_attr(MT_LINK_PHY_ID, GW_LINK_PHY_POLL_TO);
+	timer_remove_attr(MT_LINK_PHY_ID, GW_LINK_PHY_POLL_REQ);
+	link_phy_poll_turn = 0;
+
+	/* frames held during the turn go before the next poll */
+	for (uint8_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+		if (link_phy_session[i].used) {
+			link_phy_tx_flush(&link_phy_session[i]);
+		}
+	}
+
+	/* next station right away, a cycle without data pauses polling */
+	if (link_phy_poll_wrap && link_phy_poll_cycle_end()) {
+		return;
+	}
+	task_post_pure_msg(MT_LINK_PHY_ID, GW_LINK_PHY_POLL_REQ);
+}
+
+uint8_t link_phy_poll_cycle_end() {
+	uint8_t busy = link_phy_poll_busy;
+	link_phy_poll_busy = 0;
+
+	if (!busy) {
+		timer_set(MT_LINK_PHY_ID, GW_LINK_PHY_POLL_REQ, LINK_PHY_POLL_IDLE_INTERVAL, TIMER_ONE_SHOT);
+		return 1;
+	}
+	return 0;
+}
+
+void link_phy_poll_miss(link_phy_session_t* session) {
+	if (session->down) {
+		session->down_skip = LINK_PHY_POLL_DOWN_SKIP;
+	}
+	else if (++session->poll_miss >= LINK_PHY_POLL_MISS_MAX) {
+		link_phy_station_give_up(session);
+	}
+}
+
+void link_phy_station_give_up(link_phy_session_t* session) {
+	link_phy_station_down++;
+	session->down = 1;
+	session->down_skip = LINK_PHY_POLL_DOWN_SKIP;
+
+	/* held frames are dropped, mac gets SEND_ERR for the request waiting on
+	 * the window and for every next one until the station is back */
+	link_phy_send_window_flush(session);
+	if (session->send_done_pending) {
+		session->send_done_pending = 0;
+		link_phy_send_answer(session->addr, GW_LINK_MAC_FRAME_SEND_ERR);
+	}
+	session->send_err_pending = 0;
+	session->sync_pending = 0;
+
+	link_phy_sync_done(session);
+	if (session->rev_ack_pending) {
+		link_phy_rev_ack_clear(session);
+	}
+}
+
+void link_phy_frame_rev_cobs_byte(uint8_t c) {
+	if (link_phy_rev_cobs_len >= LINK_FBUF_SIZE) {
+		if (link_phy_rev_cobs_len == LINK_FBUF_SIZE) {
+			link_phy_rev_drop++;
+			link_phy_rev_cobs_len = LINK_PHY_REV_COBS_DROP;
+		}
+		return;
+	}
+
+	if (link_phy_rev_cobs_len == 0) {
+		if (rev_link_phy_fbuf == LINK_FBUF_NULL) {
+			rev_link_phy_fbuf = link_fbuf_malloc(0);
+			if (rev_link_phy_fbuf == LINK_FBUF_NULL) {
+				link_phy_rev_cobs_len = LINK_PHY_REV_COBS_DROP;
+				link_phy_rev_drop++;
+				return;
+			}
+			rev_link_phy_frame = (link_phy_frame_t*)link_fbuf_data(rev_link_phy_fbuf);
+		}
+		link_phy_rev_frame_start_to();
+		link_phy_rev_skip = 0;
+#if (LINK_PHY_MULTI_DROP == 1)
+		link_phy_rev_addr_len = 0;
+		link_phy_rev_cobs_run = 0;
+#endif
+	}
+
+	((uint8_t*)rev_link_phy_frame)[link_phy_rev_cobs_len++] = c;
+
+#if (LINK_PHY_MULTI_DROP == 1)
+	if (link_phy_rev_addr_len <= sizeof(uint32_t)) {
+		link_phy_frame_rev_cobs_addr(c);
+		if (link_phy_rev_skip) {
+			link_phy_rev_cobs_len = LINK_PHY_REV_COBS_SKIP;
+		}
+	}
+#endif
+}
+
+#if (LINK_PHY_MULTI_DROP == 1)
+void link_phy_frame_rev_cobs_addr(uint8_t c) {
+	/* stuffed header is decoded on the fly up to the destination address,
+	 * a code byte is followed by its run and an implied zero unless 0xFF */
+	if (link_phy_rev_cobs_run == 0) {
+		link_phy_rev_cobs_code = c;
+		link_phy_rev_cobs_run = c;
+	}
+	else {
+		if (link_phy_rev_addr_len > 0) {
+			((uint8_t*)&link_phy_rev_addr)[link_phy_rev_addr_len - 1] = c;
+		}
+		link_phy_rev_addr_len++;
+	}
+
+	if (--link_phy_rev_cobs_run == 0 && link_phy_rev_cobs_code != 0xFF) {
+		if (link_phy_rev_addr_len > 0 && link_phy_rev_addr_len <= sizeof(uint32_t)) {
+			((uint8_t*)&link_phy_rev_addr)[link_phy_rev_addr_len - 1] = COBS_DELIMITER;
+		}
+		link_phy_rev_addr_len++;
+	}
+
+	/* sof and destination address decoded */
+	if (link_phy_rev_addr_len > sizeof(uint32_t)) {
+		link_phy_frame_rev_addr_check(link_phy_rev_addr);
+	}
+}
+
+void link_phy_frame_rev_addr_check(uint32_t des_addr) {
+	if (des_addr != link_phy_addr) {
+		link_phy_rev_skip = 1;
+		link_phy_rev_foreign++;
+	}
+}
+#endif
+
+void link_phy_frame_rev_cobs_end() {
+	uint32_t len = 0;
+
+	if (link_phy_rev_cobs_len <= LINK_FBUF_SIZE) {
+		len = cobs_decode((uint8_t*)rev_link_phy_frame, link_phy_rev_cobs_len);
+	}
+	else if (link_phy_rev_cobs_len == LINK_PHY_REV_COBS_SKIP) {
+		/* counted when its address was seen */
+		link_phy_rev_cobs_len = 0;
+		link_phy_rev_frame_clear_to();
+		link_phy_frame_parser_state_revc_set(PARSER_STATE_COBS);
+		return;
+	}
+	link_phy_rev_cobs_len = 0;
+
+	/* repaired before any check, CRC-16 still has the last word on it */
+	if (link_phy_fec_parity && len) {
+		len = link_phy_frame_fec_decode((uint8_t*)rev_link_phy_frame, len);
+	}
+
+	/* stuffed frames always carry CRC-16 */
+	link_phy_frame_header_t* header = &rev_link_phy_frame->header;
+	if (len >= LINK_PHY_FRAME_HEADER_SIZE + LINK_PHY_FRAME_TRAILER_SIZE &&
+			header->sof == LINK_PHY_SOF &&
+			(header->type & PHY_FRAME_TYPE_FCS_CRC16) &&
+			header->len <= LINK_PHY_FRAME_DATA_SIZE) {
+		uint8_t fcs_ok = 0;
+
+		/* a lost byte shows as length mismatch, answered like a bad checksum */
+		if (LINK_PHY_FRAME_HEADER_SIZE + header->len + LINK_PHY_FRAME_TRAILER_SIZE == len) {
+			uint8_t* trailer = &rev_link_phy_frame->data[header->len];
+			uint16_t crc = crc16_ccitt(CRC16_CCITT_INIT, (uint8_t*)rev_link_phy_frame, len - LINK_PHY_FRAME_TRAILER_SIZE);
+			fcs_ok = (crc == (uint16_t)((trailer[0] << 8) | trailer[1]));
+		}
+		link_phy_frame_rev_end(fcs_ok);
+	}
+	else {
+		link_phy_rev_frame_clear_to();
+		link_phy_rev_drop++;
+	}
+
+	/* delimiter also opens the next frame, even if its leading one is lost */
+	link_phy_frame_parser_state_revc_set(PARSER_STATE_COBS);
+}
+
+uint32_t link_phy_frame_fec_decode(uint8_t* frame, uint32_t len) {
+	uint8_t parity_len = link_phy_fec_parity;
+	uint32_t block_size = LINK_PHY_FEC_BLOCK_SIZE(parity_len);
+	uint32_t frame_len = 0;
+
+	/* frame length is the one whose codeword count matches the parity received */
+	for (uint32_t parity_size = parity_len; parity_size < len; parity_size += parity_len) {
+		if (LINK_PHY_FEC_SIZE(len - parity_size, parity_len) == parity_size) {
+			frame_len = len - parity_size;
+			break;
+		}
+	}
+
+	/* too short for parity, fails the length check */
+	if (frame_len == 0) {
+		return len;
+	}
+
+	uint8_t* parity = frame + frame_len;
+	int32_t fixed = 0;
+
+	for (uint32_t i = 0; i < frame_len; i += block_size) {
+		uint32_t block = (frame_len - i < block_size) ? frame_len - i : block_size;
+		int32_t ret = rs_decode(frame + i, block, parity, parity_len);
+		if (ret > 0) {
+			fixed += ret;
+		}
+		parity += parity_len;
+	}
+
+	if (fixed) {
+		link_phy_fec_fixed++;
+		link_phy_fec_byte += fixed;
+	}
+
+	return frame_len;
+}
+
+void link_phy_frame_send_max_retry(link_phy_session_t* session) {
+	link_phy_send_fail++;
+
+	/* drop whole window, peer receiving base is re-synced before next frame */
+	link_phy_send_window_flush(session);
+
+	/* one answer per SEND_REQ: MAC is either waiting for it now or will send next */
+	if (session->send_done_pending) {
+		session->send_done_pending = 0;
+		link_phy_send_answer(session->addr, GW_LINK_MAC_FRAME_SEND_ERR);
+	}
+	else {
+		session->send_err_pending = 1;
+	}
+
+	session->window_size = 1;
+	session->sync_retry = 0;
+	link_phy_sync_req(session);
+}
+
+void link_phy_send_window_flush(link_phy_session_t* session) {
+	for (uint8_t i = 0; i < LINK_PHY_WINDOW_SIZE; i++) {
+		if (session->send_window[i].fbuf != LINK_FBUF_NULL) {
+			link_fbuf_free(session->send_window[i].fbuf);
+			session->send_window[i].fbuf = LINK_FBUF_NULL;
+		}
+		session->send_window[i].state = LINK_PHY_SLOT_FREE;
+	}
+	session->send_base = session->send_next;
+	if (!link_phy_send_window_busy()) {
+		timer_remove_attr(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_SEND_TO);
+	}
+}
+
+void link_phy_send_answer(uint32_t station, uint8_t sig) {
+	/* mac keeps one request per station */
+	task_post_common_msg(MT_LINK_MAC_ID, sig, (uint8_t*)&station, sizeof(uint32_t));
+}
+
+void link_phy_session_gc() {
+	for (uint8_t i = 0; i < LINK_PHY_SESSION_NUM; i++) {
+		link_phy_session_t* session = &link_phy_session[i];
+		uint8_t polled = 0;
+
+		if (!session->used) {
+			continue;
+		}
+
+		pthread_mutex_lock(&mt_link_phy_poll_schedule);
+		for (uint8_t j = 0; j < link_phy_poll_len; j++) {
+			if (link_phy_poll_schedule[j] == session->addr) {
+				polled = 1;
+				break;
+			}
+		}
+		pthread_mutex_unlock(&mt_link_phy_poll_schedule);
+
+		if (polled) {
+			continue;
+		}
+
+		/* station left the schedule, frames still held for it are lost */
+		for (uint8_t j = 0; j < LINK_PHY_WINDOW_SIZE; j++) {
+			if (session->send_window[j].fbuf != LINK_FBUF_NULL) {
+				link_fbuf_free(session->send_window[j].fbuf);
+				session->send_window[j].fbuf = LINK_FBUF_NULL;
+			}
+			if (session->rev_window[j].fbuf != LINK_FBUF_NULL) {
+				link_fbuf_free(session->rev_window[j].fbuf);
+				session->rev_window[j].fbuf = LINK_FBUF_NULL;
+			}
+		}
+
+		if (session->send_done_pending) {
+			link_phy_send_answer(session->addr, GW_LINK_MAC_FRAME_SEND_ERR);
+		}
+
+		link_phy_rev_ack_clear(session);
+		link_phy_sync_done(session);
+		session->used = 0;
 	}
 }
 
@@ -450,116 +1831,166 @@ uint8_t link_phy_max_retry_get() {
 uint8_t gw_link_phy_frame_rev_byte(uint8_t c) {
 	static uint8_t link_phy_util_index;
 	uint8_t ret_handle = LINK_HAL_HANDLED;
+	link_phy_frame_parser_state_e state = link_phy_frame_parser_state_revc_get();
+
+	/* running CRC over every wire byte of SOF framing, trailer excluded */
+	if (state == PARSER_STATE_SOF) {
+		link_phy_rev_crc = CRC16_CCITT_INIT;
+	}
+	if (state < PARSER_STATE_CRC) {
+		link_phy_rev_crc = CRC16_CCITT_UPDATE(link_phy_rev_crc, c);
+	}
 
-	switch (link_phy_frame_parser_state_revc_get()) {
+	switch (state) {
 	case PARSER_STATE_SOF: {
-		if (LINK_PHY_SOF == c) {
-			link_phy_util_index = 3;
+		if (LINK_PHY_SOF == c && rev_link_phy_fbuf == LINK_FBUF_NULL) {
+			rev_link_phy_fbuf = link_fbuf_malloc(0);
+			if (rev_link_phy_fbuf != LINK_FBUF_NULL) {
+				rev_link_phy_frame = (link_phy_frame_t*)link_fbuf_data(rev_link_phy_fbuf);
+			}
+			else {
+				link_phy_rev_drop++;
+			}
+		}
+
+		if (LINK_PHY_SOF == c && rev_link_phy_fbuf != LINK_FBUF_NULL) {
+			rev_link_phy_frame->header.sof = c;
+			link_phy_rev_skip = 0;
+			link_phy_util_index = 0;
 			link_phy_frame_parser_state_revc_set(PARSER_STATE_DES_ADDR);
 			link_phy_rev_frame_start_to();
 		}
+#if (LINK_PHY_FRAMING == LINK_PHY_FRAMING_COBS)
+		else if (COBS_DELIMITER == c) {
+			link_phy_rev_cobs_len = 0;
+			link_phy_frame_parser_state_revc_set(PARSER_STATE_COBS);
+		}
+#endif
 		else {
 			ret_handle = LINK_HAL_IGNORED;
 		}
 	}
 		break;
 
+	/* addresses are in memory order, as the header is written */
 	case PARSER_STATE_DES_ADDR: {
-		((uint8_t*)&rev_link_phy_frame.header.des_addr)[link_phy_util_index] = c;
-		if (link_phy_util_index == 0) {
-			link_phy_util_index = 3;
+		((uint8_t*)&rev_link_phy_frame->header.des_addr)[link_phy_util_index] = c;
+		if (link_phy_util_index == sizeof(uint32_t) - 1) {
+#if (LINK_PHY_MULTI_DROP == 1)
+			link_phy_frame_rev_addr_check(rev_link_phy_frame->header.des_addr);
+#endif
+			link_phy_util_index = 0;
 			link_phy_frame_parser_state_revc_set(PARSER_STATE_SRC_ADDR);
 		}
 		else {
-			link_phy_util_index--;
+			link_phy_util_index++;
 		}
 	}
 		break;
 
 	case PARSER_STATE_SRC_ADDR: {
-		((uint8_t*)&rev_link_phy_frame.header.src_addr)[link_phy_util_index] = c;
-		if (link_phy_util_index == 0) {
+		((uint8_t*)&rev_link_phy_frame->header.src_addr)[link_phy_util_index] = c;
+		if (link_phy_util_index == sizeof(uint32_t) - 1) {
 			link_phy_frame_parser_state_revc_set(PARSER_STATE_TYPE);
 		}
 		else {
-			link_phy_util_index--;
+			link_phy_util_index++;
 		}
 	}
 		break;
 
 	case PARSER_STATE_TYPE: {
-		rev_link_phy_frame.header.type = c;
+		rev_link_phy_frame->header.type = c;
 		link_phy_frame_parser_state_revc_set(PARSER_STATE_SUB_TYPE);
 	}
 		break;
 
 	case PARSER_STATE_SUB_TYPE: {
-		rev_link_phy_frame.header.sub_type = c;
+		rev_link_phy_frame->header.sub_type = c;
 		link_phy_frame_parser_state_revc_set(PARSER_STATE_SEQ_NUM);
 	}
 		break;
 
 	case PARSER_STATE_SEQ_NUM: {
-		rev_link_phy_frame.header.seq_num = c;
+		rev_link_phy_frame->header.seq_num = c;
 		link_phy_frame_parser_state_revc_set(PARSER_STATE_LEN);
 	}
 		break;
 
 	case PARSER_STATE_LEN: {
-		rev_link_phy_frame.header.len = c;
-		if (rev_link_phy_frame.header.len > LINK_PHY_FRAME_SIZE) {
+		rev_link_phy_frame->header.len = c;
+		/* data is parsed straight into the pooled buffer, never beyond it */
+		if (rev_link_phy_frame->header.len > LINK_PHY_FRAME_DATA_SIZE) {
 			link_phy_frame_parser_state_revc_set(PARSER_STATE_SOF);
-			timer_remove_attr(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_REV_TO);
-			//FATAL("LK_PHY", 0x04); // Only for internal link layer 
-			
+			link_phy_rev_drop++;
+			link_phy_rev_frame_clear_to();
+			//FATAL("LK_PHY", 0x04); // Only for internal link layer testing
+
 			break;
 		}
 		link_phy_frame_parser_state_revc_set(PARSER_STATE_FCS);
 	}
 		break;
 
-    case PARSER_STATE_FCS: {
-		rev_link_phy_frame.header.fcs = c;
+	case PARSER_STATE_FCS: {
+		rev_link_phy_frame->header.fcs = c;
 
-		if (rev_link_phy_frame.header.len > 0) {
+		if (rev_link_phy_frame->header.len > 0) {
 			link_phy_util_index = 0;
 			link_phy_frame_parser_state_revc_set(PARSER_STATE_DATA);
 		}
+		else if (rev_link_phy_frame->header.type & PHY_FRAME_TYPE_FCS_CRC16) {
+			link_phy_util_index = 0;
+			link_phy_frame_parser_state_revc_set(PARSER_STATE_CRC);
+		}
 		else {
-			link_phy_rev_frame_clear_to();
+			link_phy_frame_rev_end(link_phy_frame_cals_checksum(rev_link_phy_frame) == rev_link_phy_frame->header.fcs);
+		}
+	}
+		break;
 
-			uint8_t cals_cs = link_phy_frame_cals_checksum(&rev_link_phy_frame);
+	case PARSER_STATE_DATA: {
+		/* payload of a frame for another station is only counted */
+		if (!link_phy_rev_skip) {
+			rev_link_phy_frame->data[link_phy_util_index] = c;
+		}
+		link_phy_util_index++;
 
-			if (cals_cs == rev_link_phy_frame.header.fcs) {
-				task_post_common_msg(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_REV, (uint8_t*)&rev_link_phy_frame, sizeof(link_phy_frame_t));
+		if (link_phy_util_index == rev_link_phy_frame->header.len) {
+			if (rev_link_phy_frame->header.type & PHY_FRAME_TYPE_FCS_CRC16) {
+				link_phy_util_index = 0;
+				link_phy_frame_parser_state_revc_set(PARSER_STATE_CRC);
 			}
 			else {
-				LINK_DBG("checksum incorrectly !\n");
-				task_post_common_msg(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_REV_CS_ERR, (uint8_t*)&rev_link_phy_frame, sizeof(link_phy_frame_t));
+				link_phy_frame_rev_end(link_phy_frame_cals_checksum(rev_link_phy_frame) == rev_link_phy_frame->header.fcs);
 			}
-
-			link_phy_frame_parser_state_revc_set(PARSER_STATE_SOF);
 		}
 	}
 		break;
 
-    case PARSER_STATE_DATA: {
-		rev_link_phy_frame.data[link_phy_util_index++] = c;
-
-		if (link_phy_util_index == rev_link_phy_frame.header.len) {
-			link_phy_rev_frame_clear_to();
+	case PARSER_STATE_CRC: {
+		link_phy_rev_crc_trailer = (uint16_t)((link_phy_rev_crc_trailer << 8) | c);
 
-			uint8_t cals_cs = link_phy_frame_cals_checksum(&rev_link_phy_frame);
+		if (++link_phy_util_index == sizeof(uint16_t)) {
+			link_phy_frame_rev_end(link_phy_rev_crc_trailer == link_phy_rev_crc);
+		}
+	}
+		break;
 
-			if (cals_cs == rev_link_phy_frame.header.fcs) {
-				task_post_common_msg(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_REV, (uint8_t*)&rev_link_phy_frame, sizeof(link_phy_frame_t));
-			}
-			else {
-				LINK_DBG("checksum incorrectly !\n");
-				task_post_common_msg(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_REV_CS_ERR, (uint8_t*)&rev_link_phy_frame, sizeof(link_phy_frame_t));
+	case PARSER_STATE_COBS: {
+		if (COBS_DELIMITER == c) {
+			if (link_phy_rev_cobs_len != 0) {
+				link_phy_frame_rev_cobs_end();
 			}
-
+		}
+		else if (link_phy_rev_cobs_len == 0 && LINK_PHY_SOF == c) {
+			/* SOF framed sync between stuffed frames, a stuffed CRC-16 frame
+			 * starts with a code byte <= 14 (header fcs byte is 0) */
 			link_phy_frame_parser_state_revc_set(PARSER_STATE_SOF);
+			ret_handle = gw_link_phy_frame_rev_byte(c);
+		}
+		else {
+			link_phy_frame_rev_cobs_byte(c);
 		}
 	}
 		break;
@@ -572,6 +2003,33 @@ uint8_t gw_link_phy_frame_rev_byte(uint8_t c) {
 	return ret_handle;
 }
 
+void link_phy_frame_rev_end(uint8_t fcs_ok) {
+	link_phy_rev_frame_clear_to();
+
+	/* frame for another station, buffer is kept for the next one */
+	if (link_phy_rev_skip) {
+		link_phy_rev_skip = 0;
+		link_phy_frame_parser_state_revc_set(PARSER_STATE_SOF);
+		return;
+	}
+
+	/* hand the buffer over to the phy task, next frame takes a new one */
+	link_fbuf_t* fbuf = rev_link_phy_fbuf;
+	fbuf->len = LINK_PHY_FRAME_HEADER_SIZE + rev_link_phy_frame->header.len;
+	rev_link_phy_fbuf = LINK_FBUF_NULL;
+
+	if (fcs_ok) {
+		link_fbuf_post(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_REV, fbuf);
+	}
+	else {
+		LINK_DBG("checksum incorrectly !\n");
+		link_phy_fcs_err++;
+		link_fbuf_post(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_REV_CS_ERR, fbuf);
+	}
+
+	link_phy_frame_parser_state_revc_set(PARSER_STATE_SOF);
+}
+
 void link_phy_rev_frame_start_to() {
 #if 1
 	timer_set(MT_LINK_PHY_ID, GW_LINK_PHY_FRAME_REV_TO, LINK_PHY_FRAME_REV_TO_INTERVAL, TIMER_ONE_SHOT);
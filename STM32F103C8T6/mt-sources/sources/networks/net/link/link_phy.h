@@ -7,10 +7,30 @@
 
 #define LINK_PHY_SOF	0xEF
 
+/* frame check algorithm identifiers, exchanged at link sync */
+#define LINK_PHY_FCS_XOR8		0
+#define LINK_PHY_FCS_CRC16		1
+
+/* framing identifiers, exchanged at link sync */
+#define LINK_PHY_FRAMING_SOF	0 /* SOF byte, length from header */
+#define LINK_PHY_FRAMING_COBS	1 /* byte stuffed, 0x00 delimited */
+
+/* capability flags, exchanged at link sync. Effective set is common to both ends */
+#define LINK_PHY_CAP_MAC_CREDIT	0x01 /* mac credit based flow control */
+#define LINK_PHY_CAP_MAC_INTERLEAVE	0x02 /* mac interleaves fragments of pdus, needs LINK_PHY_CAP_MAC_CREDIT */
+#define LINK_PHY_CAP_ACK_PIGGYBACK	0x04 /* data frames carry cumulative ack, standalone ack is delayed */
+#define LINK_PHY_CAP_LINK_AGGREGATE	0x08 /* link packs small messages into one pdu */
+#define LINK_PHY_CAP_LINK_LZ	0x10 /* link compresses pdus */
+
+#define LINK_PHY_FRAME_TRAILER_SIZE	2 /* CRC-16 trailer */
+
 #define LINK_PHY_FRAME_HEADER_SIZE	(sizeof(link_phy_frame_header_t))
 #define LINK_PHY_FRAME_SIZE			(sizeof(link_phy_frame_t))
 
-#define LINK_PHY_FRAME_DATA_SIZE	(AK_COMMON_MSG_DATA_SIZE - LINK_PHY_FRAME_HEADER_SIZE)
+#define LINK_PHY_FRAME_DATA_SIZE	LINK_PHY_FRAME_DATA_SIZE_MAX
+
+/* frame sized for an AK common message, used until the peer answered sync */
+#define LINK_PHY_FRAME_DATA_SIZE_LEGACY	(AK_COMMON_MSG_DATA_SIZE - LINK_PHY_FRAME_HEADER_SIZE)
 
 typedef struct {
 	uint8_t sof; /* start of frame */
@@ -25,7 +45,7 @@ typedef struct {
 
 typedef struct {
 	link_phy_frame_header_t header;
-	uint8_t data[LINK_PHY_FRAME_DATA_SIZE]; /* frame data buffer */
+	uint8_t data[LINK_PHY_FRAME_DATA_SIZE + LINK_PHY_FRAME_TRAILER_SIZE]; /* frame data buffer, room for trailer */
 } __AK_PACKETED link_phy_frame_t;
 
 extern fsm_t fsm_link_phy;
@@ -36,7 +56,53 @@ extern void fsm_link_phy_state_handle(ak_msg_t* msg);
 extern void link_phy_max_retry_set(uint8_t);
 extern uint8_t link_phy_max_retry_get();
 
-extern uint32_t link_phy_get_send_frame_to();
+/* negotiated with the station, defaults before the session is synced */
+extern uint32_t link_phy_get_send_frame_to(uint32_t station);
+extern uint8_t link_phy_get_frame_data_size(uint32_t station);
+extern uint8_t link_phy_get_caps(uint32_t station);
+
+/* multi-drop: stations polled in turn, one listed n times gets n turns per cycle.
+ * A session is kept with each polled station, at most LINK_PHY_STATION_NUM of them.
+ * LINK_PHY_ADDR_STATION is polled alone by default */
+extern void link_phy_poll_set(const uint32_t* schedule, uint8_t len);
+
+/* multi-drop: station given up, see LINK_PHY_POLL_MISS_MAX. Always 0 point-to-point */
+extern uint8_t link_phy_get_station_down(uint32_t station);
+
+typedef struct {
+	uint32_t station; /* peer of the session */
+	uint32_t srtt; /* smoothed round trip time (ms) */
+	uint32_t rttvar; /* round trip time variation (ms) */
+	uint32_t rto; /* current retransmission timeout (ms) */
+	uint32_t rtt_last; /* last valid round trip sample (ms) */
+	uint32_t retransmit; /* frames resent after timeout */
+	uint32_t fast_retransmit; /* frames resent after NACK */
+	uint32_t frame_sent; /* data frames sent, retransmissions excluded */
+	uint32_t frame_rev; /* data frames delivered in order to mac */
+	uint32_t byte_sent; /* data bytes of frame_sent */
+	uint32_t byte_rev; /* data bytes of frame_rev */
+	uint32_t fcs_err; /* frames failed frame check or length */
+	uint32_t rev_to; /* frames not completed within LINK_PHY_FRAME_REV_TO_INTERVAL */
+	uint32_t rev_drop; /* frames dropped, no buffer or malformed */
+	uint32_t send_fail; /* send window given up after max retry */
+	uint32_t fec_fixed; /* frames repaired by forward error correction */
+	uint32_t fec_byte; /* bytes repaired by forward error correction */
+	uint32_t rev_foreign; /* multi-drop: frames for other stations, payload not buffered */
+	uint32_t poll; /* multi-drop: turns granted */
+	uint32_t poll_to; /* multi-drop: turns not ended by the station */
+	uint32_t station_down; /* multi-drop: stations given up, LINK_PHY_POLL_MISS_MAX turns not ended */
+	uint8_t window_size; /* negotiated window */
+	uint8_t fcs_algo; /* negotiated frame check, LINK_PHY_FCS_xxx */
+	uint8_t frame_data_size; /* negotiated frame payload */
+	uint8_t framing; /* negotiated framing, LINK_PHY_FRAMING_xxx */
+	uint8_t caps; /* negotiated capabilities, LINK_PHY_CAP_xxx */
+	uint8_t fec_parity; /* negotiated parity bytes per fec codeword, 0 without fec */
+} link_phy_stat_t;
+
+/* counters of all sessions, negotiated values of the first one */
+extern void link_phy_get_stat(link_phy_stat_t* stat);
+/* negotiated values of session idx, 0 when it is not in use */
+extern uint8_t link_phy_get_session_stat(uint8_t idx, link_phy_stat_t* stat);
 
 extern q_msg_t taskLinkPhyMailbox;
 extern void* TaskLinkPhyEntry(void*);
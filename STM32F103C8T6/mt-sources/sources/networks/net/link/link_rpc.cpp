@@ -0,0 +1,222 @@
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "app.h"
+#include "app_dbg.h"
+#include "task_list.h"
+
+#include "ak.h"
+#include "message.h"
+#include "timer.h"
+
+#include "link.h"
+#include "link_config.h"
+#include "link_sig.h"
+#include "link_rpc.h"
+
+/* call waiting for its response, id LINK_RPC_ID_NONE is a free entry */
+typedef struct {
+	uint8_t id;
+	uint32_t task_id;
+	uint8_t done_sig;
+	uint32_t remain; /* ms */
+} link_rpc_call_t;
+
+static pthread_mutex_t mt_link_rpc;
+static link_rpc_call_t link_rpc_table[LINK_RPC_CALL_MAX];
+static uint8_t link_rpc_table_len; /* calls waiting */
+static uint8_t link_rpc_id_last;
+
+static uint8_t link_rpc_find(uint8_t id);
+static void link_rpc_free(uint8_t i);
+static uint8_t link_rpc_send(link_rpc_header_t* header, uint8_t if_src_task_id, uint8_t if_src_type, uint8_t if_des_type, uint8_t if_des_task_id, uint8_t if_sig, uint8_t* data, uint32_t len, uint8_t over);
+
+uint8_t link_rpc_call(uint8_t task_id, uint8_t done_sig, uint8_t if_des_type, uint8_t if_des_task_id, uint8_t if_sig, uint8_t* data, uint32_t len, uint32_t timeout) {
+	pthread_mutex_lock(&mt_link_rpc);
+	if (len > LINK_RPC_DATA_SIZE || link_rpc_table_len >= LINK_RPC_CALL_MAX) {
+		pthread_mutex_unlock(&mt_link_rpc);
+		return LINK_RPC_ID_NONE;
+	}
+
+	/* ids go round, a late response meets a new call of its id only after 255 calls */
+	do {
+		link_rpc_id_last++;
+	} while (link_rpc_id_last == LINK_RPC_ID_NONE || link_rpc_find(link_rpc_id_last) < LINK_RPC_CALL_MAX);
+
+	link_rpc_call_t* call = &link_rpc_table[link_rpc_find(LINK_RPC_ID_NONE)];
+	call->id = link_rpc_id_last;
+	call->task_id = task_id;
+	call->done_sig = done_sig;
+	call->remain = timeout;
+
+	if (link_rpc_table_len++ == 0) {
+		timer_set(MT_LINK_ID, GW_LINK_RPC_TICK, LINK_RPC_TICK_INTERVAL, TIMER_PERIODIC);
+	}
+
+	/* response comes back to link task */
+	link_rpc_header_t header;
+	header.id = call->id;
+	header.res_sig = GW_LINK_RPC_RES;
+	header.status = LINK_RPC_STATUS_OK;
+	pthread_mutex_unlock(&mt_link_rpc);
+
+	/* link is full, caller keeps its data and calls again later */
+	if (link_rpc_send(&header, MT_LINK_ID, IF_TYPE_CPU_SERIAL_MT, if_des_type, if_des_task_id, if_sig, data, len, 0) == LINK_SEND_STATUS_FULL) {
+		link_rpc_cancel(header.id);
+		return LINK_RPC_ID_NONE;
+	}
+
+	return header.id;
+}
+
+void link_rpc_cancel(uint8_t id) {
+	pthread_mutex_lock(&mt_link_rpc);
+	uint8_t i = link_rpc_find(id);
+
+	if (id != LINK_RPC_ID_NONE && i < LINK_RPC_CALL_MAX) {
+		link_rpc_free(i);
+	}
+	pthread_mutex_unlock(&mt_link_rpc);
+}
+
+void link_rpc_reply(ak_msg_t* req, uint8_t* data, uint32_t len) {
+	link_rpc_header_t header;
+
+	link_rpc_get_data(req, &header, NULL, 0);
+	if (header.id == LINK_RPC_ID_NONE || len > LINK_RPC_DATA_SIZE) {
+		LINK_DBG("[LINK] rpc reply to sig %d dropped\n", req->header->sig);
+		return;
+	}
+
+	uint8_t res_sig = header.res_sig;
+	header.res_sig = 0;
+	header.status = LINK_RPC_STATUS_OK;
+	/* request is gone, its answer is held by link also when it is full */
+	link_rpc_send(&header, req->header->if_des_task_id, req->header->if_des_type, req->header->if_src_type, req->header->if_src_task_id, res_sig, data, len, 1);
+}
+
+uint32_t link_rpc_get_data(ak_msg_t* msg, link_rpc_header_t* header, uint8_t* data, uint32_t size) {
+	uint8_t buf[sizeof(link_rpc_header_t) + LINK_RPC_DATA_SIZE];
+
+	header->id = LINK_RPC_ID_NONE;
+
+	if (get_msg_type(msg) != DYNAMIC_MSG_TYPE || get_data_len_dynamic_msg(msg) < sizeof(link_rpc_header_t)) {
+		return 0;
+	}
+
+	uint32_t buf_len = get_data_len_dynamic_msg(msg);
+	if (buf_len > sizeof(buf)) {
+		buf_len = sizeof(buf);
+	}
+	get_data_dynamic_msg(msg, buf, buf_len);
+
+	uint32_t len = buf_len - sizeof(link_rpc_header_t);
+
+	if (len > size) {
+		len = size;
+	}
+	memcpy(header, buf, sizeof(link_rpc_header_t));
+	if (len > 0) {
+		memcpy(data, &buf[sizeof(link_rpc_header_t)], len);
+	}
+	return len;
+}
+
+void link_rpc_rev(ak_msg_t* msg) {
+	link_rpc_header_t header;
+
+	link_rpc_get_data(msg, &header, NULL, 0);
+
+	pthread_mutex_lock(&mt_link_rpc);
+	uint8_t i = link_rpc_find(header.id);
+
+	if (header.id == LINK_RPC_ID_NONE || i >= LINK_RPC_CALL_MAX) {
+		pthread_mutex_unlock(&mt_link_rpc);
+		LINK_DBG("[LINK] rpc response %d without call, drop\n", header.id);
+		return;
+	}
+
+	uint32_t task_id = link_rpc_table[i].task_id;
+	uint8_t done_sig = link_rpc_table[i].done_sig;
+	link_rpc_free(i);
+	pthread_mutex_unlock(&mt_link_rpc);
+
+	/* response is the completion, caller reads it like the request */
+	ak_msg_t* done_msg = ak_memcpy_msg(msg);
+	set_msg_sig(done_msg, done_sig);
+	set_msg_src_task_id(done_msg, MT_LINK_ID);
+	task_post(task_id, done_msg);
+}
+
+void link_rpc_tick() {
+	pthread_mutex_lock(&mt_link_rpc);
+	for (uint8_t i = 0; i < LINK_RPC_CALL_MAX; i++) {
+		link_rpc_call_t* call = &link_rpc_table[i];
+
+		if (call->id == LINK_RPC_ID_NONE) {
+			continue;
+		}
+
+		if (call->remain > LINK_RPC_TICK_INTERVAL) {
+			call->remain -= LINK_RPC_TICK_INTERVAL;
+			continue;
+		}
+
+		link_rpc_header_t header;
+		header.id = call->id;
+		header.res_sig = 0;
+		header.status = LINK_RPC_STATUS_TIMEOUT;
+		task_post_dynamic_msg(MT_LINK_ID, call->task_id, call->done_sig, (uint8_t*)&header, sizeof(link_rpc_header_t));
+
+		link_rpc_free(i);
+	}
+	pthread_mutex_unlock(&mt_link_rpc);
+}
+
+uint8_t link_rpc_find(uint8_t id) {
+	uint8_t i = 0;
+
+	while (i < LINK_RPC_CALL_MAX && link_rpc_table[i].id != id) {
+		i++;
+	}
+	return i;
+}
+
+void link_rpc_free(uint8_t i) {
+	link_rpc_table[i].id = LINK_RPC_ID_NONE;
+
+	if (--link_rpc_table_len == 0) {
+		timer_remove_attr(MT_LINK_ID, GW_LINK_RPC_TICK);
+	}
+}
+
+uint8_t link_rpc_send(link_rpc_header_t* header, uint8_t if_src_task_id, uint8_t if_src_type, uint8_t if_des_type, uint8_t if_des_task_id, uint8_t if_sig, uint8_t* data, uint32_t len, uint8_t over) {
+	uint8_t buf[sizeof(link_rpc_header_t) + LINK_RPC_DATA_SIZE];
+
+	memcpy(buf, header, sizeof(link_rpc_header_t));
+	if (len > 0) {
+		memcpy(&buf[sizeof(link_rpc_header_t)], data, len);
+	}
+
+	ak_msg_t* msg = get_dynamic_msg();
+	set_if_src_task_id(msg, if_src_task_id);
+	set_if_des_task_id(msg, if_des_task_id);
+	set_if_src_type(msg, if_src_type);
+	set_if_des_type(msg, if_des_type);
+	set_if_sig(msg, if_sig);
+	set_data_dynamic_msg(msg, buf, sizeof(link_rpc_header_t) + len);
+
+	set_msg_sig(msg, GW_LINK_SEND_DYNAMIC_MSG);
+
+	if (over) {
+		link_send_post_over(msg);
+		return LINK_SEND_STATUS_HOLD;
+	}
+
+	uint8_t status = link_send_post(msg);
+	if (status == LINK_SEND_STATUS_FULL) {
+		ak_msg_free(msg);
+	}
+	return status;
+}
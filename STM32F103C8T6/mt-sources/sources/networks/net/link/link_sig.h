@@ -20,6 +20,10 @@ enum {
 	GW_LINK_PHY_FRAME_REV,
 	GW_LINK_PHY_FRAME_REV_TO,
 	GW_LINK_PHY_FRAME_REV_CS_ERR,
+	GW_LINK_PHY_SYNC_TO,
+	GW_LINK_PHY_ACK_DELAY_TO,
+	GW_LINK_PHY_POLL_REQ,
+	GW_LINK_PHY_POLL_TO,
 };
 
 /*****************************************************************************/
@@ -34,13 +38,16 @@ enum {
 	GW_LINK_MAC_INIT = AK_USER_DEFINE_SIG,
 	GW_LINK_MAC_PHY_LAYER_STARTED,
 	GW_LINK_MAC_FRAME_SEND_REQ,
+	GW_LINK_MAC_REV_PDU_FREE,
 
 	/* private */
-	GW_LINK_MAC_FRAME_SEND_START,
 	GW_LINK_MAC_FRAME_SEND_DONE,
 	GW_LINK_MAC_FRAME_SEND_ERR,
 	GW_LINK_MAC_FRAME_REV,
 	GW_LINK_MAC_FRAME_REV_TO,
+	GW_LINK_MAC_PHY_SYNCED,
+	GW_LINK_MAC_CREDIT_TO,
+	GW_LINK_MAC_SEND_RESUME,
 };
 
 /*****************************************************************************/
@@ -59,10 +66,14 @@ enum {
 	GW_LINK_SEND_DYNAMIC_MSG,
 	GW_LINK_SEND_DATA,
 	GW_LINK_SEND_HANDLE_PDU_FULL,
+	GW_LINK_RPC_RES,
 
 	/* private */
 	GW_LINK_SEND_DONE,
 	GW_LINK_SEND_ERR,
+	GW_LINK_SEND_AGG_TO,
+	GW_LINK_SEND_RETRY_TO,
+	GW_LINK_RPC_TICK,
 
 	GW_LINK_REV_MSG,
 };
@@ -0,0 +1,124 @@
+/* crc16_ccitt (one 512B table) and crc16_ccitt_s4 (slice-by-4), built with
+ * CRC16_SLICE_BY_4:
+ *   check value	"123456789" gives 0x29B1 from both
+ *   random buffers	random start value, length and alignment give the same
+ *					crc from both, also when a buffer is fed in two parts
+ * Then bytes per cycle of both on link frame sizes. Exits 1 on any mismatch.
+ *
+ *   crc_bench [random buffers]	default 20000 */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "crc16.h"
+
+#if !defined(CRC16_SLICE_BY_4)
+#error "crc_bench is built with -DCRC16_SLICE_BY_4"
+#endif
+
+#define CRC_BENCH_LEN_MAX	(1024)
+#define CRC_BENCH_BYTES		(64 * 1024 * 1024)	/* per size and variant */
+
+static const uint16_t crc_bench_size[] = { 4, 16, 64, 256, 1024 };
+
+static uint8_t crc_bench_buf[CRC_BENCH_LEN_MAX + 8];
+
+/* tsc on x86, ns elsewhere */
+static uint64_t crc_bench_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static uint32_t crc_bench_check(uint32_t buffers) {
+	static const uint8_t check[] = "123456789";
+	uint32_t violation = 0;
+
+	uint16_t crc = crc16_ccitt(CRC16_CCITT_INIT, check, 9);
+	uint16_t crc_s4 = crc16_ccitt_s4(CRC16_CCITT_INIT, check, 9);
+	if (crc != 0x29B1 || crc_s4 != 0x29B1) {
+		printf("check value 0x%04X (table) 0x%04X (s4), expected 0x29B1\n", crc, crc_s4);
+		violation++;
+	}
+
+	for (uint32_t i = 0; i < sizeof(crc_bench_buf); i++) {
+		crc_bench_buf[i] = (uint8_t)rand();
+	}
+
+	for (uint32_t n = 0; n < buffers; n++) {
+		uint32_t len = rand() % (CRC_BENCH_LEN_MAX + 1);
+		uint32_t off = rand() % 8;
+		uint32_t cut = len ? rand() % len : 0;
+		uint16_t init = (uint16_t)rand();
+		const uint8_t* data = &crc_bench_buf[off];
+
+		crc = crc16_ccitt(init, data, len);
+		crc_s4 = crc16_ccitt_s4(init, data, len);
+		uint16_t crc_cut = crc16_ccitt_s4(crc16_ccitt_s4(init, data, cut), &data[cut], len - cut);
+
+		if (crc != crc_s4 || crc != crc_cut) {
+			if (violation++ < 5) {
+				printf("init 0x%04X +%u len %u: 0x%04X (table) 0x%04X (s4) 0x%04X (s4 cut at %u)\n",
+					   init, off, len, crc, crc_s4, crc_cut, cut);
+			}
+		}
+
+		/* new random bytes now and then */
+		crc_bench_buf[rand() % sizeof(crc_bench_buf)] = (uint8_t)rand();
+	}
+
+	return violation;
+}
+
+static double crc_bench_rate(uint16_t (*crc_fn)(uint16_t, const uint8_t*, uint32_t), uint32_t len) {
+	volatile uint16_t sink;
+	uint32_t rounds = CRC_BENCH_BYTES / len;
+	uint16_t crc = CRC16_CCITT_INIT;
+
+	uint64_t t0 = crc_bench_cycles();
+	for (uint32_t r = 0; r < rounds; r++) {
+		/* each result feeds the next call, no call can be dropped */
+		crc = crc_fn(crc, crc_bench_buf, len);
+	}
+	uint64_t t = crc_bench_cycles() - t0;
+	sink = crc;
+	(void)sink;
+
+	return (double)rounds * len / (t ? t : 1);
+}
+
+int main(int argc, char** argv) {
+	uint32_t buffers = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 20000;
+
+	srand(1);
+
+	uint32_t violation = crc_bench_check(buffers);
+	printf("crc16_ccitt_s4 vs crc16_ccitt, %u random buffers up to %u bytes: %u mismatches\n",
+		   buffers, CRC_BENCH_LEN_MAX, violation);
+
+#if defined(__x86_64__) || defined(__i386__)
+	printf("SIZE\tbytes/cycle (tsc)\n\ttable\ts4\ts4/table\n");
+#else
+	printf("SIZE\tbytes/ns\n\ttable\ts4\ts4/table\n");
+#endif
+	for (uint32_t i = 0; i < sizeof(crc_bench_size) / sizeof(crc_bench_size[0]); i++) {
+		uint32_t len = crc_bench_size[i];
+		double table = crc_bench_rate(crc16_ccitt, len);
+		double s4 = crc_bench_rate(crc16_ccitt_s4, len);
+
+		printf("%u\t%.3f\t%.3f\t%.2fx\n", len, table, s4, s4 / table);
+	}
+
+	printf("%s\n", violation ? "FAIL" : "PASS");
+	return violation ? 1 : 0;
+}
@@ -0,0 +1,216 @@
+/* link stack without its task threads, see link_drive.h.
+ * The link sources are built into this file so their task handlers and the
+ * phy byte parser can be called directly. ak.cpp is built with its main()
+ * renamed, the mailboxes are made ready here.
+ * On target the phy task takes each frame while link_hal parses the rest of
+ * its read, here the stack runs from inside the parser at every frame end.
+ * Otherwise one read of many frames runs the fbuf pool and the mac receive
+ * pdus out before any of them is given back. */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "link.cpp"
+#include "link_mac.cpp"
+
+static void link_drive_post_common_msg(uint32_t task_dst_id, uint32_t sig, uint8_t* data, uint32_t len);
+
+#define task_post_common_msg	link_drive_post_common_msg
+#include "link_phy.cpp"
+#undef task_post_common_msg
+
+#include "link_drive.h"
+
+/* a frame makes a few dozen messages, more is a loop between the layers */
+#define LINK_DRIVE_MSG_MAX		100000
+
+q_msg_t taskIfMailbox;
+q_msg_t taskCpuSerialIfMailbox;
+q_msg_t taskSmMailbox;
+q_msg_t taskFirmwareMailbox;
+q_msg_t taskSystemMailbox;
+q_msg_t taskDevManagerMailbox;
+
+static uint8_t link_drive_started;
+static uint8_t link_drive_parsing;
+static uint32_t link_drive_delivered_cnt;
+static pf_link_drive_tap link_drive_tap;
+
+static void* link_drive_task(void*) {
+	return (void*)0;
+}
+
+ak_task_t task_list[] = {
+	{	MT_TASK_TIMER_ID,			TASK_PRI_LEVEL_1,	link_drive_task			,	&timerMailbox				,	"TIMER"			},
+	{	MT_TASK_IF_ID,				TASK_PRI_LEVEL_1,	link_drive_task			,	&taskIfMailbox				,	"IF"			},
+	{	MT_TASK_IF_CPU_SERIAL_ID,	TASK_PRI_LEVEL_1,	link_drive_task			,	&taskCpuSerialIfMailbox		,	"CPU SERIAL IF"	},
+	{	MT_TASK_SM_ID,				TASK_PRI_LEVEL_1,	link_drive_task			,	&taskSmMailbox				,	"SM"			},
+	{	MT_TASK_FIRMWARE_ID,		TASK_PRI_LEVEL_1,	link_drive_task			,	&taskFirmwareMailbox		,	"FIRMWARE"		},
+	{	MT_TASK_SYSTEM_ID,			TASK_PRI_LEVEL_1,	link_drive_task			,	&taskSystemMailbox			,	"SYSTEM"		},
+	{	MT_TASK_DEVICE_MANAGER_ID,	TASK_PRI_LEVEL_1,	link_drive_task			,	&taskDevManagerMailbox		,	"DEVICE"		},
+
+	/* LINK TASKS */
+	{	MT_LINK_PHY_ID,				TASK_PRI_LEVEL_3,	TaskLinkPhyEntry		,	&taskLinkPhyMailbox			,	"LINK PHYSICAL"	},
+	{	MT_LINK_MAC_ID,				TASK_PRI_LEVEL_2,	TaskLinkMacEntry		,	&taskLinkMacMailbox			,	"LINK MAC"		},
+	{	MT_LINK_ID,					TASK_PRI_LEVEL_1,	TaskLinkEntry			,	&taskLinkMailbox			,	"LINK"			},
+};
+
+/* TaskLinkPhyEntry() is not run, nothing opens it */
+static char link_drive_path[] = "none";
+
+char* filePathRetStr(filePathIdx_t) {
+	return link_drive_path;
+}
+
+/* ak main() is not run */
+void task_init() {
+}
+
+static void link_drive_dispatch(uint32_t id, ak_msg_t* msg) {
+	switch (id) {
+	case MT_LINK_PHY_ID:
+		task_link_phy(msg);
+		break;
+
+	case MT_LINK_MAC_ID:
+		if (link_drive_tap != NULL && msg->header->sig == GW_LINK_MAC_FRAME_REV) {
+			link_fbuf_t* fbuf = link_fbuf_msg(msg);
+			link_drive_tap(LINK_DRIVE_LAYER_MAC, link_fbuf_data(fbuf), fbuf->len);
+		}
+		task_link_mac(msg);
+		break;
+
+	case MT_LINK_ID:
+		if (link_drive_tap != NULL && msg->header->sig == GW_LINK_REV_MSG) {
+			uint32_t pdu_id;
+			memcpy(&pdu_id, get_data_common_msg(msg), sizeof(uint32_t));
+
+			link_pdu_t* pdu = link_pdu_get(pdu_id);
+			link_drive_tap(LINK_DRIVE_LAYER_LINK, pdu->payload, pdu->len);
+		}
+		task_link(msg);
+		break;
+
+	default:
+		link_drive_delivered_cnt++;
+		break;
+	}
+}
+
+static void link_drive_run() {
+	uint32_t cnt = 0;
+	uint8_t busy = 1;
+
+	while (busy) {
+		busy = 0;
+
+		for (uint32_t id = 0; id < MT_TASK_LIST_LEN; id++) {
+			while (q_msg_len(task_list[id].mailbox) > 0) {
+				ak_msg_t* msg = ak_msg_rev(id);
+
+				link_drive_dispatch(id, msg);
+				ak_msg_free(msg);
+
+				if (++cnt > LINK_DRIVE_MSG_MAX) {
+					printf("link_drive: more than %u messages for one input\n", LINK_DRIVE_MSG_MAX);
+					abort();
+				}
+				busy = 1;
+			}
+		}
+	}
+}
+
+/* phy posts, a frame from the parser is taken before the next one is parsed */
+void link_drive_post_common_msg(uint32_t task_dst_id, uint32_t sig, uint8_t* data, uint32_t len) {
+	task_post_common_msg(task_dst_id, sig, data, len);
+
+	if (link_drive_parsing) {
+		link_drive_parsing = 0;
+		link_drive_run();
+		link_drive_parsing = 1;
+	}
+}
+
+void link_drive_reset() {
+	if (!link_drive_started) {
+		for (uint32_t id = 0; id < MT_TASK_LIST_LEN; id++) {
+			q_msg_init(task_list[id].mailbox);
+			pthread_cond_init(&task_list[id].mailbox_cond, NULL);
+		}
+		link_drive_started = 1;
+	}
+
+	/* messages left by the last input, pools are made again by link init */
+	for (uint32_t id = 0; id < MT_TASK_LIST_LEN; id++) {
+		while (q_msg_len(task_list[id].mailbox) > 0) {
+			ak_msg_free(ak_msg_rev(id));
+		}
+	}
+
+	for (uint8_t channel = 0; channel < LINK_CHANNEL_NUM; channel++) {
+		while (q_msg_len(&link_send_hold_q[channel]) > 0) {
+			ak_msg_free(q_msg_get(&link_send_hold_q[channel]));
+		}
+	}
+
+	/* same start for every input, phy takes its sequence bases from rand() */
+	srand(1);
+
+	link_init_state_machine();
+	task_post_pure_msg(MT_LINK_ID, GW_LINK_INIT);
+	link_drive_run();
+
+	link_drive_delivered_cnt = 0;
+}
+
+void link_drive_phy(const uint8_t* data, uint32_t len) {
+	link_drive_parsing = 1;
+	link_phy_rev_frame_parser((uint8_t*)data, len);
+	link_drive_parsing = 0;
+
+	link_drive_run();
+}
+
+void link_drive_mac(const uint8_t* frame, uint32_t len) {
+	link_fbuf_t* fbuf = link_fbuf_malloc(0);
+
+	if (fbuf == LINK_FBUF_NULL) {
+		return;
+	}
+
+	if (len > LINK_FBUF_SIZE) {
+		len = LINK_FBUF_SIZE;
+	}
+	memcpy(link_fbuf_put(fbuf, len), frame, len);
+
+	link_fbuf_post(MT_LINK_MAC_ID, GW_LINK_MAC_FRAME_REV, fbuf);
+	link_drive_run();
+}
+
+void link_drive_link(const uint8_t* pdu, uint32_t len) {
+	link_pdu_t* link_pdu = link_pdu_rx_malloc();
+
+	if (link_pdu == LINK_PDU_NULL) {
+		return;
+	}
+
+	if (len > LINK_PDU_BUF_SIZE) {
+		len = LINK_PDU_BUF_SIZE;
+	}
+	memcpy(link_pdu->payload, pdu, len);
+	link_pdu->len = len;
+
+	uint32_t pdu_id = link_pdu->id;
+	task_post_common_msg(MT_LINK_ID, GW_LINK_REV_MSG, (uint8_t*)&pdu_id, sizeof(uint32_t));
+	link_drive_run();
+}
+
+uint32_t link_drive_delivered() {
+	return link_drive_delivered_cnt;
+}
+
+void link_drive_tap_set(pf_link_drive_tap tap) {
+	link_drive_tap = tap;
+}
@@ -0,0 +1,28 @@
+#ifndef __LINK_DRIVE_H__
+#define __LINK_DRIVE_H__
+
+#include <stdint.h>
+
+/* link stack run in the calling thread: received bytes, mac frames or link
+ * pdus go in, then every message the stack posts is dispatched until all
+ * mailboxes are empty. Timers never fire and nothing is written to a line */
+#define LINK_DRIVE_LAYER_MAC		(1) /* mac frame, phy header stripped */
+#define LINK_DRIVE_LAYER_LINK		(2) /* link pdu, reassembled by mac */
+
+/* sees each mac frame and link pdu before its layer takes it */
+typedef void (*pf_link_drive_tap)(uint8_t layer, const uint8_t* data, uint32_t len);
+
+/* stack as after start: pools empty, phy waiting for the peer sync */
+extern void link_drive_reset();
+
+/* bytes as read from the line by link_hal */
+extern void link_drive_phy(const uint8_t* data, uint32_t len);
+extern void link_drive_mac(const uint8_t* frame, uint32_t len);
+extern void link_drive_link(const uint8_t* pdu, uint32_t len);
+
+/* messages delivered to application tasks since reset */
+extern uint32_t link_drive_delivered();
+
+extern void link_drive_tap_set(pf_link_drive_tap tap);
+
+#endif //__LINK_DRIVE_H__
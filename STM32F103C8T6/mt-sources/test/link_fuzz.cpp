@@ -0,0 +1,340 @@
+/* fuzz target of the link receive path: phy byte parser, mac reassembly and
+ * link pdu decoding (lz included), driven in one thread by link_drive.
+ * An input is a layer byte and its data:
+ *   0	bytes from the line, next byte is the read size of link_hal, 0 all at once
+ *   1	mac frames, each a length byte and the frame
+ *   2	one link pdu
+ *
+ * Built with -DLINK_FUZZ_ENGINE -fsanitize=fuzzer the fuzzer engine runs it.
+ * Otherwise it is its own driver, built with the sanitizers by make:
+ *   link_fuzz [-runs n] file|dir ...	each input once, then n random mutations
+ *										of them, 10000 by default
+ *   link_fuzz -seeds dir stream ...	inputs of all three layers from line
+ *										streams recorded by link_pair */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <vector>
+
+#include "link_config.h"
+#include "link.h"
+#include "link_lz.h"
+
+#include "link_drive.h"
+
+#define LINK_FUZZ_LAYER_PHY		0
+#define LINK_FUZZ_LAYER_MAC		1
+#define LINK_FUZZ_LAYER_LINK	2
+
+#define LINK_FUZZ_SEED_FRAMES	8 /* mac frames per seed input */
+#define LINK_FUZZ_SEED_MAX		32 /* seed inputs per layer and stream */
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+	if (size < 1) {
+		return 0;
+	}
+
+	uint8_t layer = data[0] % 3;
+	data++;
+	size--;
+
+	link_drive_reset();
+
+	switch (layer) {
+	case LINK_FUZZ_LAYER_PHY: {
+		if (size < 1) {
+			break;
+		}
+
+		size_t chunk = data[0] ? data[0] : size - 1;
+		data++;
+		size--;
+
+		for (size_t off = 0; off < size; off += chunk) {
+			link_drive_phy(data + off, (uint32_t)((size - off < chunk) ? size - off : chunk));
+		}
+	}
+		break;
+
+	case LINK_FUZZ_LAYER_MAC: {
+		size_t off = 0;
+
+		while (off < size) {
+			size_t len = data[off++];
+
+			if (len > size - off) {
+				len = size - off;
+			}
+			link_drive_mac(data + off, (uint32_t)len);
+			off += len;
+		}
+	}
+		break;
+
+	default:
+		link_drive_link(data, (uint32_t)size);
+		break;
+	}
+
+	return 0;
+}
+
+#ifndef LINK_FUZZ_ENGINE
+typedef std::vector<uint8_t> link_fuzz_input_t;
+
+static std::vector<link_fuzz_input_t> link_fuzz_seed_mac;
+static std::vector<link_fuzz_input_t> link_fuzz_seed_link;
+static uint32_t link_fuzz_seed_mac_frames;
+
+static uint8_t link_fuzz_read(const char* path, link_fuzz_input_t& input) {
+	FILE* f = fopen(path, "rb");
+	if (f == NULL) {
+		return 0;
+	}
+
+	uint8_t buf[4096];
+	size_t n;
+	while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+		input.insert(input.end(), buf, buf + n);
+	}
+	fclose(f);
+	return 1;
+}
+
+static uint8_t link_fuzz_write(const std::string& path, const link_fuzz_input_t& input) {
+	FILE* f = fopen(path.c_str(), "wb");
+	if (f == NULL) {
+		printf("%s: cannot write\n", path.c_str());
+		return 0;
+	}
+
+	fwrite(input.data(), 1, input.size(), f);
+	fclose(f);
+	return 1;
+}
+
+/* files of a directory or the file itself */
+static void link_fuzz_load(const char* path, std::vector<link_fuzz_input_t>& inputs) {
+	struct stat st;
+	if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+		DIR* dir = opendir(path);
+		struct dirent* entry;
+
+		while (dir != NULL && (entry = readdir(dir)) != NULL) {
+			if (entry->d_name[0] != '.') {
+				link_fuzz_load((std::string(path) + "/" + entry->d_name).c_str(), inputs);
+			}
+		}
+
+		if (dir != NULL) {
+			closedir(dir);
+		}
+		return;
+	}
+
+	link_fuzz_input_t input;
+	if (link_fuzz_read(path, input)) {
+		inputs.push_back(input);
+	}
+	else {
+		printf("%s: cannot open\n", path);
+	}
+}
+
+static void link_fuzz_mutate(link_fuzz_input_t& input, const std::vector<link_fuzz_input_t>& inputs) {
+	uint32_t ops = 1 + rand() % 8;
+
+	for (uint32_t i = 0; i < ops; i++) {
+		size_t pos = input.empty() ? 0 : (size_t)rand() % input.size();
+
+		switch (rand() % 6) {
+		case 0:
+			if (!input.empty()) {
+				input[pos] ^= (uint8_t)(1 << (rand() % 8));
+			}
+			break;
+
+		case 1:
+			if (!input.empty()) {
+				input[pos] = (uint8_t)rand();
+			}
+			break;
+
+		case 2:
+			input.insert(input.begin() + pos, (uint8_t)rand());
+			break;
+
+		case 3:
+			if (!input.empty()) {
+				input.erase(input.begin() + pos);
+			}
+			break;
+
+		case 4:
+			input.resize(pos);
+			break;
+
+		default: {
+			/* piece of another input */
+			const link_fuzz_input_t& other = inputs[rand() % inputs.size()];
+			if (other.empty()) {
+				break;
+			}
+
+			size_t from = (size_t)rand() % other.size();
+			size_t len = 1 + (size_t)rand() % (other.size() - from);
+			input.insert(input.begin() + pos, other.begin() + from, other.begin() + from + len);
+		}
+			break;
+		}
+	}
+
+	/* first byte picks the layer, keep most runs on the layer of the input */
+	if (!input.empty() && rand() % 16 == 0) {
+		input[0] = (uint8_t)rand();
+	}
+}
+
+static void link_fuzz_tap(uint8_t layer, const uint8_t* data, uint32_t len) {
+	if (layer == LINK_DRIVE_LAYER_MAC) {
+		if (link_fuzz_seed_mac_frames++ % LINK_FUZZ_SEED_FRAMES == 0) {
+			link_fuzz_seed_mac.push_back(link_fuzz_input_t(1, LINK_FUZZ_LAYER_MAC));
+		}
+
+		link_fuzz_input_t& input = link_fuzz_seed_mac.back();
+		input.push_back((uint8_t)len);
+		input.insert(input.end(), data, data + len);
+	}
+	else {
+		link_fuzz_input_t input(1, LINK_FUZZ_LAYER_LINK);
+		input.insert(input.end(), data, data + len);
+		link_fuzz_seed_link.push_back(input);
+
+		/* same pdu lz coded, data of the harness is rarely shorter coded */
+		link_frame_t frame;
+		if (len < sizeof(link_frame_header_t) || len > sizeof(frame)) {
+			return;
+		}
+		memcpy(&frame, data, len);
+
+		uint32_t data_len = len - sizeof(link_frame_header_t);
+		if (frame.header.len < data_len) {
+			data_len = frame.header.len;
+		}
+
+		uint32_t lz_len = link_lz_compress(&data[sizeof(link_frame_header_t)], data_len, frame.data, LINK_DATA_BUF_SIZE);
+		if (frame.header.sub_type == LINK_FRAME_SUB_TYPE_NONE && lz_len != 0) {
+			frame.header.sub_type = LINK_FRAME_SUB_TYPE_LZ;
+			frame.header.len = lz_len;
+
+			input.resize(1);
+			input.insert(input.end(), (uint8_t*)&frame, (uint8_t*)&frame + sizeof(link_frame_header_t) + lz_len);
+			link_fuzz_seed_link.push_back(input);
+		}
+	}
+}
+
+/* one seed file per mac frame group and link pdu is plenty, keep a spread */
+static uint8_t link_fuzz_seed_write(const std::string& prefix, const std::vector<link_fuzz_input_t>& inputs) {
+	size_t step = (inputs.size() + LINK_FUZZ_SEED_MAX - 1) / LINK_FUZZ_SEED_MAX;
+
+	for (size_t i = 0; i < inputs.size(); i += (step ? step : 1)) {
+		char name[32];
+		snprintf(name, sizeof(name), "-%03zu", i);
+		if (!link_fuzz_write(prefix + name, inputs[i])) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static int link_fuzz_seeds(const char* dir, int argc, char** argv) {
+	link_drive_tap_set(link_fuzz_tap);
+
+	for (int i = 0; i < argc; i++) {
+		link_fuzz_input_t stream;
+		if (!link_fuzz_read(argv[i], stream)) {
+			printf("%s: cannot open\n", argv[i]);
+			return 1;
+		}
+
+		const char* name = strrchr(argv[i], '/');
+		std::string prefix = std::string(dir) + "/" + (name ? name + 1 : argv[i]);
+
+		link_fuzz_seed_mac.clear();
+		link_fuzz_seed_mac_frames = 0;
+		link_fuzz_seed_link.clear();
+
+		/* whole stream as read by link_hal, and in uart sized pieces */
+		link_fuzz_input_t input;
+		input.push_back(LINK_FUZZ_LAYER_PHY);
+		input.push_back(0);
+		input.insert(input.end(), stream.begin(), stream.end());
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+		link_fuzz_write(prefix + "-phy", input);
+
+		input[1] = 7;
+		link_fuzz_write(prefix + "-phy7", input);
+
+		if (!link_fuzz_seed_write(prefix + "-mac", link_fuzz_seed_mac) || !link_fuzz_seed_write(prefix + "-link", link_fuzz_seed_link)) {
+			return 1;
+		}
+
+		printf("%s: %zu mac frame groups, %zu link pdus\n", argv[i], link_fuzz_seed_mac.size(), link_fuzz_seed_link.size());
+	}
+
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	uint32_t runs = 10000;
+	int arg = 1;
+
+	if (argc > 2 && strcmp(argv[1], "-seeds") == 0) {
+		return link_fuzz_seeds(argv[2], argc - 3, argv + 3);
+	}
+
+	if (argc > 2 && strcmp(argv[1], "-runs") == 0) {
+		runs = (uint32_t)strtoul(argv[2], NULL, 0);
+		arg = 3;
+	}
+
+	std::vector<link_fuzz_input_t> inputs;
+	for (; arg < argc; arg++) {
+		link_fuzz_load(argv[arg], inputs);
+	}
+
+	if (inputs.empty()) {
+		printf("FAIL no input\n");
+		return 1;
+	}
+
+	uint32_t delivered = 0;
+	for (size_t i = 0; i < inputs.size(); i++) {
+		LLVMFuzzerTestOneInput(inputs[i].data(), inputs[i].size());
+		delivered += link_drive_delivered();
+	}
+	printf("%zu inputs, %u messages delivered\n", inputs.size(), delivered);
+
+	srand(1);
+	for (uint32_t r = 0; r < runs; r++) {
+		link_fuzz_input_t input = inputs[rand() % inputs.size()];
+
+		/* the stack reseeds rand(), mutations go on from their own state */
+		uint32_t seed = rand();
+		link_fuzz_mutate(input, inputs);
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+		srand(seed);
+	}
+	printf("%u mutated inputs\n", runs);
+
+	/* sanitizers abort on a finding, getting here is a pass */
+	printf("PASS\n");
+	return 0;
+}
+#endif
@@ -0,0 +1,1114 @@
+/* two link stacks, one per process, over the loopback pair of link_hal.
+ * Each end sends LINK_PAIR_COUNT dynamic messages to the sink task of the
+ * other end, which checks length, content and order. Exits 0 when both ends
+ * received at least LINK_PAIR_MIN messages and none was corrupted.
+ *
+ * Cost of delivery is printed as bytes moved by memcpy/memmove of the stack
+ * (linked with -Wl,--wrap) and cpu time of both processes per delivered byte,
+ * send and receive path together.
+ *
+ * environment:
+ *   LINK_PAIR_LINE		delay,loss,corrupt,rate of each direction (ms, per million bytes,
+ *						bytes per second), "0,0,0"
+ *   LINK_PAIR_COUNT	messages sent by each end, 300
+ *   LINK_PAIR_MIN		messages each end has to receive, LINK_PAIR_COUNT
+ *   LINK_PAIR_SIZE		largest message data, 200
+ *   LINK_PAIR_PERIOD	ms between messages, 5
+ *   LINK_PAIR_SECS		give up after, 60
+ *   LINK_PAIR_QUEUE	1: keep the hold queue of link filled, like an application
+ *						queueing a bulk transfer
+ *   LINK_PAIR_OVERLOAD	1: messages go unpaced by link_send_q_post(), the sender
+ *						keeps them while link is full and sends on when link_send_wait()
+ *						wakes it. Link has to take every message without one held
+ *						above LINK_SEND_HOLD_MAX and the sender has to see it full
+ *   LINK_PAIR_ALARM	ms between alarm messages sent along the data, 0 none
+ *   LINK_PAIR_ALARM_CH	channel of the alarm messages, LINK_CHANNEL_URGENT
+ *   LINK_PAIR_ALARM_MAX	ms of alarm latency, more fails the test, 0 no bound
+ *   LINK_PAIR_ROUTE	1: messages go by link_route_post() of a route to the sink
+ *   LINK_PAIR_RPC		ms timeout, each message is a link_rpc_call() the sink
+ *						echoes with link_rpc_reply(), the next call waits for the
+ *						completion. Every call has to complete once, responses have
+ *						to match their call. 0 plain messages
+ *   LINK_PAIR_RECORD	file, bytes end b writes on the line, which end a reads on
+ *						a clean line. Replayed by link_replay, seeds of link_fuzz
+ *   LINK_PAIR_PEER		program of end b, link_sl: the sl link stack over a pty.
+ *						Link sync has to agree the same window, frame check, frame
+ *						size, framing, capabilities and fec on both ends, each the
+ *						smaller of the offers (capabilities both offer), on a clean
+ *						line mac credits keep the receive pool of both stacks from
+ *						dropping a pdu and with fec on a corrupting line frames are
+ *						repaired. Not with LINK_PAIR_ALARM, LINK_PAIR_OVERLOAD and
+ *						LINK_PAIR_RECORD, end b does not run them
+ *   LINK_PAIR_STATIONS	with LINK_PAIR_PEER (link_sl_md) and built as link_pair_md:
+ *						this end is the master of a bus to that many stations
+ *						(1 .. LINK_PHY_STATION_NUM - 1) at addresses 1..n, and
+ *						polls station n + 1 too which never answers. Each message
+ *						goes to every station, each station sends to this end;
+ *						every station has to get all of its messages and deliver
+ *						all of its own, the absent station has to be given up and
+ *						its pdus dropped. Messages carry their send stamp
+ *   LINK_PAIR_LAT_MAX	ms from send to delivery of any message with
+ *						LINK_PAIR_STATIONS, more fails the test, 0 no bound */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+
+#include "ak.h"
+#include "message.h"
+#include "timer.h"
+
+#include "task_list.h"
+
+#include "link.h"
+#include "link_sig.h"
+#include "link_data.h"
+#include "link_mac.h"
+#include "link_phy.h"
+#include "link_hal.h"
+#include "link_rpc.h"
+
+#include "link_sl.h"
+
+#define LINK_PAIR_SIG_DATA		5
+#define LINK_PAIR_SIG_ALARM		6
+#define LINK_PAIR_SIG_RPC_DONE	8
+#define LINK_PAIR_SIG_READY		9
+#define LINK_PAIR_SIG_TICK		10
+#define LINK_PAIR_TICK_INTERVAL	100 /* ms, overloaded sender looks at the deadline */
+#define LINK_PAIR_START_DELAY	1500 /* ms, both ends synced */
+#define LINK_PAIR_IDLE_DELAY	3000 /* ms, nothing more comes after all is sent */
+#define LINK_PAIR_END_NUM		(1 + LINK_PHY_STATION_NUM) /* a, then b or the stations */
+
+/* result of one end, shared by both processes */
+typedef struct {
+	volatile uint32_t tx;
+	volatile uint32_t rx_ok;
+	volatile uint32_t rx_bad;
+	volatile uint32_t rx_gap;
+	volatile uint32_t rx_byte;
+	volatile uint32_t rx_last; /* ms, last message received */
+	volatile uint32_t tx_start; /* ms, first message sent */
+	volatile uint32_t cpu_us;
+	volatile uint32_t alarm_tx;
+	volatile uint32_t alarm_rx;
+	volatile uint64_t alarm_sum; /* us */
+	volatile uint64_t alarm_max; /* us */
+	uint32_t rpc_ok;
+	uint32_t rpc_timeout;
+	uint32_t rpc_bad; /* no call, completion of another call or wrong response */
+	uint32_t unrouted;
+	uint64_t copy_byte;
+	uint32_t over; /* link_send_over_get() */
+	uint32_t resend; /* pdus given up by mac and sent again */
+	uint32_t full; /* messages the sender kept, link full */
+	uint32_t lost; /* pdus to a station given up */
+	uint32_t lat_max; /* ms, with LINK_PAIR_STATIONS */
+	link_phy_stat_t phy;
+	link_mac_stat_t mac;
+	link_stat_t link;
+} link_pair_end_t;
+
+static link_pair_end_t* link_pair_end; /* [0] process of "loopback-a", [1] of "loopback-b", [k] station k */
+static uint32_t link_pair_me;
+static pid_t link_pair_peer_pid;
+static char link_pair_path[64];
+static uint32_t link_pair_sink = MT_TASK_IF_CPU_SERIAL_ID; /* task of end b receiving the messages */
+static link_sl_end_t* link_pair_sl; /* end b run by LINK_PAIR_PEER, its result */
+static link_sl_end_t* link_pair_st[LINK_PAIR_END_NUM]; /* [k] station k, LINK_PAIR_STATIONS */
+static pid_t link_pair_st_pid[LINK_PAIR_END_NUM];
+static uint32_t link_pair_loss;
+static uint32_t link_pair_corrupt;
+
+static uint32_t link_pair_count;
+static uint32_t link_pair_min;
+static uint32_t link_pair_size;
+static uint32_t link_pair_period;
+static uint32_t link_pair_secs;
+static uint32_t link_pair_queue;
+static uint32_t link_pair_overload;
+static uint32_t link_pair_alarm;
+static uint32_t link_pair_alarm_ch;
+static uint32_t link_pair_alarm_max;
+static uint32_t link_pair_route;
+static uint32_t link_pair_rpc;
+static uint32_t link_pair_stations;
+static uint32_t link_pair_lat_max;
+static uint32_t link_pair_head = sizeof(uint32_t); /* sequence, and the send stamp with stations */
+
+/* what this end received from each station */
+typedef struct {
+	volatile uint32_t rx_seq;
+	volatile uint32_t rx_ok;
+	volatile uint32_t rx_bad;
+	volatile uint32_t rx_gap;
+	volatile uint32_t lat_max; /* ms */
+} link_pair_from_t;
+
+static link_pair_from_t link_pair_from[LINK_PAIR_END_NUM];
+
+/* bus of the stations: [0] pty master, line of this end, [k] socket of station k */
+static int link_pair_bus_fd[LINK_PAIR_END_NUM];
+
+static link_send_q_t link_pair_send_q;
+static uint32_t link_pair_rx_seq;
+static uint64_t link_pair_copy_byte;
+static FILE* link_pair_record;
+
+q_msg_t taskIfMailbox;
+q_msg_t taskCpuSerialIfMailbox;
+q_msg_t taskSmMailbox;
+q_msg_t taskFirmwareMailbox;
+q_msg_t taskSystemMailbox;
+q_msg_t taskDevManagerMailbox;
+
+static uint32_t link_pair_env(const char* name, uint32_t def) {
+	const char* val = getenv(name);
+	return (val != NULL) ? (uint32_t)strtoul(val, NULL, 0) : def;
+}
+
+/* monotonic clock is the same in both processes */
+static uint64_t link_pair_micros() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint32_t link_pair_millis() {
+	return (uint32_t)(link_pair_micros() / 1000);
+}
+
+static uint32_t link_pair_len(uint32_t seq) {
+	return link_pair_head + seq % (link_pair_size - link_pair_head + 1);
+}
+
+static void link_pair_fill(uint8_t* data, uint32_t len, uint32_t seq) {
+	memcpy(data, &seq, sizeof(seq));
+	for (uint32_t i = sizeof(seq); i < len; i++) {
+		data[i] = (uint8_t)(seq * 7 + i);
+	}
+}
+
+extern "C" {
+void* __real_memcpy(void* dst, const void* src, size_t len);
+void* __real_memmove(void* dst, const void* src, size_t len);
+
+void* __wrap_memcpy(void* dst, const void* src, size_t len) {
+	__atomic_fetch_add(&link_pair_copy_byte, len, __ATOMIC_RELAXED);
+	return __real_memcpy(dst, src, len);
+}
+
+void* __wrap_memmove(void* dst, const void* src, size_t len) {
+	__atomic_fetch_add(&link_pair_copy_byte, len, __ATOMIC_RELAXED);
+	return __real_memmove(dst, src, len);
+}
+
+/* link_hal_write_block(), only called by the phy task */
+void __real__Z20link_hal_write_blockPhj(uint8_t* data, uint32_t len);
+
+void __wrap__Z20link_hal_write_blockPhj(uint8_t* data, uint32_t len) {
+	if (link_pair_record != NULL) {
+		fwrite(data, 1, len, link_pair_record);
+	}
+	__real__Z20link_hal_write_blockPhj(data, len);
+}
+}
+
+/* end b of LINK_PAIR_PEER, or a station, into its link_pair_end[] */
+static void link_pair_peer_end(link_sl_end_t* p, link_pair_end_t* e) {
+	e->tx = p->tx;
+	e->rx_ok = p->rx_ok;
+	e->rx_bad = p->rx_bad;
+	e->rx_gap = p->rx_gap;
+	e->rx_byte = p->rx_byte;
+	e->rx_last = p->rx_last;
+	e->tx_start = p->tx_start;
+	e->lat_max = p->lat_max;
+
+	if (!__atomic_load_n(&p->done, __ATOMIC_ACQUIRE)) {
+		return;
+	}
+
+	e->cpu_us = p->cpu_us;
+	e->rpc_ok = p->rpc_ok;
+	e->rpc_timeout = p->rpc_timeout;
+	e->rpc_bad = p->rpc_bad;
+	e->over = p->over;
+	e->resend = p->resend;
+	e->full = p->full;
+
+	e->phy.frame_sent = p->phy_frame_sent;
+	e->phy.byte_sent = p->phy_byte_sent;
+	e->phy.frame_rev = p->phy_frame_rev;
+	e->phy.byte_rev = p->phy_byte_rev;
+	e->phy.fcs_err = p->phy_fcs_err;
+	e->phy.rev_to = p->phy_rev_to;
+	e->phy.retransmit = p->phy_retransmit;
+	e->phy.fast_retransmit = p->phy_fast_retransmit;
+	e->phy.rev_drop = p->phy_rev_drop;
+	e->phy.send_fail = p->phy_send_fail;
+	e->phy.fec_fixed = p->phy_fec_fixed;
+	e->phy.fec_byte = p->phy_fec_byte;
+	e->phy.poll = p->phy_poll;
+	e->phy.window_size = p->sync.window_size;
+	e->phy.fcs_algo = p->sync.fcs_algo;
+	e->phy.frame_data_size = p->sync.frame_data_size;
+	e->phy.framing = p->sync.framing;
+	e->phy.caps = p->sync.caps;
+	e->phy.fec_parity = p->sync.fec_parity;
+
+	e->mac.pdu_sent = p->mac_pdu_sent;
+	e->mac.pdu_err = p->mac_pdu_err;
+	e->mac.pdu_retry = p->mac_pdu_retry;
+	e->mac.pdu_rev = p->mac_pdu_rev;
+	e->mac.rev_to = p->mac_rev_to;
+	e->mac.rev_drop = p->mac_rev_drop;
+	e->mac.credit_block = p->mac_credit_block;
+
+	e->link.msg_sent = p->link_msg_sent;
+	e->link.msg_rev = p->link_msg_rev;
+	e->link.rev_err = p->link_rev_err;
+	e->link.agg_pdu = p->link_agg_pdu;
+	e->link.lz_pdu = p->link_lz_pdu;
+	e->link.lz_saved = p->link_lz_saved;
+}
+
+static uint8_t link_pair_min8(uint8_t a, uint8_t b) {
+	return (a < b) ? a : b;
+}
+
+/* both ends agreed on what link_phy sync makes of the two offers */
+static uint8_t link_pair_peer_passed() {
+	link_sl_sync_t* offer = &link_pair_sl->offer;
+	link_phy_stat_t* a = &link_pair_end[0].phy;
+	link_phy_stat_t* b = &link_pair_end[1].phy;
+	link_sl_sync_t want;
+
+	if (!link_pair_sl->done || link_pair_sl->fatal != 0) {
+		printf("b: %s\n", link_pair_sl->fatal ? "fatal" : "no report");
+		return 0;
+	}
+
+	want.window_size = link_pair_min8(LINK_PHY_WINDOW_SIZE, offer->window_size);
+	want.window_size = (want.window_size > 0) ? want.window_size : 1;
+	want.fcs_algo = link_pair_min8(LINK_PHY_FCS_ALGO, offer->fcs_algo);
+	want.frame_data_size = link_pair_min8(LINK_PHY_FRAME_DATA_SIZE, offer->frame_data_size);
+	want.frame_data_size = (want.frame_data_size > LINK_PHY_FRAME_DATA_SIZE_LEGACY) ? want.frame_data_size : LINK_PHY_FRAME_DATA_SIZE_LEGACY;
+	want.framing = link_pair_min8(LINK_PHY_FRAMING, offer->framing);
+	want.caps = LINK_PHY_CAPS & offer->caps;
+	want.fec_parity = (want.framing == LINK_PHY_FRAMING_COBS) ? link_pair_min8(LINK_PHY_FEC_PARITY, offer->fec_parity) : 0;
+
+	printf("sync window=%u/%u fcs=%u/%u size=%u/%u framing=%u/%u caps=0x%02X/0x%02X fec=%u/%u, expected %u %u %u %u 0x%02X %u\n",
+		   a->window_size, b->window_size, a->fcs_algo, b->fcs_algo, a->frame_data_size, b->frame_data_size,
+		   a->framing, b->framing, a->caps, b->caps, a->fec_parity, b->fec_parity,
+		   want.window_size, want.fcs_algo, want.frame_data_size, want.framing, want.caps, want.fec_parity);
+
+	for (uint32_t end = 0; end < 2; end++) {
+		link_phy_stat_t* phy = &link_pair_end[end].phy;
+
+		if (phy->window_size != want.window_size || phy->fcs_algo != want.fcs_algo || phy->frame_data_size != want.frame_data_size || \
+			phy->framing != want.framing || phy->caps != want.caps || phy->fec_parity != want.fec_parity) {
+			return 0;
+		}
+	}
+
+	/* credits of peer bound what is sent to its receive pool, smaller on sl */
+	if ((want.caps & LINK_PHY_CAP_MAC_CREDIT) && link_pair_loss == 0 && link_pair_corrupt == 0 && \
+		(link_pair_end[0].mac.rev_drop != 0 || link_pair_end[1].mac.rev_drop != 0)) {
+		return 0;
+	}
+
+	/* unpaced sends outrun the one slot pool of sl, mt must have waited on it */
+	if ((want.caps & LINK_PHY_CAP_MAC_CREDIT) && link_pair_queue && link_pair_period == 0 && link_pair_end[0].mac.credit_block == 0) {
+		return 0;
+	}
+
+	if (want.fec_parity != 0 && link_pair_corrupt != 0 && link_pair_end[0].phy.fec_fixed + link_pair_end[1].phy.fec_fixed == 0) {
+		return 0;
+	}
+	return 1;
+}
+
+static void link_pair_print(uint32_t end) {
+	link_pair_end_t* e = &link_pair_end[end];
+
+	printf("%c: tx=%u rx=%u/%uB bad=%u gap=%u\n", 'a' + end, e->tx, e->rx_ok, e->rx_byte, e->rx_bad, e->rx_gap);
+	printf("   phy sent=%u/%uB rev=%u/%uB fcs=%u rto=%u retx=%u fretx=%u rdrop=%u fail=%u fec=%u/%uB\n",
+		   e->phy.frame_sent, e->phy.byte_sent, e->phy.frame_rev, e->phy.byte_rev, e->phy.fcs_err, e->phy.rev_to,
+		   e->phy.retransmit, e->phy.fast_retransmit, e->phy.rev_drop, e->phy.send_fail, e->phy.fec_fixed, e->phy.fec_byte);
+	printf("   mac sent=%u err=%u retry=%u rev=%u rto=%u rdrop=%u cblk=%u\n",
+		   e->mac.pdu_sent, e->mac.pdu_err, e->mac.pdu_retry, e->mac.pdu_rev, e->mac.rev_to, e->mac.rev_drop, e->mac.credit_block);
+	printf("   link sent=%u rev=%u err=%u over=%u resend=%u agg=%u lz=%u saved=%uB\n",
+		   e->link.msg_sent, e->link.msg_rev, e->link.rev_err, e->over, e->resend, e->link.agg_pdu, e->link.lz_pdu, e->link.lz_saved);
+
+	if (link_pair_overload != 0) {
+		printf("   overload kept=%u of %u messages\n", e->full, e->tx);
+	}
+
+	if (link_pair_route != 0) {
+		printf("   route unrouted=%u\n", e->unrouted);
+	}
+
+	if (link_pair_rpc != 0) {
+		printf("   rpc ok=%u timeout=%u bad=%u of %u calls\n", e->rpc_ok, e->rpc_timeout, e->rpc_bad, e->tx);
+	}
+
+	if (link_pair_alarm != 0) {
+		printf("   alarm rx=%u/%u latency avg=%.1fms max=%.1fms\n", e->alarm_rx, link_pair_end[end ^ 1].alarm_tx,
+			   e->alarm_rx ? e->alarm_sum / 1000.0 / e->alarm_rx : 0.0, e->alarm_max / 1000.0);
+	}
+
+	if (link_pair_stations != 0 && end == 0) {
+		printf("   stations down=%u lost=%u\n", e->phy.station_down, e->lost);
+		for (uint32_t k = 1; k <= link_pair_stations; k++) {
+			link_pair_from_t* from = &link_pair_from[k];
+			printf("   from %c rx=%u bad=%u gap=%u latency max=%ums\n", 'a' + k, from->rx_ok, from->rx_bad, from->rx_gap, from->lat_max);
+		}
+	}
+	else if (link_pair_stations != 0) {
+		printf("   latency max=%ums\n", e->lat_max);
+	}
+}
+
+static uint8_t link_pair_passed(uint32_t end) {
+	link_pair_end_t* e = &link_pair_end[end];
+
+	if (link_pair_alarm_max != 0 && \
+		(e->alarm_rx == 0 || e->alarm_rx != link_pair_end[end ^ 1].alarm_tx || e->alarm_max > link_pair_alarm_max * 1000)) {
+		return 0;
+	}
+
+	if (link_pair_rpc != 0 && (e->rpc_bad != 0 || e->rpc_ok + e->rpc_timeout != e->tx || e->rpc_ok < link_pair_min)) {
+		return 0;
+	}
+
+	/* peer was really overloaded and link kept to its bound */
+	if (link_pair_overload != 0 && (link_pair_end[end ^ 1].full == 0 || link_pair_end[end ^ 1].over != 0)) {
+		return 0;
+	}
+	return e->rx_ok >= link_pair_min && e->rx_bad == 0 && e->unrouted == 0;
+}
+
+/* every station got all of its messages and delivered all of its own within
+ * the bound, the absent one was given up and messages to it dropped */
+static uint8_t link_pair_stations_passed() {
+	link_pair_end_t* a = &link_pair_end[0];
+	uint8_t passed = (a->phy.station_down != 0 && a->lost != 0);
+
+	for (uint32_t k = 1; k <= link_pair_stations; k++) {
+		link_pair_end_t* e = &link_pair_end[k];
+		link_pair_from_t* from = &link_pair_from[k];
+
+		if (!link_pair_st[k]->done || link_pair_st[k]->fatal != 0) {
+			printf("%c: %s\n", 'a' + k, link_pair_st[k]->fatal ? "fatal" : "no report");
+			passed = 0;
+		}
+
+		if (e->rx_ok < link_pair_min || e->rx_bad != 0 || from->rx_ok < link_pair_min || from->rx_bad != 0) {
+			passed = 0;
+		}
+
+		if (link_pair_lat_max != 0 && (e->lat_max > link_pair_lat_max || from->lat_max > link_pair_lat_max)) {
+			passed = 0;
+		}
+	}
+	return passed;
+}
+
+/* ends reporting: a and b, or a and the stations */
+static uint32_t link_pair_ends() {
+	return (link_pair_stations != 0) ? 1 + link_pair_stations : 2;
+}
+
+static void link_pair_finish() {
+	link_pair_end_t* e = &link_pair_end[link_pair_me];
+	struct rusage ru;
+
+	getrusage(RUSAGE_SELF, &ru);
+	e->cpu_us = (uint32_t)(ru.ru_utime.tv_sec * 1000000 + ru.ru_utime.tv_usec + ru.ru_stime.tv_sec * 1000000 + ru.ru_stime.tv_usec);
+	link_phy_get_stat(&e->phy);
+	link_mac_get_stat(&e->mac);
+	link_get_stat(&e->link);
+	e->over = link_send_over_get();
+	for (uint8_t channel = 0; channel < LINK_CHANNEL_NUM; channel++) {
+		link_channel_stat_t stat;
+		link_get_channel_stat(channel, &stat);
+		e->resend += stat.err;
+		e->lost += stat.lost;
+	}
+	e->copy_byte = __atomic_load_n(&link_pair_copy_byte, __ATOMIC_RELAXED);
+
+	if (link_pair_me == 1) {
+		/* phy may still write, stdio locks the file */
+		if (link_pair_record != NULL) {
+			fflush(link_pair_record);
+		}
+		_exit(0);
+	}
+
+	int status;
+	if (link_pair_sl != NULL) {
+		__atomic_store_n(&link_pair_sl->stop, 1, __ATOMIC_RELEASE);
+		waitpid(link_pair_peer_pid, &status, 0);
+		link_pair_peer_end(link_pair_sl, &link_pair_end[1]);
+	}
+	else if (link_pair_stations != 0) {
+		for (uint32_t k = 1; k <= link_pair_stations; k++) {
+			__atomic_store_n(&link_pair_st[k]->stop, 1, __ATOMIC_RELEASE);
+		}
+		for (uint32_t k = 1; k <= link_pair_stations; k++) {
+			waitpid(link_pair_st_pid[k], &status, 0);
+			link_pair_peer_end(link_pair_st[k], &link_pair_end[k]);
+		}
+	}
+	else {
+		waitpid(link_pair_peer_pid, &status, 0);
+	}
+
+	uint32_t rx_byte = 0;
+	uint64_t copy_byte = 0;
+	uint64_t cpu_us = 0;
+
+	/* all directions from the first message sent to the last received */
+	uint32_t start = link_pair_end[0].tx_start;
+	uint32_t last = link_pair_end[0].rx_last;
+
+	for (uint32_t end = 0; end < link_pair_ends(); end++) {
+		link_pair_print(end);
+
+		rx_byte += link_pair_end[end].rx_byte;
+		copy_byte += link_pair_end[end].copy_byte;
+		cpu_us += link_pair_end[end].cpu_us;
+		if ((int32_t)(link_pair_end[end].tx_start - start) < 0) {
+			start = link_pair_end[end].tx_start;
+		}
+		if ((int32_t)(link_pair_end[end].rx_last - last) > 0) {
+			last = link_pair_end[end].rx_last;
+		}
+	}
+
+	if (rx_byte != 0) {
+		if (link_pair_sl != NULL || link_pair_stations != 0) {
+			/* copies of the sl end are not wrapped */
+			printf("per delivered byte: cpu=%.0fns\n", cpu_us * 1000.0 / rx_byte);
+		}
+		else {
+			printf("per delivered byte: copy=%.2fB cpu=%.0fns\n", (double)copy_byte / rx_byte, cpu_us * 1000.0 / rx_byte);
+		}
+		printf("goodput=%uB/s in %ums\n", (last != start) ? (uint32_t)(rx_byte * 1000ULL / (last - start)) : 0, last - start);
+	}
+
+	uint8_t passed;
+	if (link_pair_stations != 0) {
+		passed = link_pair_passed(0) && link_pair_stations_passed();
+	}
+	else {
+		passed = link_pair_passed(0) && link_pair_passed(1) && (link_pair_sl == NULL || link_pair_peer_passed());
+	}
+	printf("%s %s\n", passed ? "PASS" : "FAIL", link_pair_path);
+	fflush(stdout);
+	_exit(passed ? 0 : 1);
+}
+
+/* one call, waits for its completion */
+static void link_pair_call(uint8_t* data, uint32_t len) {
+	link_pair_end_t* e = &link_pair_end[link_pair_me];
+	uint8_t id = link_rpc_call(MT_TASK_IF_ID, LINK_PAIR_SIG_RPC_DONE, 0, link_pair_sink, LINK_PAIR_SIG_DATA, data, len, link_pair_rpc);
+
+	if (id == LINK_RPC_ID_NONE) {
+		e->rpc_bad++;
+		return;
+	}
+
+	ak_msg_t* msg = ak_msg_rev(MT_TASK_IF_ID);
+	link_rpc_header_t header;
+	uint8_t res[LINK_RPC_DATA_SIZE];
+	uint32_t res_len = link_rpc_get_data(msg, &header, res, sizeof(res));
+
+	if (msg->header->sig != LINK_PAIR_SIG_RPC_DONE || header.id != id) {
+		e->rpc_bad++;
+	}
+	else if (header.status == LINK_RPC_STATUS_TIMEOUT) {
+		e->rpc_timeout++;
+	}
+	else if (header.status == LINK_RPC_STATUS_OK && res_len == len && memcmp(res, data, len) == 0) {
+		e->rpc_ok++;
+	}
+	else {
+		e->rpc_bad++;
+	}
+
+	ak_msg_free(msg);
+}
+
+/* overloaded sender waits until link took its kept messages */
+static void link_pair_send_flush(uint32_t deadline) {
+	while (q_msg_available(&link_pair_send_q.q) && (int32_t)(deadline - link_pair_millis()) > 0) {
+		ak_msg_t* msg = ak_msg_rev(MT_TASK_IF_ID);
+
+		if (msg->header->sig == LINK_PAIR_SIG_READY) {
+			link_send_q_flush(&link_pair_send_q);
+		}
+		ak_msg_free(msg);
+	}
+}
+
+/* one message of seq to des_type, 0 the peer or station des_type */
+static void link_pair_send(uint32_t seq, uint8_t des_type, uint32_t deadline) {
+	uint8_t data[LINK_PDU_BUF_SIZE];
+	uint32_t len = link_pair_len(seq);
+
+	link_pair_fill(data, len, seq);
+
+	/* back off while link holds messages, messages still in its mailbox
+	 * are not counted yet and would overrun the hold queue */
+	uint8_t busy = link_pair_queue ? LINK_SEND_STATUS_FULL : LINK_SEND_STATUS_HOLD;
+
+	while (link_pair_overload == 0 && link_send_status() >= busy && (int32_t)(deadline - link_pair_millis()) > 0) {
+		usleep(1000);
+	}
+
+	/* latency of a station message is from when link could take it */
+	if (link_pair_stations != 0) {
+		uint32_t now = link_pair_millis();
+		memcpy(&data[sizeof(seq)], &now, sizeof(now));
+	}
+
+	link_pair_end[link_pair_me].tx++;
+
+	if (link_pair_rpc != 0) {
+		link_pair_call(data, len);
+		return;
+	}
+
+	ak_msg_t* s_msg = get_dynamic_msg();
+	set_if_src_task_id(s_msg, MT_TASK_IF_ID);
+	set_if_des_task_id(s_msg, link_pair_sink);
+	set_if_src_type(s_msg, 0);
+	set_if_des_type(s_msg, des_type);
+	set_if_sig(s_msg, LINK_PAIR_SIG_DATA);
+	set_data_dynamic_msg(s_msg, data, len);
+
+	uint8_t status;
+
+	if (link_pair_route == 0) {
+		set_msg_sig(s_msg, GW_LINK_SEND_DYNAMIC_MSG);
+		status = link_send_q_post(&link_pair_send_q, s_msg);
+	}
+	else if ((status = link_route_post(&link_pair_send_q, s_msg)) == LINK_ROUTE_NONE) {
+		link_pair_end[link_pair_me].unrouted++;
+		ak_msg_free(s_msg);
+	}
+
+	if (status == LINK_SEND_STATUS_FULL) {
+		link_pair_end[link_pair_me].full++;
+		link_pair_send_flush(deadline);
+	}
+}
+
+/* every end has all the other ends sent to it */
+static uint8_t link_pair_received() {
+	if (link_pair_stations == 0) {
+		return link_pair_end[0].rx_ok >= link_pair_count && link_pair_end[1].rx_ok >= link_pair_count;
+	}
+
+	for (uint32_t k = 1; k <= link_pair_stations; k++) {
+		if (link_pair_from[k].rx_ok < link_pair_count || link_pair_end[k].rx_ok < link_pair_count) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* sender */
+void* TaskIfEntry(void*) {
+	wait_all_tasks_started();
+
+	/* stations 1..n and the absent n + 1 are polled and addressed by their
+	 * interface type, the absent one is given up before the first message */
+	if (link_pair_stations != 0) {
+		uint32_t schedule[LINK_PAIR_END_NUM];
+
+		for (uint32_t k = 1; k <= link_pair_stations + 1; k++) {
+			link_station_set((uint8_t)k, k);
+			schedule[k - 1] = k;
+		}
+		link_phy_poll_set(schedule, (uint8_t)(link_pair_stations + 1));
+	}
+	usleep(LINK_PAIR_START_DELAY * 1000);
+
+	if (link_pair_route != 0) {
+		link_route_set(0, link_pair_sink, LINK_CHANNEL_DEFAULT);
+	}
+
+	uint32_t deadline = link_pair_millis() + link_pair_secs * 1000;
+
+	link_send_q_init(&link_pair_send_q, MT_TASK_IF_ID, LINK_PAIR_SIG_READY);
+	if (link_pair_overload != 0) {
+		timer_set(MT_TASK_IF_ID, LINK_PAIR_SIG_TICK, LINK_PAIR_TICK_INTERVAL, TIMER_PERIODIC);
+	}
+
+	/* sync exchange is not part of the cost */
+	__atomic_store_n(&link_pair_copy_byte, 0, __ATOMIC_RELAXED);
+	link_pair_end[link_pair_me].tx_start = link_pair_millis();
+
+	for (uint32_t seq = 0; seq < link_pair_count; seq++) {
+		if (link_pair_stations == 0) {
+			link_pair_send(seq, 0, deadline);
+		}
+		else {
+			for (uint32_t k = 1; k <= link_pair_stations + 1; k++) {
+				link_pair_send(seq, (uint8_t)k, deadline);
+			}
+		}
+
+		usleep(link_pair_period * 1000);
+	}
+
+	if (link_pair_overload != 0) {
+		timer_remove_attr(MT_TASK_IF_ID, LINK_PAIR_SIG_TICK);
+	}
+
+	/* stay on the line until the peer has all it can get */
+	uint32_t idle = link_pair_millis();
+
+	while ((int32_t)(deadline - link_pair_millis()) > 0 && !link_pair_received()) {
+		uint32_t rx = 0;
+		uint8_t sending = 0;
+
+		for (uint32_t end = 0; end < link_pair_ends(); end++) {
+			rx += link_pair_end[end].rx_ok + link_pair_end[end].alarm_rx;
+		}
+
+		usleep(10 * 1000);
+
+		if (link_pair_sl != NULL) {
+			if (link_pair_sl->done) {
+				break;
+			}
+			link_pair_peer_end(link_pair_sl, &link_pair_end[1]);
+		}
+
+		for (uint32_t k = 1; k <= link_pair_stations; k++) {
+			link_pair_peer_end(link_pair_st[k], &link_pair_end[k]);
+		}
+
+		for (uint32_t end = 0; end < link_pair_ends(); end++) {
+			rx -= link_pair_end[end].rx_ok + link_pair_end[end].alarm_rx;
+			sending |= (end != link_pair_me && link_pair_end[end].tx < link_pair_count);
+		}
+
+		if (rx != 0 || sending) {
+			idle = link_pair_millis();
+		}
+		else if ((int32_t)(link_pair_millis() - idle) > LINK_PAIR_IDLE_DELAY) {
+			break;
+		}
+	}
+
+	link_pair_finish();
+	return (void*)0;
+}
+
+/* receiver */
+void* TaskCpuSerialIfEntry(void*) {
+	wait_all_tasks_started();
+
+	while (1) {
+		ak_msg_t* msg = ak_msg_rev(MT_TASK_IF_CPU_SERIAL_ID);
+		link_pair_end_t* e = &link_pair_end[link_pair_me];
+
+		if (get_msg_type(msg) == DYNAMIC_MSG_TYPE && msg->header->if_sig == LINK_PAIR_SIG_DATA) {
+			uint8_t data[LINK_PDU_BUF_SIZE];
+			uint8_t ref[LINK_PDU_BUF_SIZE];
+			uint32_t len = get_data_len_dynamic_msg(msg);
+			uint32_t seq = 0;
+			link_rpc_header_t header;
+
+			if (link_pair_rpc != 0) {
+				/* request data follows the rpc header */
+				len = link_rpc_get_data(msg, &header, data, LINK_RPC_DATA_SIZE);
+			}
+			else if (len <= sizeof(data)) {
+				get_data_dynamic_msg(msg, data, len);
+			}
+
+			if (len >= link_pair_head && len <= sizeof(data)) {
+				memcpy(&seq, data, sizeof(seq));
+				link_pair_fill(ref, len, seq);
+				memcpy(&ref[sizeof(seq)], &data[sizeof(seq)], link_pair_head - sizeof(seq));
+			}
+
+			uint8_t ok = (len >= link_pair_head && len <= sizeof(data) && len == link_pair_len(seq) && memcmp(data, ref, len) == 0);
+
+			/* a station is known by the interface type link gave its messages */
+			uint32_t src = msg->header->if_src_type;
+			link_pair_from_t* from = (src >= 1 && src <= link_pair_stations) ? &link_pair_from[src] : NULL;
+
+			if (!ok || (link_pair_stations != 0 && from == NULL)) {
+				if (from != NULL) {
+					from->rx_bad++;
+				}
+				e->rx_bad++;
+			}
+			else {
+				if (from != NULL) {
+					uint32_t sent;
+					memcpy(&sent, &data[sizeof(seq)], sizeof(sent));
+
+					uint32_t lat = link_pair_millis() - sent;
+					if (lat > from->lat_max) {
+						from->lat_max = lat;
+					}
+
+					if (seq != from->rx_seq) {
+						from->rx_gap++;
+					}
+					from->rx_seq = seq + 1;
+					from->rx_ok++;
+				}
+				else {
+					if (seq != link_pair_rx_seq) {
+						e->rx_gap++;
+					}
+					link_pair_rx_seq = seq + 1;
+				}
+				e->rx_ok++;
+				e->rx_byte += len;
+				e->rx_last = link_pair_millis();
+
+				if (link_pair_rpc != 0) {
+					link_rpc_reply(msg, data, len);
+				}
+			}
+		}
+
+		ak_msg_free(msg);
+	}
+
+	return (void*)0;
+}
+
+/* alarm sender, runs while data is sent */
+void* TaskSystemEntry(void*) {
+	wait_all_tasks_started();
+	usleep(LINK_PAIR_START_DELAY * 1000);
+
+	if (link_pair_alarm != 0) {
+		link_set_channel(MT_TASK_SM_ID, link_pair_alarm_ch);
+
+		while (link_pair_end[link_pair_me].tx < link_pair_count) {
+			uint64_t now = link_pair_micros();
+
+			ak_msg_t* s_msg = get_common_msg();
+			set_if_src_task_id(s_msg, MT_TASK_SYSTEM_ID);
+			set_if_des_task_id(s_msg, MT_TASK_SM_ID);
+			set_if_src_type(s_msg, 0);
+			set_if_des_type(s_msg, 0);
+			set_if_sig(s_msg, LINK_PAIR_SIG_ALARM);
+			set_data_common_msg(s_msg, (uint8_t*)&now, sizeof(now));
+			set_msg_sig(s_msg, GW_LINK_SEND_COMMON_MSG);
+
+			/* latency is measured from now, an alarm is never kept back */
+			link_send_post_over(s_msg);
+
+			link_pair_end[link_pair_me].alarm_tx++;
+			usleep(link_pair_alarm * 1000);
+		}
+	}
+
+	while (1) {
+		ak_msg_free(ak_msg_rev(MT_TASK_SYSTEM_ID));
+	}
+
+	return (void*)0;
+}
+
+/* alarm receiver */
+void* TaskSmEntry(void*) {
+	wait_all_tasks_started();
+
+	while (1) {
+		ak_msg_t* msg = ak_msg_rev(MT_TASK_SM_ID);
+		link_pair_end_t* e = &link_pair_end[link_pair_me];
+
+		if (get_msg_type(msg) == COMMON_MSG_TYPE && msg->header->if_sig == LINK_PAIR_SIG_ALARM && \
+			get_data_len_common_msg(msg) == sizeof(uint64_t)) {
+			uint64_t sent;
+			memcpy(&sent, get_data_common_msg(msg), sizeof(sent));
+
+			uint64_t latency = link_pair_micros() - sent;
+			e->alarm_rx++;
+			e->alarm_sum += latency;
+			if (latency > e->alarm_max) {
+				e->alarm_max = latency;
+			}
+		}
+
+		ak_msg_free(msg);
+	}
+
+	return (void*)0;
+}
+
+static void* link_pair_idle(uint32_t id) {
+	wait_all_tasks_started();
+
+	while (1) {
+		ak_msg_free(ak_msg_rev(id));
+	}
+
+	return (void*)0;
+}
+
+void* TaskFirmwareEntry(void*) { return link_pair_idle(MT_TASK_FIRMWARE_ID); }
+void* TaskDevManagerEntry(void*) { return link_pair_idle(MT_TASK_DEVICE_MANAGER_ID); }
+
+ak_task_t task_list[] = {
+	{	MT_TASK_TIMER_ID,			TASK_PRI_LEVEL_1,	TaskTimerEntry			,	&timerMailbox				,	"TIMER"		},
+	{	MT_TASK_IF_ID,				TASK_PRI_LEVEL_1,	TaskIfEntry				,	&taskIfMailbox				,	"SENDER"	},
+	{	MT_TASK_IF_CPU_SERIAL_ID,	TASK_PRI_LEVEL_1,	TaskCpuSerialIfEntry	,	&taskCpuSerialIfMailbox		,	"RECEIVER"	},
+	{	MT_TASK_SM_ID,				TASK_PRI_LEVEL_1,	TaskSmEntry				,	&taskSmMailbox				,	"ALARM RECEIVER"	},
+	{	MT_TASK_FIRMWARE_ID,		TASK_PRI_LEVEL_1,	TaskFirmwareEntry		,	&taskFirmwareMailbox		,	"FIRMWARE"	},
+	{	MT_TASK_SYSTEM_ID,			TASK_PRI_LEVEL_1,	TaskSystemEntry			,	&taskSystemMailbox			,	"ALARM SENDER"	},
+	{	MT_TASK_DEVICE_MANAGER_ID,	TASK_PRI_LEVEL_1,	TaskDevManagerEntry		,	&taskDevManagerMailbox		,	"DEVICE"	},
+
+	/* LINK TASKS */
+	{	MT_LINK_PHY_ID,				TASK_PRI_LEVEL_3,	TaskLinkPhyEntry		,	&taskLinkPhyMailbox			,	"LINK PHYSICAL"	},
+	{	MT_LINK_MAC_ID,				TASK_PRI_LEVEL_2,	TaskLinkMacEntry		,	&taskLinkMacMailbox			,	"LINK MAC"		},
+	{	MT_LINK_ID,					TASK_PRI_LEVEL_1,	TaskLinkEntry			,	&taskLinkMailbox			,	"LINK"			},
+};
+
+char* filePathRetStr(filePathIdx_t id) {
+	return (id == SERIAL_PORT_INTERFACE) ? link_pair_path : NULL;
+}
+
+/* this end opens the slave of a pty as a serial device, the master is the
+ * line of the far end. Raw before the far end writes, the line discipline
+ * would echo its frames back. Held open, the master does not hang up until
+ * the phy opens it */
+static int link_pair_line_open() {
+	int line = posix_openpt(O_RDWR | O_NOCTTY);
+
+	if (line < 0 || grantpt(line) < 0 || unlockpt(line) < 0) {
+		printf("FAIL no pty\n");
+		exit(1);
+	}
+
+	struct termios options;
+	int slave = open(ptsname(line), O_RDWR | O_NOCTTY | O_CLOEXEC);
+	tcgetattr(slave, &options);
+	cfmakeraw(&options);
+	tcsetattr(slave, TCSANOW, &options);
+
+	snprintf(link_pair_path, sizeof(link_pair_path), "%s", ptsname(line));
+	link_pair_sink = LINK_SL_SINK_ID;
+	return line;
+}
+
+/* LINK_PAIR_PEER on line, its result in a shared memfd, both survive exec.
+ * addr is the station it is, 0 end b */
+static link_sl_end_t* link_pair_peer_exec(const char* peer, int line, uint32_t addr, pid_t* pid) {
+	int end = memfd_create("link_sl_end", 0);
+	link_sl_end_t* sl = (link_sl_end_t*)MAP_FAILED;
+
+	if (end >= 0 && ftruncate(end, sizeof(link_sl_end_t)) == 0) {
+		sl = (link_sl_end_t*)mmap(NULL, sizeof(link_sl_end_t), PROT_READ | PROT_WRITE, MAP_SHARED, end, 0);
+	}
+
+	if (sl == MAP_FAILED) {
+		printf("FAIL no shared memory\n");
+		exit(1);
+	}
+	fflush(stdout);
+
+	*pid = fork();
+	if (*pid == 0) {
+		char val[16];
+
+		snprintf(val, sizeof(val), "%d", line);
+		setenv(LINK_SL_ENV_LINE_FD, val, 1);
+		snprintf(val, sizeof(val), "%d", end);
+		setenv(LINK_SL_ENV_END_FD, val, 1);
+		if (addr != 0) {
+			snprintf(val, sizeof(val), "%u", addr);
+			setenv(LINK_SL_ENV_ADDR, val, 1);
+		}
+
+		execl(peer, peer, (char*)NULL);
+		printf("FAIL exec %s\n", peer);
+		_exit(1);
+	}
+
+	close(end);
+	return sl;
+}
+
+/* end b is LINK_PAIR_PEER on the master of the pty */
+static void link_pair_peer_start(const char* peer) {
+	int line = link_pair_line_open();
+
+	link_pair_sl = link_pair_peer_exec(peer, line, 0, &link_pair_peer_pid);
+	close(line);
+}
+
+/* bus of the stations, like RS485 what one writes all others read */
+static void* link_pair_bus(void*) {
+	struct pollfd pfd[LINK_PAIR_END_NUM];
+	uint32_t num = 1 + link_pair_stations;
+
+	for (uint32_t i = 0; i < num; i++) {
+		pfd[i].fd = link_pair_bus_fd[i];
+		pfd[i].events = POLLIN;
+	}
+
+	while (1) {
+		if (poll(pfd, num, -1) <= 0) {
+			continue;
+		}
+
+		for (uint32_t i = 0; i < num; i++) {
+			uint8_t data[256];
+			ssize_t len;
+
+			if (pfd[i].fd < 0 || pfd[i].revents == 0) {
+				continue;
+			}
+
+			/* station exited */
+			if ((len = read(pfd[i].fd, data, sizeof(data))) <= 0) {
+				pfd[i].fd = -1;
+				continue;
+			}
+
+			for (uint32_t j = 0; j < num; j++) {
+				if (j == 0 && i != 0) {
+					(void)!write(pfd[j].fd, data, len);
+				}
+				else if (j != i && pfd[j].fd >= 0) {
+					send(pfd[j].fd, data, len, MSG_NOSIGNAL);
+				}
+			}
+		}
+	}
+
+	return (void*)0;
+}
+
+/* stations 1..n are LINK_PAIR_PEER, each on its socket of the bus */
+static void link_pair_stations_start(const char* peer) {
+	pthread_t bus;
+
+	link_pair_bus_fd[0] = link_pair_line_open();
+	fcntl(link_pair_bus_fd[0], F_SETFD, FD_CLOEXEC);
+
+	for (uint32_t k = 1; k <= link_pair_stations; k++) {
+		int sv[2];
+
+		if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0) {
+			printf("FAIL no socket for station %u\n", k);
+			exit(1);
+		}
+
+		/* only its own end goes to the station */
+		fcntl(sv[1], F_SETFD, 0);
+		link_pair_st[k] = link_pair_peer_exec(peer, sv[1], k, &link_pair_st_pid[k]);
+		close(sv[1]);
+		link_pair_bus_fd[k] = sv[0];
+	}
+
+	if (pthread_create(&bus, NULL, link_pair_bus, NULL) != 0) {
+		printf("FAIL no bus\n");
+		exit(1);
+	}
+}
+
+/* called by ak main() before any task runs, splits into the two ends */
+void task_init() {
+	const char* line = getenv("LINK_PAIR_LINE");
+
+	link_pair_count = link_pair_env("LINK_PAIR_COUNT", 300);
+	link_pair_min = link_pair_env("LINK_PAIR_MIN", link_pair_count);
+	link_pair_size = link_pair_env("LINK_PAIR_SIZE", 200);
+	link_pair_period = link_pair_env("LINK_PAIR_PERIOD", 5);
+	link_pair_secs = link_pair_env("LINK_PAIR_SECS", 60);
+	link_pair_queue = link_pair_env("LINK_PAIR_QUEUE", 0);
+	link_pair_overload = link_pair_env("LINK_PAIR_OVERLOAD", 0);
+	link_pair_alarm = link_pair_env("LINK_PAIR_ALARM", 0);
+	link_pair_alarm_ch = link_pair_env("LINK_PAIR_ALARM_CH", LINK_CHANNEL_URGENT);
+	link_pair_alarm_max = link_pair_env("LINK_PAIR_ALARM_MAX", 0);
+	link_pair_route = link_pair_env("LINK_PAIR_ROUTE", 0);
+	link_pair_rpc = link_pair_env("LINK_PAIR_RPC", 0);
+	link_pair_stations = link_pair_env("LINK_PAIR_STATIONS", 0);
+	link_pair_lat_max = link_pair_env("LINK_PAIR_LAT_MAX", 0);
+
+	if (link_pair_stations != 0) {
+		link_pair_head = 2 * sizeof(uint32_t);
+		link_pair_rpc = 0;
+	}
+
+	/* room for the message and link headers in a pdu */
+	if (link_pair_size < link_pair_head || link_pair_size > LINK_PDU_BUF_SIZE - 64) {
+		link_pair_size = 200;
+	}
+
+	if (link_pair_rpc != 0 && link_pair_size > LINK_RPC_DATA_SIZE) {
+		link_pair_size = LINK_RPC_DATA_SIZE;
+	}
+
+	link_pair_end = (link_pair_end_t*)mmap(NULL, LINK_PAIR_END_NUM * sizeof(link_pair_end_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (link_pair_end == MAP_FAILED || link_hal_loopback_pair() < 0) {
+		printf("FAIL no shared memory\n");
+		exit(1);
+	}
+	memset(link_pair_end, 0, LINK_PAIR_END_NUM * sizeof(link_pair_end_t));
+
+	setvbuf(stdout, NULL, _IOLBF, 0);
+	fflush(stdout);
+
+	if (line != NULL) {
+		uint32_t delay = 0;
+		sscanf(line, "%u,%u,%u", &delay, &link_pair_loss, &link_pair_corrupt);
+	}
+
+	if (getenv("LINK_PAIR_PEER") != NULL && link_pair_stations != 0) {
+		if (LINK_PHY_MULTI_DROP == 1 && link_pair_stations < LINK_PHY_STATION_NUM) {
+			link_pair_me = 0;
+			link_pair_stations_start(getenv("LINK_PAIR_PEER"));
+			return;
+		}
+		printf("FAIL LINK_PAIR_STATIONS 1..%u with link_pair_md\n", LINK_PHY_STATION_NUM - 1);
+		exit(1);
+	}
+
+	if (getenv("LINK_PAIR_PEER") != NULL) {
+		link_pair_me = 0;
+		link_pair_peer_start(getenv("LINK_PAIR_PEER"));
+		return;
+	}
+
+	link_pair_peer_pid = fork();
+	link_pair_me = (link_pair_peer_pid == 0) ? 1 : 0;
+
+	snprintf(link_pair_path, sizeof(link_pair_path), "%s:%s", link_pair_me ? LINK_HAL_PATH_LOOPBACK_B : LINK_HAL_PATH_LOOPBACK_A,
+			 (line != NULL) ? line : "0,0,0");
+
+	if (link_pair_me == 1) {
+		/* only the first end reports */
+		freopen("/dev/null", "w", stdout);
+
+		if (getenv("LINK_PAIR_RECORD") != NULL) {
+			link_pair_record = fopen(getenv("LINK_PAIR_RECORD"), "wb");
+		}
+	}
+}
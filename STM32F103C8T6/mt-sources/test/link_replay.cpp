@@ -0,0 +1,166 @@
+/* receive path speed without the line: a recorded stream is fed through the
+ * phy parser, mac and link by link_drive in link_hal read sized pieces, every
+ * round from a fresh stack. Prints MB/s of line bytes, phy frames/s and
+ * messages/s delivered to the application tasks. Exits 1 when a stream
+ * delivers no message.
+ * With a baud rate the stream arrives as on the sl serial interface: each
+ * 1 ms tick puts the bytes of the line into the sl ring buffer, then the
+ * poll hands its spans to the parser. Also prints how much faster than the
+ * line the receive path is and the bytes the ring overran, an overrun fails.
+ *
+ *   link_replay [-chunk n] [-rounds n] [-baud n] stream ...
+ *		chunk 4096 (link_hal buffer), rounds 50, baud 0 for no line.
+ *		Streams are recorded by link_pair, LINK_PAIR_RECORD */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include "link_phy.h"
+#include "ring_buffer.h"
+
+#include "link_drive.h"
+
+#define LINK_REPLAY_RING_SIZE		(256) /* CPU_SERIAL_IF_BUFFER_SIZE of sl */
+#define LINK_REPLAY_TICK_HZ			(1000)
+
+static uint8_t link_replay_ring_buf[LINK_REPLAY_RING_SIZE];
+
+static double link_replay_seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint8_t link_replay_run(const char* name, const std::vector<uint8_t>& stream, uint32_t chunk, uint32_t rounds) {
+	link_phy_stat_t stat;
+	uint32_t delivered = 0;
+	double t = 0;
+
+	for (uint32_t r = 0; r < rounds; r++) {
+		link_drive_reset();
+
+		double t0 = link_replay_seconds();
+		for (size_t off = 0; off < stream.size(); off += chunk) {
+			link_drive_phy(&stream[off], (uint32_t)((stream.size() - off < chunk) ? stream.size() - off : chunk));
+		}
+		t += link_replay_seconds() - t0;
+
+		delivered = link_drive_delivered();
+	}
+
+	link_phy_get_stat(&stat);
+
+	printf("%-24s chunk %4u: %7zuB, %4u frames, %4u fcs err, %4u messages: %6.1f MB/s, %8.0f frames/s, %8.0f messages/s\n",
+		   name, chunk, stream.size(), stat.frame_rev, stat.fcs_err, delivered,
+		   stream.size() * (double)rounds / t / 1e6, stat.frame_rev * (double)rounds / t, delivered * (double)rounds / t);
+	return delivered != 0;
+}
+
+/* 10 bits a byte on the line, the ring is read every tick like TaskPollCpuSerialIf() */
+static uint8_t link_replay_run_baud(const char* name, const std::vector<uint8_t>& stream, uint32_t baud, uint32_t rounds) {
+	link_phy_stat_t stat;
+	ringBufferChar_t ring;
+	uint32_t delivered = 0;
+	uint32_t overrun = 0;
+	uint32_t ticks = 0;
+	double t = 0;
+
+	for (uint32_t r = 0; r < rounds; r++) {
+		link_drive_reset();
+		ringBufferCharInit(&ring, link_replay_ring_buf, LINK_REPLAY_RING_SIZE);
+		overrun = 0;
+		ticks = 0;
+
+		double t0 = link_replay_seconds();
+		size_t off = 0;
+		while (off < stream.size() || ringBufferCharAvailable(&ring) > 0) {
+			/* bytes of the line up to the end of this tick */
+			size_t end = (size_t)((uint64_t)++ticks * baud / 10 / LINK_REPLAY_TICK_HZ);
+			for (; off < end && off < stream.size(); off++) {
+				if (isRingBufferCharFull(&ring)) {
+					overrun++;
+				}
+				ringBufferCharPut(&ring, stream[off]);
+			}
+
+			for (uint8_t i = 0; i < 2; i++) {
+				uint8_t* data;
+				uint16_t len = ringBufferCharSpan(&ring, &data);
+
+				if (len == 0) {
+					break;
+				}
+				link_drive_phy(data, len);
+				ringBufferCharSkip(&ring, len);
+			}
+		}
+		t += link_replay_seconds() - t0;
+
+		delivered = link_drive_delivered();
+	}
+
+	link_phy_get_stat(&stat);
+
+	double line = (double)ticks / LINK_REPLAY_TICK_HZ;
+	printf("%-24s baud %6u: %7zuB, %4u frames, %4u fcs err, %4u messages, %u overrun: %8.0f frames/s on the line, %8.0f frames/s, %6.0fx line\n",
+		   name, baud, stream.size(), stat.frame_rev, stat.fcs_err, delivered, overrun,
+		   stat.frame_rev / line, stat.frame_rev * (double)rounds / t, line * rounds / t);
+	return delivered != 0 && overrun == 0;
+}
+
+int main(int argc, char** argv) {
+	uint32_t chunk = 4096;
+	uint32_t rounds = 50;
+	uint32_t baud = 0;
+	uint8_t ok = 1;
+	int arg = 1;
+
+	while (arg + 1 < argc && argv[arg][0] == '-') {
+		if (strcmp(argv[arg], "-chunk") == 0) {
+			chunk = (uint32_t)strtoul(argv[arg + 1], NULL, 0);
+		}
+		else if (strcmp(argv[arg], "-rounds") == 0) {
+			rounds = (uint32_t)strtoul(argv[arg + 1], NULL, 0);
+		}
+		else if (strcmp(argv[arg], "-baud") == 0) {
+			baud = (uint32_t)strtoul(argv[arg + 1], NULL, 0);
+		}
+		arg += 2;
+	}
+
+	if (arg >= argc || chunk == 0 || rounds == 0) {
+		printf("link_replay [-chunk n] [-rounds n] [-baud n] stream ...\n");
+		return 1;
+	}
+
+	for (; arg < argc; arg++) {
+		FILE* f = fopen(argv[arg], "rb");
+		if (f == NULL) {
+			printf("%s: cannot open\n", argv[arg]);
+			return 1;
+		}
+
+		std::vector<uint8_t> stream;
+		uint8_t buf[4096];
+		size_t n;
+		while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+			stream.insert(stream.end(), buf, buf + n);
+		}
+		fclose(f);
+
+		const char* name = strrchr(argv[arg], '/');
+		if (baud) {
+			ok &= link_replay_run_baud(name ? name + 1 : argv[arg], stream, baud, rounds);
+		}
+		else {
+			ok &= link_replay_run(name ? name + 1 : argv[arg], stream, chunk, rounds);
+		}
+	}
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,575 @@
+/* sl link stack on the host, the far end of link_pair with LINK_PAIR_PEER.
+ * The sl kernel, link tasks and containers are built unchanged for the
+ * host; this file stands in for the board: clock, critical sections, heap
+ * port, the task tables and a polling task feeding the pty line to
+ * link_hal_rev_block() and ticking the kernel timer every 10ms like SysTick.
+ *
+ * Started by link_pair with the pty master and the shared link_sl_end_t in
+ * the environment (see link_sl.h). Sends LINK_PAIR_COUNT dynamic messages, or
+ * link_rpc_call()s, to the sink task of link_pair and checks what link_pair
+ * sends to its own sink like link_pair does, echoing rpc requests. Reports
+ * and exits when link_pair sets stop. Reads the link_pair environment:
+ *   LINK_PAIR_LINE		loss and corrupt (per million bytes) are applied here
+ *						to both directions, delay and rate are not, the pty
+ *						has no timing
+ *   LINK_PAIR_COUNT, LINK_PAIR_SIZE, LINK_PAIR_PERIOD, LINK_PAIR_SECS,
+ *   LINK_PAIR_QUEUE, LINK_PAIR_RPC	as link_pair, the period is rounded up
+ *						to the 10ms kernel tick
+ * With LINK_SL_ADDR (built as link_sl_md) it is that station of the bus of
+ * LINK_PAIR_STATIONS: messages carry their send stamp after the sequence and
+ * the largest delay of those received is reported, no rpc */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+#include "ak.h"
+#include "task.h"
+#include "message.h"
+#include "timer.h"
+#include "heap.h"
+
+#include "platform.h"
+#include "sys_ctl.h"
+#include "sys_dbg.h"
+#include "xprintf.h"
+
+#include "task_list.h"
+
+#include "link.h"
+#include "link_sig.h"
+#include "link_data.h"
+#include "link_mac.h"
+#include "link_phy.h"
+#include "link_hal.h"
+#include "link_rpc.h"
+
+#include "link_sl.h"
+
+static_assert(LINK_SL_SINK_ID == SL_TASK_CPU_SERIAL_IF_ID, "link_sl.h sink id");
+static_assert(LINK_SL_SENDER_ID == SL_TASK_IF_ID, "link_sl.h sender id");
+
+#define LINK_SL_SIG_DATA		5 /* if_sig of link_pair data */
+#define LINK_SL_MT_SINK_ID		2 /* MT_TASK_IF_CPU_SERIAL_ID */
+
+#define LINK_SL_SIG_INIT		(AK_USER_DEFINE_SIG + 0)
+#define LINK_SL_SIG_START		(AK_USER_DEFINE_SIG + 1)
+#define LINK_SL_SIG_TICK		(AK_USER_DEFINE_SIG + 2)
+#define LINK_SL_SIG_READY		(AK_USER_DEFINE_SIG + 3)
+#define LINK_SL_SIG_RPC_DONE	(AK_USER_DEFINE_SIG + 4)
+
+#define LINK_SL_KERNEL_TICK		10 /* ms, timer_tick() of SysTick_Handler */
+#define LINK_SL_START_DELAY		1500 /* ms, as link_pair */
+#define LINK_SL_EXIT_DELAY		10000 /* ms after LINK_PAIR_SECS, link_pair is gone */
+
+static link_sl_end_t* link_sl_end;
+static int link_sl_fd = -1;
+
+static uint32_t link_sl_count;
+static uint32_t link_sl_size;
+static uint32_t link_sl_period;
+static uint32_t link_sl_secs;
+static uint32_t link_sl_queue;
+static uint32_t link_sl_rpc;
+static uint32_t link_sl_loss;
+static uint32_t link_sl_corrupt;
+static uint32_t link_sl_addr;
+static uint32_t link_sl_head = sizeof(uint32_t); /* sequence, and the send stamp of a station */
+
+static uint32_t link_sl_tx_seq;
+static uint32_t link_sl_rx_seq;
+static uint8_t link_sl_rpc_id = LINK_RPC_ID_NONE;
+static uint8_t link_sl_rpc_data[LINK_RPC_DATA_SIZE];
+static uint32_t link_sl_rpc_len;
+static uint32_t link_sl_tick_last;
+static uint32_t link_sl_exit;
+static uint32_t link_sl_seed_rx = 3;
+static uint32_t link_sl_seed_tx = 4;
+
+static link_send_q_t link_sl_send_q = { AK_MSG_NULL, AK_MSG_NULL, SL_TASK_IF_ID, LINK_SL_SIG_READY };
+
+static uint32_t link_sl_env(const char* name, uint32_t def) {
+	const char* val = getenv(name);
+	return (val != NULL) ? (uint32_t)strtoul(val, NULL, 0) : def;
+}
+
+/* monotonic clock is the same in both processes */
+static uint32_t link_sl_millis() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static uint32_t link_sl_len(uint32_t seq) {
+	return link_sl_head + seq % (link_sl_size - link_sl_head + 1);
+}
+
+static void link_sl_fill(uint8_t* data, uint32_t len, uint32_t seq) {
+	memcpy(data, &seq, sizeof(seq));
+	for (uint32_t i = sizeof(seq); i < len; i++) {
+		data[i] = (uint8_t)(seq * 7 + i);
+	}
+}
+
+/* noisy line, bytes are lost or corrupted in place, return length left */
+static uint32_t link_sl_line(uint8_t* data, uint32_t len, uint32_t* seed) {
+	uint32_t kept = 0;
+
+	for (uint32_t i = 0; i < len; i++) {
+		if (link_sl_loss != 0 && (uint32_t)rand_r((unsigned int*)seed) % 1000000 < link_sl_loss) {
+			continue;
+		}
+
+		data[kept] = data[i];
+		if (link_sl_corrupt != 0 && (uint32_t)rand_r((unsigned int*)seed) % 1000000 < link_sl_corrupt) {
+			data[kept] ^= (uint8_t)(1 + rand_r((unsigned int*)seed) % 255);
+		}
+		kept++;
+	}
+
+	return kept;
+}
+
+/*----------------------------------------------------------------------------*
+ *  board
+ *----------------------------------------------------------------------------*/
+extern "C" {
+/* single thread, nothing preempts the tasks */
+static int link_sl_critical;
+
+void entryCritical(void) { link_sl_critical++; }
+void exitCritical(void) { link_sl_critical--; }
+void enableInterrupts(void) {}
+void disableInterrupts(void) {}
+int getNestEntryCriticalCounter(void) { return link_sl_critical; }
+
+uint32_t millisTick(void) {
+	return link_sl_millis();
+}
+
+uint32_t microsTick(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+/* heap.c carves the linker script heap with 32 bit pointers, libc heap here */
+void* PortMalloc(uint32_t byteAmount) {
+	return malloc(byteAmount);
+}
+
+void PortFree(void* pFree) {
+	free(pFree);
+}
+
+/* run-time budget is checked from the TIM2 interrupt of the board, not here */
+void overrunLogRecord(uint8_t taskId, uint8_t sig, uint32_t pc, uint32_t runTime, uint16_t budget) {
+	(void)taskId;
+	(void)sig;
+	(void)pc;
+	(void)runTime;
+	(void)budget;
+}
+
+void appFatal(const int8_t* s, uint8_t c) {
+	printf("[link_sl] fatal %s 0x%02X\n", (const char*)s, c);
+	fflush(stdout);
+
+	if (link_sl_end != NULL) {
+		link_sl_end->fatal = (uint32_t)c + 1;
+		link_sl_end->done = 1;
+	}
+	_exit(1);
+}
+}
+
+static void link_sl_putc(int c) {
+	putchar(c);
+}
+
+static void link_sl_write_block(uint8_t* data, uint32_t len) {
+	uint8_t line[LINK_FBUF_SIZE * 2];
+
+	while (len != 0) {
+		uint32_t n = (len < sizeof(line)) ? len : sizeof(line);
+
+		memcpy(line, data, n);
+		uint32_t kept = link_sl_line(line, n, &link_sl_seed_tx);
+
+		if (kept != 0 && write(link_sl_fd, line, kept) < 0) {
+			return;
+		}
+		data += n;
+		len -= n;
+	}
+}
+
+static const link_hal_transport_t link_sl_transport = {
+	"pty",
+	link_sl_write_block
+};
+
+/*----------------------------------------------------------------------------*
+ *  end
+ *----------------------------------------------------------------------------*/
+static void link_sl_finish() {
+	link_sl_end_t* e = link_sl_end;
+	struct rusage ru;
+	link_phy_stat_t phy;
+	link_mac_stat_t mac;
+	link_stat_t link;
+
+	getrusage(RUSAGE_SELF, &ru);
+	e->cpu_us = (uint32_t)(ru.ru_utime.tv_sec * 1000000 + ru.ru_utime.tv_usec + ru.ru_stime.tv_sec * 1000000 + ru.ru_stime.tv_usec);
+
+	link_phy_get_stat(&phy);
+	e->phy_frame_sent = phy.frame_sent;
+	e->phy_byte_sent = phy.byte_sent;
+	e->phy_frame_rev = phy.frame_rev;
+	e->phy_byte_rev = phy.byte_rev;
+	e->phy_fcs_err = phy.fcs_err;
+	e->phy_rev_to = phy.rev_to;
+	e->phy_retransmit = phy.retransmit;
+	e->phy_fast_retransmit = phy.fast_retransmit;
+	e->phy_rev_drop = phy.rev_drop;
+	e->phy_send_fail = phy.send_fail;
+	e->phy_fec_fixed = phy.fec_fixed;
+	e->phy_fec_byte = phy.fec_byte;
+	e->phy_poll = phy.poll;
+
+	e->sync.window_size = phy.window_size;
+	e->sync.fcs_algo = phy.fcs_algo;
+	e->sync.frame_data_size = phy.frame_data_size;
+	e->sync.framing = phy.framing;
+	e->sync.caps = phy.caps;
+	e->sync.fec_parity = phy.fec_parity;
+
+	link_mac_get_stat(&mac);
+	e->mac_pdu_sent = mac.pdu_sent;
+	e->mac_pdu_err = mac.pdu_err;
+	e->mac_pdu_retry = mac.pdu_retry;
+	e->mac_pdu_rev = mac.pdu_rev;
+	e->mac_rev_to = mac.rev_to;
+	e->mac_rev_drop = mac.rev_drop;
+	e->mac_credit_block = mac.credit_block;
+
+	link_get_stat(&link);
+	e->link_msg_sent = link.msg_sent;
+	e->link_msg_rev = link.msg_rev;
+	e->link_rev_err = link.rev_err;
+	e->link_agg_pdu = link.agg_pdu;
+	e->link_lz_pdu = link.lz_pdu;
+	e->link_lz_saved = link.lz_saved;
+
+	e->over = link_send_over_get();
+	for (uint8_t channel = 0; channel < LINK_CHANNEL_NUM; channel++) {
+		link_channel_stat_t stat;
+		link_get_channel_stat(channel, &stat);
+		e->resend += stat.err;
+	}
+
+	__atomic_store_n(&e->done, 1, __ATOMIC_RELEASE);
+	_exit(0);
+}
+
+/* sender */
+static void link_sl_send() {
+	link_sl_end_t* e = link_sl_end;
+	uint8_t data[LINK_PDU_BUF_SIZE];
+	uint32_t len = link_sl_len(link_sl_tx_seq);
+
+	link_sl_fill(data, len, link_sl_tx_seq);
+	if (link_sl_addr != 0) {
+		uint32_t now = link_sl_millis();
+		memcpy(&data[sizeof(uint32_t)], &now, sizeof(now));
+	}
+
+	if (link_sl_rpc != 0) {
+		link_sl_rpc_id = link_rpc_call(SL_TASK_IF_ID, LINK_SL_SIG_RPC_DONE, 0, LINK_SL_MT_SINK_ID, LINK_SL_SIG_DATA, data, len, link_sl_rpc);
+		if (link_sl_rpc_id == LINK_RPC_ID_NONE) {
+			/* link full, tried again next tick */
+			return;
+		}
+		memcpy(link_sl_rpc_data, data, len);
+		link_sl_rpc_len = len;
+	}
+	else {
+		ak_msg_t* s_msg = get_dynamic_msg();
+		set_if_src_task_id(s_msg, SL_TASK_IF_ID);
+		set_if_des_task_id(s_msg, LINK_SL_MT_SINK_ID);
+		set_if_src_type(s_msg, 0);
+		set_if_des_type(s_msg, 0);
+		set_if_sig(s_msg, LINK_SL_SIG_DATA);
+		set_data_dynamic_msg(s_msg, data, len);
+		set_msg_sig(s_msg, AC_LINK_SEND_DYNAMIC_MSG);
+
+		if (link_send_q_post(&link_sl_send_q, s_msg) == LINK_SEND_STATUS_FULL) {
+			e->full++;
+		}
+	}
+
+	link_sl_tx_seq++;
+	e->tx++;
+}
+
+void link_sl_sender(ak_msg_t* msg) {
+	link_sl_end_t* e = link_sl_end;
+
+	switch (msg->sig) {
+	case LINK_SL_SIG_START: {
+		e->tx_start = link_sl_millis();
+		timer_set(SL_TASK_IF_ID, LINK_SL_SIG_TICK, link_sl_period, TIMER_PERIODIC);
+	}
+		break;
+
+	case LINK_SL_SIG_TICK: {
+		/* back off while link holds messages, kept ones go first */
+		uint8_t busy = link_sl_queue ? LINK_SEND_STATUS_FULL : LINK_SEND_STATUS_HOLD;
+
+		if (link_sl_tx_seq >= link_sl_count) {
+			timer_remove_attr(SL_TASK_IF_ID, LINK_SL_SIG_TICK);
+		}
+		else if (link_sl_send_q.head == AK_MSG_NULL && link_send_status() < busy && link_sl_rpc_id == LINK_RPC_ID_NONE) {
+			link_sl_send();
+		}
+	}
+		break;
+
+	case LINK_SL_SIG_READY: {
+		link_send_q_flush(&link_sl_send_q);
+	}
+		break;
+
+	case LINK_SL_SIG_RPC_DONE: {
+		link_rpc_header_t header;
+		uint8_t res[LINK_RPC_DATA_SIZE];
+		uint32_t res_len = link_rpc_get_data(msg, &header, res, sizeof(res));
+
+		if (link_sl_rpc_id == LINK_RPC_ID_NONE || header.id != link_sl_rpc_id) {
+			e->rpc_bad++;
+		}
+		else if (header.status == LINK_RPC_STATUS_TIMEOUT) {
+			e->rpc_timeout++;
+		}
+		else if (header.status == LINK_RPC_STATUS_OK && res_len == link_sl_rpc_len && memcmp(res, link_sl_rpc_data, res_len) == 0) {
+			e->rpc_ok++;
+		}
+		else {
+			e->rpc_bad++;
+		}
+		link_sl_rpc_id = LINK_RPC_ID_NONE;
+	}
+		break;
+
+	default:
+		break;
+	}
+}
+
+/* receiver */
+void link_sl_sink(ak_msg_t* msg) {
+	link_sl_end_t* e = link_sl_end;
+
+	switch (msg->sig) {
+	case LINK_SL_SIG_INIT: {
+		task_polling_set_ability(SL_TASK_POLL_CPU_SERIAL_ID, AK_ENABLE);
+		link_hal_reg_transport(&link_sl_transport);
+
+		link_init_state_machine();
+		task_post_pure_msg(SL_LINK_ID, AC_LINK_INIT);
+	}
+		break;
+
+	case LINK_SL_SIG_DATA: {
+		if (get_msg_type(msg) != DYNAMIC_MSG_TYPE) {
+			e->rx_bad++;
+			break;
+		}
+
+		uint8_t data[LINK_PDU_BUF_SIZE];
+		uint8_t ref[LINK_PDU_BUF_SIZE];
+		uint32_t len = get_data_len_dynamic_msg(msg);
+		uint32_t seq = 0;
+		link_rpc_header_t header;
+
+		if (link_sl_rpc != 0) {
+			/* request data follows the rpc header */
+			len = link_rpc_get_data(msg, &header, data, LINK_RPC_DATA_SIZE);
+		}
+		else if (len <= sizeof(data)) {
+			memcpy(data, get_data_dynamic_msg(msg), len);
+		}
+
+		if (len >= link_sl_head && len <= sizeof(data)) {
+			memcpy(&seq, data, sizeof(seq));
+			link_sl_fill(ref, len, seq);
+			memcpy(&ref[sizeof(seq)], &data[sizeof(seq)], link_sl_head - sizeof(seq));
+		}
+
+		if (len >= link_sl_head && len <= sizeof(data) && len == link_sl_len(seq) && memcmp(data, ref, len) == 0) {
+			if (seq != link_sl_rx_seq) {
+				e->rx_gap++;
+			}
+
+			if (link_sl_addr != 0) {
+				uint32_t sent;
+				memcpy(&sent, &data[sizeof(seq)], sizeof(sent));
+
+				uint32_t lat = link_sl_millis() - sent;
+				if (lat > e->lat_max) {
+					e->lat_max = lat;
+				}
+			}
+			link_sl_rx_seq = seq + 1;
+			e->rx_ok++;
+			e->rx_byte += len;
+			e->rx_last = link_sl_millis();
+
+			if (link_sl_rpc != 0) {
+				link_rpc_reply(msg, data, len);
+			}
+		}
+		else {
+			e->rx_bad++;
+		}
+	}
+		break;
+
+	default:
+		break;
+	}
+}
+
+void link_sl_idle(ak_msg_t* msg) {
+	(void)msg;
+}
+
+/* line and kernel tick, what the uart interrupt and SysTick do on the board */
+void link_sl_poll() {
+	struct pollfd pfd = { link_sl_fd, POLLIN, 0 };
+	uint8_t data[256];
+
+	if (poll(&pfd, 1, 1) > 0) {
+		int32_t len = read(link_sl_fd, data, sizeof(data));
+
+		if (len > 0) {
+			uint32_t kept = link_sl_line(data, (uint32_t)len, &link_sl_seed_rx);
+			if (kept != 0) {
+				link_hal_rev_block(data, kept);
+			}
+		}
+	}
+
+	uint32_t now = link_sl_millis();
+	while ((int32_t)(now - link_sl_tick_last) >= LINK_SL_KERNEL_TICK) {
+		timer_tick(LINK_SL_KERNEL_TICK);
+		link_sl_tick_last += LINK_SL_KERNEL_TICK;
+	}
+
+	if (__atomic_load_n(&link_sl_end->stop, __ATOMIC_ACQUIRE) != 0) {
+		link_sl_finish();
+	}
+
+	if ((int32_t)(now - link_sl_exit) > 0 || getppid() == 1) {
+		printf("[link_sl] link_pair is gone\n");
+		_exit(1);
+	}
+}
+
+const task_t app_task_table[] = {
+	{SL_TASK_TIMER_TICK_ID		,	TASK_PRI_LEVEL_7	,	20	,	task_timer_tick		},
+	{SL_TASK_CONSOLE_ID			,	TASK_PRI_LEVEL_3	,	0	,	link_sl_idle		},
+	{SL_TASK_SYSTEM_ID			,	TASK_PRI_LEVEL_6	,	0	,	link_sl_idle		},
+	{SL_TASK_SM_ID				,	TASK_PRI_LEVEL_3	,	0	,	link_sl_idle		},
+	{SL_TASK_IF_ID				,	TASK_PRI_LEVEL_4	,	50	,	link_sl_sender		},
+	{SL_TASK_CPU_SERIAL_IF_ID	,	TASK_PRI_LEVEL_4	,	50	,	link_sl_sink		},
+	{SL_TASK_FIRMWARE_ID		,	TASK_PRI_LEVEL_2	,	0	,	link_sl_idle		},
+	{SL_TASK_DEVICE_MANAGER_ID	,	TASK_PRI_LEVEL_4	,	0	,	link_sl_idle		},
+	{SL_LINK_PHY_ID				,	TASK_PRI_LEVEL_3	,	50	,	TaskLinkPhy			},
+	{SL_LINK_MAC_ID				,	TASK_PRI_LEVEL_4	,	50	,	TaskLinkMac			},
+	{SL_LINK_ID					,	TASK_PRI_LEVEL_5	,	50	,	TaskLink			},
+	{SL_TASK_EOT_ID				,	TASK_PRI_LEVEL_0	,	0	,	(pf_task)0			}
+};
+
+task_polling_t app_task_polling_table[] = {
+	{SL_TASK_POLLING_CONSOLE_ID	,	AK_DISABLE			,	(pf_task_polling)0	},
+	{SL_TASK_POLL_CPU_SERIAL_ID	,	AK_DISABLE			,	link_sl_poll		},
+	{SL_TASK_POLLING_EOT_ID		,	AK_DISABLE			,	(pf_task_polling)0	},
+};
+
+int main() {
+	const char* line = getenv("LINK_PAIR_LINE");
+	const char* line_fd = getenv(LINK_SL_ENV_LINE_FD);
+	const char* end_fd = getenv(LINK_SL_ENV_END_FD);
+	uint32_t delay = 0, rate = 0;
+
+	link_sl_count = link_sl_env("LINK_PAIR_COUNT", 300);
+	link_sl_size = link_sl_env("LINK_PAIR_SIZE", 200);
+	link_sl_period = link_sl_env("LINK_PAIR_PERIOD", 5);
+	link_sl_secs = link_sl_env("LINK_PAIR_SECS", 60);
+	link_sl_queue = link_sl_env("LINK_PAIR_QUEUE", 0);
+	link_sl_rpc = link_sl_env("LINK_PAIR_RPC", 0);
+	link_sl_addr = link_sl_env(LINK_SL_ENV_ADDR, 0);
+
+	if (line != NULL) {
+		sscanf(line, "%u,%u,%u,%u", &delay, &link_sl_loss, &link_sl_corrupt, &rate);
+	}
+
+	if (link_sl_addr != 0) {
+		link_sl_head = 2 * sizeof(uint32_t);
+		link_sl_rpc = 0;
+		link_phy_addr_set(link_sl_addr);
+	}
+
+	/* same bounds as link_pair, against the smaller pdu of this stack */
+	if (link_sl_size < link_sl_head || link_sl_size > LINK_PDU_BUF_SIZE - 64) {
+		link_sl_size = 200;
+	}
+
+	if (link_sl_rpc != 0 && link_sl_size > LINK_RPC_DATA_SIZE) {
+		link_sl_size = LINK_RPC_DATA_SIZE;
+	}
+
+	if (link_sl_period < LINK_SL_KERNEL_TICK) {
+		link_sl_period = LINK_SL_KERNEL_TICK;
+	}
+
+	if (line_fd == NULL || end_fd == NULL) {
+		printf("[link_sl] started by link_pair with LINK_PAIR_PEER\n");
+		return 1;
+	}
+
+	link_sl_fd = atoi(line_fd);
+	link_sl_end = (link_sl_end_t*)mmap(NULL, sizeof(link_sl_end_t), PROT_READ | PROT_WRITE, MAP_SHARED, atoi(end_fd), 0);
+	if (link_sl_end == MAP_FAILED) {
+		printf("[link_sl] no shared end\n");
+		return 1;
+	}
+
+	link_sl_end->offer.window_size = LINK_PHY_WINDOW_SIZE;
+	link_sl_end->offer.fcs_algo = LINK_PHY_FCS_ALGO;
+	link_sl_end->offer.frame_data_size = LINK_PHY_FRAME_DATA_SIZE;
+	link_sl_end->offer.framing = LINK_PHY_FRAMING;
+	link_sl_end->offer.caps = LINK_PHY_CAPS;
+	link_sl_end->offer.fec_parity = LINK_PHY_FEC_PARITY;
+
+	setvbuf(stdout, NULL, _IOLBF, 0);
+	xfunc_output = link_sl_putc;
+
+	link_sl_tick_last = link_sl_millis();
+	link_sl_exit = link_sl_tick_last + LINK_SL_START_DELAY + link_sl_secs * 1000 + LINK_SL_EXIT_DELAY;
+
+	task_init();
+	task_create((task_t*)app_task_table);
+	task_polling_create((task_polling_t*)app_task_polling_table);
+
+	task_post_pure_msg(SL_TASK_CPU_SERIAL_IF_ID, LINK_SL_SIG_INIT);
+	timer_set(SL_TASK_IF_ID, LINK_SL_SIG_START, LINK_SL_START_DELAY, TIMER_ONE_SHOT);
+
+	return task_run();
+}
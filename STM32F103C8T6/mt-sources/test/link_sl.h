@@ -0,0 +1,85 @@
+/* end of link_pair run by link_sl, the sl link stack built for the host.
+ * link_pair makes the line (a pty, link_sl gets its master, or a socket of
+ * the bus of LINK_PAIR_STATIONS) and a shared page for this result, both
+ * passed by fd in the environment. Only plain types here, link_pair and
+ * link_sl include the link headers of different stacks. */
+#ifndef __LINK_SL_H__
+#define __LINK_SL_H__
+
+#include <stdint.h>
+
+#define LINK_SL_ENV_LINE_FD		"LINK_SL_LINE_FD"	/* pty master */
+#define LINK_SL_ENV_END_FD		"LINK_SL_END_FD"	/* link_sl_end_t, mapped shared */
+#define LINK_SL_ENV_ADDR		"LINK_SL_ADDR"		/* multi-drop station address, messages carry their send stamp */
+
+/* task ids of the sl stack, sl app/task_list.h */
+#define LINK_SL_SINK_ID			5 /* SL_TASK_CPU_SERIAL_IF_ID, receiver */
+#define LINK_SL_SENDER_ID		4 /* SL_TASK_IF_ID */
+
+/* link_phy sync parameters, offered at compile time or negotiated */
+typedef struct {
+	uint8_t window_size;
+	uint8_t fcs_algo;
+	uint8_t frame_data_size;
+	uint8_t framing;
+	uint8_t caps;
+	uint8_t fec_parity;
+} link_sl_sync_t;
+
+typedef struct {
+	volatile uint32_t stop; /* set by link_pair, link_sl reports and exits */
+	volatile uint32_t done; /* set by link_sl, fields below are final */
+	volatile uint32_t tx;
+	volatile uint32_t rx_ok;
+	volatile uint32_t rx_bad;
+	volatile uint32_t rx_gap;
+	volatile uint32_t rx_byte;
+	volatile uint32_t rx_last; /* ms, monotonic clock */
+	volatile uint32_t tx_start; /* ms */
+	volatile uint32_t lat_max; /* ms, send stamp to delivery, with LINK_SL_ENV_ADDR */
+	uint32_t cpu_us;
+	uint32_t rpc_ok;
+	uint32_t rpc_timeout;
+	uint32_t rpc_bad;
+	uint32_t over;
+	uint32_t resend;
+	uint32_t full;
+	uint32_t fatal; /* appFatal() code + 1, 0 none */
+
+	/* link_phy_stat_t */
+	uint32_t phy_frame_sent;
+	uint32_t phy_byte_sent;
+	uint32_t phy_frame_rev;
+	uint32_t phy_byte_rev;
+	uint32_t phy_fcs_err;
+	uint32_t phy_rev_to;
+	uint32_t phy_retransmit;
+	uint32_t phy_fast_retransmit;
+	uint32_t phy_rev_drop;
+	uint32_t phy_send_fail;
+	uint32_t phy_fec_fixed;
+	uint32_t phy_fec_byte;
+	uint32_t phy_poll;
+
+	/* link_mac_stat_t */
+	uint32_t mac_pdu_sent;
+	uint32_t mac_pdu_err;
+	uint32_t mac_pdu_retry;
+	uint32_t mac_pdu_rev;
+	uint32_t mac_rev_to;
+	uint32_t mac_rev_drop;
+	uint32_t mac_credit_block;
+
+	/* link_stat_t */
+	uint32_t link_msg_sent;
+	uint32_t link_msg_rev;
+	uint32_t link_rev_err;
+	uint32_t link_agg_pdu;
+	uint32_t link_lz_pdu;
+	uint32_t link_lz_saved;
+
+	link_sl_sync_t offer;
+	link_sl_sync_t sync;
+} link_sl_end_t;
+
+#endif //__LINK_SL_H__
@@ -0,0 +1,141 @@
+/* link_lz round trip, ratio and speed per pdu.
+ * Each input is cut in pdu sized chunks, 244 bytes (MCU pdu data) and 500
+ * bytes (master pdu data). A chunk is coded as link does: into one byte less
+ * than its length, raw when coding does not make it shorter. Every coded
+ * chunk is decoded and compared. Exits 1 on any mismatch.
+ *
+ *   lz_bench [file ...]	firmware .bin, logs. Without files a generated log,
+ *							counting and random data are used */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include "link_lz.h"
+
+#define LZ_BENCH_ROUNDS		20 /* coding is repeated for the timing */
+
+static const uint32_t lz_bench_chunk[] = { 244, 500 };
+
+static double lz_bench_seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void lz_bench_log(std::vector<uint8_t>& data, uint32_t size) {
+	char line[96];
+
+	for (uint32_t k = 0; data.size() < size; k++) {
+		int n = snprintf(line, sizeof(line), "[%08u] node %u temp=%d rssi=-%u status=OK\n", k * 13, k % 5, 20 + (int)(k % 7), 60 + k % 11);
+		data.insert(data.end(), line, line + n);
+	}
+	data.resize(size);
+}
+
+static uint8_t lz_bench_run(const char* name, const std::vector<uint8_t>& data) {
+	uint8_t coded[LINK_PDU_BUF_SIZE];
+	uint8_t decoded[LINK_PDU_BUF_SIZE];
+	uint8_t ok = 1;
+
+	for (uint32_t c = 0; c < sizeof(lz_bench_chunk) / sizeof(lz_bench_chunk[0]); c++) {
+		uint32_t chunk = lz_bench_chunk[c];
+		uint64_t raw = 0;
+		uint64_t sent = 0;
+		uint32_t pdu = 0;
+		uint32_t pdu_lz = 0;
+		double t_compress = 0;
+		double t_decompress = 0;
+
+		for (size_t off = 0; off < data.size(); off += chunk) {
+			uint32_t len = (data.size() - off < chunk) ? (uint32_t)(data.size() - off) : chunk;
+			const uint8_t* src = &data[off];
+			uint32_t lz_len = 0;
+
+			double t0 = lz_bench_seconds();
+			for (uint32_t r = 0; r < LZ_BENCH_ROUNDS; r++) {
+				lz_len = link_lz_compress(src, len, coded, len - 1);
+			}
+			t_compress += lz_bench_seconds() - t0;
+
+			pdu++;
+			raw += len;
+
+			if (lz_len == 0) {
+				sent += len;
+				continue;
+			}
+
+			uint32_t out_len = 0;
+
+			t0 = lz_bench_seconds();
+			for (uint32_t r = 0; r < LZ_BENCH_ROUNDS; r++) {
+				out_len = link_lz_decompress(coded, lz_len, decoded, sizeof(decoded));
+			}
+			t_decompress += lz_bench_seconds() - t0;
+
+			if (out_len != len || memcmp(decoded, src, len) != 0) {
+				printf("%s: round trip mismatch at offset %zu\n", name, off);
+				ok = 0;
+			}
+
+			pdu_lz++;
+			sent += lz_len;
+		}
+
+		printf("%-24s pdu %3u: %6u pdus, %5.1f%% coded, saved %5.1f%%, compress %6.1f MB/s, decompress %6.1f MB/s\n",
+			   name, chunk, pdu, pdu ? 100.0 * pdu_lz / pdu : 0.0, raw ? 100.0 * (raw - sent) / raw : 0.0,
+			   t_compress > 0 ? raw * LZ_BENCH_ROUNDS / t_compress / 1e6 : 0.0,
+			   t_decompress > 0 ? raw * LZ_BENCH_ROUNDS / t_decompress / 1e6 : 0.0);
+	}
+
+	return ok;
+}
+
+int main(int argc, char** argv) {
+	uint8_t ok = 1;
+
+	if (argc < 2) {
+		std::vector<uint8_t> data;
+
+		lz_bench_log(data, 256 * 1024);
+		ok &= lz_bench_run("log", data);
+
+		data.resize(256 * 1024);
+		for (size_t i = 0; i < data.size(); i++) {
+			data[i] = (uint8_t)(i / 4);
+		}
+		ok &= lz_bench_run("counting", data);
+
+		srand(1);
+		for (size_t i = 0; i < data.size(); i++) {
+			data[i] = (uint8_t)rand();
+		}
+		ok &= lz_bench_run("random", data);
+	}
+
+	for (int i = 1; i < argc; i++) {
+		FILE* f = fopen(argv[i], "rb");
+		if (f == NULL) {
+			printf("%s: cannot open\n", argv[i]);
+			return 1;
+		}
+
+		std::vector<uint8_t> data;
+		uint8_t buf[4096];
+		size_t n;
+		while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+			data.insert(data.end(), buf, buf + n);
+		}
+		fclose(f);
+
+		const char* name = strrchr(argv[i], '/');
+		ok &= lz_bench_run(name ? name + 1 : argv[i], data);
+	}
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
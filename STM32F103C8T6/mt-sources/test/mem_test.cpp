@@ -0,0 +1,223 @@
+/* mem_cpy/mem_set/mem_cmp of sl common/utils.c, the portable C reference of
+ * the MCU word routines, against libc:
+ *   mem_cpy	every source and destination alignment, length 0 .. 300, bytes
+ *				around the destination are left untouched
+ *   mem_set	every alignment, length 0 .. 300, values with and without the
+ *				top bit
+ *   mem_cmp	every alignment pair, length 0 .. 300, equal and one byte
+ *				different in the head, the words and the tail, sign as memcmp
+ * Then the cycles of the 4/16/64/256 byte cases of the console bench
+ * command, on the host. Exits 1 on any mismatch.
+ *
+ *   mem_test [bench rounds]	default 100000 */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "utils.h"
+
+#define MEM_TEST_LEN_MAX	(300)
+#define MEM_TEST_ALIGN		(8)		/* covers the word alignment of both pointers */
+#define MEM_TEST_GUARD		(16)
+#define MEM_TEST_BUF_SIZE	(MEM_TEST_GUARD + MEM_TEST_ALIGN + MEM_TEST_LEN_MAX + MEM_TEST_GUARD)
+
+static const uint16_t mem_test_bench_size[] = { 4, 16, 64, 256 };
+
+/* word aligned buffers, the alignment under test is an offset into them */
+static uint64_t mem_test_a[MEM_TEST_BUF_SIZE / sizeof(uint64_t) + 1];
+static uint64_t mem_test_b[MEM_TEST_BUF_SIZE / sizeof(uint64_t) + 1];
+static uint64_t mem_test_ref[MEM_TEST_BUF_SIZE / sizeof(uint64_t) + 1];
+
+/* tsc on x86, ns elsewhere */
+static uint64_t mem_test_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static void mem_test_fill(uint8_t* buf, uint32_t seed) {
+	for (uint32_t i = 0; i < MEM_TEST_BUF_SIZE; i++) {
+		buf[i] = (uint8_t)((i + seed) * 151 + 7);
+	}
+}
+
+static int mem_test_sign(int v) {
+	return (v > 0) - (v < 0);
+}
+
+static uint32_t mem_test_cpy() {
+	uint8_t* src = (uint8_t*)mem_test_a;
+	uint8_t* dst = (uint8_t*)mem_test_b;
+	uint8_t* ref = (uint8_t*)mem_test_ref;
+	uint32_t violation = 0;
+
+	mem_test_fill(src, 0);
+
+	for (uint32_t s = 0; s < MEM_TEST_ALIGN; s++) {
+		for (uint32_t d = 0; d < MEM_TEST_ALIGN; d++) {
+			for (uint32_t len = 0; len <= MEM_TEST_LEN_MAX; len++) {
+				mem_test_fill(dst, 1);
+				mem_test_fill(ref, 1);
+
+				void* ret = mem_cpy(&dst[MEM_TEST_GUARD + d], &src[MEM_TEST_GUARD + s], len);
+				memcpy(&ref[MEM_TEST_GUARD + d], &src[MEM_TEST_GUARD + s], len);
+
+				if (ret != &dst[MEM_TEST_GUARD + d] || memcmp(dst, ref, MEM_TEST_BUF_SIZE) != 0) {
+					if (violation++ < 5) {
+						printf("mem_cpy src+%u dst+%u len %u differs from memcpy\n", s, d, len);
+					}
+				}
+			}
+		}
+	}
+
+	return violation;
+}
+
+static uint32_t mem_test_set() {
+	static const int value[] = { 0x00, 0x5A, 0xA5, 0xFF, 0x1FF };
+	uint8_t* dst = (uint8_t*)mem_test_a;
+	uint8_t* ref = (uint8_t*)mem_test_ref;
+	uint32_t violation = 0;
+
+	for (uint32_t v = 0; v < sizeof(value) / sizeof(value[0]); v++) {
+		for (uint32_t d = 0; d < MEM_TEST_ALIGN; d++) {
+			for (uint32_t len = 0; len <= MEM_TEST_LEN_MAX; len++) {
+				mem_test_fill(dst, 2);
+				mem_test_fill(ref, 2);
+
+				void* ret = mem_set(&dst[MEM_TEST_GUARD + d], value[v], len);
+				memset(&ref[MEM_TEST_GUARD + d], value[v], len);
+
+				if (ret != &dst[MEM_TEST_GUARD + d] || memcmp(dst, ref, MEM_TEST_BUF_SIZE) != 0) {
+					if (violation++ < 5) {
+						printf("mem_set 0x%X dst+%u len %u differs from memset\n", value[v], d, len);
+					}
+				}
+			}
+		}
+	}
+
+	return violation;
+}
+
+static uint32_t mem_test_cmp() {
+	uint8_t* p1 = (uint8_t*)mem_test_a;
+	uint8_t* p2 = (uint8_t*)mem_test_b;
+	uint32_t violation = 0;
+
+	for (uint32_t a1 = 0; a1 < MEM_TEST_ALIGN; a1++) {
+		for (uint32_t a2 = 0; a2 < MEM_TEST_ALIGN; a2++) {
+			uint8_t* m1 = &p1[MEM_TEST_GUARD + a1];
+			uint8_t* m2 = &p2[MEM_TEST_GUARD + a2];
+
+			for (uint32_t len = 0; len <= MEM_TEST_LEN_MAX; len++) {
+				/* equal, then one byte different at the head, the middle and the tail */
+				uint32_t pos[] = { len, 0, 1, 3, 4, len / 2, len - 5, len - 2, len - 1 };
+
+				for (uint32_t k = 0; k < sizeof(pos) / sizeof(pos[0]); k++) {
+					if (k && pos[k] >= len) {
+						continue;
+					}
+
+					for (uint32_t dir = 0; dir < 2; dir++) {
+						mem_test_fill(p1, 3);
+						memcpy(m2, m1, len);
+
+						if (k) {
+							m2[pos[k]] = (uint8_t)(m1[pos[k]] + (dir ? 0x81 : 0x01));
+						}
+
+						int ret = mem_test_sign(mem_cmp(m1, m2, len));
+						if (ret != mem_test_sign(memcmp(m1, m2, len))) {
+							if (violation++ < 5) {
+								printf("mem_cmp +%u +%u len %u diff at %u gives %d, not as memcmp\n", a1, a2, len, k ? pos[k] : len, ret);
+							}
+						}
+
+						if (!k) {
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return violation;
+}
+
+/* kept out of line so the loop stays a byte loop */
+static void __attribute__((noinline)) mem_test_byte_cpy(uint8_t* dst, const uint8_t* src, size_t size) {
+	while (size--) {
+		*dst++ = *src++;
+		__asm__ volatile ("" ::: "memory");
+	}
+}
+
+#define MEM_TEST_BENCH(result, call)								\
+	do {															\
+		uint64_t t0 = mem_test_cycles();							\
+		for (uint32_t r = 0; r < rounds; r++) {						\
+			call;													\
+			__asm__ volatile ("" ::: "memory");						\
+		}															\
+		result = (double)(mem_test_cycles() - t0) / rounds;			\
+	} while (0)
+
+static void mem_test_bench(uint32_t rounds) {
+	uint8_t* src = (uint8_t*)mem_test_a;
+	uint8_t* dst = (uint8_t*)mem_test_b;
+	volatile int sink = 0;
+	double byte_loop, memcpy_lib, mem_copy, mem_copy_mis, mem_fill, mem_compare;
+
+	mem_test_fill(src, 4);
+
+#if defined(__x86_64__) || defined(__i386__)
+	printf("[BENCH] cycles (tsc) per call\n");
+#else
+	printf("[BENCH] ns per call\n");
+#endif
+	printf("SIZE\tBYTE\tmemcpy\tmem_cpy\tmem_cpy(+1)\tmem_set\tmem_cmp\n");
+
+	for (uint32_t id = 0; id < sizeof(mem_test_bench_size) / sizeof(mem_test_bench_size[0]); id++) {
+		size_t len = mem_test_bench_size[id];
+
+		MEM_TEST_BENCH(byte_loop, mem_test_byte_cpy(dst, src, len));
+		MEM_TEST_BENCH(memcpy_lib, memcpy(dst, src, len));
+		MEM_TEST_BENCH(mem_copy, mem_cpy(dst, src, len));
+		MEM_TEST_BENCH(mem_copy_mis, mem_cpy(dst + 1, src + 1, len));
+		MEM_TEST_BENCH(mem_fill, mem_set(dst, 0x5A, len));
+		memcpy(src, dst, len);
+		MEM_TEST_BENCH(mem_compare, sink += mem_cmp(dst, src, len));
+
+		printf("%u\t%.1f\t%.1f\t%.1f\t%.1f\t\t%.1f\t%.1f\n", (uint32_t)len, byte_loop, memcpy_lib, mem_copy, mem_copy_mis, mem_fill, mem_compare);
+	}
+}
+
+int main(int argc, char** argv) {
+	uint32_t rounds = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 100000;
+	uint32_t violation = 0;
+
+	violation += mem_test_cpy();
+	violation += mem_test_set();
+	violation += mem_test_cmp();
+
+	printf("mem_cpy/mem_set/mem_cmp vs libc, alignment 0..%u, length 0..%u: %u mismatches\n",
+		   MEM_TEST_ALIGN - 1, MEM_TEST_LEN_MAX, violation);
+
+	mem_test_bench(rounds);
+
+	printf("%s\n", violation ? "FAIL" : "PASS");
+	return violation ? 1 : 0;
+}
@@ -0,0 +1,178 @@
+/* ringBufferCharSpan/ringBufferCharSkip of the sl ring buffer, which the sl
+ * serial interface parses in place:
+ *   every read start and fill	first span runs to the buffer end at most, the
+ *								second one holds the wrapped rest, both give the
+ *								bytes in the order they were put
+ *   skip past the fill			takes the fill only
+ *   random put/span/skip		same bytes as a plain queue, also when puts
+ *								overrun the buffer and drop the oldest bytes
+ * Exits 1 on any violation.
+ *
+ *   ring_test [random steps]	default 1000000 */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <deque>
+
+#include "ring_buffer.h"
+
+#define RING_TEST_SIZE		(256) /* CPU_SERIAL_IF_BUFFER_SIZE of sl */
+
+static uint8_t ring_test_buf[RING_TEST_SIZE];
+
+/* ring read start at head with fill bytes in it, byte i is (uint8_t)(base + i) */
+static void ring_test_set(ringBufferChar_t* ring, uint16_t head, uint16_t fill, uint8_t base) {
+	ringBufferCharInit(ring, ring_test_buf, RING_TEST_SIZE);
+
+	for (uint16_t i = 0; i < head; i++) {
+		ringBufferCharPut(ring, 0);
+	}
+	ringBufferCharSkip(ring, head);
+
+	for (uint16_t i = 0; i < fill; i++) {
+		ringBufferCharPut(ring, (uint8_t)(base + i));
+	}
+}
+
+static uint32_t ring_test_wrap() {
+	uint32_t violation = 0;
+	ringBufferChar_t ring;
+	uint8_t* data;
+
+	for (uint16_t head = 0; head < RING_TEST_SIZE; head++) {
+		for (uint16_t fill = 0; fill <= RING_TEST_SIZE; fill++) {
+			uint8_t base = (uint8_t)(head * 7 + fill);
+			ring_test_set(&ring, head, fill, base);
+
+			uint16_t first = RING_TEST_SIZE - head;
+			if (first > fill) {
+				first = fill;
+			}
+
+			/* the same span until skipped */
+			uint16_t len = ringBufferCharSpan(&ring, &data);
+			if (len != first || data != &ring_test_buf[head] || ringBufferCharSpan(&ring, &data) != first) {
+				violation++;
+				continue;
+			}
+
+			for (uint16_t i = 0; i < len; i++) {
+				if (data[i] != (uint8_t)(base + i)) {
+					violation++;
+					break;
+				}
+			}
+			ringBufferCharSkip(&ring, len);
+
+			/* wrapped rest starts at the buffer start */
+			len = ringBufferCharSpan(&ring, &data);
+			if (len != fill - first || (len && data != ring_test_buf)) {
+				violation++;
+				continue;
+			}
+
+			for (uint16_t i = 0; i < len; i++) {
+				if (data[i] != (uint8_t)(base + first + i)) {
+					violation++;
+					break;
+				}
+			}
+			ringBufferCharSkip(&ring, len);
+
+			if (ringBufferCharAvailable(&ring) != 0 || ringBufferCharSpan(&ring, &data) != 0) {
+				violation++;
+			}
+
+			/* skip past the fill leaves an empty ring at the next put position */
+			ring_test_set(&ring, head, fill, base);
+			ringBufferCharSkip(&ring, fill + 1 + head);
+			ringBufferCharPut(&ring, 0x5a);
+
+			len = ringBufferCharSpan(&ring, &data);
+			if (ringBufferCharAvailable(&ring) != 1 || len != 1 || *data != 0x5a || \
+					data != &ring_test_buf[(head + fill) % RING_TEST_SIZE]) {
+				violation++;
+			}
+		}
+	}
+
+	printf("wrap: %u read starts, %u fills, %u violations\n", RING_TEST_SIZE, RING_TEST_SIZE + 1, violation);
+	return violation;
+}
+
+static uint32_t ring_test_random(uint32_t steps) {
+	uint32_t violation = 0;
+	uint32_t overrun = 0;
+	uint32_t wrapped = 0;
+	uint8_t next = 0;
+	ringBufferChar_t ring;
+	std::deque<uint8_t> queue;
+
+	ringBufferCharInit(&ring, ring_test_buf, RING_TEST_SIZE);
+
+	for (uint32_t s = 0; s < steps; s++) {
+		if (rand() % 2) {
+			/* bytes of a few uart interrupts, the oldest go on overrun */
+			uint32_t n = rand() % 128;
+
+			for (uint32_t i = 0; i < n; i++) {
+				ringBufferCharPut(&ring, next);
+				queue.push_back(next++);
+
+				if (queue.size() > RING_TEST_SIZE) {
+					queue.pop_front();
+					overrun++;
+				}
+			}
+		}
+		else {
+			/* serial poll takes at most two spans, a parser may stop early */
+			for (uint8_t k = 0; k < 2; k++) {
+				uint8_t* data;
+				uint16_t len = ringBufferCharSpan(&ring, &data);
+
+				if (len == 0) {
+					break;
+				}
+
+				if (k == 1) {
+					wrapped++;
+				}
+
+				for (uint16_t i = 0; i < len; i++) {
+					if (queue.empty() || data[i] != queue[i]) {
+						violation++;
+						break;
+					}
+				}
+
+				uint16_t take = (rand() % 4) ? len : rand() % (len + 1);
+				ringBufferCharSkip(&ring, take);
+				queue.erase(queue.begin(), queue.begin() + take);
+			}
+		}
+
+		if (ringBufferCharAvailable(&ring) != queue.size()) {
+			violation++;
+			break;
+		}
+	}
+
+	printf("random: %u steps, %u bytes overrun, %u wrapped second spans, %u violations\n", steps, overrun, wrapped, violation);
+	return violation;
+}
+
+int main(int argc, char** argv) {
+	uint32_t steps = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 1000000;
+	uint32_t violation = 0;
+
+	srand(1);
+
+	violation += ring_test_wrap();
+	violation += ring_test_random(steps);
+
+	printf("%s\n", violation ? "FAIL" : "PASS");
+	return violation ? 1 : 0;
+}
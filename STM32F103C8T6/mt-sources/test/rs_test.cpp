@@ -0,0 +1,147 @@
+/* rs_encode/rs_decode capacity and speed.
+ * Random shortened codewords for each parity size get random byte errors:
+ *   up to nroots / 2 errors	must be corrected to the sent word
+ *   nroots / 2 + 1 .. nroots	must never be taken for a clean word, and a word
+ *								found beyond correction must be left untouched
+ * Exits 1 on any violation.
+ *
+ *   rs_test [words per parity size]	default 20000 */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "rs.h"
+
+static const uint8_t rs_test_nroots[] = { 2, 4, 6, 8, 10, 12, 16, 32 };
+
+static double rs_test_seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* flip nerr distinct bytes of data and parity to other values */
+static void rs_test_corrupt(uint8_t* word, uint32_t size, uint32_t nerr) {
+	uint8_t hit[RS_CODEWORD_SIZE_MAX] = { 0 };
+
+	for (uint32_t i = 0; i < nerr; i++) {
+		uint32_t pos;
+		do {
+			pos = rand() % size;
+		} while (hit[pos]);
+
+		hit[pos] = 1;
+		word[pos] ^= (uint8_t)(1 + rand() % 255);
+	}
+}
+
+static uint8_t rs_test_capacity(uint8_t nroots, uint32_t words) {
+	uint32_t fixed = 0;
+	uint32_t refused = 0;
+	uint32_t miscorrected = 0;
+	uint32_t violation = 0;
+
+	for (uint32_t w = 0; w < words; w++) {
+		uint8_t sent[RS_CODEWORD_SIZE_MAX];
+		uint8_t word[RS_CODEWORD_SIZE_MAX];
+		uint8_t before[RS_CODEWORD_SIZE_MAX];
+		uint32_t len = 1 + rand() % (RS_CODEWORD_SIZE_MAX - nroots);
+		uint32_t size = len + nroots;
+
+		for (uint32_t i = 0; i < len; i++) {
+			sent[i] = (uint8_t)rand();
+		}
+		rs_encode(sent, len, &sent[len], nroots);
+
+		/* half within capacity, half beyond it up to nroots errors */
+		uint32_t t = nroots / 2;
+		uint32_t nerr = (w & 1) ? t + 1 + rand() % (nroots - t) : rand() % (t + 1);
+
+		memcpy(word, sent, size);
+		rs_test_corrupt(word, size, nerr);
+		memcpy(before, word, size);
+
+		int32_t ret = rs_decode(word, len, &word[len], nroots);
+
+		if (nerr <= t) {
+			if (ret != (int32_t)nerr || memcmp(word, sent, size) != 0) {
+				violation++;
+			}
+			else {
+				fixed++;
+			}
+		}
+		else if (ret == 0) {
+			/* less than nroots + 1 errors never make another codeword */
+			violation++;
+		}
+		else if (ret < 0) {
+			if (memcmp(word, before, size) != 0) {
+				violation++;
+			}
+			refused++;
+		}
+		else {
+			/* landed within t of another codeword, caught by the frame crc */
+			miscorrected++;
+		}
+	}
+
+	printf("nroots %2u: %6u corrected, %6u refused, %4u miscorrected beyond capacity, %u violations\n",
+		   nroots, fixed, refused, miscorrected, violation);
+	return violation == 0;
+}
+
+/* phy frame of 143 bytes with 8 parity bytes */
+static void rs_test_speed() {
+	const uint32_t len = 143;
+	const uint8_t nroots = 8;
+	const uint32_t rounds = 20000;
+	uint8_t sent[RS_CODEWORD_SIZE_MAX];
+	uint8_t word[RS_CODEWORD_SIZE_MAX];
+
+	for (uint32_t i = 0; i < len; i++) {
+		sent[i] = (uint8_t)rand();
+	}
+
+	double t0 = rs_test_seconds();
+	for (uint32_t r = 0; r < rounds; r++) {
+		rs_encode(sent, len, &sent[len], nroots);
+	}
+	double t_encode = rs_test_seconds() - t0;
+
+	double t_decode[2] = { 0, 0 };
+	for (uint32_t k = 0; k < 2; k++) {
+		for (uint32_t r = 0; r < rounds; r++) {
+			memcpy(word, sent, len + nroots);
+			if (k) {
+				rs_test_corrupt(word, len + nroots, nroots / 2);
+			}
+
+			t0 = rs_test_seconds();
+			rs_decode(word, len, &word[len], nroots);
+			t_decode[k] += rs_test_seconds() - t0;
+		}
+	}
+
+	printf("%u byte frame, %u parity: encode %.2f us, decode clean %.2f us, decode %u errors %.2f us\n",
+		   len, nroots, t_encode * 1e6 / rounds, t_decode[0] * 1e6 / rounds, nroots / 2, t_decode[1] * 1e6 / rounds);
+}
+
+int main(int argc, char** argv) {
+	uint32_t words = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 20000;
+	uint8_t ok = 1;
+
+	srand(1);
+
+	for (uint32_t i = 0; i < sizeof(rs_test_nroots); i++) {
+		ok &= rs_test_capacity(rs_test_nroots[i], words);
+	}
+
+	rs_test_speed();
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
@@ -16,6 +16,24 @@ TIMER_POOL_SIZE = -DAK_TIMER_POOL_SIZE=6
 # Task objects log queue enable
 TASK_OBJ_LOG_ENABLE = -DAK_TASK_OBJ_LOG_ENABLE
 
+# Starvation detection of low priority tasks
+TASK_STARVATION_ENABLE = -DAK_TASK_STARVATION_ENABLE
+
+# Oldest pending message age (ms) considered as starvation
+TASK_STARVATION_BOUND = -DAK_TASK_STARVATION_BOUND=1000
+
+# Aging: serve one message of a starved priority ahead of higher priorities, once per bound
+# TASK_AGING_ENABLE = -DAK_TASK_AGING_ENABLE
+
+# Heap BLOCK owner tagging (task id + call-site) and per-task accounting
+# HEAP_OWNER_ENABLE = -DAK_HEAP_OWNER_ENABLE
+
+# Task run-time budget checked from hardware timer (budget column of task table)
+TASK_BUDGET_ENABLE = -DAK_TASK_BUDGET_ENABLE
+
+# Budget overrun escalates to FATAL (overrun record is kept in any case)
+# TASK_BUDGET_ESCALATE = -DAK_TASK_BUDGET_ESCALATE
+
 GENERAL_FLAGS += \
 	$(COMMON_MSG_POOL_SIZE) \
 	$(COMMON_MSG_DATA_SIZE) \
@@ -25,5 +43,11 @@ GENERAL_FLAGS += \
 	$(DYNAMIC_PDU_SIZE) \
 	$(TIMER_POOL_SIZE) \
 	$(TASK_OBJ_LOG_ENABLE) \
+	$(TASK_STARVATION_ENABLE) \
+	$(TASK_STARVATION_BOUND) \
+	$(TASK_AGING_ENABLE) \
+	$(HEAP_OWNER_ENABLE) \
+	$(TASK_BUDGET_ENABLE) \
+	$(TASK_BUDGET_ESCALATE) \
 	$(LOG_AK_KERNEL_ENABLE) \
 	$(IRQ_OBJ_LOG_ENABLE) \
@@ -53,6 +53,7 @@ extern "C"
 #define TASK_PRI_LEVEL_6				(6)
 #define TASK_PRI_LEVEL_7				(7)
 
+#define AK_TASK_PRE_SCHEDULER_ID		(0xED)
 #define AK_TASK_INTERRUPT_ID			(0xEE)
 #define AK_TASK_IDLE_ID					(0xEF)
 
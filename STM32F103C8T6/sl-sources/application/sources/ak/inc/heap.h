@@ -38,6 +38,8 @@ extern uint32_t __heap_end__;
 #define HEAP_END_ADDR                   ( &__heap_end__   )
 
 #define BLOCK_LINK_STRUCT_SIZE          ( sizeof(struct BLOCK_LINK) )
+#define HEAP_BYTE_ALIGNMENT             ( 4U )
+#define HEAP_BYTE_ALIGNMENT_MASK        ( HEAP_BYTE_ALIGNMENT - 1U )
 
 
 #define INVALID_HEAP_SIZE()             FATAL("HEAP", 0x0A)
@@ -47,6 +49,17 @@ extern uint32_t __heap_end__;
 #define INVALID_VALUE_FREE()            FATAL("HEAP", 0x04)
 #define INVALID_BLOCK_TO_FREE()         FATAL("HEAP", 0x05)
 
+/*--------------------------------------------------------*/
+/* Owner tagging: each BLOCK records the task allocated   */
+/* it and a call-site tag. Compiled out, the tag argument */
+/* is dropped by the macro and BLOCK header is unchanged  */
+/*--------------------------------------------------------*/
+#if defined(AK_HEAP_OWNER_ENABLE)
+#define HEAP_MALLOC(size, tag)          PortMallocTag(size, tag)
+#else
+#define HEAP_MALLOC(size, tag)          PortMalloc(size)
+#endif
+
 /* Typedef -------------------------------------------------------------------*/
 typedef struct HEAP_REGION {
     uint8_t  *pointerStartAddress;
@@ -58,8 +71,23 @@ typedef struct HEAP_REGION {
 typedef struct BLOCK_LINK {
     struct BLOCK_LINK *nextFreeBlock;
     uint32_t blockSize;     
+#if defined(AK_HEAP_OWNER_ENABLE)
+    const char *tag;
+    uint8_t owner;
+#endif
 } BlockLink_t;
 
+#if defined(AK_HEAP_OWNER_ENABLE)
+typedef struct {
+    uint32_t liveBytes;
+    uint32_t liveBlocks;
+    uint32_t peakBytes;
+} HeapOwnerStat_t;
+
+/* Called for each allocated BLOCK, outside critical section on a copy of its header */
+typedef void (*pfHeapWalk)(void *addr, uint32_t size, uint8_t owner, const char *tag);
+#endif
+
 /* Function prototypes -------------------------------------------------------*/
 extern void* PortMalloc(uint32_t byteAmount);
 extern void PortFree(void *pFree);
@@ -69,6 +97,14 @@ extern uint32_t getTotalHeapUsed(void);
 extern uint32_t getMaxFreeBlockSize(void);
 extern uint32_t getMinFreeBlockSize(void);
 
+#if defined(AK_HEAP_OWNER_ENABLE)
+extern void* PortMallocTag(uint32_t byteAmount, const char *tag);
+extern uint8_t getHeapOwnerSlots(void);
+extern uint8_t getHeapOwnerId(uint8_t slot);
+extern HeapOwnerStat_t* getHeapOwnerStat(uint8_t slot);
+extern void heapWalk(pfHeapWalk walk);
+#endif
+
 
 #ifdef __cplusplus
 }
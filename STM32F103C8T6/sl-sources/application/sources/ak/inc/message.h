@@ -72,6 +72,11 @@ extern "C"
 #define AK_DYNAMIC_PDU_SIZE			(4)
 #endif
 
+/*-----------------------------------------------*/
+/* Alignment of common/dynamic message data area */
+/*-----------------------------------------------*/
+#define AK_MSG_DATA_ALIGN			(4)
+
 #define AK_MSG_TYPE_MASK			(0xC0)
 #define AK_MSG_REF_COUNT_MASK		(0x3F)
 
@@ -129,6 +134,10 @@ typedef struct ak_msg_t {
 	dbg_handler_t		dbg_handler;
 #endif
 
+#if defined(AK_TASK_STARVATION_ENABLE)
+	uint32_t			post_at;	/* enqueue time, age of the message in queue */
+#endif
+
 	/*-------------*/
 	/* Task header */
 	/*-------------*/
@@ -154,7 +163,7 @@ typedef struct ak_msg_t {
 typedef struct {
 	ak_msg_t	msg_header;
 	uint8_t		len;
-	uint8_t		data[AK_COMMON_MSG_DATA_SIZE];
+	uint8_t		data[AK_COMMON_MSG_DATA_SIZE] __AK_ALIGNED(AK_MSG_DATA_ALIGN);
 } ak_msg_common_t;
 
 /*--------------*/
@@ -225,7 +234,13 @@ extern void msg_dec_ref_count(ak_msg_t* msg);
  *  DECLARE: Dynamic allocate
  *  Note: 
  *----------------------------------------------------------------------------*/
+#if defined(AK_HEAP_OWNER_ENABLE)
+/* heap BLOCK is tagged with the caller function name */
+#define ak_malloc(size)			ak_malloc_tag(size, __func__)
+extern void* ak_malloc_tag(size_t, const char*);
+#else
 extern void* ak_malloc(size_t);
+#endif
 extern void ak_free(void*);
 
 /*----------------------------------------------------------------------------*
@@ -0,0 +1,147 @@
+//=============================================================================
+//    A C T I V E    K E R N E L
+//=============================================================================
+// Project   :  Event driven
+// Author    :  HungPNQ
+// Date      :  19/10/2026
+// Brief     :  Typed message API for C++ application code
+//=============================================================================
+// Usage
+//  > Sender   : post(SL_TASK_SM_ID, SL_SM_MT_FRIWMARE_OTA_RES, firmwareReport);
+//  > Receiver : firmwareHeader_t* report = msg_cast<firmwareHeader_t>(msg);
+//
+//  The message pool is selected from sizeof(T) at compile time:
+//   - empty type                          -> pure message
+//   - sizeof(T) <= AK_COMMON_MSG_DATA_SIZE -> common message
+//   - otherwise                           -> dynamic message (heap)
+//  Payload is copy-constructed directly into the pool storage, there is no
+//  intermediate buffer as with set_data_common_msg().
+//  post_common() forces the common pool and rejects oversized T at compile
+//  time, use it on paths that must not touch the heap.
+//=============================================================================
+
+#ifndef __MESSAGE_HPP
+#define __MESSAGE_HPP
+
+#ifndef __cplusplus
+#error "message.hpp is only available for C++ translation units"
+#endif
+
+#include <new>
+#include <type_traits>
+
+#include "ak.h"
+#include "message.h"
+#include "task.h"
+
+#include "sys_dbg.h"
+
+/*----------------------------------------------------------------------------*
+ *  DECLARE: Pool selection
+ *  Note: resolved at compile time, no runtime branch
+ *----------------------------------------------------------------------------*/
+template<uint8_t pool_type>
+struct ak_msg_pool_tag { };
+
+template<typename T>
+struct ak_msg_traits {
+	static_assert(std::is_trivially_copyable<T>::value,
+				  "AK message payload must be trivially copyable (message is freed without destructor)");
+	static_assert(alignof(T) <= AK_MSG_DATA_ALIGN,
+				  "AK message payload alignment exceeds AK_MSG_DATA_ALIGN");
+
+	static const uint8_t type = std::is_empty<T>::value ? PURE_MSG_TYPE :
+								(sizeof(T) <= AK_COMMON_MSG_DATA_SIZE) ? COMMON_MSG_TYPE :
+								DYNAMIC_MSG_TYPE;
+
+	typedef ak_msg_pool_tag<type> tag;
+};
+
+/*----------------------------------------------------------------------------*
+ *  DECLARE: Allocate and construct
+ *----------------------------------------------------------------------------*/
+template<typename T>
+inline ak_msg_t* ak_msg_make(const T&, ak_msg_pool_tag<PURE_MSG_TYPE>) {
+	return get_pure_msg();
+}
+
+template<typename T>
+inline ak_msg_t* ak_msg_make(const T& data, ak_msg_pool_tag<COMMON_MSG_TYPE>) {
+	static_assert(sizeof(T) <= AK_COMMON_MSG_DATA_SIZE,
+				  "AK message payload is larger than AK_COMMON_MSG_DATA_SIZE");
+
+	ak_msg_t* msg = get_common_msg();
+
+	((ak_msg_common_t*)msg)->len = sizeof(T);
+	new (((ak_msg_common_t*)msg)->data) T(data);
+
+	return msg;
+}
+
+template<typename T>
+inline ak_msg_t* ak_msg_make(const T& data, ak_msg_pool_tag<DYNAMIC_MSG_TYPE>) {
+	ak_msg_t* msg = get_dynamic_msg();
+	void* storage = ak_malloc(sizeof(T));
+
+	((ak_msg_dynamic_t*)msg)->len = sizeof(T);
+	((ak_msg_dynamic_t*)msg)->data = (uint8_t*)storage;
+	new (storage) T(data);
+
+	return msg;
+}
+
+/*----------------------------------------------------------------------------*
+ *  DECLARE: Payload access
+ *----------------------------------------------------------------------------*/
+template<typename T>
+inline T* ak_msg_payload(ak_msg_t* msg, ak_msg_pool_tag<COMMON_MSG_TYPE>) {
+	if (((ak_msg_common_t*)msg)->len != sizeof(T)) {
+		FATAL("MF", 0x52);
+	}
+
+	return (T*)((ak_msg_common_t*)msg)->data;
+}
+
+template<typename T>
+inline T* ak_msg_payload(ak_msg_t* msg, ak_msg_pool_tag<DYNAMIC_MSG_TYPE>) {
+	if (((ak_msg_dynamic_t*)msg)->len != sizeof(T)) {
+		FATAL("MF", 0x53);
+	}
+
+	return (T*)((ak_msg_dynamic_t*)msg)->data;
+}
+
+/*----------------------------------------------------------------------------*
+ *  DECLARE: Public typed API
+ *----------------------------------------------------------------------------*/
+/* Allocate the message from the pool matching T, copy data in place, post it */
+template<typename T>
+inline void post(task_id_t des_task_id, uint8_t sig, const T& data) {
+	ak_msg_t* msg = ak_msg_make<T>(data, typename ak_msg_traits<T>::tag());
+
+	set_msg_sig(msg, sig);
+	task_post(des_task_id, msg);
+}
+
+/* Same as post() but never falls back to heap, oversized T fails to compile */
+template<typename T>
+inline void post_common(task_id_t des_task_id, uint8_t sig, const T& data) {
+	ak_msg_t* msg = ak_msg_make<T>(data, ak_msg_pool_tag<COMMON_MSG_TYPE>());
+
+	set_msg_sig(msg, sig);
+	task_post(des_task_id, msg);
+}
+
+/* Return the payload of msg as T, FATAL when pool type or length mismatch */
+template<typename T>
+inline T* msg_cast(ak_msg_t* msg) {
+	static_assert(!std::is_empty<T>::value, "pure message has no payload");
+
+	if (get_msg_type(msg) != ak_msg_traits<T>::type) {
+		FATAL("MF", 0x51);
+	}
+
+	return ak_msg_payload<T>(msg, typename ak_msg_traits<T>::tag());
+}
+
+#endif /* __MESSAGE_HPP */
@@ -18,6 +18,7 @@
  *----------------------------------------------------------------------------*/
 #define __AK_PACKETED	        __attribute__((__packed__))
 #define __AK_WEAK		        __attribute__((__weak__))
+#define __AK_ALIGNED(n)	        __attribute__((__aligned__(n)))
 
 #define AkCtl_Millis()          millisTick()
 
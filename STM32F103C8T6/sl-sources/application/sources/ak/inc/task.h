@@ -33,6 +33,14 @@ extern "C"
  *----------------------------------------------------------------------------*/
 #define LOG_QUEUE_OBJECT_SIZE			(312)
 
+/*------------------------------------------------------*/
+/* Starvation: pending work of a priority level waits   */
+/* longer than the bound without being served           */
+/*------------------------------------------------------*/
+#ifndef AK_TASK_STARVATION_BOUND
+#define AK_TASK_STARVATION_BOUND		(1000)	/* ms */
+#endif
+
 /* Typedef -------------------------------------------------------------------*/
 typedef uint8_t	task_pri_t;
 typedef uint8_t	task_id_t;
@@ -42,6 +50,7 @@ typedef void (*pf_task_polling)();
 typedef struct {
 	task_id_t id;
 	task_pri_t pri;
+	uint16_t budget;	/* max run time of one handler call (ms), 0: unchecked */
 	pf_task task;
 } task_t;
 
@@ -56,6 +65,14 @@ typedef struct {
 	uint32_t timestamp;
 } exception_info_t;
 
+#if defined(AK_TASK_STARVATION_ENABLE)
+typedef struct {
+	uint32_t starved;	/* number of starvation episodes detected */
+	uint32_t promoted;	/* number of messages served by aging policy */
+	uint32_t max_wait;	/* longest time a message waited in queue before served (ms) */
+} task_starvation_stat_t;
+#endif
+
 /* Extern variables ----------------------------------------------------------*/
 #if defined(AK_TASK_OBJ_LOG_ENABLE)
 extern log_queue_t Log_Task_Dbg_Obj_Queue;
@@ -84,6 +101,18 @@ extern task_id_t get_current_task_id(); /* Get current task id include interrupt
 extern task_t* get_current_task_info(); /* Get current task info */
 extern ak_msg_t* get_current_active_object(); /* Get current active object info (active message) */
 
+#if defined(AK_TASK_STARVATION_ENABLE)
+extern task_starvation_stat_t* task_starvation_stat(task_pri_t pri); /* pri: 1 .. TASK_PRI_MAX_SIZE */
+extern void task_starvation_stat_reset();
+#endif
+
+#if defined(AK_TASK_BUDGET_ENABLE)
+/* This function MUST-BE called from periodic hardware timer interrupt,
+ * pc is the program counter stacked by the interrupt entry.
+ */
+extern void task_budget_check(uint32_t pc);
+#endif
+
 extern void task_irq_io_entry_trigger(); /* This function MUST-BE redefine */
 extern void task_irq_io_exit_trigger() ; /* This function MUST-BE redefine */
 
@@ -23,6 +23,11 @@
 #include "sys_log.h"
 #include "sys_ctl.h"
 
+#if defined(AK_HEAP_OWNER_ENABLE)
+#include "task.h"
+#include "task_list.h"
+#endif
+
 #define TAG "Heap"
 
 //=================================================================//
@@ -37,6 +42,19 @@ static HeapRegionStruct_t HeapStructure;
 static BlockLink_t StartBLOCK;
 static BlockLink_t *pEndBLOCK = NULL;
 
+#if defined(AK_HEAP_OWNER_ENABLE)
+/* Owner slots: application tasks, then interrupt, idle (polling) and before scheduler */
+#define HEAP_OWNER_SLOT_INTERRUPT       ( SL_TASK_EOT_ID )
+#define HEAP_OWNER_SLOT_IDLE            ( SL_TASK_EOT_ID + 1 )
+#define HEAP_OWNER_SLOT_PRE_SCHEDULER   ( SL_TASK_EOT_ID + 2 )
+#define HEAP_OWNER_SLOTS                ( SL_TASK_EOT_ID + 3 )
+
+/* BLOCKs copied per critical section by heapWalk */
+#define HEAP_WALK_BATCH                 ( 8 )
+
+static HeapOwnerStat_t HeapOwner[HEAP_OWNER_SLOTS];
+#endif
+
 /* Private function prototypes -----------------------------------------------*/
 static void initHeap( void );
 static void expandFreeBlock(BlockLink_t *blockExpand);
@@ -44,8 +62,20 @@ static void linkBlockAddr(BlockLink_t *blockLink);
 static void linkFromStartBlock(BlockLink_t *pStartBlock, BlockLink_t *pInsertBlock);
 static void linkFromInsertBlock(BlockLink_t *pInsertBlock, BlockLink_t *pStartBlock);
 
+#if defined(AK_HEAP_OWNER_ENABLE)
+static uint8_t ownerToSlot(uint8_t owner);
+#endif
 
+
+#if defined(AK_HEAP_OWNER_ENABLE)
 void * PortMalloc(uint32_t byteAmount) {
+    return PortMallocTag(byteAmount, NULL);
+}
+
+void * PortMallocTag(uint32_t byteAmount, const char *tag) {
+#else
+void * PortMalloc(uint32_t byteAmount) {
+#endif
     BlockLink_t * pTraverseBlock, * pPrevBlock, * blockExpand;
     void * pvReturn = NULL;
     uint32_t totalByteAllocated = 0U;
@@ -61,6 +91,9 @@ void * PortMalloc(uint32_t byteAmount) {
     if (byteAmount == 0) {
         INVALID_VALUE_ALLOCATED();
     }
+
+    /* Keep every BLOCK word aligned, payload may be accessed as uint32_t */
+    byteAmount = (byteAmount + HEAP_BYTE_ALIGNMENT_MASK) & ~HEAP_BYTE_ALIGNMENT_MASK;
     
     /* FATAL if heap is overflow */
     if (HeapStructure.freeSize < totalByteAllocated) {
@@ -101,9 +134,25 @@ void * PortMalloc(uint32_t byteAmount) {
 
     pTraverseBlock->nextFreeBlock = NULL;
 
-    /* Update heap information */
-    HeapStructure.freeSize -= totalByteAllocated;
-    HeapStructure.usedSize += totalByteAllocated;
+    /* Update heap information, BLOCK is not split when remain is too small */
+    HeapStructure.freeSize -= pTraverseBlock->blockSize;
+    HeapStructure.usedSize += pTraverseBlock->blockSize;
+
+#if defined(AK_HEAP_OWNER_ENABLE)
+    {
+        HeapOwnerStat_t *pOwner;
+
+        pTraverseBlock->owner = get_current_task_id();
+        pTraverseBlock->tag = tag;
+
+        pOwner = &HeapOwner[ownerToSlot(pTraverseBlock->owner)];
+        pOwner->liveBytes += pTraverseBlock->blockSize;
+        pOwner->liveBlocks++;
+        if (pOwner->liveBytes > pOwner->peakBytes) {
+            pOwner->peakBytes = pOwner->liveBytes;
+        }
+    }
+#endif
 
     EXIT_CRITICAL();
 
@@ -131,6 +180,15 @@ void PortFree(void * pFree) {
     HeapStructure.freeSize += pFreeBlock->blockSize;
     HeapStructure.usedSize -= pFreeBlock->blockSize;
 
+#if defined(AK_HEAP_OWNER_ENABLE)
+    {
+        HeapOwnerStat_t *pOwner = &HeapOwner[ownerToSlot(pFreeBlock->owner)];
+
+        pOwner->liveBytes -= pFreeBlock->blockSize;
+        pOwner->liveBlocks--;
+    }
+#endif
+
     /* Expand free BLOCK list */
     linkBlockAddr(pFreeBlock);
 }
@@ -193,6 +251,90 @@ uint32_t getMinFreeBlockSize() {
     return minBlockSize;
 }
 
+#if defined(AK_HEAP_OWNER_ENABLE)
+uint8_t ownerToSlot(uint8_t owner) {
+    if (owner < SL_TASK_EOT_ID) {
+        return owner;
+    }
+    else if (owner == AK_TASK_INTERRUPT_ID) {
+        return HEAP_OWNER_SLOT_INTERRUPT;
+    }
+    else if (owner == AK_TASK_PRE_SCHEDULER_ID) {
+        return HEAP_OWNER_SLOT_PRE_SCHEDULER;
+    }
+
+    return HEAP_OWNER_SLOT_IDLE;
+}
+
+uint8_t getHeapOwnerSlots() {
+    return HEAP_OWNER_SLOTS;
+}
+
+uint8_t getHeapOwnerId(uint8_t slot) {
+    if (slot == HEAP_OWNER_SLOT_INTERRUPT) {
+        return AK_TASK_INTERRUPT_ID;
+    }
+    else if (slot == HEAP_OWNER_SLOT_IDLE) {
+        return AK_TASK_IDLE_ID;
+    }
+    else if (slot == HEAP_OWNER_SLOT_PRE_SCHEDULER) {
+        return AK_TASK_PRE_SCHEDULER_ID;
+    }
+
+    return slot;
+}
+
+HeapOwnerStat_t* getHeapOwnerStat(uint8_t slot) {
+    if (slot >= HEAP_OWNER_SLOTS) {
+        return NULL;
+    }
+
+    return &HeapOwner[slot];
+}
+
+void heapWalk(pfHeapWalk walk) {
+    BlockLink_t *pBlock;
+    BlockLink_t batch[HEAP_WALK_BATCH];
+    uint8_t *batchAddr[HEAP_WALK_BATCH];
+    uint8_t *pLast = NULL;
+    uint8_t batchLen;
+
+    if (pEndBLOCK == NULL) {
+        return;
+    }
+
+    /* headers are copied a batch at a time, callback runs with interrupts on.
+     * BLOCKs may be merged in between, each batch walks again from heap start */
+    do {
+        batchLen = 0;
+
+        ENTRY_CRITICAL();
+
+        /* BLOCKs are contiguous from heap start to pEndBLOCK, allocated one has no next free */
+        pBlock = (BlockLink_t *)HeapStructure.pointerStartAddress;
+        while (pBlock < pEndBLOCK && pBlock->blockSize != 0U && batchLen < HEAP_WALK_BATCH) {
+            if (pBlock->nextFreeBlock == NULL && (uint8_t *)pBlock > pLast) {
+                batch[batchLen] = *pBlock;
+                batchAddr[batchLen] = (uint8_t *)pBlock;
+                batchLen++;
+            }
+
+            pBlock = (BlockLink_t *)((uint8_t *)pBlock + pBlock->blockSize);
+        }
+
+        EXIT_CRITICAL();
+
+        for (uint8_t i = 0; i < batchLen; i++) {
+            walk(batchAddr[i] + BLOCK_LINK_STRUCT_SIZE, batch[i].blockSize, batch[i].owner, batch[i].tag);
+        }
+
+        if (batchLen > 0) {
+            pLast = batchAddr[batchLen - 1];
+        }
+    } while (batchLen == HEAP_WALK_BATCH);
+}
+#endif
+
 void initHeap() {
     BlockLink_t *firstBlockInit;
 
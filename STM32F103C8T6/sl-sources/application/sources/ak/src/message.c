@@ -14,6 +14,7 @@
 #include "message.h"
 #include "task.h"
 #include "heap.h"
+#include "utils.h"
 
 #include "sys_dbg.h"
 
@@ -127,10 +128,14 @@ void msg_dec_ref_count(ak_msg_t* msg) {
     }
 }
 
+#if defined(AK_HEAP_OWNER_ENABLE)
+void* ak_malloc_tag(size_t size, const char* tag) {
+#else
 void* ak_malloc(size_t size) {
+#endif
     static uint8_t* ak_heap = NULL;
 
-    ak_heap = PortMalloc(size);
+    ak_heap = HEAP_MALLOC(size, tag);
 
     if (ak_heap == NULL) {
         FATAL("ak_malloc", 0x01);
@@ -305,7 +310,7 @@ uint8_t set_data_common_msg(ak_msg_t* msg, uint8_t* data, uint8_t size) {
     }
 
     ((ak_msg_common_t*)msg)->len = size;
-    memcpy(((ak_msg_common_t*)msg)->data, data, size);
+    mem_cpy(((ak_msg_common_t*)msg)->data, data, size);
 
     return AK_MSG_OK;
 }
@@ -415,7 +420,7 @@ uint8_t set_data_dynamic_msg(ak_msg_t* msg, uint8_t* data, uint32_t size) {
 
     ((ak_msg_dynamic_t*)msg)->len = size;
     ((ak_msg_dynamic_t*)msg)->data = (uint8_t*)ak_malloc(size);
-    memcpy(((ak_msg_dynamic_t*)msg)->data, data, size);
+    mem_cpy(((ak_msg_dynamic_t*)msg)->data, data, size);
     return AK_MSG_OK;
 }
 
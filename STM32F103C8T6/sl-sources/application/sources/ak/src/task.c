@@ -29,6 +29,12 @@ typedef struct {
 	uint8_t     mask;
 	ak_msg_t*   qhead;
 	ak_msg_t*   qtail;
+#if defined(AK_TASK_STARVATION_ENABLE)
+	uint8_t     starved;
+#endif
+#if defined(AK_TASK_AGING_ENABLE)
+	uint32_t    promoted_at;	/* time of the last promotion */
+#endif
 } tcb_t;
 
 /* Private variables ---------------------------------------------------------*/
@@ -53,9 +59,24 @@ static uint8_t	task_ready = 0;
 static task_polling_t* task_polling_table = (task_polling_t*)0;
 static uint8_t	task_polling_table_size = 0;
 
+#if defined(AK_TASK_STARVATION_ENABLE)
+static task_starvation_stat_t task_starvation[TASK_PRI_MAX_SIZE];
+#endif
+
+#if defined(AK_TASK_BUDGET_ENABLE)
+static volatile uint8_t task_budget_running = 0;
+static volatile uint8_t task_budget_reported = 0;
+static volatile uint32_t task_budget_start;
+#endif
+
 /* Private function prototypes -----------------------------------------------*/
 static void task_sheduler();
 
+#if defined(AK_TASK_STARVATION_ENABLE)
+static uint8_t task_starvation_check(uint8_t task_top, uint8_t task_floor);
+static void task_starvation_served(tcb_t* t_tcb, ak_msg_t* t_msg);
+#endif
+
 /*---------------------------*/
 /* Function MUST-BE redefine */
 /*---------------------------*/
@@ -137,6 +158,10 @@ void task_post(task_id_t des_task_id, ak_msg_t* msg) {
 	}
 #endif
 
+#if defined(AK_TASK_STARVATION_ENABLE)
+	msg->post_at = AkCtl_Millis();
+#endif
+
 	if (t_tcb->qtail == AK_MSG_NULL) {
 		/* put message to queue */
 		t_tcb->qtail = msg;
@@ -144,6 +169,10 @@ void task_post(task_id_t des_task_id, ak_msg_t* msg) {
 
 		/* change status task to ready*/
 		task_ready |= t_tcb->mask;
+
+#if defined(AK_TASK_STARVATION_ENABLE)
+		t_tcb->starved = 0;
+#endif
 	}
 	else {
 		/* put message to queue */
@@ -273,9 +302,14 @@ int task_init() {
 	task_current = 0;
 	task_ready = 0;
 
+	/* no task is running until scheduler dispatches the first message */
+	current_task_id = AK_TASK_PRE_SCHEDULER_ID;
+	current_task_info.id = AK_TASK_PRE_SCHEDULER_ID;
+
 	/* init kernel queue */
 	for (pri = 1; pri <= TASK_PRI_MAX_SIZE; pri++) {
 		t_tcb = &task_pri_queue[pri - 1];
+		t_tcb->pri      = pri;
 		t_tcb->mask     = (1 << (pri - 1));
 		t_tcb->qhead    = AK_MSG_NULL;
 		t_tcb->qtail    = AK_MSG_NULL;
@@ -371,6 +405,10 @@ void task_sheduler() {
 	uint8_t t_task_current = task_current;
 
 	while ((t_task_new = LOG2LKUP(task_ready)) > t_task_current) {
+#if defined(AK_TASK_STARVATION_ENABLE)
+		t_task_new = task_starvation_check(t_task_new, t_task_current);
+#endif
+
 		/* get task */
 		tcb_t* t_tcb = &task_pri_queue[t_task_new - 1];
 
@@ -385,6 +423,10 @@ void task_sheduler() {
 			task_ready &= ~t_tcb->mask;
 		}
 
+#if defined(AK_TASK_STARVATION_ENABLE)
+		task_starvation_served(t_tcb, t_msg);
+#endif
+
 		/* Update current task */
 		task_current = t_task_new;
 
@@ -395,6 +437,12 @@ void task_sheduler() {
 		/* Update current task id NOTE: current task id will be change when entry interrupt handler */
 		current_task_id = t_msg->des_task_id;
 
+#if defined(AK_TASK_BUDGET_ENABLE)
+		task_budget_start = AkCtl_Millis();
+		task_budget_reported = 0;
+		task_budget_running = 1;
+#endif
+
 		EXIT_CRITICAL();
 		/*---------------------------------------------*/
 		/*		Task scheduler starts execution		   */
@@ -405,6 +453,10 @@ void task_sheduler() {
 		/*---------------------------------------------*/
 		ENTRY_CRITICAL();
 
+#if defined(AK_TASK_BUDGET_ENABLE)
+		task_budget_running = 0;
+#endif
+
 #if defined(AK_TASK_OBJ_LOG_ENABLE)
 		/* Reject msg of timer task */
 		if (current_active_object.des_task_id > 0) {
@@ -437,6 +489,111 @@ void task_sheduler() {
 	EXIT_CRITICAL();
 }
 
+#if defined(AK_TASK_STARVATION_ENABLE)
+/* Called in critical section.
+ * task_top is the highest ready priority, only ready priorities in
+ * (task_floor, task_top) can be starved by it. Return the priority to serve.
+ */
+uint8_t task_starvation_check(uint8_t task_top, uint8_t task_floor) {
+#if defined(AK_TASK_AGING_ENABLE)
+	uint8_t t_task_serve = task_top;
+	uint32_t t_oldest_wait = 0;
+#endif
+	uint32_t t_now = AkCtl_Millis();
+
+	for (uint8_t t_task = task_floor + 1; t_task < task_top; t_task++) {
+		tcb_t* t_tcb = &task_pri_queue[t_task - 1];
+
+		if (!(task_ready & t_tcb->mask)) {
+			continue;
+		}
+
+		/* queue head is the oldest pending message of the priority */
+		uint32_t t_wait = t_now - t_tcb->qhead->post_at;
+
+		if (t_wait < AK_TASK_STARVATION_BOUND) {
+			continue;
+		}
+
+		/* count one episode until the priority is served again */
+		if (!t_tcb->starved) {
+			t_tcb->starved = 1;
+			task_starvation[t_task - 1].starved++;
+		}
+
+#if defined(AK_TASK_AGING_ENABLE)
+		/* a priority can not be promoted more than once per bound */
+		if (t_wait > t_oldest_wait &&
+				t_now - t_tcb->promoted_at >= AK_TASK_STARVATION_BOUND) {
+			t_oldest_wait = t_wait;
+			t_task_serve = t_task;
+		}
+#endif
+	}
+
+#if defined(AK_TASK_AGING_ENABLE)
+	/* promote one message only */
+	if (t_task_serve != task_top) {
+		task_pri_queue[t_task_serve - 1].promoted_at = t_now;
+		task_starvation[t_task_serve - 1].promoted++;
+		return t_task_serve;
+	}
+#endif
+
+	return task_top;
+}
+
+/* Called in critical section, after t_msg was dequeued from t_tcb */
+void task_starvation_served(tcb_t* t_tcb, ak_msg_t* t_msg) {
+	uint32_t t_wait = AkCtl_Millis() - t_msg->post_at;
+	task_starvation_stat_t* t_stat = &task_starvation[t_tcb->pri - 1];
+
+	if (t_wait > t_stat->max_wait) {
+		t_stat->max_wait = t_wait;
+	}
+
+	/* next head starts a new episode, its age is kept in post_at */
+	t_tcb->starved = 0;
+}
+
+task_starvation_stat_t* task_starvation_stat(task_pri_t pri) {
+	if (pri == 0 || pri > TASK_PRI_MAX_SIZE) {
+		FATAL("TK", 0x08);
+	}
+
+	return &task_starvation[pri - 1];
+}
+
+void task_starvation_stat_reset() {
+	ENTRY_CRITICAL();
+	memset(task_starvation, 0, sizeof(task_starvation));
+	EXIT_CRITICAL();
+}
+#endif
+
+#if defined(AK_TASK_BUDGET_ENABLE)
+void task_budget_check(uint32_t pc) {
+	uint32_t t_run_time;
+
+	/* report once per handler call */
+	if (!task_budget_running || task_budget_reported || current_task_info.budget == 0) {
+		return;
+	}
+
+	t_run_time = AkCtl_Millis() - task_budget_start;
+
+	if (t_run_time > current_task_info.budget) {
+		task_budget_reported = 1;
+
+		overrunLogRecord(current_task_info.id, current_active_object.sig, pc, t_run_time, current_task_info.budget);
+
+#if defined(AK_TASK_BUDGET_ESCALATE)
+		FATAL("TK-BUDGET", current_task_info.id);
+#endif
+	}
+}
+#endif
+
 task_id_t task_self() {
 	return current_task_info.id;
 }
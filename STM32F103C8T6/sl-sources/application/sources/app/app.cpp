@@ -67,6 +67,9 @@ int main_app() {
 	/*					 Software configuration 						   */	 
 	/*---------------------------------------------------------------------*/
 	watchdogInit();	/* 32s */
+#if defined(AK_TASK_BUDGET_ENABLE)
+	taskBudgetTimerInit();
+#endif
 	
 	portClkOpen();
 	ADCsInit();
@@ -89,6 +92,7 @@ int main_app() {
 	/*							 System app setup						   */	
 	/*---------------------------------------------------------------------*/
 	fatalInit();
+	overrunLogInit();
 	sysBootInit();
 
 	/*---------------------------------------------------------------------*/
@@ -74,11 +74,8 @@ enum {
 
 /* Define signal */
 enum {
-    SL_IF_PURE_MSG_IN = AK_USER_DEFINE_SIG,
-    SL_IF_PURE_MSG_OUT,
-    SL_IF_COMMON_MSG_IN	,
+    SL_IF_PURE_MSG_OUT = AK_USER_DEFINE_SIG,
     SL_IF_COMMON_MSG_OUT,
-    SL_IF_DYNAMIC_MSG_IN,
     SL_IF_DYNAMIC_MSG_OUT
 };
 
@@ -94,9 +91,7 @@ enum {
     SL_CPU_SERIAL_IF_PURE_MSG_OUT,
     SL_CPU_SERIAL_IF_COMMON_MSG_OUT,
     SL_CPU_SERIAL_IF_DYNAMIC_MSG_OUT,
-    SL_CPU_SERIAL_IF_PURE_MSG_IN,
-    SL_CPU_SERIAL_IF_COMMON_MSG_IN,
-    SL_CPU_SERIAL_IF_DYNAMIC_MSG_IN,
+    SL_CPU_SERIAL_IF_LINK_READY,
 };
 
 /*----------------------------------------------------------------------------*
@@ -112,6 +107,7 @@ enum {
     SL_SYSTEM_KEEP_ALIVE = AK_USER_DEFINE_SIG,
     SL_SYSTEM_REBOOT_REQ,
     SL_SYSTEM_SYNC_INFO_REQ,
+    SL_SYSTEM_LINK_STAT_REQ,
 };
 
 /*----------------------------------------------------------------------------*
@@ -152,6 +148,9 @@ enum {
     SL_SM_MT_ENABLE_UPDATE_FIRMWARE_RES,
     SL_SM_MT_FIRWARE_OTA_FAILURE,
     SL_SM_FIRMWARE_OTA_TIMEOUT,
+
+    /* link takes messages again */
+    SL_SM_LINK_READY,
 };
 
 /*----------------------------------------------------------------------------*
@@ -196,13 +195,40 @@ typedef struct t_ManufactureDeviceReport {
     uint8_t status;
 } deviceInfoReport_t;
 
+typedef struct t_LinkStatReport {
+    struct {
+        uint32_t frameSent;
+        uint32_t frameRev;
+        uint32_t byteSent;
+        uint32_t byteRev;
+        uint32_t retransmit;
+        uint32_t fcsErr;
+        uint32_t revDrop;
+        uint32_t sendFail;
+    } phy;
+
+    struct {
+        uint32_t pduSent;
+        uint32_t pduErr;
+        uint32_t pduRev;
+        uint32_t revDrop;
+    } mac;
+
+    struct {
+        uint32_t msgSent;
+        uint32_t msgRev;
+        uint32_t msgOver;
+        uint32_t revErr;
+    } link;
+} linkStatReport_t;
+
 typedef struct t_SensorsStatusReport {
 
 } SensorSttRep_t;
 
 typedef struct t_DevReport {
 
-} SensorSttRep_t;
+} DevReport_t;
 
 /* Function prototypes -------------------------------------------------------*/
 extern int main_app();
@@ -13,11 +13,8 @@
 
 /* Define signal */
 enum {
-    MT_CPU_SERIAL_IF_PURE_MSG_IN = AK_USER_DEFINE_SIG,
-    MT_CPU_SERIAL_IF_PURE_MSG_OUT,
-    MT_CPU_SERIAL_IF_COMMON_MSG_IN,
+    MT_CPU_SERIAL_IF_PURE_MSG_OUT = AK_USER_DEFINE_SIG,
     MT_CPU_SERIAL_IF_COMMON_MSG_OUT,
-    MT_CPU_SERIAL_IF_DYNAMIC_MSG_IN,
     MT_CPU_SERIAL_IF_DYNAMIC_MSG_OUT,
 };
 
@@ -29,11 +26,8 @@ enum {
 
 /* Define signal */
 enum {
-    MT_IF_PURE_MSG_IN = AK_USER_DEFINE_SIG,
-    MT_IF_PURE_MSG_OUT,
-    MT_IF_COMMON_MSG_IN,
+    MT_IF_PURE_MSG_OUT = AK_USER_DEFINE_SIG,
     MT_IF_COMMON_MSG_OUT,
-    MT_IF_DYNAMIC_MSG_IN,
     MT_IF_DYNAMIC_MSG_OUT
 };
 
@@ -11,6 +11,7 @@
 #include "app_dbg.h"
 #include "task_list.h"
 #include "task_cpu_serial_if.h"
+#include "task_list_if.h"
 
 #include "platform.h"
 #include "io_cfg.h"
@@ -29,16 +30,18 @@
 /* Extern variables ----------------------------------------------------------*/
 extern ringBufferChar_t cpuSeriIfBufferReceived;
 
-/*---------------------------------*/
-/* Portable link put byte function */
-/* 			"link_phy.h"		   */
-/*---------------------------------*/
-extern void (*link_put_c)(uint8_t);
+/* Private function prototypes -----------------------------------------------*/
+static void cpuSerialIfWriteBlock(uint8_t* data, uint32_t len);
 
 /* Private variables ---------------------------------------------------------*/
+/* link_hal transport over cpu serial interface */
+static const link_hal_transport_t cpuSerialIfTransport = {
+	"uart",
+	cpuSerialIfWriteBlock
+};
 
-
-/* Private function prototypes -----------------------------------------------*/
+/* messages kept while link is full */
+static link_send_q_t cpuSerialIfLinkSendQ = { AK_MSG_NULL, AK_MSG_NULL, SL_TASK_CPU_SERIAL_IF_ID, SL_CPU_SERIAL_IF_LINK_READY };
 
 
 /* Function implementation ---------------------------------------------------*/
@@ -50,9 +53,10 @@ void TaskCpuSerialIf(ak_msg_t* msg) {
 								
 		task_polling_set_ability(SL_TASK_POLL_CPU_SERIAL_ID, AK_ENABLE);
 		cpuSerialIfInit();
-		link_put_c = putCpuSerialIfData;
+		link_hal_reg_transport(&cpuSerialIfTransport);
 		
 		link_init_state_machine();
+		link_route_set(IF_TYPE_CPU_SERIAL_MT, MT_TASK_SM_ID, LINK_CHANNEL_DEFAULT);
 		task_post_pure_msg(SL_LINK_ID, AC_LINK_INIT);
 	}
 	break;
@@ -62,7 +66,7 @@ void TaskCpuSerialIf(ak_msg_t* msg) {
 
 		msg_inc_ref_count(msg);
 		set_msg_sig(msg, AC_LINK_SEND_PURE_MSG);
-		task_post(SL_LINK_ID, msg);
+		link_send_q_post(&cpuSerialIfLinkSendQ, msg);
 	}
 	break;
 
@@ -71,7 +75,7 @@ void TaskCpuSerialIf(ak_msg_t* msg) {
 
 		msg_inc_ref_count(msg);
 		set_msg_sig(msg, AC_LINK_SEND_COMMON_MSG);
-		task_post(SL_LINK_ID, msg);
+		link_send_q_post(&cpuSerialIfLinkSendQ, msg);
 	}
 	break;
 
@@ -80,34 +84,13 @@ void TaskCpuSerialIf(ak_msg_t* msg) {
 
 		msg_inc_ref_count(msg);
 		set_msg_sig(msg, AC_LINK_SEND_DYNAMIC_MSG);
-		task_post(SL_LINK_ID, msg);
-	}
-	break;
-
-	case SL_CPU_SERIAL_IF_PURE_MSG_IN: {
-		DBG_LINK_PRINT(TAG, "SL_CPU_SERIAL_IF_PURE_MSG_IN");
-
-		msg_inc_ref_count(msg);
-		set_msg_sig(msg, SL_IF_PURE_MSG_IN);
-		task_post(SL_TASK_IF_ID, msg);
+		link_send_q_post(&cpuSerialIfLinkSendQ, msg);
 	}
 	break;
 
-	case SL_CPU_SERIAL_IF_COMMON_MSG_IN: {
-		DBG_LINK_PRINT(TAG, "SL_CPU_SERIAL_IF_COMMON_MSG_IN");
-
-		msg_inc_ref_count(msg);
-		set_msg_sig(msg, SL_IF_COMMON_MSG_IN);
-		task_post(SL_TASK_IF_ID, msg);
-	}
-	break;
-
-	case SL_CPU_SERIAL_IF_DYNAMIC_MSG_IN: {
-		DBG_LINK_PRINT(TAG, "SL_CPU_SERIAL_IF_DYNAMIC_MSG_IN");
-
-		msg_inc_ref_count(msg);
-		set_msg_sig(msg, SL_IF_DYNAMIC_MSG_IN);
-		task_post(SL_TASK_IF_ID, msg);
+	case SL_CPU_SERIAL_IF_LINK_READY: {
+		DBG_LINK_PRINT(TAG, "SL_CPU_SERIAL_IF_LINK_READY");
+		link_send_q_flush(&cpuSerialIfLinkSendQ);
 	}
 	break;
 
@@ -118,13 +101,29 @@ void TaskCpuSerialIf(ak_msg_t* msg) {
 
 /*----------------------------------------------------------------------------*/
 void TaskPollCpuSerialIf() {
-	uint8_t data = 0;
-
-    while (!isRingBufferCharEmpty(&cpuSeriIfBufferReceived)) {
-        ENTRY_CRITICAL();
-        data = ringBufferCharGet(&cpuSeriIfBufferReceived);
-        EXIT_CRITICAL();
+	uint8_t* data;
+	uint16_t len;
+
+	/* parser reads the ring in place, bytes are released after it. A wrapped
+	 * fill is two spans, an overrun while parsing loses bytes either way */
+	for (uint8_t i = 0; i < 2; i++) {
+		ENTRY_CRITICAL();
+		len = ringBufferCharSpan(&cpuSeriIfBufferReceived, &data);
+		EXIT_CRITICAL();
+
+		if (len == 0) {
+			break;
+		}
+		link_hal_rev_block(data, len);
+
+		ENTRY_CRITICAL();
+		ringBufferCharSkip(&cpuSeriIfBufferReceived, len);
+		EXIT_CRITICAL();
+	}
+}
 
-        plink_hal_rev_byte(data);
-    }
+void cpuSerialIfWriteBlock(uint8_t* data, uint32_t len) {
+	while (len--) {
+		putCpuSerialIfData(*(data++));
+	}
 }
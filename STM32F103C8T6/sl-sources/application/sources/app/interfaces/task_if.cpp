@@ -27,36 +27,6 @@ void TaskIf(ak_msg_t* msg) {
 		msg->if_des_type == IF_TYPE_CPU_SERIAL_SL)
 	{	
 		switch (msg->sig) {
-		case SL_IF_PURE_MSG_IN:	{
-			DBG_LINK_PRINT(TAG, "SL_IF_PURE_MSG_IN");
-
-			msg_inc_ref_count(msg);
-			set_msg_sig(msg, msg->if_sig);
-			set_msg_src_task_id(msg, msg->if_src_task_id);
-			task_post(msg->if_des_task_id, msg);
-		}
-		break;
-
-		case SL_IF_COMMON_MSG_IN: {
-			DBG_LINK_PRINT(TAG, "SL_IF_COMMON_MSG_IN");
-
-			msg_inc_ref_count(msg);
-			set_msg_sig(msg, msg->if_sig);
-			set_msg_src_task_id(msg, msg->if_src_task_id);
-			task_post(msg->if_des_task_id, msg);
-		}
-		break;
-
-		case SL_IF_DYNAMIC_MSG_IN: {
-			DBG_LINK_PRINT(TAG, "SL_IF_DYNAMIC_MSG_IN");
-
-			msg_inc_ref_count(msg);
-			set_msg_sig(msg, msg->if_sig);
-			set_msg_src_task_id(msg, msg->if_src_task_id);
-			task_post(msg->if_des_task_id, msg);
-		}
-		break;
-
 		case SL_IF_PURE_MSG_OUT: {
 			DBG_LINK_PRINT(TAG, "SL_IF_PURE_MSG_OUT");
 
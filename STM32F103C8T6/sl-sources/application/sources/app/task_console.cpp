@@ -7,6 +7,8 @@
 #include "timer.h"
 
 #include "cmd_line.h"
+#include "utils.h"
+#include "crc16.h"
 #include "ring_buffer.h"
 
 #include "app.h"
@@ -17,6 +19,10 @@
 #include "task_list.h"
 #include "task_console.h"
 
+#include "link.h"
+#include "link_mac.h"
+#include "link_phy.h"
+
 #include "platform.h"
 #include "io_cfg.h"
 #include "sys_cfg.h"
@@ -36,6 +42,11 @@ static int8_t csHelp(uint8_t* argv);
 static int8_t csRst(uint8_t* argv);
 static int8_t csFatal(uint8_t* argv);
 static int8_t csDev(uint8_t* argv);
+static int8_t csBench(uint8_t* argv);
+static int8_t csLink(uint8_t* argv);
+#if defined(AK_HEAP_OWNER_ENABLE)
+static int8_t csHeap(uint8_t* argv);
+#endif
 
 static cmdLineStruct_t lgnCmdTable[] = {
 	/*------------------------------------------------------------------------------*/
@@ -46,6 +57,11 @@ static cmdLineStruct_t lgnCmdTable[] = {
 	{(const int8_t*)"rst",		csRst,		(const int8_t*)"Reset system"			},
 	{(const int8_t*)"fatal"	,	csFatal,	(const int8_t*)"Fatal information"		},
 	{(const int8_t*)"dev"	,	csDev,		(const int8_t*)"Devices manager" 		},
+	{(const int8_t*)"bench"	,	csBench,	(const int8_t*)"Benchmark memory and checksum routines"	},
+	{(const int8_t*)"link"	,	csLink,		(const int8_t*)"Link layers statistics"	},
+#if defined(AK_HEAP_OWNER_ENABLE)
+	{(const int8_t*)"heap"	,	csHeap,		(const int8_t*)"Heap usage by owner"	},
+#endif
 	/*------------------------------------------------------------------------------*/
 	/*									End of table								*/
 	/*------------------------------------------------------------------------------*/
@@ -122,6 +138,20 @@ int8_t csInfo(uint8_t* argv) {
 			APP_PRINT("[BOOT] Cs: 0x%X, len: %d\n", sysBootRead->bootCurrent.fCs, sysBootRead->bootCurrent.binLen);
 			APP_PRINT("[APP] Cs: 0x%X, len: %d\n", sysBootRead->appCurrent.fCs, sysBootRead->appCurrent.binLen);
 		}
+#if defined(AK_TASK_STARVATION_ENABLE)
+		else if (strcmp((const char*)cmdLineGetAttr(1), (const char*)"starv") == 0) {
+			APP_PRINT("\n[STARVATION] bound: %d ms\n", AK_TASK_STARVATION_BOUND);
+			APP_PRINT("PRI\tSTARVED\tPROMOTED\tMAX WAIT(ms)\n");
+			for (uint8_t pri = 1; pri <= TASK_PRI_MAX_SIZE; pri++) {
+				task_starvation_stat_t* stat = task_starvation_stat(pri);
+				APP_PRINT("%d\t%d\t%d\t\t%d\n", pri, stat->starved, stat->promoted, stat->max_wait);
+			}
+		}
+		else if (strcmp((const char*)cmdLineGetAttr(1), (const char*)"starv-clr") == 0) {
+			task_starvation_stat_reset();
+			APP_PRINT("Starvation counters cleared\n");
+		}
+#endif
 	}
 	break;
 
@@ -202,13 +232,33 @@ int8_t csFatal(uint8_t* argv) {
 	}
 	break;
 
+	case 'o': {
+		overrunLog_t *overrunLogCs = overrunLogRead();
+
+		APP_PRINT("\r\n");
+		APP_PRINT("[TIMES] OVERRUN: %d\r\n", overrunLogCs->overrunTimes);
+		APP_PRINT("[OVERRUN] TASK: %d, SIG: %d\r\n", overrunLogCs->taskId, overrunLogCs->sig);
+		APP_PRINT("[OVERRUN] PC: 0x%08X\r\n", overrunLogCs->pc);
+		APP_PRINT("[OVERRUN] RUN: %d ms, BUDGET: %d ms\r\n", overrunLogCs->runTime, overrunLogCs->budget);
+		APP_PRINT("\n");
+	}
+	break;
+
+	case 'c': {
+		overrunLogClear();
+		APP_PRINT("Overrun clear\n");
+	}
+	break;
+
 	default: {
 		APP_PRINT("\n<Fatal commands>\n");
 		APP_PRINT("Usage:\n");
 		APP_PRINT("  fatal [options]\n");
 		APP_PRINT("Options:\n");
 		APP_PRINT("  l: Fatal log\n");
-		APP_PRINT("  r: Fatal clear\n\n");
+		APP_PRINT("  r: Fatal clear\n");
+		APP_PRINT("  o: Task budget overrun log\n");
+		APP_PRINT("  c: Overrun clear\n\n");
 	}
 	break;
 	}
@@ -281,4 +331,197 @@ int8_t csDev(uint8_t* argv) {
 	}
 
 	return 0;
-}
\ No newline at end of file
+}
+
+int8_t csLink(uint8_t* argv) {
+	(void)argv;
+
+	link_phy_stat_t phyStat;
+	link_mac_stat_t macStat;
+	link_stat_t linkStat;
+	link_channel_stat_t channelStat;
+
+	link_phy_get_stat(&phyStat);
+	link_mac_get_stat(&macStat);
+	link_get_stat(&linkStat);
+
+	APP_PRINT("\r\n");
+	APP_PRINT("[PHY] SENT: %d frames, %d bytes\r\n", phyStat.frame_sent, phyStat.byte_sent);
+	APP_PRINT("[PHY] REV: %d frames, %d bytes\r\n", phyStat.frame_rev, phyStat.byte_rev);
+	APP_PRINT("[PHY] RETRANSMIT: %d, FAST: %d, FAIL: %d\r\n", phyStat.retransmit, phyStat.fast_retransmit, phyStat.send_fail);
+	APP_PRINT("[PHY] FCS ERR: %d, REV TO: %d, REV DROP: %d\r\n", phyStat.fcs_err, phyStat.rev_to, phyStat.rev_drop);
+	APP_PRINT("[PHY] RTT: %d ms, RTO: %d ms, WINDOW: %d, CAPS: 0x%02X\r\n", phyStat.srtt, phyStat.rto, phyStat.window_size, phyStat.caps);
+	APP_PRINT("[PHY] FEC PARITY: %d, FIXED: %d frames, %d bytes\r\n", phyStat.fec_parity, phyStat.fec_fixed, phyStat.fec_byte);
+#if (LINK_PHY_MULTI_DROP == 1)
+	APP_PRINT("[PHY] ADDR: 0x%08X, TURNS: %d, FOREIGN: %d\r\n", link_phy_addr_get(), phyStat.poll, phyStat.rev_foreign);
+#endif
+
+	APP_PRINT("\r\n");
+	APP_PRINT("[MAC] SENT: %d, ERR: %d, RETRY: %d, CREDIT BLOCK: %d\r\n", macStat.pdu_sent, macStat.pdu_err, macStat.pdu_retry, macStat.credit_block);
+	APP_PRINT("[MAC] REV: %d, REV TO: %d, REV DROP: %d\r\n", macStat.pdu_rev, macStat.rev_to, macStat.rev_drop);
+
+	APP_PRINT("\r\n");
+	APP_PRINT("[LINK] SENT: %d, REV: %d, REV ERR: %d, OVER: %d\r\n", linkStat.msg_sent, linkStat.msg_rev, linkStat.rev_err, link_send_over_get());
+	APP_PRINT("[LINK] AGGREGATE: %d, LZ: %d, LZ SAVED: %d bytes\r\n", linkStat.agg_pdu, linkStat.lz_pdu, linkStat.lz_saved);
+
+	for (uint8_t channel = 0; channel < LINK_CHANNEL_NUM; channel++) {
+		link_get_channel_stat(channel, &channelStat);
+		APP_PRINT("[LINK] CHANNEL[%d] SENT: %d, ERR: %d, OVER: %d, HOLD: %d\r\n", channel, channelStat.sent, channelStat.err, channelStat.over, channelStat.hold);
+	}
+	APP_PRINT("\n");
+
+	return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+static void* benchByteCpy(void *dst, const void *src, size_t size) {
+	const volatile uint8_t *ptr = (const volatile uint8_t *)src;
+	volatile uint8_t *ptr2 = (volatile uint8_t *)dst;
+	while (size--) {
+		*ptr2++ = *ptr++;
+	}
+	return dst;
+}
+
+static uint8_t benchXor8(const uint8_t *data, size_t size) {
+	uint8_t sum = 0;
+	while (size--) {
+		sum ^= *data++;
+	}
+	return sum;
+}
+
+int8_t csBench(uint8_t* argv) {
+	(void)argv;
+
+	static const uint16_t sizes[] = { 4, 16, 64, 256 };
+	static uint32_t benchSrc[(256 + 4) / sizeof(uint32_t)];
+	static uint32_t benchDst[(256 + 4) / sizeof(uint32_t)];
+	uint8_t *src = (uint8_t *)benchSrc;
+	uint8_t *dst = (uint8_t *)benchDst;
+	uint32_t start, byteLoop, memcpyLib, memCpy, memCpyMis, memSet, memCmp;
+
+	cycleCounterEnable();
+
+	APP_PRINT("\n[BENCH] cycles\n");
+	APP_PRINT("SIZE\tBYTE\tmemcpy\tmem_cpy\tmem_cpy(+1)\tmem_set\tmem_cmp\n");
+
+	for (uint8_t id = 0; id < sizeof(sizes) / sizeof(sizes[0]); ++id) {
+		size_t len = sizes[id];
+
+		ENTRY_CRITICAL();
+
+		start = cycleCounterGet();
+		benchByteCpy(dst, src, len);
+		byteLoop = cycleCounterGet() - start;
+
+		start = cycleCounterGet();
+		memcpy(dst, src, len);
+		memcpyLib = cycleCounterGet() - start;
+
+		start = cycleCounterGet();
+		mem_cpy(dst, src, len);
+		memCpy = cycleCounterGet() - start;
+
+		start = cycleCounterGet();
+		mem_cpy(dst + 1, src + 1, len);
+		memCpyMis = cycleCounterGet() - start;
+
+		start = cycleCounterGet();
+		mem_set(dst, 0x5A, len);
+		memSet = cycleCounterGet() - start;
+
+		mem_cpy(src, dst, len);
+		start = cycleCounterGet();
+		mem_cmp(dst, src, len);
+		memCmp = cycleCounterGet() - start;
+
+		EXIT_CRITICAL();
+
+		APP_PRINT("%d\t%d\t%d\t%d\t%d\t\t%d\t%d\n", len, byteLoop, memcpyLib, memCpy, memCpyMis, memSet, memCmp);
+	}
+
+	/* link frame check candidates, results are kept so the calls are not removed */
+	volatile uint16_t benchSink;
+	uint32_t xor8, crc16;
+#if defined(CRC16_SLICE_BY_4)
+	uint32_t crc16s4;
+	APP_PRINT("\nSIZE\txor8\tcrc16\tcrc16(s4)\n");
+#else
+	APP_PRINT("\nSIZE\txor8\tcrc16\n");
+#endif
+
+	for (uint8_t id = 0; id < sizeof(sizes) / sizeof(sizes[0]); ++id) {
+		size_t len = sizes[id];
+
+		ENTRY_CRITICAL();
+
+		start = cycleCounterGet();
+		benchSink = benchXor8(src, len);
+		xor8 = cycleCounterGet() - start;
+
+		start = cycleCounterGet();
+		benchSink = crc16_ccitt(CRC16_CCITT_INIT, src, len);
+		crc16 = cycleCounterGet() - start;
+
+#if defined(CRC16_SLICE_BY_4)
+		start = cycleCounterGet();
+		benchSink = crc16_ccitt_s4(CRC16_CCITT_INIT, src, len);
+		crc16s4 = cycleCounterGet() - start;
+#endif
+
+		EXIT_CRITICAL();
+
+#if defined(CRC16_SLICE_BY_4)
+		APP_PRINT("%d\t%d\t%d\t%d\n", len, xor8, crc16, crc16s4);
+#else
+		APP_PRINT("%d\t%d\t%d\n", len, xor8, crc16);
+#endif
+	}
+	(void)benchSink;
+
+	return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+#if defined(AK_HEAP_OWNER_ENABLE)
+static uint8_t heapWalkOwner;
+
+static void heapWalkPrint(void *addr, uint32_t size, uint8_t owner, const char *tag) {
+	if (owner == heapWalkOwner) {
+		APP_PRINT("\t0x%08X\t%d\t%s\n", (uint32_t)(uintptr_t)addr, size, tag ? tag : "-");
+	}
+}
+
+int8_t csHeap(uint8_t* argv) {
+	(void)argv;
+
+	APP_PRINT("\n[HEAP] Size: %d, used: %d, free: %d\n", getTotalHeapSize(), getTotalHeapUsed(),  getTotalHeapFree());
+	APP_PRINT("OWNER\tLIVE\tBLOCKS\tPEAK\n");
+
+	for (uint8_t slot = 0; slot < getHeapOwnerSlots(); slot++) {
+		HeapOwnerStat_t* stat = getHeapOwnerStat(slot);
+
+		if (stat->peakBytes == 0) {
+			continue;
+		}
+
+		APP_PRINT("0x%02X\t%d\t%d\t%d\n", getHeapOwnerId(slot), stat->liveBytes, stat->liveBlocks, stat->peakBytes);
+	}
+
+	/* heap walk: outstanding BLOCKs grouped by owner */
+	if (getCmdLineParserCounter() == 1 && strcmp((const char*)cmdLineGetAttr(1), (const char*)"walk") == 0) {
+		for (uint8_t slot = 0; slot < getHeapOwnerSlots(); slot++) {
+			if (getHeapOwnerStat(slot)->liveBlocks == 0) {
+				continue;
+			}
+
+			heapWalkOwner = getHeapOwnerId(slot);
+			APP_PRINT("\nOWNER 0x%02X\n", heapWalkOwner);
+			heapWalk(heapWalkPrint);
+		}
+	}
+
+	return 0;
+}
+#endif
@@ -2,6 +2,7 @@
 
 #include "ak.h"
 #include "message.h"
+#include "message.hpp"
 #include "timer.h"
 #include "fsm.h"
 
@@ -108,7 +109,7 @@ void TaskFirmware(ak_msg_t* msg) {
 		APP_DBG(TAG, "Len: %d", firmwareReport.binLen);
 
 		/* Report to master application */
-		task_post_common_msg(SL_TASK_SM_ID, SL_SM_MT_FRIWMARE_OTA_RES, (uint8_t *)&firmwareReport, sizeof(firmwareHeader_t));
+		post(SL_TASK_SM_ID, SL_SM_MT_FRIWMARE_OTA_RES, firmwareReport);
 	}
 	break;
 
@@ -2,34 +2,35 @@
 #include "timer.h"
 
 /* Extern variables ------------------------------------------------------------*/
+/* id, priority, run-time budget (ms, 0: unchecked), handler */
 const task_t app_task_table[] = {
 	/*--------------------------------------------------------------------------*/
 	/*                              SYSTEM TASK                                 */
 	/*--------------------------------------------------------------------------*/
-	{SL_TASK_TIMER_TICK_ID		,	TASK_PRI_LEVEL_7	,	task_timer_tick		},
+	{SL_TASK_TIMER_TICK_ID		,	TASK_PRI_LEVEL_7	,	20	,	task_timer_tick		},
 
 	/*--------------------------------------------------------------------------*/
 	/*                              APP TASK                                    */
 	/*--------------------------------------------------------------------------*/
-	{SL_TASK_CONSOLE_ID			,	TASK_PRI_LEVEL_3	,	TaskConsole			},
-	{SL_TASK_SYSTEM_ID			,	TASK_PRI_LEVEL_6	,	TaskSystem			},
-	{SL_TASK_SM_ID				,	TASK_PRI_LEVEL_3	,	TaskSm				},
-	{SL_TASK_IF_ID				,	TASK_PRI_LEVEL_4	,	TaskIf				},
-	{SL_TASK_CPU_SERIAL_IF_ID	,	TASK_PRI_LEVEL_4	,	TaskCpuSerialIf		},
-	{SL_TASK_FIRMWARE_ID		,	TASK_PRI_LEVEL_2	,	TaskFirmware		},
-	{SL_TASK_DEVICE_MANAGER_ID	,	TASK_PRI_LEVEL_4	,	TaskDevManager		},
+	{SL_TASK_CONSOLE_ID			,	TASK_PRI_LEVEL_3	,	500	,	TaskConsole			},
+	{SL_TASK_SYSTEM_ID			,	TASK_PRI_LEVEL_6	,	50	,	TaskSystem			},
+	{SL_TASK_SM_ID				,	TASK_PRI_LEVEL_3	,	50	,	TaskSm				},
+	{SL_TASK_IF_ID				,	TASK_PRI_LEVEL_4	,	50	,	TaskIf				},
+	{SL_TASK_CPU_SERIAL_IF_ID	,	TASK_PRI_LEVEL_4	,	50	,	TaskCpuSerialIf		},
+	{SL_TASK_FIRMWARE_ID		,	TASK_PRI_LEVEL_2	,	0	,	TaskFirmware		},
+	{SL_TASK_DEVICE_MANAGER_ID	,	TASK_PRI_LEVEL_4	,	100	,	TaskDevManager		},
 
 	/*--------------------------------------------------------------------------*/
 	/*                             LINK TASK                                    */
 	/*--------------------------------------------------------------------------*/
-	{SL_LINK_PHY_ID				,	TASK_PRI_LEVEL_3	,	TaskLinkPhy			},
-	{SL_LINK_MAC_ID				,	TASK_PRI_LEVEL_4	,	TaskLinkMac			},
-	{SL_LINK_ID					,	TASK_PRI_LEVEL_5	,	TaskLink			},
+	{SL_LINK_PHY_ID				,	TASK_PRI_LEVEL_3	,	50	,	TaskLinkPhy			},
+	{SL_LINK_MAC_ID				,	TASK_PRI_LEVEL_4	,	50	,	TaskLinkMac			},
+	{SL_LINK_ID					,	TASK_PRI_LEVEL_5	,	50	,	TaskLink			},
 
 	/*--------------------------------------------------------------------------*/
 	/*                            END OF TABLE                                  */
 	/*--------------------------------------------------------------------------*/
-	{SL_TASK_EOT_ID				,	TASK_PRI_LEVEL_0	,	(pf_task)0			}
+	{SL_TASK_EOT_ID				,	TASK_PRI_LEVEL_0	,	0	,	(pf_task)0			}
 };
 
 task_polling_t app_task_polling_table[] = {
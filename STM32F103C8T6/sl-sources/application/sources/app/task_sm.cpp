@@ -17,6 +17,8 @@
 #include "app_if.h"
 #include "task_list_if.h"
 
+#include "link.h"
+
 #include "platform.h"
 #include "io_cfg.h"
 #include "sys_cfg.h"
@@ -59,6 +61,8 @@ static void slSmMtEnableUpdateFirwmareRes(ak_msg_t *msg);
 static void slSmMtFirmwareOtaFailure(ak_msg_t *msg);
 static void slSmFirmwareOtaTimeout(ak_msg_t *msg);
 
+static void slSmLinkReady(ak_msg_t *msg);
+
 static void forwardOutside(uint8_t eId, uint8_t eSig, ak_msg_t *msg);
 static void forwardInside(uint8_t iId, uint8_t iSig, ak_msg_t *msg);
 
@@ -84,6 +88,9 @@ static tsm_t idleStatusTbl[] = {
     { SL_SM_MT_START_FRIMWARE_TRANSF_REQ,	SM_IDLE,        slSmMtStartFirmwareTransfReq    },
     { SL_SM_MT_START_FRIMWARE_TRANSF_RES,	SM_OTA,         slSmMtStartFirmwareTransfRes    },
 
+    /* LINK */
+    { SL_SM_LINK_READY,	                    SM_IDLE,        slSmLinkReady                   },
+
     /* END */
     { SL_SM_END_OF_TABLE,	                SM_IDLE,        TSM_FUNCTION_NULL               },
 };
@@ -109,6 +116,9 @@ static tsm_t otaStatusTbl[] = {
     { SL_SM_MT_FIRWARE_OTA_FAILURE,	            SM_IDLE,    slSmMtFirmwareOtaFailure        },
     { SL_SM_FIRMWARE_OTA_TIMEOUT,	            SM_IDLE,    slSmFirmwareOtaTimeout          },
 
+    /* LINK */
+    { SL_SM_LINK_READY,	                        SM_OTA,     slSmLinkReady                   },
+
     /* END */
     { SL_SM_END_OF_TABLE,	                    SM_OTA,     TSM_FUNCTION_NULL               },
 };
@@ -124,6 +134,9 @@ tsm_t* slStateMachineTbl[] = {
 
 static uint8_t otaTimeoutCtrl = OTA_TIM_UNK;
 
+/* routed messages kept while link is full */
+static link_send_q_t smLinkSendQ = { AK_MSG_NULL, AK_MSG_NULL, SL_TASK_SM_ID, SL_SM_LINK_READY };
+
 static void setOtaTimStatus(uint8_t state) {
     otaTimeoutCtrl = state;
 }
@@ -284,6 +297,13 @@ void slSmFirmwareOtaTimeout(ak_msg_t *msg) {
     APP_DBG_SIG(TAG, "SL_SM_FIRMWARE_OTA_TIMEOUT");
 }
 
+/* Groups functions link -------------------------------------------------------*/
+void slSmLinkReady(ak_msg_t *msg) {
+    APP_DBG_SIG(TAG, "SL_SM_LINK_READY");
+    (void)msg;
+    link_send_q_flush(&smLinkSendQ);
+}
+
 /* Private functions -----------------------------------------------------------*/
 void forwardOutside(uint8_t mtId, uint8_t mtSig, ak_msg_t *msg) {
     msg_inc_ref_count(msg);
@@ -294,6 +314,11 @@ void forwardOutside(uint8_t mtId, uint8_t mtSig, ak_msg_t *msg) {
     set_if_sig(msg, mtSig);
     set_msg_src_task_id(msg, SL_TASK_SM_ID);
 
+    /* routed destination skips the interface tasks, kept in order while link is full */
+    if (link_route_post(&smLinkSendQ, msg) != LINK_ROUTE_NONE) {
+        return;
+    }
+
     switch (get_msg_type(msg)) {
     case PURE_MSG_TYPE: {
         set_msg_sig(msg, SL_IF_PURE_MSG_OUT);
@@ -13,6 +13,11 @@
 #include "task_list.h"
 #include "task_system.h"
 
+#include "link.h"
+#include "link_mac.h"
+#include "link_phy.h"
+#include "link_rpc.h"
+
 #include "platform.h"
 #include "io_cfg.h"
 #include "sys_cfg.h"
@@ -26,6 +31,7 @@
 extern deviceInfoReport_t manufactureInfo;
 
 /* Private variables ---------------------------------------------------------*/
+static_assert(sizeof(linkStatReport_t) <= AK_COMMON_MSG_DATA_SIZE, "link stat report does not fit a common message");
 
 /* Private function prototypes -----------------------------------------------*/
 
@@ -53,6 +59,39 @@ void TaskSystem(ak_msg_t* msg) {
 	}
 	break;
 
+	case SL_SYSTEM_LINK_STAT_REQ: {
+		APP_DBG_SIG(TAG, "SL_SYSTEM_LINK_STAT_REQ");
+
+		link_phy_stat_t phyStat;
+		link_mac_stat_t macStat;
+		link_stat_t linkStat;
+		linkStatReport_t linkStatReport;
+
+		link_phy_get_stat(&phyStat);
+		link_mac_get_stat(&macStat);
+		link_get_stat(&linkStat);
+
+		linkStatReport.phy.frameSent = phyStat.frame_sent;
+		linkStatReport.phy.frameRev = phyStat.frame_rev;
+		linkStatReport.phy.byteSent = phyStat.byte_sent;
+		linkStatReport.phy.byteRev = phyStat.byte_rev;
+		linkStatReport.phy.retransmit = phyStat.retransmit + phyStat.fast_retransmit;
+		linkStatReport.phy.fcsErr = phyStat.fcs_err;
+		linkStatReport.phy.revDrop = phyStat.rev_drop + phyStat.rev_to;
+		linkStatReport.phy.sendFail = phyStat.send_fail;
+		linkStatReport.mac.pduSent = macStat.pdu_sent;
+		linkStatReport.mac.pduErr = macStat.pdu_err;
+		linkStatReport.mac.pduRev = macStat.pdu_rev;
+		linkStatReport.mac.revDrop = macStat.rev_drop;
+		linkStatReport.link.msgSent = linkStat.msg_sent;
+		linkStatReport.link.msgRev = linkStat.msg_rev;
+		linkStatReport.link.msgOver = link_send_over_get();
+		linkStatReport.link.revErr = linkStat.rev_err;
+
+		link_rpc_reply(msg, (uint8_t*)&linkStatReport, sizeof(linkStatReport_t));
+	}
+	break;
+
 	default:
 	break;
 	}
@@ -9,6 +9,9 @@ VPATH += sources/common
 C_SOURCES += sources/common/utils.c
 C_SOURCES += sources/common/xprintf.c
 C_SOURCES += sources/common/cmd_line.c
+C_SOURCES += sources/common/crc16.c
+C_SOURCES += sources/common/cobs.c
+C_SOURCES += sources/common/rs.c
 
 
 
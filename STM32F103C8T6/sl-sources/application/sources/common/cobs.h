@@ -0,0 +1,37 @@
+/*------------------------------------------------------------------------/
+/  COBS (Consistent Overhead Byte Stuffing) codec
+/-------------------------------------------------------------------------/
+/ @author: HungPNQ
+/ @date: 19/10/2026
+/-------------------------------------------------------------------------*/
+
+#ifndef __COBS_H__
+#define __COBS_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------*
+ *  DECLARE: Public definitions
+ *  Note: encoded data never contains 0x00, the caller frames it with a 0x00
+ *  delimiter. Overhead is one byte per started 254 bytes of input.
+ *----------------------------------------------------------------------------*/
+#define COBS_DELIMITER					(0x00)
+#define COBS_ENCODED_SIZE_MAX(len)		((len) + ((len) / 254) + 1)
+
+/* Function prototypes -------------------------------------------------------*/
+/* encode len bytes of src into dst (COBS_ENCODED_SIZE_MAX(len) bytes), return encoded length */
+extern uint32_t cobs_encode(const uint8_t* src, uint32_t len, uint8_t* dst);
+
+/* decode in place, return decoded length, 0 when data is malformed */
+extern uint32_t cobs_decode(uint8_t* buf, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __COBS_H__ */
@@ -150,4 +150,27 @@ uint8_t	ringBufferCharGet(ringBufferChar_t* pRingBuf) {
 	}
 
 	return ret;
-}
\ No newline at end of file
+}
+
+/*----------------------------------------------------------------------------*/
+uint16_t ringBufferCharSpan(ringBufferChar_t* pRingBuf, uint8_t** pData) {
+	uint16_t ret = pRingBuf->bufSize - pRingBuf->headId;
+
+	/* filled bytes wrap at most once, the first span ends at buffer end */
+	if (ret > pRingBuf->fillSize) {
+		ret = pRingBuf->fillSize;
+	}
+	*pData = &pRingBuf->pBuf[pRingBuf->headId];
+
+	return ret;
+}
+
+/*----------------------------------------------------------------------------*/
+void ringBufferCharSkip(ringBufferChar_t* pRingBuf, uint16_t len) {
+	if (len > pRingBuf->fillSize) {
+		len = pRingBuf->fillSize;
+	}
+
+	pRingBuf->headId = (pRingBuf->headId + len) % pRingBuf->bufSize;
+	pRingBuf->fillSize -= len;
+}
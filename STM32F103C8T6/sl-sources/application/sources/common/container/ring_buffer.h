@@ -56,6 +56,8 @@ extern bool	isRingBufferCharEmpty(ringBufferChar_t* pRingBuf);
 extern bool	isRingBufferCharFull(ringBufferChar_t* pRingBuf);
 extern void	ringBufferCharPut(ringBufferChar_t* pRingBuf, uint8_t ch);
 extern uint8_t ringBufferCharGet(ringBufferChar_t* pRingBuf);
+extern uint16_t ringBufferCharSpan(ringBufferChar_t* pRingBuf, uint8_t** pData);
+extern void	ringBufferCharSkip(ringBufferChar_t* pRingBuf, uint16_t len);
 
 #ifdef __cplusplus
 }
@@ -23,43 +23,136 @@ uint32_t str_len(const int8_t *str) {
 	return length;
 }
 
-/*----------------------------------------------------------------------------*/
-void* mem_set(void *str, int c,size_t size) {
+/*----------------------------------------------------------------------------*
+ *  Memory routines
+ *  Note: both pointers are brought to word boundary when they share the same
+ *  alignment, then data is moved by word (LDM/STM 16 bytes bursts on
+ *  Cortex-M3). Misaligned pair falls back to byte loop. The C path is the
+ *  portable reference, it is used as is on host builds.
+ *----------------------------------------------------------------------------*/
+#define MEM_WORD_SIZE		(sizeof(uint32_t))
+#define MEM_WORD_MASK		(MEM_WORD_SIZE - 1)
+#define MEM_BURST_SIZE		(4 * MEM_WORD_SIZE)
+
+typedef uint32_t __attribute__((__may_alias__)) mem_word_t;
+
+void* mem_set(void *str, int c, size_t size) {
 	uint8_t *ptr = (uint8_t *)str;
 	const uint8_t ch = c;
-	while(size--)
+
+	if (size >= MEM_BURST_SIZE) {
+		uint32_t word = ch * 0x01010101U;
+
+		while ((uintptr_t)ptr & MEM_WORD_MASK) {
+			*ptr++ = ch;
+			size--;
+		}
+
+#if defined(__ARM_ARCH_7M__)
+		if (size >= MEM_BURST_SIZE) {
+			uint32_t burst = size / MEM_BURST_SIZE;
+			__asm volatile (
+				"	mov		r3, %[w]			\n"
+				"	mov		r4, %[w]			\n"
+				"	mov		r5, %[w]			\n"
+				"	mov		r6, %[w]			\n"
+				"1:	stmia	%[p]!, {r3-r6}		\n"
+				"	subs	%[n], %[n], #1		\n"
+				"	bne		1b					\n"
+				: [p] "+r" (ptr), [n] "+r" (burst)
+				: [w] "r" (word)
+				: "r3", "r4", "r5", "r6", "cc", "memory");
+			size &= (MEM_BURST_SIZE - 1);
+		}
+#endif
+
+		mem_word_t *wptr = (mem_word_t *)ptr;
+		while (size >= MEM_WORD_SIZE) {
+			*wptr++ = word;
+			size -= MEM_WORD_SIZE;
+		}
+		ptr = (uint8_t *)wptr;
+	}
+
+	while (size--) {
 		*ptr++ = ch;
+	}
+
 	return str;
 }
 
 /*----------------------------------------------------------------------------*/
-void* mem_cpy(void *dst,const void *str, size_t size) {
-	uint8_t *ptr = (uint8_t *)str;
+void* mem_cpy(void *dst, const void *str, size_t size) {
+	const uint8_t *ptr = (const uint8_t *)str;
 	uint8_t *ptr2 = (uint8_t *)dst;
-	while(size--)
+
+	if (size >= MEM_WORD_SIZE * 2 && (((uintptr_t)ptr ^ (uintptr_t)ptr2) & MEM_WORD_MASK) == 0) {
+		while ((uintptr_t)ptr2 & MEM_WORD_MASK) {
+			*ptr2++ = *ptr++;
+			size--;
+		}
+
+#if defined(__ARM_ARCH_7M__)
+		if (size >= MEM_BURST_SIZE) {
+			uint32_t burst = size / MEM_BURST_SIZE;
+			__asm volatile (
+				"1:	ldmia	%[s]!, {r3-r6}		\n"
+				"	stmia	%[d]!, {r3-r6}		\n"
+				"	subs	%[n], %[n], #1		\n"
+				"	bne		1b					\n"
+				: [d] "+r" (ptr2), [s] "+r" (ptr), [n] "+r" (burst)
+				:
+				: "r3", "r4", "r5", "r6", "cc", "memory");
+			size &= (MEM_BURST_SIZE - 1);
+		}
+#endif
+
+		const mem_word_t *wptr = (const mem_word_t *)ptr;
+		mem_word_t *wptr2 = (mem_word_t *)ptr2;
+		while (size >= MEM_WORD_SIZE) {
+			*wptr2++ = *wptr++;
+			size -= MEM_WORD_SIZE;
+		}
+		ptr = (const uint8_t *)wptr;
+		ptr2 = (uint8_t *)wptr2;
+	}
+
+	while (size--) {
 		*ptr2++ = *ptr++;
+	}
+
 	return dst;
 }
 
 /*----------------------------------------------------------------------------*/
 int mem_cmp(const void * ptr1, const void * ptr2, size_t num) {
-	uint8_t *pmem1 = (uint8_t *)ptr1;
-	uint8_t *pmem2 = (uint8_t *)ptr2;
+	const uint8_t *pmem1 = (const uint8_t *)ptr1;
+	const uint8_t *pmem2 = (const uint8_t *)ptr2;
+
+	if (num >= MEM_WORD_SIZE * 2 && (((uintptr_t)pmem1 ^ (uintptr_t)pmem2) & MEM_WORD_MASK) == 0) {
+		while ((uintptr_t)pmem1 & MEM_WORD_MASK) {
+			if (*pmem1 != *pmem2) {
+				return (*pmem1 > *pmem2) ? 1 : -1;
+			}
+			pmem1++;
+			pmem2++;
+			num--;
+		}
 
-	while (*pmem1++ == *pmem2++) {
-		if (num == 0) {
-			break;
+		/* skip equal words, the different word is resolved by byte loop */
+		while (num >= MEM_WORD_SIZE && *(const mem_word_t *)pmem1 == *(const mem_word_t *)pmem2) {
+			pmem1 += MEM_WORD_SIZE;
+			pmem2 += MEM_WORD_SIZE;
+			num -= MEM_WORD_SIZE;
 		}
-		num--;
 	}
 
-	if (num != 0) {
-		if (*pmem1 > *pmem2) {
-			return 1;
-		}
-		else {
-			return -1;
+	while (num--) {
+		if (*pmem1 != *pmem2) {
+			return (*pmem1 > *pmem2) ? 1 : -1;
 		}
+		pmem1++;
+		pmem2++;
 	}
 
 	return 0;
@@ -67,24 +160,14 @@ int mem_cmp(const void * ptr1, const void * ptr2, size_t num) {
 
 /*----------------------------------------------------------------------------*/
 uint8_t mem_read(uint32_t address, uint8_t* data, uint32_t len) {
-	uint8_t *src = (uint8_t *)address;
-	uint8_t *dat = (uint8_t *)data;
-
-	while (len--) {
-		*dat++ = *src++;
-	}
+	mem_cpy(data, (const void *)(uintptr_t)address, len);
 
 	return 0;
 }
 
 /*----------------------------------------------------------------------------*/
 uint8_t mem_write(uint32_t address, uint8_t* data, uint32_t len) {
-	uint8_t *dst = (uint8_t *)address;
-	uint8_t *dat = (uint8_t *)data;
-
-	while (len--) {
-		*dst++ = *dat++;
-	}
+	mem_cpy((void *)(uintptr_t)address, data, len);
 
 	return 0;
 }
@@ -8,3 +8,5 @@ SOURCES_CPP += sources/networks/net/link/link.cpp
 SOURCES_CPP += sources/networks/net/link/link_mac.cpp
 SOURCES_CPP += sources/networks/net/link/link_phy.cpp
 SOURCES_CPP += sources/networks/net/link/link_data.cpp
+SOURCES_CPP += sources/networks/net/link/link_lz.cpp
+SOURCES_CPP += sources/networks/net/link/link_rpc.cpp
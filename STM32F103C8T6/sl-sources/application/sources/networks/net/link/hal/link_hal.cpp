@@ -1,38 +1,55 @@
 #include "link_hal.h"
 #include "sys_dbg.h"
 
-/* default base method */
-static uint8_t link_hal_write_byte(uint8_t);
-static uint8_t link_hal_rev_byte(uint8_t);
+/* default base method, no line: written bytes are lost, received ones ignored */
+static void link_hal_write_block_none(uint8_t* data, uint32_t len);
+static void link_hal_rev_block_none(uint8_t* data, uint32_t len);
+
+static const link_hal_transport_t link_hal_transport_none = {
+	"none",
+	link_hal_write_block_none
+};
 
 /* initial link hal method */
-pf_link_hal_write_byte plink_hal_write_byte = link_hal_write_byte;
-pf_link_hal_rev_byte plink_hal_rev_byte = link_hal_rev_byte;
+static const link_hal_transport_t* plink_hal_transport = &link_hal_transport_none;
+static pf_link_hal_rev_block plink_hal_rev_block = link_hal_rev_block_none;
 
-uint8_t link_hal_write_byte(uint8_t byte) {
-	(void)byte;
-	return byte;
+void link_hal_write_block_none(uint8_t* data, uint32_t len) {
+	(void)data;
+	(void)len;
 }
 
-uint8_t link_hal_rev_byte(uint8_t byte) {
-	(void)byte;
-	return LINK_HAL_IGNORED;
+void link_hal_rev_block_none(uint8_t* data, uint32_t len) {
+	(void)data;
+	(void)len;
 }
 
-void link_hal_reg_write_byte(pf_link_hal_write_byte f_write_byte) {
-	if (f_write_byte != ((pf_link_hal_write_byte)0)) {
-		plink_hal_write_byte = f_write_byte;
+void link_hal_reg_transport(const link_hal_transport_t* transport) {
+	if (transport != ((const link_hal_transport_t*)0) && transport->write_block != 0) {
+		plink_hal_transport = transport;
 	}
 	else {
 		FATAL("link_hal", 0x01);
 	}
 }
 
-void link_hal_reg_rev_byte(pf_link_hal_rev_byte f_rev_byte) {
-	if (f_rev_byte != ((pf_link_hal_rev_byte)0)) {
-		plink_hal_rev_byte = f_rev_byte;
+void link_hal_reg_rev_block(pf_link_hal_rev_block f_rev_block) {
+	if (f_rev_block != ((pf_link_hal_rev_block)0)) {
+		plink_hal_rev_block = f_rev_block;
 	}
 	else {
 		FATAL("link_hal", 0x02);
 	}
 }
+
+const char* link_hal_name() {
+	return plink_hal_transport->name;
+}
+
+void link_hal_write_block(uint8_t* data, uint32_t len) {
+	plink_hal_transport->write_block(data, len);
+}
+
+void link_hal_rev_block(uint8_t* data, uint32_t len) {
+	plink_hal_rev_block(data, len);
+}
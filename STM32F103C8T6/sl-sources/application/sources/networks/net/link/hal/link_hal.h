@@ -7,14 +7,21 @@
 #define LINK_HAL_HANDLED	1
 #define LINK_HAL_IGNORED	0
 
-typedef uint8_t (*pf_link_hal_write_byte)(uint8_t);
-typedef uint8_t (*pf_link_hal_rev_byte)(uint8_t);
+/* transport under link_phy. Frames go out with link_hal_write_block(), owner
+ * of the line pushes received bytes with link_hal_rev_block() */
+typedef struct {
+	const char* name;
+	void (*write_block)(uint8_t* data, uint32_t len);
+} link_hal_transport_t;
 
-extern pf_link_hal_write_byte plink_hal_write_byte;
-extern pf_link_hal_rev_byte plink_hal_rev_byte;
+typedef void (*pf_link_hal_rev_block)(uint8_t* data, uint32_t len);
 
-extern void link_hal_reg_write_byte(pf_link_hal_write_byte);
-extern void link_hal_reg_rev_byte(pf_link_hal_rev_byte);
+extern void link_hal_reg_transport(const link_hal_transport_t* transport);
+extern void link_hal_reg_rev_block(pf_link_hal_rev_block f_rev_block);
+
+extern const char* link_hal_name();
+extern void link_hal_write_block(uint8_t* data, uint32_t len);
+extern void link_hal_rev_block(uint8_t* data, uint32_t len);
 
 
 #endif //__LINK_HAL_H__
@@ -13,6 +13,8 @@
 #include "fsm.h"
 #include "timer.h"
 
+#include "utils.h"
+
 #include "sys_dbg.h"
 
 #include "link.h"
@@ -20,11 +22,89 @@
 #include "link_data.h"
 #include "link_mac.h"
 #include "link_phy.h"
+#include "link_lz.h"
+#include "link_rpc.h"
 
 static fsm_t fsm_link;
 static void fsm_link_state_init(ak_msg_t* msg);
 static void fsm_link_state_handle(ak_msg_t* msg);
 
+/* send messages waiting for a free pdu, one queue per channel. Held by a
+ * reference and linked through msg->next */
+static ak_msg_t* link_send_hold_head[LINK_CHANNEL_NUM];
+static ak_msg_t* link_send_hold_tail[LINK_CHANNEL_NUM];
+static uint8_t link_send_hold_len; /* all channels */
+static uint32_t link_send_over;
+
+/* messages taken by link_send_post(), still in the mailbox. Counted with the
+ * held ones so senders see LINK_SEND_STATUS_FULL before they overrun */
+static uint8_t link_send_posted;
+
+/* senders waiting for link to take messages again, set by link_send_wait() */
+typedef struct {
+	uint8_t task_id;
+	uint8_t sig;
+} link_send_waiter_t;
+
+static link_send_waiter_t link_send_waiter[LINK_SEND_WAIT_MAX];
+static uint8_t link_send_waiter_len;
+
+/* pdus given up by mac, sent again on AC_LINK_SEND_RETRY_TO */
+static link_pdu_t* link_send_retry_head;
+static link_pdu_t* link_send_retry_tail;
+
+/* channel of a destination task, set by link_set_channel() */
+typedef struct {
+	uint8_t task_id;
+	uint8_t channel;
+} link_channel_map_t;
+
+static link_channel_map_t link_channel_map[LINK_CHANNEL_MAP_SIZE];
+static uint8_t link_channel_map_len;
+
+/* remote route of a destination, set by link_route_set() */
+typedef struct {
+	uint8_t if_type;
+	uint8_t task_id;
+	uint8_t channel;
+} link_route_t;
+
+static link_route_t link_route_table[LINK_ROUTE_TABLE_SIZE];
+static uint8_t link_route_table_len;
+
+static link_channel_stat_t link_channel_stat[LINK_CHANNEL_NUM];
+static link_stat_t link_stat;
+
+/* small messages of the normal channel packed into one pdu while an earlier
+ * pdu is on the way, only with a peer which negotiated LINK_PHY_CAP_LINK_AGGREGATE */
+#define LINK_FRAME_COMMON_MSG_LEN(data_len)		(sizeof(ak_msg_common_if_t) - AK_COMMON_MSG_DATA_SIZE + (data_len))
+#define LINK_FRAME_DYNAMIC_MSG_LEN(data_len)	(sizeof(ak_msg_if_header_t) + sizeof(uint32_t) + (data_len))
+
+static link_pdu_t* link_send_agg_pdu;
+static uint8_t link_send_agg_cnt;
+static uint8_t link_send_pdu_pending; /* pdus given to mac, not answered yet */
+
+/* pdu coded before sending or decoded after receiving, only with a peer
+ * which negotiated LINK_PHY_CAP_LINK_LZ */
+static link_frame_t link_lz_frame;
+
+static uint8_t link_route_find(uint8_t if_type, uint8_t task_id);
+static uint8_t link_send_channel(ak_msg_t* msg);
+static uint8_t link_send_msg(ak_msg_t* msg, uint8_t channel);
+static void link_send_frame(ak_msg_t* msg, link_frame_t* link_frame);
+static void link_send_pdu(link_pdu_t* link_pdu);
+static uint8_t link_send_agg_put(ak_msg_t* msg);
+static void link_send_agg_flush();
+static void link_send_lz(link_pdu_t* link_pdu);
+static uint32_t link_rev_lz(link_frame_t* link_frame, uint32_t len);
+static void link_rev_frame(link_frame_t* link_frame, uint32_t len);
+static void link_rev_post(ak_msg_t* msg);
+static void link_send_hold(ak_msg_t* msg, uint8_t channel);
+static void link_send_release();
+static uint8_t link_send_pending_status();
+static void link_send_wake();
+static void link_send_retry(link_pdu_t* link_pdu);
+
 void TaskLink(ak_msg_t* msg) {
 	fsm_dispatch(&fsm_link, msg);
 }
@@ -43,6 +123,25 @@ void fsm_link_state_init(ak_msg_t* msg) {
 		/* link protocol data unit pool initial */
 		link_pdu_init();
 
+		/* frame buffer pool shared by mac/phy */
+		link_fbuf_init();
+
+		for (uint8_t channel = 0; channel < LINK_CHANNEL_NUM; channel++) {
+			link_send_hold_head[channel] = AK_MSG_NULL;
+			link_send_hold_tail[channel] = AK_MSG_NULL;
+			mem_set((uint8_t*)&link_channel_stat[channel], 0, sizeof(link_channel_stat_t));
+		}
+		link_send_hold_len = 0;
+		link_send_over = 0;
+		link_send_posted = 0;
+		link_send_waiter_len = 0;
+		mem_set((uint8_t*)&link_stat, 0, sizeof(link_stat_t));
+
+		link_send_retry_head = LINK_PDU_NULL;
+		link_send_retry_tail = LINK_PDU_NULL;
+		link_send_agg_pdu = LINK_PDU_NULL;
+		link_send_pdu_pending = 0;
+
 		/* request lower layer init */
 		task_post_pure_msg(SL_LINK_MAC_ID, AC_LINK_MAC_INIT);
 	}
@@ -69,228 +168,727 @@ void fsm_link_state_init(ak_msg_t* msg) {
 
 void fsm_link_state_handle(ak_msg_t* msg) {
 	switch (msg->sig) {
-	case AC_LINK_SEND_PURE_MSG: {
-		LINK_DBG_SIG("AC_LINK_SEND_PURE_MSG\n");
-		link_pdu_t* link_pdu = link_pdu_malloc();
+	case AC_LINK_SEND_PURE_MSG:
+	case AC_LINK_SEND_COMMON_MSG:
+	case AC_LINK_SEND_DYNAMIC_MSG:
+	case AC_LINK_SEND_DATA: {
+		LINK_DBG_SIG("AC_LINK_SEND_MSG\n");
+		uint8_t channel = link_send_channel(msg);
 
-		if (link_pdu == LINK_PDU_NULL) {
-			task_post_pure_msg(SL_LINK_ID, AC_LINK_SEND_HANDLE_PDU_FULL);
+		/* keep sending order inside a channel */
+		if (link_send_hold_head[channel] != AK_MSG_NULL || !link_send_msg(msg, channel)) {
+			link_send_hold(msg, channel);
 		}
-		else {
-			ak_msg_pure_if_t if_msg;
-			if_msg.header.src_task_id = msg->if_src_task_id;
-			if_msg.header.des_task_id = msg->if_des_task_id;
-			if_msg.header.type = get_msg_type(msg);
-			if_msg.header.if_src_type = msg->if_src_type;
-			if_msg.header.if_des_type = msg->if_des_type;
-			if_msg.header.sig = msg->if_sig;
-
-			link_frame_t link_frame;
-			link_frame.header.src_addr = if_msg.header.src_task_id;
-			link_frame.header.des_addr = if_msg.header.des_task_id;
-			link_frame.header.type = LINK_FRAME_TYPE_PURE_MSG;
-			link_frame.header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
-			link_frame.header.len = sizeof(ak_msg_pure_if_t);
-			memcpy(link_frame.data, (uint8_t*)&if_msg, link_frame.header.len);
-
-			link_pdu->len = sizeof(link_frame_header_t) + link_frame.header.len;
-			memcpy(link_pdu->payload, (uint8_t*)&link_frame, link_pdu->len);
 
-			uint32_t link_pdu_id = link_pdu->id;
-			task_post_common_msg(SL_LINK_MAC_ID, AC_LINK_MAC_FRAME_SEND_REQ, (uint8_t*)&link_pdu_id, sizeof(uint32_t));
+		/* counted as held now or sent */
+		if (link_send_posted > 0) {
+			link_send_posted--;
 		}
+
+		link_send_wake();
 	}
 		break;
 
-	case AC_LINK_SEND_COMMON_MSG: {
-		LINK_DBG_SIG("AC_LINK_SEND_COMMON_MSG\n");
-		link_pdu_t* link_pdu = link_pdu_malloc();
+	case AC_LINK_SEND_HANDLE_PDU_FULL: {
+		LINK_DBG_SIG("AC_LINK_SEND_HANDLE_PDU_FULL\n");
+		link_send_release();
+		link_send_wake();
+	}
+		break;
 
-		if (link_pdu == LINK_PDU_NULL) {
+	case AC_LINK_SEND_DONE: {
+		LINK_DBG_SIG("AC_LINK_SEND_DONE\n");
+		uint32_t* link_pdu_send_done = (uint32_t*)get_data_common_msg(msg);
+		link_channel_stat[link_pdu_get(*link_pdu_send_done)->channel].sent++;
+		link_pdu_free(*link_pdu_send_done);
+		link_send_pdu_pending--;
+
+		/* link is free again, packed messages go now */
+		link_send_agg_flush();
+
+		if (link_send_hold_len > 0) {
 			task_post_pure_msg(SL_LINK_ID, AC_LINK_SEND_HANDLE_PDU_FULL);
 		}
-		else {
-			ak_msg_common_if_t if_msg;
-			if_msg.header.src_task_id = msg->if_src_task_id;
-			if_msg.header.des_task_id = msg->if_des_task_id;
-			if_msg.header.type = get_msg_type(msg);
-			if_msg.header.if_src_type = msg->if_src_type;
-			if_msg.header.if_des_type = msg->if_des_type;
-			if_msg.header.sig = msg->if_sig;
-			if_msg.len = get_data_len_common_msg(msg);
-			memcpy(if_msg.data, get_data_common_msg(msg), if_msg.len);
-
-			link_frame_t link_frame;
-			link_frame.header.src_addr = if_msg.header.src_task_id;
-			link_frame.header.des_addr = if_msg.header.des_task_id;
-			link_frame.header.type = LINK_FRAME_TYPE_COMMON_MSG;
-			link_frame.header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
-			link_frame.header.len = sizeof(ak_msg_common_if_t);
-			memcpy(link_frame.data, (uint8_t*)&if_msg, link_frame.header.len);
-
-			link_pdu->len = sizeof(link_frame_header_t) + link_frame.header.len;
-			memcpy(link_pdu->payload, (uint8_t*)&link_frame, link_pdu->len);
+	}
+		break;
 
+	case AC_LINK_SEND_ERR: {
+		LINK_DBG_SIG("AC_LINK_SEND_ERR\n");
+		uint32_t* link_pdu_send_err = (uint32_t*)get_data_common_msg(msg);
+		link_pdu_t* link_pdu = link_pdu_get(*link_pdu_send_err);
+		link_channel_stat[link_pdu->channel].err++;
+
+		/* pdu stays pending, peer gets it once it answers again */
+		link_send_retry(link_pdu);
+	}
+		break;
+
+	case AC_LINK_SEND_RETRY_TO: {
+		LINK_DBG_SIG("AC_LINK_SEND_RETRY_TO\n");
+		while (link_send_retry_head != LINK_PDU_NULL) {
+			link_pdu_t* link_pdu = link_send_retry_head;
+			link_send_retry_head = link_pdu->next;
+
+			/* already coded, only mac sends it again */
 			uint32_t link_pdu_id = link_pdu->id;
 			task_post_common_msg(SL_LINK_MAC_ID, AC_LINK_MAC_FRAME_SEND_REQ, (uint8_t*)&link_pdu_id, sizeof(uint32_t));
 		}
+		link_send_retry_tail = LINK_PDU_NULL;
 	}
 		break;
 
-	case AC_LINK_SEND_DYNAMIC_MSG: {
-		LINK_DBG_SIG("AC_LINK_SEND_DYNAMIC_MSG\n");
-		link_pdu_t* link_pdu = link_pdu_malloc();
+	case AC_LINK_SEND_AGG_TO: {
+		LINK_DBG_SIG("AC_LINK_SEND_AGG_TO\n");
+		link_send_agg_flush();
+	}
+		break;
 
-		if (link_pdu == LINK_PDU_NULL) {
-			task_post_pure_msg(SL_LINK_ID, AC_LINK_SEND_HANDLE_PDU_FULL);
+	case AC_LINK_RPC_RES: {
+		LINK_DBG_SIG("AC_LINK_RPC_RES\n");
+		link_rpc_rev(msg);
+	}
+		break;
+
+	case AC_LINK_RPC_TICK: {
+		LINK_DBG_SIG("AC_LINK_RPC_TICK\n");
+		link_rpc_tick();
+	}
+		break;
+
+	case AC_LINK_REV_MSG: {
+		LINK_DBG_SIG("AC_LINK_REV_MSG\n");
+		uint32_t* rev_pdu_id = (uint32_t*)get_data_common_msg(msg);
+		link_pdu_t* link_pdu = link_pdu_get(*rev_pdu_id);
+		link_frame_t* link_frame = (link_frame_t*)link_pdu->payload;
+		uint32_t len = link_pdu->len;
+
+		if (len >= sizeof(link_frame_header_t) && link_frame->header.sub_type == LINK_FRAME_SUB_TYPE_LZ) {
+			len = link_rev_lz(link_frame, len);
+			link_frame = &link_lz_frame;
 		}
-		else {
-			ak_msg_dynamic_if_t if_msg;
-			if_msg.header.src_task_id = msg->if_src_task_id;
-			if_msg.header.des_task_id = msg->if_des_task_id;
-			if_msg.header.type = get_msg_type(msg);
-			if_msg.header.if_src_type = msg->if_src_type;
-			if_msg.header.if_des_type = msg->if_des_type;
-			if_msg.header.sig = msg->if_sig;
-			if_msg.len = get_data_len_dynamic_msg(msg);
-
-			link_frame_t link_frame;
-			link_frame.header.src_addr = if_msg.header.src_task_id;
-			link_frame.header.des_addr = if_msg.header.des_task_id;
-			link_frame.header.type = LINK_FRAME_TYPE_DYNAMIC_MSG;
-			link_frame.header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
-			link_frame.header.len = sizeof(ak_msg_if_header_t) + sizeof(uint32_t) + if_msg.len;
-
-			memcpy(&link_frame.data[0], \
-					(uint8_t*)&if_msg, \
-					sizeof(ak_msg_if_header_t) + sizeof(uint32_t));
-
-			memcpy((uint8_t*)&link_frame.data[sizeof(ak_msg_if_header_t) + sizeof(uint32_t)], \
-					get_data_dynamic_msg(msg), \
-					if_msg.len);
-
-            link_pdu->len = sizeof(link_frame_header_t) + link_frame.header.len;
-			memcpy(link_pdu->payload, (uint8_t*)&link_frame, link_pdu->len);
 
-			uint32_t link_pdu_id = link_pdu->id;
-			task_post_common_msg(SL_LINK_MAC_ID, AC_LINK_MAC_FRAME_SEND_REQ, (uint8_t*)&link_pdu_id, sizeof(uint32_t));
+		if (len > 0) {
+			link_rev_frame(link_frame, len);
 		}
+
+		link_pdu_free(*rev_pdu_id);
+
+		/* receive pdu is back, mac advertises it to peer */
+		task_post_pure_msg(SL_LINK_MAC_ID, AC_LINK_MAC_REV_PDU_FREE);
 	}
 		break;
 
-	case AC_LINK_SEND_DATA: {
-		LINK_DBG_SIG("AC_LINK_SEND_DATA\n");
-		link_pdu_t* link_pdu = link_pdu_malloc();
+	default:
+		break;
+	}
+}
 
-		if (link_pdu == LINK_PDU_NULL) {
-			task_post_pure_msg(SL_LINK_ID, AC_LINK_SEND_HANDLE_PDU_FULL);
+uint8_t link_send_status() {
+	return link_send_pending_status();
+}
+
+uint32_t link_send_over_get() {
+	return link_send_over;
+}
+
+uint8_t link_send_post(ak_msg_t* msg) {
+	uint8_t status = link_send_pending_status();
+
+	if (status != LINK_SEND_STATUS_FULL) {
+		link_send_posted++;
+		task_post(SL_LINK_ID, msg);
+	}
+	return status;
+}
+
+void link_send_post_over(ak_msg_t* msg) {
+	link_send_posted++;
+	task_post(SL_LINK_ID, msg);
+}
+
+void link_send_wait(uint8_t task_id, uint8_t sig) {
+	if (link_send_pending_status() != LINK_SEND_STATUS_FULL) {
+		task_post_pure_msg(task_id, sig);
+		return;
+	}
+
+	for (uint8_t i = 0; i < link_send_waiter_len; i++) {
+		if (link_send_waiter[i].task_id == task_id) {
+			link_send_waiter[i].sig = sig;
+			return;
 		}
-		else {
-			link_frame_t link_frame;
-			link_frame.header.src_addr = link_get_src_addr();
-			link_frame.header.des_addr = link_get_des_addr();
-			link_frame.header.type = LINK_FRAME_TYPE_DATA;
-			link_frame.header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
-			link_frame.header.len = get_data_len_common_msg(msg);
-			memcpy(link_frame.data, get_data_common_msg(msg), link_frame.header.len);
+	}
 
-			link_pdu->len = sizeof(link_frame_header_t) + link_frame.header.len;
+	if (link_send_waiter_len >= LINK_SEND_WAIT_MAX) {
+		FATAL("link", 0x09);
+	}
+	link_send_waiter[link_send_waiter_len].task_id = task_id;
+	link_send_waiter[link_send_waiter_len].sig = sig;
+	link_send_waiter_len++;
+}
 
-			uint32_t link_pdu_id = link_pdu->id;
-			task_post_common_msg(SL_LINK_MAC_ID, AC_LINK_MAC_FRAME_SEND_REQ, (uint8_t*)&link_pdu_id, sizeof(uint32_t));
+void link_send_q_init(link_send_q_t* send_q, uint8_t task_id, uint8_t sig) {
+	send_q->head = AK_MSG_NULL;
+	send_q->tail = AK_MSG_NULL;
+	send_q->task_id = task_id;
+	send_q->sig = sig;
+}
+
+uint8_t link_send_q_post(link_send_q_t* send_q, ak_msg_t* msg) {
+	/* behind kept ones, sending order stays */
+	uint8_t status = LINK_SEND_STATUS_FULL;
+	if (send_q->head == AK_MSG_NULL) {
+		status = link_send_post(msg);
+		if (status != LINK_SEND_STATUS_FULL) {
+			return status;
 		}
+		link_send_wait(send_q->task_id, send_q->sig);
+	}
+
+	/* reference of the caller stays with the queue */
+	msg->next = AK_MSG_NULL;
+	if (send_q->tail == AK_MSG_NULL) {
+		send_q->head = msg;
+	}
+	else {
+		send_q->tail->next = msg;
+	}
+	send_q->tail = msg;
+	return status;
+}
+
+void link_send_q_flush(link_send_q_t* send_q) {
+	while (send_q->head != AK_MSG_NULL) {
+		ak_msg_t* msg = send_q->head;
+		ak_msg_t* next = msg->next;
+
+		if (link_send_post(msg) == LINK_SEND_STATUS_FULL) {
+			link_send_wait(send_q->task_id, send_q->sig);
+			return;
+		}
+
+		send_q->head = next;
+		if (send_q->head == AK_MSG_NULL) {
+			send_q->tail = AK_MSG_NULL;
+		}
+	}
+}
+
+void link_set_channel(uint8_t if_des_task_id, uint8_t channel) {
+	if (channel >= LINK_CHANNEL_NUM) {
+		FATAL("link", 0x04);
+	}
+
+	for (uint8_t i = 0; i < link_channel_map_len; i++) {
+		if (link_channel_map[i].task_id == if_des_task_id) {
+			link_channel_map[i].channel = channel;
+			return;
+		}
+	}
+
+	if (link_channel_map_len >= LINK_CHANNEL_MAP_SIZE) {
+		FATAL("link", 0x05);
+	}
+	link_channel_map[link_channel_map_len].task_id = if_des_task_id;
+	link_channel_map[link_channel_map_len].channel = channel;
+	link_channel_map_len++;
+}
+
+void link_route_set(uint8_t if_des_type, uint8_t if_des_task_id, uint8_t channel) {
+	if (channel >= LINK_CHANNEL_NUM && channel != LINK_CHANNEL_DEFAULT) {
+		FATAL("link", 0x06);
 	}
+
+	uint8_t i = link_route_find(if_des_type, if_des_task_id);
+	if (i < link_route_table_len) {
+		link_route_table[i].channel = channel;
+		return;
+	}
+
+	if (link_route_table_len >= LINK_ROUTE_TABLE_SIZE) {
+		FATAL("link", 0x07);
+	}
+	link_route_table[link_route_table_len].if_type = if_des_type;
+	link_route_table[link_route_table_len].task_id = if_des_task_id;
+	link_route_table[link_route_table_len].channel = channel;
+	link_route_table_len++;
+}
+
+uint8_t link_route_post(link_send_q_t* send_q, ak_msg_t* msg) {
+	uint8_t routed = (link_route_find(msg->if_des_type, msg->if_des_task_id) < link_route_table_len);
+
+	if (!routed) {
+		return LINK_ROUTE_NONE;
+	}
+
+	switch (get_msg_type(msg)) {
+	case PURE_MSG_TYPE:
+		set_msg_sig(msg, AC_LINK_SEND_PURE_MSG);
 		break;
 
-	case AC_LINK_SEND_HANDLE_PDU_FULL: {
-		LINK_DBG_SIG("AC_LINK_SEND_HANDLE_PDU_FULL\n");
+	case COMMON_MSG_TYPE:
+		set_msg_sig(msg, AC_LINK_SEND_COMMON_MSG);
+		break;
+
+	case DYNAMIC_MSG_TYPE:
+		set_msg_sig(msg, AC_LINK_SEND_DYNAMIC_MSG);
+		break;
+
+	default:
+		return LINK_ROUTE_NONE;
+	}
+
+	return link_send_q_post(send_q, msg);
+}
+
+void link_get_channel_stat(uint8_t channel, link_channel_stat_t* stat) {
+	if (channel < LINK_CHANNEL_NUM) {
+		*stat = link_channel_stat[channel];
+	}
+}
+
+void link_get_stat(link_stat_t* stat) {
+	*stat = link_stat;
+}
+
+uint8_t link_route_find(uint8_t if_type, uint8_t task_id) {
+	uint8_t i = 0;
+
+	while (i < link_route_table_len && (link_route_table[i].if_type != if_type || link_route_table[i].task_id != task_id)) {
+		i++;
+	}
+	return i;
+}
+
+uint8_t link_send_channel(ak_msg_t* msg) {
+	if (msg->sig != AC_LINK_SEND_DATA) {
+		uint8_t i = link_route_find(msg->if_des_type, msg->if_des_task_id);
+		if (i < link_route_table_len && link_route_table[i].channel != LINK_CHANNEL_DEFAULT) {
+			return link_route_table[i].channel;
+		}
+
+		for (uint8_t i = 0; i < link_channel_map_len; i++) {
+			if (link_channel_map[i].task_id == msg->if_des_task_id) {
+				return link_channel_map[i].channel;
+			}
+		}
+	}
+
+	return (msg->sig == AC_LINK_SEND_DYNAMIC_MSG) ? LINK_CHANNEL_BULK : LINK_CHANNEL_NORMAL;
+}
+
+uint8_t link_send_msg(ak_msg_t* msg, uint8_t channel) {
+	if (channel == LINK_CHANNEL_NORMAL && link_send_agg_put(msg)) {
+		return 1;
+	}
+
+	/* nothing overtakes packed messages, urgent one does not wait behind them */
+	link_send_agg_flush();
+
+	/* bulk transfer leaves some pdus to the other channels */
+	if (channel == LINK_CHANNEL_BULK && link_pdu_tx_available() <= LINK_PDU_TX_BULK_RESERVE) {
+		return 0;
+	}
+
+	link_pdu_t* link_pdu = link_pdu_malloc();
+
+	if (link_pdu == LINK_PDU_NULL) {
+		return 0;
+	}
+	link_pdu->channel = channel;
+
+	/* link frame is built in place */
+	link_frame_t* link_frame = (link_frame_t*)link_pdu->payload;
+	link_send_frame(msg, link_frame);
+	link_pdu->len = sizeof(link_frame_header_t) + link_frame->header.len;
+
+	link_send_pdu(link_pdu);
+	return 1;
+}
+
+void link_send_frame(ak_msg_t* msg, link_frame_t* link_frame) {
+	link_stat.msg_sent++;
+
+	switch (msg->sig) {
+	case AC_LINK_SEND_PURE_MSG: {
+		ak_msg_pure_if_t* if_msg = (ak_msg_pure_if_t*)link_frame->data;
+		if_msg->header.src_task_id = msg->if_src_task_id;
+		if_msg->header.des_task_id = msg->if_des_task_id;
+		if_msg->header.type = get_msg_type(msg);
+		if_msg->header.if_src_type = msg->if_src_type;
+		if_msg->header.if_des_type = msg->if_des_type;
+		if_msg->header.sig = msg->if_sig;
+
+		link_frame->header.src_addr = if_msg->header.src_task_id;
+		link_frame->header.des_addr = if_msg->header.des_task_id;
+		link_frame->header.type = LINK_FRAME_TYPE_PURE_MSG;
+		link_frame->header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
+		link_frame->header.len = sizeof(ak_msg_pure_if_t);
 	}
 		break;
 
-	case AC_LINK_SEND_DONE: {
-		LINK_DBG_SIG("AC_LINK_SEND_DONE\n");
-		uint32_t* link_pdu_send_done = (uint32_t*)get_data_common_msg(msg);
-		link_pdu_free(*link_pdu_send_done);
+	case AC_LINK_SEND_COMMON_MSG: {
+		ak_msg_common_if_t* if_msg = (ak_msg_common_if_t*)link_frame->data;
+		if_msg->header.src_task_id = msg->if_src_task_id;
+		if_msg->header.des_task_id = msg->if_des_task_id;
+		if_msg->header.type = get_msg_type(msg);
+		if_msg->header.if_src_type = msg->if_src_type;
+		if_msg->header.if_des_type = msg->if_des_type;
+		if_msg->header.sig = msg->if_sig;
+		if_msg->len = get_data_len_common_msg(msg);
+		mem_cpy(if_msg->data, get_data_common_msg(msg), if_msg->len);
+
+		link_frame->header.src_addr = if_msg->header.src_task_id;
+		link_frame->header.des_addr = if_msg->header.des_task_id;
+		link_frame->header.type = LINK_FRAME_TYPE_COMMON_MSG;
+		link_frame->header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
+		link_frame->header.len = sizeof(ak_msg_common_if_t);
 	}
 		break;
 
-	case AC_LINK_SEND_ERR: {
-		LINK_DBG_SIG("AC_LINK_SEND_ERR\n");
-		uint32_t* link_pdu_send_err = (uint32_t*)get_data_common_msg(msg);
-		link_pdu_free(*link_pdu_send_err);
+	case AC_LINK_SEND_DYNAMIC_MSG: {
+		ak_msg_dynamic_if_t* if_msg = (ak_msg_dynamic_if_t*)link_frame->data;
+		if_msg->header.src_task_id = msg->if_src_task_id;
+		if_msg->header.des_task_id = msg->if_des_task_id;
+		if_msg->header.type = get_msg_type(msg);
+		if_msg->header.if_src_type = msg->if_src_type;
+		if_msg->header.if_des_type = msg->if_des_type;
+		if_msg->header.sig = msg->if_sig;
+		if_msg->len = get_data_len_dynamic_msg(msg);
+
+		link_frame->header.src_addr = if_msg->header.src_task_id;
+		link_frame->header.des_addr = if_msg->header.des_task_id;
+		link_frame->header.type = LINK_FRAME_TYPE_DYNAMIC_MSG;
+		link_frame->header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
+		link_frame->header.len = LINK_FRAME_DYNAMIC_MSG_LEN(if_msg->len);
+
+		mem_cpy((uint8_t*)&link_frame->data[sizeof(ak_msg_if_header_t) + sizeof(uint32_t)], \
+				get_data_dynamic_msg(msg), \
+				if_msg->len);
+	}
+		break;
 
-		/* TODO: handle ERROR */
+	default: { /* AC_LINK_SEND_DATA */
+		link_frame->header.src_addr = link_get_src_addr();
+		link_frame->header.des_addr = link_get_des_addr();
+		link_frame->header.type = LINK_FRAME_TYPE_DATA;
+		link_frame->header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
+		link_frame->header.len = get_data_len_common_msg(msg);
+		mem_cpy(link_frame->data, get_data_common_msg(msg), link_frame->header.len);
 	}
 		break;
+	}
+}
 
-	case AC_LINK_REV_MSG: {
-		LINK_DBG_SIG("AC_LINK_REV_MSG\n");
-		uint32_t* rev_pdu_id = (uint32_t*)get_data_common_msg(msg);
-		link_pdu_t* link_pdu = link_pdu_get(*rev_pdu_id);
-		link_frame_t* link_frame = (link_frame_t*)link_pdu->payload;
+void link_send_pdu(link_pdu_t* link_pdu) {
+	link_send_lz(link_pdu);
+	link_send_pdu_pending++;
 
-		switch (link_frame->header.type) {
-		case LINK_FRAME_TYPE_PURE_MSG: {
-			ak_msg_pure_if_t* if_msg = (ak_msg_pure_if_t*)link_frame->data;
+	uint32_t link_pdu_id = link_pdu->id;
+	task_post_common_msg(SL_LINK_MAC_ID, AC_LINK_MAC_FRAME_SEND_REQ, (uint8_t*)&link_pdu_id, sizeof(uint32_t));
+}
 
-			ak_msg_t* s_msg = get_pure_msg();
-			set_if_src_task_id(s_msg, if_msg->header.src_task_id);
-			set_if_des_task_id(s_msg, if_msg->header.des_task_id);
-			set_if_src_type(s_msg, if_msg->header.if_src_type);
-			set_if_des_type(s_msg, if_msg->header.if_des_type);
-			set_if_sig(s_msg, if_msg->header.sig);
+uint8_t link_send_agg_put(ak_msg_t* msg) {
+	uint32_t record_len = sizeof(link_frame_header_t);
 
-			set_msg_sig(s_msg, SL_CPU_SERIAL_IF_PURE_MSG_IN);
-			task_post(SL_TASK_CPU_SERIAL_IF_ID, s_msg);
-		}
-			break;
+	switch (msg->sig) {
+	case AC_LINK_SEND_PURE_MSG:
+		record_len += sizeof(ak_msg_pure_if_t);
+		break;
 
-		case LINK_FRAME_TYPE_COMMON_MSG: {
-			ak_msg_common_if_t* if_msg = (ak_msg_common_if_t*)link_frame->data;
+	case AC_LINK_SEND_COMMON_MSG:
+		/* unused data bytes are not sent */
+		record_len += LINK_FRAME_COMMON_MSG_LEN(get_data_len_common_msg(msg));
+		break;
 
-			ak_msg_t* s_msg = get_common_msg();
-			set_if_src_task_id(s_msg, if_msg->header.src_task_id);
-			set_if_des_task_id(s_msg, if_msg->header.des_task_id);
-			set_if_src_type(s_msg, if_msg->header.if_src_type);
-			set_if_des_type(s_msg, if_msg->header.if_des_type);
-			set_if_sig(s_msg, if_msg->header.sig);
-			set_if_data_common_msg(s_msg, if_msg->data, if_msg->len);
+	default:
+		return 0;
+	}
 
-			set_msg_sig(s_msg, SL_CPU_SERIAL_IF_COMMON_MSG_IN);
-			task_post(SL_TASK_CPU_SERIAL_IF_ID, s_msg);
-		}
-			break;
+	if (!(link_phy_get_caps() & LINK_PHY_CAP_LINK_AGGREGATE)) {
+		return 0;
+	}
 
-		case LINK_FRAME_TYPE_DYNAMIC_MSG: {
-			ak_msg_dynamic_if_t* if_msg = (ak_msg_dynamic_if_t*)link_frame->data;
+	if (link_send_agg_pdu != LINK_PDU_NULL && link_send_agg_pdu->len + record_len > LINK_PDU_BUF_SIZE) {
+		link_send_agg_flush();
+	}
 
-			ak_msg_t* s_msg = get_dynamic_msg();
-			set_if_src_task_id(s_msg, if_msg->header.src_task_id);
-			set_if_des_task_id(s_msg, if_msg->header.des_task_id);
-			set_if_src_type(s_msg, if_msg->header.if_src_type);
-			set_if_des_type(s_msg, if_msg->header.if_des_type);
-			set_if_sig(s_msg, if_msg->header.sig);
-			set_if_data_dynamic_msg(s_msg, (uint8_t*)&link_frame->data[sizeof(ak_msg_if_header_t) + sizeof(uint32_t)], if_msg->len);
+	if (link_send_agg_pdu == LINK_PDU_NULL) {
+		/* idle link sends at once */
+		if (link_send_pdu_pending == 0) {
+			return 0;
+		}
 
-			set_msg_sig(s_msg, SL_CPU_SERIAL_IF_DYNAMIC_MSG_IN);
-			task_post(SL_TASK_CPU_SERIAL_IF_ID, s_msg);
+		link_send_agg_pdu = link_pdu_malloc();
+		if (link_send_agg_pdu == LINK_PDU_NULL) {
+			return 0;
 		}
-			break;
+		link_send_agg_pdu->channel = LINK_CHANNEL_NORMAL;
+		link_send_agg_pdu->len = sizeof(link_frame_header_t);
+		link_send_agg_cnt = 0;
+
+		link_frame_t* link_frame = (link_frame_t*)link_send_agg_pdu->payload;
+		link_frame->header.src_addr = link_get_src_addr();
+		link_frame->header.des_addr = link_get_des_addr();
+		link_frame->header.type = LINK_FRAME_TYPE_AGGREGATE;
+		link_frame->header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
+		link_frame->header.len = 0;
+
+		timer_set(SL_LINK_ID, AC_LINK_SEND_AGG_TO, LINK_SEND_AGG_INTERVAL, TIMER_ONE_SHOT);
+	}
+
+	link_frame_t* record = (link_frame_t*)&link_send_agg_pdu->payload[link_send_agg_pdu->len];
+	link_send_frame(msg, record);
+	record->header.len = record_len - sizeof(link_frame_header_t);
+
+	link_send_agg_pdu->len += record_len;
+	((link_frame_t*)link_send_agg_pdu->payload)->header.len = link_send_agg_pdu->len - sizeof(link_frame_header_t);
+	link_send_agg_cnt++;
+	return 1;
+}
+
+void link_send_agg_flush() {
+	link_pdu_t* link_pdu = link_send_agg_pdu;
+
+	if (link_pdu == LINK_PDU_NULL) {
+		return;
+	}
+	link_send_agg_pdu = LINK_PDU_NULL;
+	timer_remove_attr(SL_LINK_ID, AC_LINK_SEND_AGG_TO);
+
+	/* lone message goes as a plain frame */
+	if (link_send_agg_cnt == 1) {
+		link_pdu->len -= sizeof(link_frame_header_t);
+		memmove(link_pdu->payload, &link_pdu->payload[sizeof(link_frame_header_t)], link_pdu->len);
+	}
+	else {
+		link_stat.agg_pdu++;
+	}
+
+	link_send_pdu(link_pdu);
+}
+
+void link_send_lz(link_pdu_t* link_pdu) {
+	link_frame_t* link_frame = (link_frame_t*)link_pdu->payload;
+
+	if (!(link_phy_get_caps() & LINK_PHY_CAP_LINK_LZ) || link_frame->header.len < LINK_LZ_MIN_LEN) {
+		return;
+	}
+
+	/* incompressible data is sent raw */
+	uint32_t lz_len = link_lz_compress(link_frame->data, link_frame->header.len, link_lz_frame.data, link_frame->header.len - 1);
+	if (lz_len == 0) {
+		return;
+	}
 
-		case LINK_FRAME_TYPE_DATA: {
+	link_stat.lz_pdu++;
+	link_stat.lz_saved += link_frame->header.len - lz_len;
 
+	mem_cpy(link_frame->data, link_lz_frame.data, lz_len);
+	link_frame->header.sub_type = LINK_FRAME_SUB_TYPE_LZ;
+	link_frame->header.len = lz_len;
+	link_pdu->len = sizeof(link_frame_header_t) + lz_len;
+}
+
+uint32_t link_rev_lz(link_frame_t* link_frame, uint32_t len) {
+	uint32_t lz_len = len - sizeof(link_frame_header_t);
+
+	if (link_frame->header.len < lz_len) {
+		lz_len = link_frame->header.len;
+	}
+
+	uint32_t data_len = link_lz_decompress(link_frame->data, lz_len, link_lz_frame.data, LINK_DATA_BUF_SIZE);
+	if (data_len == 0) {
+		LINK_DBG("[LINK] lz pdu malformed, drop\n");
+		link_stat.rev_err++;
+		return 0;
+	}
+
+	link_lz_frame.header = link_frame->header;
+	link_lz_frame.header.sub_type = LINK_FRAME_SUB_TYPE_NONE;
+	link_lz_frame.header.len = data_len;
+	return sizeof(link_frame_header_t) + data_len;
+}
+
+void link_rev_frame(link_frame_t* link_frame, uint32_t len) {
+	/* lengths inside the frame come from peer, data is never read past the received bytes */
+	uint32_t data_len = (len > sizeof(link_frame_header_t)) ? len - sizeof(link_frame_header_t) : 0;
+
+	if (data_len > link_frame->header.len) {
+		data_len = link_frame->header.len;
+	}
+
+	switch (link_frame->header.type) {
+	case LINK_FRAME_TYPE_PURE_MSG: {
+		ak_msg_pure_if_t* if_msg = (ak_msg_pure_if_t*)link_frame->data;
+		if (data_len < sizeof(ak_msg_pure_if_t)) {
+			link_stat.rev_err++;
+			break;
 		}
+
+		ak_msg_t* s_msg = get_pure_msg();
+		set_if_src_task_id(s_msg, if_msg->header.src_task_id);
+		set_if_des_task_id(s_msg, if_msg->header.des_task_id);
+		set_if_src_type(s_msg, if_msg->header.if_src_type);
+		set_if_des_type(s_msg, if_msg->header.if_des_type);
+		set_if_sig(s_msg, if_msg->header.sig);
+
+		link_rev_post(s_msg);
+	}
+		break;
+
+	case LINK_FRAME_TYPE_COMMON_MSG: {
+		ak_msg_common_if_t* if_msg = (ak_msg_common_if_t*)link_frame->data;
+		if (data_len < LINK_FRAME_COMMON_MSG_LEN(0) || if_msg->len > AK_COMMON_MSG_DATA_SIZE || data_len < LINK_FRAME_COMMON_MSG_LEN(if_msg->len)) {
+			link_stat.rev_err++;
 			break;
+		}
+
+		ak_msg_t* s_msg = get_common_msg();
+		set_if_src_task_id(s_msg, if_msg->header.src_task_id);
+		set_if_des_task_id(s_msg, if_msg->header.des_task_id);
+		set_if_src_type(s_msg, if_msg->header.if_src_type);
+		set_if_des_type(s_msg, if_msg->header.if_des_type);
+		set_if_sig(s_msg, if_msg->header.sig);
+		set_if_data_common_msg(s_msg, if_msg->data, if_msg->len);
+
+		link_rev_post(s_msg);
+	}
+		break;
 
-		default:
+	case LINK_FRAME_TYPE_DYNAMIC_MSG: {
+		ak_msg_dynamic_if_t* if_msg = (ak_msg_dynamic_if_t*)link_frame->data;
+		if (data_len < LINK_FRAME_DYNAMIC_MSG_LEN(0) || if_msg->len > data_len - LINK_FRAME_DYNAMIC_MSG_LEN(0)) {
+			link_stat.rev_err++;
 			break;
 		}
 
-		link_pdu_free(*rev_pdu_id);
+		ak_msg_t* s_msg = get_dynamic_msg();
+		set_if_src_task_id(s_msg, if_msg->header.src_task_id);
+		set_if_des_task_id(s_msg, if_msg->header.des_task_id);
+		set_if_src_type(s_msg, if_msg->header.if_src_type);
+		set_if_des_type(s_msg, if_msg->header.if_des_type);
+		set_if_sig(s_msg, if_msg->header.sig);
+		set_if_data_dynamic_msg(s_msg, (uint8_t*)&link_frame->data[LINK_FRAME_DYNAMIC_MSG_LEN(0)], if_msg->len);
+
+		link_rev_post(s_msg);
+	}
+		break;
+
+	case LINK_FRAME_TYPE_DATA: {
+
+	}
+		break;
+
+	case LINK_FRAME_TYPE_AGGREGATE: {
+		/* packed frames in sending order, a truncated one ends the pdu */
+		uint32_t offset = 0;
+
+		while (offset + sizeof(link_frame_header_t) <= data_len) {
+			link_frame_t* record = (link_frame_t*)&link_frame->data[offset];
+			uint32_t record_len = sizeof(link_frame_header_t) + record->header.len;
+
+			if (offset + record_len > data_len || record->header.type == LINK_FRAME_TYPE_AGGREGATE) {
+				link_stat.rev_err++;
+				break;
+			}
+			link_rev_frame(record, record_len);
+			offset += record_len;
+		}
 	}
 		break;
 
 	default:
+		link_stat.rev_err++;
 		break;
 	}
 }
+
+void link_rev_post(ak_msg_t* msg) {
+	/* straight to the local task, interface tasks only carry the sending side */
+	if (msg->if_des_task_id >= SL_TASK_EOT_ID) {
+		msg_free(msg);
+		link_stat.rev_err++;
+		return;
+	}
+
+	set_msg_sig(msg, msg->if_sig);
+	set_msg_src_task_id(msg, msg->if_src_task_id);
+	task_post(msg->if_des_task_id, msg);
+	link_stat.msg_rev++;
+}
+
+void link_send_hold(ak_msg_t* msg, uint8_t channel) {
+	if (link_send_hold_len >= LINK_SEND_HOLD_MAX) {
+		/* sender ignored LINK_SEND_STATUS_FULL, held all the same */
+		link_send_over++;
+		link_channel_stat[channel].over++;
+		LINK_DBG("[LINK] send hold full, over sig %d\n", msg->sig);
+	}
+
+	/* message stays alive after this handler returns */
+	msg_inc_ref_count(msg);
+	msg->next = AK_MSG_NULL;
+
+	if (link_send_hold_tail[channel] == AK_MSG_NULL) {
+		link_send_hold_head[channel] = msg;
+	}
+	else {
+		link_send_hold_tail[channel]->next = msg;
+	}
+	link_send_hold_tail[channel] = msg;
+	link_send_hold_len++;
+	link_channel_stat[channel].hold++;
+}
+
+void link_send_release() {
+	/* highest priority channel takes free pdus first */
+	for (uint8_t channel = 0; channel < LINK_CHANNEL_NUM; channel++) {
+		while (link_send_hold_head[channel] != AK_MSG_NULL && link_send_msg(link_send_hold_head[channel], channel)) {
+			ak_msg_t* msg = link_send_hold_head[channel];
+
+			link_send_hold_head[channel] = msg->next;
+			if (link_send_hold_head[channel] == AK_MSG_NULL) {
+				link_send_hold_tail[channel] = AK_MSG_NULL;
+			}
+			link_send_hold_len--;
+			link_channel_stat[channel].hold--;
+
+			msg_free(msg);
+		}
+	}
+}
+
+uint8_t link_send_pending_status() {
+	if (link_send_hold_len + link_send_posted >= LINK_SEND_HOLD_MAX) {
+		return LINK_SEND_STATUS_FULL;
+	}
+	else if (link_send_hold_len > 0) {
+		return LINK_SEND_STATUS_HOLD;
+	}
+	return LINK_SEND_STATUS_READY;
+}
+
+void link_send_wake() {
+	if (link_send_waiter_len == 0 || link_send_pending_status() == LINK_SEND_STATUS_FULL) {
+		return;
+	}
+
+	for (uint8_t i = 0; i < link_send_waiter_len; i++) {
+		task_post_pure_msg(link_send_waiter[i].task_id, link_send_waiter[i].sig);
+	}
+	link_send_waiter_len = 0;
+}
+
+void link_send_retry(link_pdu_t* link_pdu) {
+	link_pdu->next = LINK_PDU_NULL;
+
+	if (link_send_retry_tail == LINK_PDU_NULL) {
+		link_send_retry_head = link_pdu;
+		timer_set(SL_LINK_ID, AC_LINK_SEND_RETRY_TO, LINK_SEND_RETRY_INTERVAL, TIMER_ONE_SHOT);
+	}
+	else {
+		link_send_retry_tail->next = link_pdu;
+	}
+	link_send_retry_tail = link_pdu;
+}
@@ -18,12 +18,14 @@ typedef enum {
 	LINK_FRAME_TYPE_COMMON_MSG,
 	LINK_FRAME_TYPE_DYNAMIC_MSG,
 	LINK_FRAME_TYPE_DATA,
+	LINK_FRAME_TYPE_AGGREGATE, /* data: link frames of small messages, see LINK_PHY_CAP_LINK_AGGREGATE */
 } link_frame_type_e;
 
 typedef enum {
 	/* private */
 	LINK_FRAME_SUB_TYPE_NONE,
 	/* pulic */
+	LINK_FRAME_SUB_TYPE_LZ, /* data is lz coded, see LINK_PHY_CAP_LINK_LZ */
 } link_frame_sub_type_e;
 
 typedef struct {
@@ -39,7 +41,83 @@ typedef struct {
 	uint8_t data[LINK_DATA_BUF_SIZE];
 } __AK_PACKETED link_frame_t;
 
+/* backpressure seen by local senders */
+#define LINK_SEND_STATUS_READY		(0) /* pdu free, message is sent at once */
+#define LINK_SEND_STATUS_HOLD		(1) /* pool busy, message is held until a pdu is free */
+#define LINK_SEND_STATUS_FULL		(2) /* hold queue full, sender keeps its message, see link_send_q_t */
+
+/* logical channels, each with its own queue. A lower number is served first
+ * and preempts higher ones at fragment boundaries when peer supports it */
+#define LINK_CHANNEL_URGENT			(0) /* alarm, status */
+#define LINK_CHANNEL_NORMAL			(1) /* default for pure/common message and data */
+#define LINK_CHANNEL_BULK			(2) /* default for dynamic message */
+#define LINK_CHANNEL_NUM			(3)
+
+typedef struct {
+	uint32_t sent; /* pdus acknowledged by peer */
+	uint32_t err; /* pdus given up by mac, sent again after LINK_SEND_RETRY_INTERVAL */
+	uint32_t over; /* messages held above LINK_SEND_HOLD_MAX, sender ignored LINK_SEND_STATUS_FULL */
+	uint32_t hold; /* messages waiting for a pdu */
+} link_channel_stat_t;
+
 extern void link_init_state_machine();
+extern uint8_t link_send_status();
+extern uint32_t link_send_over_get();
+
+/* takes a message with an AC_LINK_SEND_xxx sig like task_post() and returns
+ * the status, LINK_SEND_STATUS_FULL leaves it to the caller */
+extern uint8_t link_send_post(ak_msg_t* msg);
+
+/* takes it also when link is full, for a message its task can not keep
+ * (answer of a request). It is counted in link_channel_stat_t.over */
+extern void link_send_post_over(ak_msg_t* msg);
+
+/* sig is posted once to task_id when link takes messages again */
+extern void link_send_wait(uint8_t task_id, uint8_t sig);
+
+/* messages of one sender kept in order while link is full, held by a
+ * reference and linked through msg->next. link_send_q_post() takes msg like
+ * link_send_post() and keeps it when link is full, the owner task gets sig
+ * when link takes messages again and calls link_send_q_flush() */
+typedef struct {
+	ak_msg_t* head;
+	ak_msg_t* tail;
+	uint8_t task_id;
+	uint8_t sig;
+} link_send_q_t;
+
+extern void link_send_q_init(link_send_q_t* send_q, uint8_t task_id, uint8_t sig);
+extern uint8_t link_send_q_post(link_send_q_t* send_q, ak_msg_t* msg);
+extern void link_send_q_flush(link_send_q_t* send_q);
+
+/* messages to if_des_task_id use channel instead of the default of their type */
+extern void link_set_channel(uint8_t if_des_task_id, uint8_t channel);
+extern void link_get_channel_stat(uint8_t channel, link_channel_stat_t* stat);
+
+/* remote routes: a message to if_des_task_id behind interface if_des_type is
+ * posted by link_route_post() straight to link, the interface tasks are not
+ * involved. LINK_CHANNEL_DEFAULT keeps the channel of link_set_channel() or
+ * of the message type. Received messages always go straight to their task */
+#define LINK_CHANNEL_DEFAULT		(0xFF)
+
+extern void link_route_set(uint8_t if_des_type, uint8_t if_des_task_id, uint8_t channel);
+
+/* takes msg like link_send_q_post() and returns the status, LINK_ROUTE_NONE
+ * leaves it to the caller */
+#define LINK_ROUTE_NONE				(0xFF)
+
+extern uint8_t link_route_post(link_send_q_t* send_q, ak_msg_t* msg);
+
+typedef struct {
+	uint32_t msg_sent; /* messages put in a pdu */
+	uint32_t msg_rev; /* messages passed up */
+	uint32_t rev_err; /* pdus or records malformed, dropped */
+	uint32_t agg_pdu; /* pdus carrying more than one message */
+	uint32_t lz_pdu; /* pdus sent compressed */
+	uint32_t lz_saved; /* bytes saved by compression */
+} link_stat_t;
+
+extern void link_get_stat(link_stat_t* stat);
 
 #endif //__LINK_H__
 
@@ -6,10 +6,121 @@
 #define LINK_PDU_BUF_SIZE			256
 #define LINK_PDU_POOL_SIZE			3
 
+/* pdus reserved for mac reassembly, taken from LINK_PDU_POOL_SIZE. Free ones
+ * are advertised to the peer as credits when both ends support it. */
+#define LINK_PDU_RX_POOL_SIZE		1
+
+/* send messages held by link while no pdu is free, LINK_SEND_STATUS_FULL
+ * above it. Senders keep their messages then and wait, see link_send_wait().
+ * They stay in the AK message pools, keep it well below AK_COMMON_MSG_POOL_SIZE */
+#define LINK_SEND_HOLD_MAX			2
+
+/* entries of link_send_wait() */
+#define LINK_SEND_WAIT_MAX			4
+
+/* a pdu given up by mac is sent again after this delay, link keeps it until
+ * peer takes it */
+#define LINK_SEND_RETRY_INTERVAL	100 /* ms */
+
+/* send pdus a LINK_CHANNEL_BULK message may not take, an urgent message
+ * then waits at most for one fragment of a bulk transfer */
+#define LINK_PDU_TX_BULK_RESERVE	1
+
+/* entries of link_set_channel() */
+#define LINK_CHANNEL_MAP_SIZE		4
+
+/* entries of link_route_set() */
+#define LINK_ROUTE_TABLE_SIZE		4
+
+/* calls of link_rpc_call() waiting for their response, largest request or
+ * response data and step of the call timeouts */
+#define LINK_RPC_CALL_MAX			4
+#define LINK_RPC_DATA_SIZE			96
+#define LINK_RPC_TICK_INTERVAL		100 /* ms */
+
+/* pure/common messages of LINK_CHANNEL_NORMAL sent while a pdu is on the way
+ * are packed into one pdu. It goes when link is free, when it is full, before
+ * any other message or at latest after this delay */
+#define LINK_SEND_AGG_INTERVAL		20 /* ms */
+
+/* with LINK_PHY_CAP_LINK_LZ a pdu of at least this data length is LZSS
+ * coded, it is sent raw when coding does not make it shorter. Hash table
+ * takes 2 << LINK_LZ_HASH_BITS bytes of RAM */
+#define LINK_LZ_MIN_LEN				32
+#define LINK_LZ_HASH_BITS			7
+
 #define LINK_PHY_FRAME_SEND_TO_INTERVAL		500 /* 500 */
 #define LINK_PHY_FRAME_REV_TO_INTERVAL		500 /* 500 */
 
-#define LINK_PHY_MAX_RETRY_SET_DEFAULT			1
+/* selective-repeat window, power of two in [1, 8]. Effective size is the
+ * smaller of both ends, negotiated at link start (1 with a legacy peer). */
+#define LINK_PHY_WINDOW_SIZE				4
+#define LINK_PHY_WINDOW_TICK_INTERVAL		10 /* ms, retransmit timer granularity */
+
+/* mac reassembly timeout granularity, also the delay before sending again
+ * when the frame buffer pool is held by the receiving side */
+#define LINK_MAC_TICK_INTERVAL				20 /* ms */
+
+/* adaptive retransmission timeout bounds (ms), LINK_PHY_FRAME_SEND_TO_INTERVAL
+ * is used until the first round trip is measured */
+#define LINK_PHY_RTO_INIT					LINK_PHY_FRAME_SEND_TO_INTERVAL
+#define LINK_PHY_RTO_MIN					30
+#define LINK_PHY_RTO_MAX					1000
+
+/* largest phy frame payload offered at link sync, in range [50, 255].
+ * Effective size is the smaller of both ends (50 with a legacy peer), MAC
+ * fragments pdu to it. */
+#define LINK_PHY_FRAME_DATA_SIZE_MAX		128
+
+/* reference counted frame buffers shared by phy/mac, one phy frame each.
+ * Held by: send window, receive window, frame being parsed, frames queued
+ * between tasks. Receiving drops the frame when the pool is empty. */
+#define LINK_FBUF_SIZE						(LINK_PHY_FRAME_DATA_SIZE_MAX + 18 + 2 * LINK_PHY_FEC_PARITY) /* phy header, crc trailer, stuffing overhead, fec parity */
+#define LINK_FBUF_POOL_SIZE					(2 * LINK_PHY_WINDOW_SIZE + 4)
+
+/* strongest frame check offered at link sync, see LINK_PHY_FCS_xxx */
+#define LINK_PHY_FCS_ALGO					LINK_PHY_FCS_CRC16
+
+/* framing offered at link sync, see LINK_PHY_FRAMING_xxx. COBS frames are
+ * delimited by 0x00 so the receiver resyncs at the next frame after
+ * corruption, only used together with CRC-16. Can be given on the compiler
+ * command line, the host build in mt-sources/test uses both framings. */
+#ifndef LINK_PHY_FRAMING
+#define LINK_PHY_FRAMING					LINK_PHY_FRAMING_COBS
+#endif
+
+/* forward error correction offered at link sync: Reed-Solomon parity bytes
+ * per codeword of a COBS frame, in range [0, 32], 0 disables it. Effective
+ * is the smaller of both ends (0 with a legacy peer). Receiver repairs up to
+ * LINK_PHY_FEC_PARITY / 2 corrupted bytes per 255 byte codeword instead of
+ * waiting for a retransmit, worth it on long noisy RS485 runs. Can be given
+ * on the compiler command line like LINK_PHY_FRAMING */
+#ifndef LINK_PHY_FEC_PARITY
+#define LINK_PHY_FEC_PARITY					0
+#endif
+
+/* capabilities offered at link sync, see LINK_PHY_CAP_xxx */
+#define LINK_PHY_CAPS						(LINK_PHY_CAP_MAC_CREDIT | LINK_PHY_CAP_MAC_INTERLEAVE | LINK_PHY_CAP_ACK_PIGGYBACK | \
+											 LINK_PHY_CAP_LINK_AGGREGATE | LINK_PHY_CAP_LINK_LZ)
+
+/* with LINK_PHY_CAP_ACK_PIGGYBACK an in-order frame is acknowledged in the
+ * header of the next data frame to peer. A standalone ack is sent after the
+ * delay, or once this many frames are unacknowledged */
+#define LINK_PHY_ACK_DELAY_INTERVAL			10 /* ms, well below LINK_PHY_RTO_MIN */
+#define LINK_PHY_ACK_DELAY_FRAMES			2
+
+/* multi-drop bus (RS485). A station drops frames for other addresses before
+ * buffering their payload and only transmits in the turn a poll of the
+ * master grants it: held frames, acknowledgement, then an end of turn.
+ * Both ends of a point-to-point link use LINK_PHY_ADDR_MASTER. Can be given
+ * on the compiler command line like LINK_PHY_FRAMING */
+#ifndef LINK_PHY_MULTI_DROP
+#define LINK_PHY_MULTI_DROP					0
+#endif
+#define LINK_PHY_ADDR_MASTER				0x00000000
+#define LINK_PHY_ADDR_STATION				0x00000001 /* default, see link_phy_addr_set() */
+
+#define LINK_PHY_MAX_RETRY_SET_DEFAULT			3
 #define LINK_MAC_PDU_SENDING_RETRY_COUNTER_MAX	1
 
 /* DEBUG */
@@ -9,29 +9,47 @@
 static uint32_t mac_src_add = 0xFFFFFFFF;
 static uint32_t mac_des_add = 0xFFFFFFFF;
 
+#define LINK_PDU_TX_POOL_SIZE	(LINK_PDU_POOL_SIZE - LINK_PDU_RX_POOL_SIZE)
+
+static_assert(LINK_PDU_RX_POOL_SIZE > 0 && LINK_PDU_TX_POOL_SIZE > 0, "LINK_PDU_RX_POOL_SIZE out of range");
+
+/* pdu id below LINK_PDU_TX_POOL_SIZE belongs to send pool, others to receive pool */
 static link_pdu_t* free_link_pdu_pool;
+static link_pdu_t* free_link_pdu_rx_pool;
+static uint32_t free_link_pdu_tx_pool_available;
+static uint32_t free_link_pdu_rx_pool_available;
 static link_pdu_t link_pdu_pool[LINK_PDU_POOL_SIZE];
 static uint32_t free_link_pdu_pool_used;
 static uint32_t free_link_pdu_pool_used_max;
 
+static link_fbuf_t* free_link_fbuf_pool;
+static link_fbuf_t link_fbuf_pool[LINK_FBUF_POOL_SIZE];
+static uint32_t link_fbuf_pool_used;
+static uint32_t link_fbuf_pool_used_max;
+
 static void link_pdu_fatal(const char* s, uint8_t c);
+static link_pdu_t* link_pdu_alloc(link_pdu_t** free_pool);
+static void link_pdu_release(link_pdu_t* link_pdu);
 
 /* link pdu function */
 void link_pdu_init() {
 	LINK_DBG_DATA("[LINK_DATA] link_pdu_init()\n");
 	ENTRY_CRITICAL();
-	free_link_pdu_pool = (link_pdu_t*)link_pdu_pool;
+	free_link_pdu_pool = (link_pdu_t*)&link_pdu_pool[0];
+	free_link_pdu_rx_pool = (link_pdu_t*)&link_pdu_pool[LINK_PDU_TX_POOL_SIZE];
 	for (uint32_t i = 0; i < LINK_PDU_POOL_SIZE; i++) {
 		link_pdu_pool[i].id = i;
 		link_pdu_pool[i].is_used = 0;
 
-		if (i == (LINK_PDU_POOL_SIZE - 1)) {
+		if (i == (LINK_PDU_TX_POOL_SIZE - 1) || i == (LINK_PDU_POOL_SIZE - 1)) {
 			link_pdu_pool[i].next = LINK_PDU_NULL;
 		}
 		else {
 			link_pdu_pool[i].next = (link_pdu_t*)&link_pdu_pool[i + 1];
 		}
 	}
+	free_link_pdu_tx_pool_available = LINK_PDU_TX_POOL_SIZE;
+	free_link_pdu_rx_pool_available = LINK_PDU_RX_POOL_SIZE;
 	free_link_pdu_pool_used = 0;
 	free_link_pdu_pool_used_max = 0;
 	EXIT_CRITICAL();
@@ -39,37 +57,39 @@ void link_pdu_init() {
 
 link_pdu_t* link_pdu_malloc() {
 	ENTRY_CRITICAL();
-	link_pdu_t* allocate_msg = free_link_pdu_pool;
-	if (allocate_msg == LINK_PDU_NULL) {
-		EXIT_CRITICAL();
-		LINK_DBG_DATA("[LINK_DATA] LINK_PDU_NULL == link_pdu_malloc()\n");
-		return allocate_msg;
+	link_pdu_t* allocate_msg = link_pdu_alloc(&free_link_pdu_pool);
+	if (allocate_msg != LINK_PDU_NULL) {
+		free_link_pdu_tx_pool_available--;
 	}
-	else {
-		allocate_msg->is_used = 1;
-		free_link_pdu_pool = free_link_pdu_pool->next;
+	EXIT_CRITICAL();
+	return allocate_msg;
+}
 
-		free_link_pdu_pool_used++;
-		if (free_link_pdu_pool_used >= free_link_pdu_pool_used_max) {
-			free_link_pdu_pool_used_max = free_link_pdu_pool_used;
-		}
+uint32_t link_pdu_tx_available() {
+	return free_link_pdu_tx_pool_available;
+}
+
+link_pdu_t* link_pdu_rx_malloc() {
+	ENTRY_CRITICAL();
+	link_pdu_t* allocate_msg = link_pdu_alloc(&free_link_pdu_rx_pool);
+	if (allocate_msg != LINK_PDU_NULL) {
+		free_link_pdu_rx_pool_available--;
 	}
 	EXIT_CRITICAL();
-	LINK_DBG_DATA("[LINK_DATA] link_pdu_malloc(%d)\n", allocate_msg->id);
 	return allocate_msg;
 }
 
+uint32_t link_pdu_rx_available() {
+	return free_link_pdu_rx_pool_available;
+}
+
 void link_pdu_free(link_pdu_t* link_pdu) {
-	LINK_DBG_DATA("[LINK_DATA] link_pdu_free(%d)\n", link_pdu->id);
 	ENTRY_CRITICAL();
 	if ((link_pdu != LINK_PDU_NULL) && \
 			(link_pdu->id < LINK_PDU_POOL_SIZE) && \
 			link_pdu->is_used) {
-		link_pdu->is_used = 0;
-		link_pdu->next = free_link_pdu_pool;
-		free_link_pdu_pool = link_pdu;
-
-		free_link_pdu_pool_used--;
+		LINK_DBG_DATA("[LINK_DATA] link_pdu_free(%d)\n", link_pdu->id);
+		link_pdu_release(link_pdu);
 	}
 	else {
 		link_pdu_fatal("LINK_PDU", 0x04);
@@ -104,11 +124,7 @@ void link_pdu_free(uint32_t pdu_id) {
 	LINK_DBG_DATA("[LINK_DATA] link_pdu_free(%d)\n", pdu_id);
 	ENTRY_CRITICAL();
 	if (pdu_id < LINK_PDU_POOL_SIZE && link_pdu_pool[pdu_id].is_used) {
-		link_pdu_pool[pdu_id].is_used = 0;
-		link_pdu_pool[pdu_id].next = free_link_pdu_pool;
-		free_link_pdu_pool = &link_pdu_pool[pdu_id];
-
-		free_link_pdu_pool_used--;
+		link_pdu_release(&link_pdu_pool[pdu_id]);
 	}
 	else {
 		link_pdu_fatal("LINK_PDU", 0x02);
@@ -116,6 +132,172 @@ void link_pdu_free(uint32_t pdu_id) {
 	EXIT_CRITICAL();
 }
 
+/* called in critical section */
+link_pdu_t* link_pdu_alloc(link_pdu_t** free_pool) {
+	link_pdu_t* allocate_msg = *free_pool;
+	if (allocate_msg == LINK_PDU_NULL) {
+		LINK_DBG_DATA("[LINK_DATA] LINK_PDU_NULL == link_pdu_malloc()\n");
+		return allocate_msg;
+	}
+
+	allocate_msg->is_used = 1;
+	*free_pool = allocate_msg->next;
+
+	free_link_pdu_pool_used++;
+	if (free_link_pdu_pool_used >= free_link_pdu_pool_used_max) {
+		free_link_pdu_pool_used_max = free_link_pdu_pool_used;
+	}
+	LINK_DBG_DATA("[LINK_DATA] link_pdu_malloc(%d)\n", allocate_msg->id);
+	return allocate_msg;
+}
+
+/* called in critical section, pdu goes back to the pool it was taken from */
+void link_pdu_release(link_pdu_t* link_pdu) {
+	link_pdu->is_used = 0;
+	if (link_pdu->id < LINK_PDU_TX_POOL_SIZE) {
+		link_pdu->next = free_link_pdu_pool;
+		free_link_pdu_pool = link_pdu;
+		free_link_pdu_tx_pool_available++;
+	}
+	else {
+		link_pdu->next = free_link_pdu_rx_pool;
+		free_link_pdu_rx_pool = link_pdu;
+		free_link_pdu_rx_pool_available++;
+	}
+
+	free_link_pdu_pool_used--;
+}
+
+/* link frame buffer function */
+void link_fbuf_init() {
+	LINK_DBG_DATA("[LINK_DATA] link_fbuf_init()\n");
+	ENTRY_CRITICAL();
+	free_link_fbuf_pool = (link_fbuf_t*)link_fbuf_pool;
+	for (uint32_t i = 0; i < LINK_FBUF_POOL_SIZE; i++) {
+		link_fbuf_pool[i].id = i;
+		link_fbuf_pool[i].ref = 0;
+
+		if (i == (LINK_FBUF_POOL_SIZE - 1)) {
+			link_fbuf_pool[i].next = LINK_FBUF_NULL;
+		}
+		else {
+			link_fbuf_pool[i].next = (link_fbuf_t*)&link_fbuf_pool[i + 1];
+		}
+	}
+	link_fbuf_pool_used = 0;
+	link_fbuf_pool_used_max = 0;
+	EXIT_CRITICAL();
+}
+
+link_fbuf_t* link_fbuf_malloc(uint16_t headroom) {
+	if (headroom > LINK_FBUF_SIZE) {
+		FATAL("LINK_FBUF", 0x01);
+	}
+
+	ENTRY_CRITICAL();
+	link_fbuf_t* allocate_fbuf = free_link_fbuf_pool;
+	if (allocate_fbuf == LINK_FBUF_NULL) {
+		EXIT_CRITICAL();
+		LINK_DBG_DATA("[LINK_DATA] LINK_FBUF_NULL == link_fbuf_malloc()\n");
+		return allocate_fbuf;
+	}
+	else {
+		allocate_fbuf->ref = 1;
+		allocate_fbuf->head = headroom;
+		allocate_fbuf->len = 0;
+		free_link_fbuf_pool = free_link_fbuf_pool->next;
+
+		link_fbuf_pool_used++;
+		if (link_fbuf_pool_used >= link_fbuf_pool_used_max) {
+			link_fbuf_pool_used_max = link_fbuf_pool_used;
+		}
+	}
+	EXIT_CRITICAL();
+	return allocate_fbuf;
+}
+
+link_fbuf_t* link_fbuf_get(uint32_t fbuf_id) {
+	link_fbuf_t* link_fbuf = LINK_FBUF_NULL;
+	ENTRY_CRITICAL();
+	if ((fbuf_id < LINK_FBUF_POOL_SIZE) && \
+			link_fbuf_pool[fbuf_id].ref) {
+		link_fbuf = (link_fbuf_t*)&link_fbuf_pool[fbuf_id];
+	}
+	else {
+		FATAL("LINK_FBUF", 0x02);
+	}
+	EXIT_CRITICAL();
+	return link_fbuf;
+}
+
+void link_fbuf_ref(link_fbuf_t* link_fbuf) {
+	ENTRY_CRITICAL();
+	if ((link_fbuf != LINK_FBUF_NULL) && link_fbuf->ref) {
+		link_fbuf->ref++;
+	}
+	else {
+		FATAL("LINK_FBUF", 0x03);
+	}
+	EXIT_CRITICAL();
+}
+
+void link_fbuf_free(link_fbuf_t* link_fbuf) {
+	ENTRY_CRITICAL();
+	if ((link_fbuf != LINK_FBUF_NULL) && \
+			(link_fbuf->id < LINK_FBUF_POOL_SIZE) && \
+			link_fbuf->ref) {
+		if (--link_fbuf->ref == 0) {
+			link_fbuf->next = free_link_fbuf_pool;
+			free_link_fbuf_pool = link_fbuf;
+
+			link_fbuf_pool_used--;
+		}
+	}
+	else {
+		FATAL("LINK_FBUF", 0x04);
+	}
+	EXIT_CRITICAL();
+}
+
+uint8_t* link_fbuf_data(link_fbuf_t* link_fbuf) {
+	return &link_fbuf->buf[link_fbuf->head];
+}
+
+uint8_t* link_fbuf_push(link_fbuf_t* link_fbuf, uint16_t len) {
+	if (len > link_fbuf->head) {
+		FATAL("LINK_FBUF", 0x05);
+	}
+	link_fbuf->head -= len;
+	link_fbuf->len += len;
+	return &link_fbuf->buf[link_fbuf->head];
+}
+
+uint8_t* link_fbuf_pull(link_fbuf_t* link_fbuf, uint16_t len) {
+	if (len > link_fbuf->len) {
+		FATAL("LINK_FBUF", 0x06);
+	}
+	link_fbuf->head += len;
+	link_fbuf->len -= len;
+	return &link_fbuf->buf[link_fbuf->head];
+}
+
+uint8_t* link_fbuf_put(link_fbuf_t* link_fbuf, uint16_t len) {
+	uint8_t* tail = &link_fbuf->buf[link_fbuf->head + link_fbuf->len];
+	if (link_fbuf->head + link_fbuf->len + len > LINK_FBUF_SIZE) {
+		FATAL("LINK_FBUF", 0x07);
+	}
+	link_fbuf->len += len;
+	return tail;
+}
+
+uint32_t get_link_fbuf_pool_used() {
+	return link_fbuf_pool_used;
+}
+
+uint32_t get_link_fbuf_pool_used_max() {
+	return link_fbuf_pool_used_max;
+}
+
 /* link address utilities */
 void link_set_src_addr(uint32_t addr) {
 	LINK_DBG_DATA("[LINK_DATA] link_set_src_addr(%d)\n", addr);
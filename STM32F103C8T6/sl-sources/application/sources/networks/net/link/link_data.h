@@ -17,19 +17,48 @@ typedef struct link_pdu_t {
 	struct link_pdu_t* next;
 	uint32_t id;
 	uint32_t is_used;
+	uint8_t channel; /* LINK_CHANNEL_xxx of a send pdu */
 	uint32_t len;
 	uint8_t payload[LINK_PDU_BUF_SIZE];
 } link_pdu_t;
 
-/* link pdu function */
+/* define reference counted frame buffer */
+#define LINK_FBUF_NULL				((link_fbuf_t*)0)
+
+typedef struct link_fbuf_t {
+	struct link_fbuf_t* next;
+	uint32_t id;
+	uint8_t ref; /* number of holders, back to pool when it drops to 0 */
+	uint16_t head; /* offset of first valid byte */
+	uint16_t len; /* valid bytes from head */
+	uint8_t buf[LINK_FBUF_SIZE];
+} link_fbuf_t;
+
+/* link pdu function, pool is split in send (link) and receive (mac reassembly) part */
 extern void link_pdu_init();
 extern link_pdu_t* link_pdu_malloc();
+extern uint32_t link_pdu_tx_available();
+extern link_pdu_t* link_pdu_rx_malloc();
+extern uint32_t link_pdu_rx_available();
 extern void link_pdu_free(link_pdu_t*);
 extern link_pdu_t* link_pdu_get(uint32_t);
 extern void link_pdu_free(uint32_t);
 extern uint32_t get_free_link_pdu_pool_used(); /* pool analytics */
 extern uint32_t get_free_link_pdu_pool_used_max(); /* pool analytics */
 
+/* link frame buffer function, buffer id is the handle passed between layers */
+extern void link_fbuf_init();
+extern link_fbuf_t* link_fbuf_malloc(uint16_t headroom);
+extern link_fbuf_t* link_fbuf_get(uint32_t);
+extern void link_fbuf_ref(link_fbuf_t*);
+extern void link_fbuf_free(link_fbuf_t*); /* drop one reference */
+extern uint8_t* link_fbuf_data(link_fbuf_t*);
+extern uint8_t* link_fbuf_push(link_fbuf_t*, uint16_t); /* prepend header in headroom */
+extern uint8_t* link_fbuf_pull(link_fbuf_t*, uint16_t); /* strip header */
+extern uint8_t* link_fbuf_put(link_fbuf_t*, uint16_t); /* append at tail */
+extern uint32_t get_link_fbuf_pool_used(); /* pool analytics */
+extern uint32_t get_link_fbuf_pool_used_max(); /* pool analytics */
+
 /* link address utilities */
 extern void link_set_src_addr(uint32_t);
 extern uint32_t link_get_src_addr();
@@ -0,0 +1,131 @@
+#include <stdint.h>
+#include "ak.h"
+
+#include "utils.h"
+
+#include "link_config.h"
+#include "link_lz.h"
+
+/* last position + 1 of each 3 bytes hash, 0 is empty. One candidate per
+ * hash keeps RAM fixed and coding time linear. */
+static uint16_t link_lz_hash_head[1 << LINK_LZ_HASH_BITS];
+
+static inline uint32_t link_lz_hash(const uint8_t* p) {
+	uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+	return (v * 2654435761u) >> (32 - LINK_LZ_HASH_BITS);
+}
+
+uint32_t link_lz_compress(const uint8_t* src, uint32_t src_len, uint8_t* des, uint32_t des_size) {
+	uint32_t in = 0;
+	uint32_t out = 0;
+	uint32_t flag_pos = 0;
+	uint8_t flag_bit = 8;
+
+	mem_set((uint8_t*)link_lz_hash_head, 0, sizeof(link_lz_hash_head));
+
+	while (in < src_len) {
+		if (flag_bit == 8) {
+			if (out >= des_size) {
+				return 0;
+			}
+			flag_pos = out++;
+			des[flag_pos] = 0;
+			flag_bit = 0;
+		}
+
+		uint32_t match_len = 0;
+		uint32_t match_pos = 0;
+
+		if (in + LINK_LZ_MATCH_MIN <= src_len) {
+			uint32_t h = link_lz_hash(&src[in]);
+
+			if (link_lz_hash_head[h] != 0) {
+				match_pos = link_lz_hash_head[h] - 1;
+
+				if (in - match_pos <= LINK_LZ_DISTANCE_MAX) {
+					uint32_t limit = src_len - in;
+					if (limit > LINK_LZ_MATCH_MAX) {
+						limit = LINK_LZ_MATCH_MAX;
+					}
+
+					while (match_len < limit && src[match_pos + match_len] == src[in + match_len]) {
+						match_len++;
+					}
+				}
+			}
+			link_lz_hash_head[h] = in + 1;
+		}
+
+		if (match_len >= LINK_LZ_MATCH_MIN) {
+			if (out + 2 > des_size) {
+				return 0;
+			}
+
+			uint32_t distance = in - match_pos - 1;
+			des[out++] = (uint8_t)(((distance >> 8) << 4) | (match_len - LINK_LZ_MATCH_MIN));
+			des[out++] = (uint8_t)distance;
+			des[flag_pos] |= (1 << flag_bit);
+
+			/* bytes covered by the match are still candidates */
+			for (uint32_t i = in + 1; i < in + match_len && i + LINK_LZ_MATCH_MIN <= src_len; i++) {
+				link_lz_hash_head[link_lz_hash(&src[i])] = i + 1;
+			}
+			in += match_len;
+		}
+		else {
+			if (out >= des_size) {
+				return 0;
+			}
+			des[out++] = src[in++];
+		}
+
+		flag_bit++;
+	}
+
+	return out;
+}
+
+uint32_t link_lz_decompress(const uint8_t* src, uint32_t src_len, uint8_t* des, uint32_t des_size) {
+	uint32_t in = 0;
+	uint32_t out = 0;
+	uint8_t flag = 0;
+	uint8_t flag_bit = 8;
+
+	while (in < src_len) {
+		if (flag_bit == 8) {
+			flag = src[in++];
+			flag_bit = 0;
+			continue;
+		}
+
+		if (flag & (1 << flag_bit)) {
+			if (in + 2 > src_len) {
+				return 0;
+			}
+
+			uint32_t match_len = (src[in] & 0x0F) + LINK_LZ_MATCH_MIN;
+			uint32_t distance = (((uint32_t)(src[in] >> 4) << 8) | src[in + 1]) + 1;
+			in += 2;
+
+			if (distance > out || out + match_len > des_size) {
+				return 0;
+			}
+
+			/* byte by byte, match may overlap its own output */
+			while (match_len--) {
+				des[out] = des[out - distance];
+				out++;
+			}
+		}
+		else {
+			if (out >= des_size) {
+				return 0;
+			}
+			des[out++] = src[in++];
+		}
+
+		flag_bit++;
+	}
+
+	return out;
+}
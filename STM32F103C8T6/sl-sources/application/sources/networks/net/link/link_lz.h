@@ -0,0 +1,20 @@
+#ifndef __LINK_LZ_H__
+#define __LINK_LZ_H__
+
+#include <stdint.h>
+#include "link_config.h"
+
+/* LZSS coding of one pdu. A flag byte leads each group of 8 items, bit set
+ * for a match of 2 bytes (12 bits distance - 1, 4 bits length - 3), clear
+ * for a literal byte. Window is the pdu itself, input below 64 KB. */
+#define LINK_LZ_MATCH_MIN		(3)
+#define LINK_LZ_MATCH_MAX		(LINK_LZ_MATCH_MIN + 0x0F)
+#define LINK_LZ_DISTANCE_MAX	(0x1000)
+
+/* return coded length, 0 when it does not fit in des_size */
+extern uint32_t link_lz_compress(const uint8_t* src, uint32_t src_len, uint8_t* des, uint32_t des_size);
+
+/* return decoded length, 0 when src is malformed or does not fit in des_size */
+extern uint32_t link_lz_decompress(const uint8_t* src, uint32_t src_len, uint8_t* des, uint32_t des_size);
+
+#endif //__LINK_LZ_H__
@@ -12,6 +12,11 @@
 #include "message.h"
 #include "timer.h"
 
+#include "utils.h"
+#include "crc16.h"
+#include "cobs.h"
+#include "rs.h"
+
 #include "sys_dbg.h"
 #include "sys_ctl.h"
 
@@ -22,6 +27,7 @@
 #include "link_sig.h"
 #include "link_phy.h"
 #include "link_mac.h"
+#include "link_data.h"
 
 typedef enum {
 	/* private */
@@ -30,13 +36,29 @@ typedef enum {
 
 	/* pulic */
 	PHY_FRAME_TYPE_REQ, /* request frame (require target response) */
+
+	/* private */
+	PHY_FRAME_TYPE_SYNC, /* link negotiation, data: [window size, sending base sequence, fcs algorithm, frame data size, framing, capabilities, fec parity] */
+	PHY_FRAME_TYPE_POLL, /* multi-drop: master grants a station its turn, the station ends it */
 } phy_frame_type_e;
 
+#define PHY_FRAME_TYPE_MASK			(0x3F)
+#define PHY_FRAME_TYPE_FCS_CRC16	(0x80) /* fcs byte unused, CRC-16 trailer follows data */
+#define PHY_FRAME_TYPE_ACK_CUM		(0x40) /* REQ frame, sub_type: next expected sequence, all before it are received */
+
 typedef enum {
 	/* private */
 	PHY_FRAME_SUB_TYPE_NACK_TO = 0x01,
 	PHY_FRAME_SUB_TYPE_NACK_ERR,
 
+	PHY_FRAME_SUB_TYPE_ACK_CUM = 0x01, /* data[0]: next expected sequence, all before it are received */
+
+	PHY_FRAME_SUB_TYPE_SYNC_REQ = 0x01,
+	PHY_FRAME_SUB_TYPE_SYNC_RES,
+
+	PHY_FRAME_SUB_TYPE_POLL_REQ = 0x01,
+	PHY_FRAME_SUB_TYPE_POLL_END,
+
 	/* pulic */
 } phy_frame_sub_type_e;
 
@@ -49,73 +71,230 @@ typedef enum {
 	PARSER_STATE_SEQ_NUM,
 	PARSER_STATE_LEN,
 	PARSER_STATE_DATA,
-	PARSER_STATE_FCS
+	PARSER_STATE_FCS,
+	PARSER_STATE_CRC,
+	PARSER_STATE_COBS /* stuffed frame, collected up to the delimiter */
 } link_phy_frame_parser_state_e;
 
-
-/* sending data manager */
-#define LINK_PHY_SEND_STATE_IDLE		0
-#define LINK_PHY_SEND_STATE_SENDING		1
-static uint8_t link_phy_send_state = LINK_PHY_SEND_STATE_IDLE;
-static void link_phy_send_state_set(uint8_t);
-static uint8_t link_phy_send_state_get();
-
-/* retry counter */
-static uint8_t retry_counter_send;
-
-/* sequence number */
-static uint8_t link_phy_send_seq_num;
-static uint8_t link_phy_rev_seq_num;
+#if (LINK_PHY_WINDOW_SIZE == 0) || (LINK_PHY_WINDOW_SIZE > 8) || (LINK_PHY_WINDOW_SIZE & (LINK_PHY_WINDOW_SIZE - 1))
+#error "LINK_PHY_WINDOW_SIZE must be a power of two in range [1, 8]"
+#endif
+
+#define LINK_PHY_WINDOW_IDX(seq)			((seq) & (LINK_PHY_WINDOW_SIZE - 1))
+#define LINK_PHY_SEQ_OFFSET(seq, base)		((uint8_t)((uint8_t)(seq) - (uint8_t)(base)))
+
+/* sending window manager */
+#define LINK_PHY_SLOT_FREE		0
+#define LINK_PHY_SLOT_SENT		1
+#define LINK_PHY_SLOT_ACKED		2
+
+static_assert(LINK_PHY_FRAME_SIZE <= LINK_FBUF_SIZE, "link frame buffer can not hold a phy frame");
+static_assert(COBS_ENCODED_SIZE_MAX(LINK_PHY_FRAME_SIZE) <= LINK_FBUF_SIZE, "link frame buffer can not hold a stuffed phy frame");
+static_assert(LINK_PHY_FRAME_DATA_SIZE >= LINK_PHY_FRAME_DATA_SIZE_LEGACY && LINK_PHY_FRAME_DATA_SIZE <= 0xFF,
+			  "LINK_PHY_FRAME_DATA_SIZE_MAX must be in range [LINK_PHY_FRAME_DATA_SIZE_LEGACY, 255]");
+
+/* fec: one Reed-Solomon codeword per started block of frame and trailer, the
+ * parity of all codewords follows the trailer in codeword order */
+#define LINK_PHY_FEC_BLOCK_SIZE(parity)		(RS_CODEWORD_SIZE_MAX - (parity))
+#define LINK_PHY_FEC_SIZE(len, parity)		(((len) + LINK_PHY_FEC_BLOCK_SIZE(parity) - 1) / LINK_PHY_FEC_BLOCK_SIZE(parity) * (parity))
+#define LINK_PHY_FEC_SIZE_MAX				LINK_PHY_FEC_SIZE(LINK_PHY_FRAME_SIZE, LINK_PHY_FEC_PARITY)
+
+static_assert(LINK_PHY_FEC_PARITY <= RS_PARITY_MAX, "LINK_PHY_FEC_PARITY must be in range [0, 32]");
+static_assert(COBS_ENCODED_SIZE_MAX(LINK_PHY_FRAME_SIZE + LINK_PHY_FEC_SIZE_MAX) <= LINK_FBUF_SIZE, "link frame buffer can not hold a stuffed phy frame with fec parity");
+
+typedef struct {
+	link_fbuf_t* fbuf; /* header prepended in place, released when slid out */
+	uint8_t state;
+	uint8_t retry;
+	uint32_t sent_at; /* ms */
+	uint32_t rto; /* ms, doubled on each timeout of this frame */
+	uint8_t held; /* multi-drop: not written yet, goes at next turn */
+} link_phy_send_slot_t;
+
+typedef struct {
+	link_fbuf_t* fbuf; /* LINK_FBUF_NULL when empty */
+} link_phy_rev_slot_t;
+
+static link_phy_send_slot_t link_phy_send_window[LINK_PHY_WINDOW_SIZE];
+static uint8_t link_phy_send_base; /* oldest unacknowledged sequence */
+static uint8_t link_phy_send_next; /* next sequence to be sent */
+static uint8_t link_phy_send_done_pending; /* window full, SEND_DONE to MAC is deferred */
+static uint8_t link_phy_send_err_pending; /* window flushed, next SEND_REQ is answered with SEND_ERR */
+
+/* receiving window manager */
+static link_phy_rev_slot_t link_phy_rev_window[LINK_PHY_WINDOW_SIZE];
+static uint8_t link_phy_rev_base; /* next in-order sequence expected */
+static uint8_t link_phy_rev_synced; /* peer sending base is known */
+static uint8_t link_phy_rev_nack_sent;
+static uint8_t link_phy_rev_ack_pending; /* in-order frames not acknowledged yet, see LINK_PHY_CAP_ACK_PIGGYBACK */
+
+/* negotiated window, stop-and-wait (1) until peer answered sync */
+static uint8_t link_phy_window_size;
+static uint8_t link_phy_sync_retry;
+
+/* negotiated frame payload, legacy size until peer answered sync */
+static uint8_t link_phy_frame_data_size;
+
+/* negotiated framing, SOF framing until peer answered sync */
+static uint8_t link_phy_framing;
+
+/* negotiated capabilities, none until peer answered sync */
+static uint8_t link_phy_caps;
+
+/* negotiated fec parity bytes per codeword, none until peer answered sync */
+static uint8_t link_phy_fec_parity;
+
+/* encoded bytes of the stuffed frame being collected */
+#define LINK_PHY_REV_COBS_DROP		(0xFFFF) /* overrun or no buffer, wait for next delimiter */
+#define LINK_PHY_REV_COBS_SKIP		(0xFFFE) /* frame for another station, wait for next delimiter */
+static uint16_t link_phy_rev_cobs_len;
+
+/* bus addresses, both ends of a point-to-point link use LINK_PHY_ADDR_MASTER */
+#if (LINK_PHY_MULTI_DROP == 1)
+static uint32_t link_phy_addr = LINK_PHY_ADDR_STATION;
+#else
+static uint32_t link_phy_addr = LINK_PHY_ADDR_MASTER;
+#endif
+static uint32_t link_phy_peer_addr = LINK_PHY_ADDR_MASTER;
+
+/* multi-drop: station holds the bus, frames written out of turn wait for the next one */
+static uint8_t link_phy_poll_turn;
+static uint8_t link_phy_sync_pending; /* PHY_FRAME_SUB_TYPE_SYNC_xxx to send at next turn, 0 if none */
+
+/* multi-drop: frame being received is for another station, its payload is not buffered */
+static uint8_t link_phy_rev_skip;
+#if (LINK_PHY_MULTI_DROP == 1)
+static uint8_t link_phy_rev_addr_len; /* decoded bytes of a stuffed frame, up to the destination address */
+static uint32_t link_phy_rev_addr;
+static uint8_t link_phy_rev_cobs_code;
+static uint8_t link_phy_rev_cobs_run;
+#endif
+
+/* negotiated frame check, XOR-8 until peer answered sync */
+static uint8_t link_phy_fcs_algo;
+static uint16_t link_phy_rev_crc;
+static uint16_t link_phy_rev_crc_trailer;
+
+/* round trip estimation (Jacobson/Karels), srtt scaled by 8, rttvar by 4 */
+static uint32_t link_phy_srtt;
+static uint32_t link_phy_rttvar;
+static uint32_t link_phy_rto;
+static uint32_t link_phy_rtt_last;
+static uint32_t link_phy_retransmit;
+static uint32_t link_phy_fast_retransmit;
+
+/* traffic and error counters, see link_phy_stat_t */
+static uint32_t link_phy_frame_sent;
+static uint32_t link_phy_frame_rev;
+static uint32_t link_phy_byte_sent;
+static uint32_t link_phy_byte_rev;
+static uint32_t link_phy_fcs_err;
+static uint32_t link_phy_rev_to;
+static uint32_t link_phy_rev_drop;
+static uint32_t link_phy_send_fail;
+static uint32_t link_phy_fec_fixed;
+static uint32_t link_phy_fec_byte;
+static uint32_t link_phy_rev_foreign;
+static uint32_t link_phy_poll;
 
 /* link physic max retry */
 static uint8_t link_phy_max_retry_val;
 
-/* static physic frame object */
-static link_phy_frame_t send_link_phy_frame;
-static link_phy_frame_t rev_link_phy_frame;
+/* frame being parsed, kept across aborted frames and handed over on completion */
+static link_fbuf_t* rev_link_phy_fbuf;
+static link_phy_frame_t* rev_link_phy_frame;
 
 /* receive frame parser state */
 link_phy_frame_parser_state_e link_phy_frame_parser_state_revc;
 
 /* start up state-machine */
 fsm_t fsm_link_phy;
-void (*link_put_c)(uint8_t);
 
 /* write data to physical layer declare function */
 static void link_phy_frame_write_block(uint8_t* data, uint32_t data_len);
 static void link_phy_frame_write(link_phy_frame_t* frame);
+static void link_phy_frame_write_cobs(link_phy_frame_t* frame, uint8_t* crc_trailer);
+static uint32_t link_phy_frame_fec_encode(uint8_t* frame, uint32_t len);
+static void link_phy_frame_write_ctrl(uint32_t des_addr, uint8_t type, uint8_t sub_type, uint8_t seq_num, uint8_t* data, uint8_t len);
 
-/* receive byte calback function */
+/* receive calback function */
+static void link_phy_frame_rev_block(uint8_t* data, uint32_t len);
 static uint8_t ac_link_phy_frame_rev_byte(uint8_t c);
 
-/* write byte calback function */
-static uint8_t link_phy_frame_write_byte(uint8_t byte);
-
 static uint8_t link_phy_frame_cals_checksum(link_phy_frame_t* phy_frame);
+static void link_phy_frame_rev_end(uint8_t fcs_ok);
+static void link_phy_frame_rev_cobs_byte(uint8_t c);
+static uint32_t link_phy_frame_rev_cobs_block(uint8_t* data, uint32_t len);
+static void link_phy_frame_rev_cobs_end();
+static uint32_t link_phy_frame_fec_decode(uint8_t* frame, uint32_t len);
+#if (LINK_PHY_MULTI_DROP == 1)
+static void link_phy_frame_rev_cobs_addr(uint8_t c);
+static void link_phy_frame_rev_addr_check(uint32_t des_addr);
+#endif
+
+/* sliding window */
+static uint8_t link_phy_send_window_used();
+static void link_phy_send_window_slot_send(link_phy_send_slot_t* slot);
+static void link_phy_send_window_ack(uint8_t seq_num);
+static void link_phy_send_window_ack_cum(uint8_t next_seq_num);
+static void link_phy_send_window_slide();
+static void link_phy_send_window_acked(link_phy_send_slot_t* slot);
+static void link_phy_send_window_retry(link_phy_send_slot_t* slot, uint8_t is_timeout);
+static void link_phy_rtt_sample(uint32_t rtt);
+static uint32_t link_phy_millis();
+static void link_phy_rev_window_reset(uint8_t base);
+static void link_phy_rev_window_req(link_fbuf_t* fbuf);
+static void link_phy_rev_deliver(link_fbuf_t* fbuf);
+static void link_phy_rev_ack_delay();
+static void link_phy_rev_ack_send();
+static void link_phy_sync_set_window(uint8_t peer_window);
+static void link_phy_sync_set_fcs(link_phy_frame_t* sync_frame);
+static void link_phy_sync_set_frame_data_size(link_phy_frame_t* sync_frame);
+static void link_phy_sync_set_framing(link_phy_frame_t* sync_frame);
+static void link_phy_sync_set_caps(link_phy_frame_t* sync_frame);
+static void link_phy_sync_set_fec(link_phy_frame_t* sync_frame);
+static void link_phy_sync_req();
+static void link_phy_sync_res();
+
+/* multi-drop bus access */
+static uint8_t link_phy_tx_allowed();
+static void link_phy_tx_flush();
+static void link_phy_poll_turn_take();
 
 static void link_phy_frame_send_max_retry();
-static void link_phy_frame_send();
 
 void TaskLinkPhy(ak_msg_t* msg) {
 	fsm_dispatch(&fsm_link_phy, msg);
 }
 
-void link_phy_send_state_set(uint8_t state) {
-	link_phy_send_state = state;
+void link_phy_frame_write_block(uint8_t* data, uint32_t data_len) {
+	link_hal_write_block(data, data_len);
 }
 
-uint8_t link_phy_send_state_get() {
-	return link_phy_send_state;
-}
+void link_phy_frame_write(link_phy_frame_t* frame) {
+	uint8_t crc_trailer[2];
+	uint8_t crc_en = (link_phy_fcs_algo == LINK_PHY_FCS_CRC16) &&
+					 ((frame->header.type & PHY_FRAME_TYPE_MASK) != PHY_FRAME_TYPE_SYNC);
+	uint8_t cobs_en = crc_en && (link_phy_framing == LINK_PHY_FRAMING_COBS);
+
+	/* fcs is applied on the wire, a retransmitted slot follows the current algorithm */
+	if (crc_en) {
+		frame->header.type |= PHY_FRAME_TYPE_FCS_CRC16;
+		frame->header.fcs = 0;
+		uint16_t crc = crc16_ccitt(CRC16_CCITT_INIT, (uint8_t*)frame, sizeof(link_phy_frame_header_t) + frame->header.len);
+		crc_trailer[0] = (uint8_t)(crc >> 8);
+		crc_trailer[1] = (uint8_t)crc;
+	}
+	else {
+		frame->header.type &= ~PHY_FRAME_TYPE_FCS_CRC16;
+		frame->header.fcs = link_phy_frame_cals_checksum(frame);
+	}
 
-void link_phy_frame_write_block(uint8_t* data, uint32_t data_len) {
-	while (data_len) {
-		plink_hal_write_byte(*(data++));
-		data_len--;
+	if (cobs_en) {
+		link_phy_frame_write_cobs(frame, crc_trailer);
+		return;
 	}
-}
 
-void link_phy_frame_write(link_phy_frame_t* frame) {
 	/* write frame header */
 	link_phy_frame_write_block((uint8_t*)frame, sizeof(link_phy_frame_header_t));
 
@@ -123,6 +302,75 @@ void link_phy_frame_write(link_phy_frame_t* frame) {
 	if (frame->header.len) {
 		link_phy_frame_write_block((uint8_t*)frame->data, frame->header.len);
 	}
+
+	if (crc_en) {
+		link_phy_frame_write_block(crc_trailer, sizeof(crc_trailer));
+	}
+}
+
+void link_phy_frame_write_cobs(link_phy_frame_t* frame, uint8_t* crc_trailer) {
+	uint8_t wire[COBS_ENCODED_SIZE_MAX(LINK_PHY_FRAME_SIZE + LINK_PHY_FEC_SIZE_MAX) + 2];
+	uint32_t len = LINK_PHY_FRAME_HEADER_SIZE + frame->header.len;
+
+	/* trailer is stuffed with the frame, data has room for it */
+	frame->data[frame->header.len] = crc_trailer[0];
+	frame->data[frame->header.len + 1] = crc_trailer[1];
+	len += LINK_PHY_FRAME_TRAILER_SIZE;
+	len += link_phy_frame_fec_encode((uint8_t*)frame, len);
+
+	/* leading delimiter terminates any garbage pending at the receiver */
+	wire[0] = COBS_DELIMITER;
+	len = cobs_encode((uint8_t*)frame, len, &wire[1]) + 1;
+	wire[len++] = COBS_DELIMITER;
+
+	link_phy_frame_write_block(wire, len);
+}
+
+uint32_t link_phy_frame_fec_encode(uint8_t* frame, uint32_t len) {
+	uint8_t parity_len = link_phy_fec_parity;
+	uint32_t block_size = LINK_PHY_FEC_BLOCK_SIZE(parity_len);
+
+	/* parity goes after the trailer: a frame buffer is sized for it and
+	 * control frames leave most of their data room unused */
+	uint8_t* parity = frame + len;
+
+	if (parity_len == 0) {
+		return 0;
+	}
+
+	for (uint32_t i = 0; i < len; i += block_size) {
+		uint32_t block = (len - i < block_size) ? len - i : block_size;
+		rs_encode(frame + i, block, parity, parity_len);
+		parity += parity_len;
+	}
+
+	return (uint32_t)(parity - (frame + len));
+}
+
+void link_phy_frame_write_ctrl(uint32_t des_addr, uint8_t type, uint8_t sub_type, uint8_t seq_num, uint8_t* data, uint8_t len) {
+	if (!link_phy_tx_allowed()) {
+		/* out of turn: sync is answered fresh and acknowledgement goes cumulative at next turn */
+		if (type == PHY_FRAME_TYPE_SYNC) {
+			link_phy_sync_pending = sub_type;
+		}
+		else if ((type == PHY_FRAME_TYPE_ACK || type == PHY_FRAME_TYPE_NACK) && !link_phy_rev_ack_pending) {
+			link_phy_rev_ack_pending = 1;
+		}
+		return;
+	}
+
+	link_phy_frame_t ctrl_frame;
+	ctrl_frame.header.sof = LINK_PHY_SOF;
+	ctrl_frame.header.des_addr = des_addr;
+	ctrl_frame.header.src_addr = link_phy_addr;
+	ctrl_frame.header.type = type;
+	ctrl_frame.header.sub_type = sub_type;
+	ctrl_frame.header.seq_num = seq_num;
+	ctrl_frame.header.len = len;
+	if (len) {
+		mem_cpy(ctrl_frame.data, data, len);
+	}
+	link_phy_frame_write(&ctrl_frame);
 }
 
 uint8_t link_phy_frame_cals_checksum(link_phy_frame_t* phy_frame) {
@@ -150,26 +398,72 @@ void fsm_link_phy_state_init(ak_msg_t* msg) {
 		/* private object init */
 		ENTRY_CRITICAL();
 
-		link_phy_send_state_set(LINK_PHY_SEND_STATE_IDLE);
-		retry_counter_send = 0;
+		link_phy_send_base = (uint8_t)rand();
+		link_phy_send_next = link_phy_send_base;
+		link_phy_send_done_pending = 0;
+		link_phy_send_err_pending = 0;
 
-		link_phy_send_seq_num = (uint8_t)rand();
-		link_phy_rev_seq_num = (uint8_t)rand();
+		for (uint8_t i = 0; i < LINK_PHY_WINDOW_SIZE; i++) {
+			link_phy_send_window[i].fbuf = LINK_FBUF_NULL;
+			link_phy_send_window[i].state = LINK_PHY_SLOT_FREE;
+		}
+
+		/* pool was made again by link init, frames left from the last run are gone */
+		for (uint8_t i = 0; i < LINK_PHY_WINDOW_SIZE; i++) {
+			link_phy_rev_window[i].fbuf = LINK_FBUF_NULL;
+		}
 
-		send_link_phy_frame.header.sof = LINK_PHY_SOF;
-		rev_link_phy_frame.header.sof = LINK_PHY_SOF;
+		link_phy_rev_ack_pending = 0;
+		link_phy_rev_window_reset((uint8_t)rand());
+		link_phy_rev_synced = 0;
+
+		link_phy_window_size = 1;
+		link_phy_fcs_algo = LINK_PHY_FCS_XOR8;
+		link_phy_frame_data_size = LINK_PHY_FRAME_DATA_SIZE_LEGACY;
+		link_phy_framing = LINK_PHY_FRAMING_SOF;
+		link_phy_caps = 0;
+		link_phy_fec_parity = 0;
+
+		link_phy_srtt = 0;
+		link_phy_rttvar = 0;
+		link_phy_rto = LINK_PHY_RTO_INIT;
+		link_phy_rtt_last = 0;
+		link_phy_retransmit = 0;
+		link_phy_fast_retransmit = 0;
+		link_phy_frame_sent = 0;
+		link_phy_frame_rev = 0;
+		link_phy_byte_sent = 0;
+		link_phy_byte_rev = 0;
+		link_phy_fcs_err = 0;
+		link_phy_rev_to = 0;
+		link_phy_rev_drop = 0;
+		link_phy_send_fail = 0;
+		link_phy_fec_fixed = 0;
+		link_phy_fec_byte = 0;
+		link_phy_rev_foreign = 0;
+		link_phy_poll = 0;
+
+		link_phy_poll_turn = 0;
+		link_phy_sync_pending = 0;
+
+		rev_link_phy_fbuf = LINK_FBUF_NULL;
+		link_phy_rev_cobs_len = 0;
+		link_phy_rev_skip = 0;
 
 		link_phy_frame_parser_state_revc = PARSER_STATE_SOF;
 
 		link_phy_max_retry_set(LINK_PHY_MAX_RETRY_SET_DEFAULT);
 
-		link_hal_reg_rev_byte(ac_link_phy_frame_rev_byte);
-		link_hal_reg_write_byte(link_phy_frame_write_byte);
+		link_hal_reg_rev_block(link_phy_frame_rev_block);
 
 		EXIT_CRITICAL();
 
 		FSM_TRAN(&fsm_link_phy, fsm_link_phy_state_handle);
 
+		/* negotiate window with peer, stop-and-wait until answered */
+		link_phy_sync_retry = 0;
+		link_phy_sync_req();
+
 		task_post_pure_msg(SL_LINK_MAC_ID, AC_LINK_MAC_PHY_LAYER_STARTED);
 	}
 		break;
@@ -183,127 +477,243 @@ void fsm_link_phy_state_handle(ak_msg_t* msg) {
 	switch (msg->sig) {
 	case AC_LINK_PHY_FRAME_SEND_REQ: {
 		LINK_DBG_SIG("AC_LINK_PHY_FRAME_SEND_REQ\n");
-		if (link_phy_send_state_get() == LINK_PHY_SEND_STATE_IDLE) {
-			/* sending frame packed */
-			send_link_phy_frame.header.type = (uint8_t)PHY_FRAME_TYPE_REQ;
-			send_link_phy_frame.header.sub_type = 0;
-			send_link_phy_frame.header.seq_num = ++link_phy_send_seq_num;
-			send_link_phy_frame.header.len = get_data_len_common_msg(msg);
-			if (send_link_phy_frame.header.len > LINK_PHY_FRAME_DATA_SIZE) {
-				FATAL("LK_PHY", 0x01);
-			}
-			memcpy((uint8_t*)send_link_phy_frame.data, (uint8_t*)get_data_common_msg(msg), send_link_phy_frame.header.len);
-			send_link_phy_frame.header.fcs = link_phy_frame_cals_checksum((link_phy_frame_t*)&send_link_phy_frame);
+		uint32_t fbuf_id;
+		mem_cpy((uint8_t*)&fbuf_id, (uint8_t*)get_data_common_msg(msg), sizeof(uint32_t));
 
-			retry_counter_send = 0;
-			link_phy_send_state_set(LINK_PHY_SEND_STATE_SENDING);
+		link_fbuf_t* fbuf = link_fbuf_get(fbuf_id);
+		if (fbuf->len > LINK_PHY_FRAME_DATA_SIZE) {
+			FATAL("LK_PHY", 0x01);
+		}
 
-			link_phy_frame_send();
+		/* a frame of the previous request was lost, report it against this one.
+		 * A frame fragmented before the peer re-synced to a smaller size is
+		 * refused the same way, MAC restarts the pdu with the new size */
+		if (link_phy_send_err_pending || fbuf->len > link_phy_frame_data_size) {
+			link_phy_send_err_pending = 0;
+			link_fbuf_free(fbuf);
+			task_post_pure_msg(SL_LINK_MAC_ID, AC_LINK_MAC_FRAME_SEND_ERR);
+			break;
 		}
-		else {
+
+		/* MAC only sends after SEND_DONE, so a slot is free unless window shrank on re-sync */
+		if (link_phy_send_window_used() >= LINK_PHY_WINDOW_SIZE) {
 			FATAL("LK_PHY", 0x02);
 		}
+
+		uint8_t seq_num = link_phy_send_next++;
+		link_phy_send_slot_t* slot = &link_phy_send_window[LINK_PHY_WINDOW_IDX(seq_num)];
+
+		/* sending frame packed, slot takes over the buffer reference */
+		uint8_t len = (uint8_t)fbuf->len;
+		link_phy_frame_t* frame = (link_phy_frame_t*)link_fbuf_push(fbuf, LINK_PHY_FRAME_HEADER_SIZE);
+		frame->header.sof = LINK_PHY_SOF;
+		frame->header.des_addr = link_phy_peer_addr;
+		frame->header.src_addr = link_phy_addr;
+		frame->header.type = (uint8_t)PHY_FRAME_TYPE_REQ;
+		frame->header.sub_type = 0;
+		frame->header.seq_num = seq_num;
+		frame->header.len = len;
+
+		slot->fbuf = fbuf;
+		slot->state = LINK_PHY_SLOT_SENT;
+		slot->retry = 0;
+		slot->rto = link_phy_rto;
+		slot->held = 0;
+		link_phy_send_window_slot_send(slot);
+		link_phy_frame_sent++;
+		link_phy_byte_sent += len;
+
+		if (link_phy_send_window_used() == 1) {
+			timer_set(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_SEND_TO, LINK_PHY_WINDOW_TICK_INTERVAL, TIMER_PERIODIC);
+		}
+
+		/* MAC may push next frame while window is open */
+		if (link_phy_send_window_used() < link_phy_window_size) {
+			task_post_pure_msg(SL_LINK_MAC_ID, AC_LINK_MAC_FRAME_SEND_DONE);
+		}
+		else {
+			link_phy_send_done_pending = 1;
+		}
 	}
 		break;
 
 	case AC_LINK_PHY_FRAME_SEND_TO: {
 		LINK_DBG_SIG("AC_LINK_PHY_FRAME_SEND_TO\n");
-		if (retry_counter_send >= link_phy_max_retry_val) {
-			link_phy_frame_send_max_retry();
-		}
-		else {
-			link_phy_frame_send();
+		uint32_t now = link_phy_millis();
+
+		for (uint8_t seq_num = link_phy_send_base; seq_num != link_phy_send_next; seq_num++) {
+			link_phy_send_slot_t* slot = &link_phy_send_window[LINK_PHY_WINDOW_IDX(seq_num)];
+
+			if (slot->state == LINK_PHY_SLOT_SENT && !slot->held && (uint32_t)(now - slot->sent_at) >= slot->rto) {
+				link_phy_send_window_retry(slot, 1);
+
+				/* window was flushed */
+				if (link_phy_send_window_used() == 0) {
+					break;
+				}
+			}
 		}
-		retry_counter_send++;
 	}
 		break;
 
 	case AC_LINK_PHY_FRAME_REV: {
 		LINK_DBG_SIG("AC_LINK_PHY_FRAME_REV\n");
-		link_phy_frame_t* link_frame_rev = (link_phy_frame_t*)get_data_common_msg(msg);
+		uint32_t fbuf_id;
+		mem_cpy((uint8_t*)&fbuf_id, (uint8_t*)get_data_common_msg(msg), sizeof(uint32_t));
+
+		link_fbuf_t* fbuf = link_fbuf_get(fbuf_id);
+		link_phy_frame_t* link_frame_rev = (link_phy_frame_t*)link_fbuf_data(fbuf);
+
+		/* once CRC-16 is agreed, data frames protected by XOR-8 only are not trusted.
+		 * A poll may come before the master got the sync answer it is polled for */
+		if (link_phy_fcs_algo == LINK_PHY_FCS_CRC16 &&
+				!(link_frame_rev->header.type & PHY_FRAME_TYPE_FCS_CRC16) &&
+				link_frame_rev->header.type != PHY_FRAME_TYPE_SYNC &&
+				link_frame_rev->header.type != PHY_FRAME_TYPE_POLL) {
+			link_fbuf_free(fbuf);
+			break;
+		}
 
-		switch (link_frame_rev->header.type) {
+#if (LINK_PHY_MULTI_DROP == 1)
+		/* link session is with the master only */
+		if (link_frame_rev->header.src_addr != link_phy_peer_addr) {
+			link_phy_rev_foreign++;
+			link_fbuf_free(fbuf);
+			break;
+		}
+#endif
+
+		switch (link_frame_rev->header.type & PHY_FRAME_TYPE_MASK) {
 		case PHY_FRAME_TYPE_REQ: {
 			LINK_DBG("PHY_FRAME_TYPE_REQ\n");
-
-			if (link_phy_rev_seq_num != link_frame_rev->header.seq_num) {
-				link_phy_rev_seq_num = link_frame_rev->header.seq_num;
+			/* acknowledgement of reverse traffic rides in the header */
+			if (link_frame_rev->header.type & PHY_FRAME_TYPE_ACK_CUM) {
+				link_phy_send_window_ack_cum(link_frame_rev->header.sub_type);
+				link_phy_send_window_slide();
 			}
-
-			/* respond ack */
-			link_phy_frame_t st_link_phy_frame_ack;
-			st_link_phy_frame_ack.header.sof = LINK_PHY_SOF;
-			st_link_phy_frame_ack.header.des_addr = link_frame_rev->header.src_addr;
-			st_link_phy_frame_ack.header.src_addr = link_frame_rev->header.des_addr;
-			st_link_phy_frame_ack.header.type = PHY_FRAME_TYPE_ACK;
-			st_link_phy_frame_ack.header.sub_type = 0;
-			st_link_phy_frame_ack.header.seq_num = link_frame_rev->header.seq_num;
-			st_link_phy_frame_ack.header.len = 0;
-			st_link_phy_frame_ack.header.fcs = link_phy_frame_cals_checksum((link_phy_frame_t*)&st_link_phy_frame_ack);
-			link_phy_frame_write(&st_link_phy_frame_ack);
-
-			/* post message to higher layer */
-			task_post_common_msg(SL_LINK_MAC_ID, AC_LINK_MAC_FRAME_REV, (uint8_t*)link_frame_rev->data, link_frame_rev->header.len);
+			link_phy_rev_window_req(fbuf);
 		}
 			break;
 
 		case PHY_FRAME_TYPE_ACK: {
 			LINK_DBG("PHY_FRAME_TYPE_ACK\n");
-			if (link_phy_send_state_get() == LINK_PHY_SEND_STATE_SENDING) {
-				if (link_phy_send_seq_num == link_frame_rev->header.seq_num) {
-					timer_remove_attr(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_SEND_TO);
-					link_phy_send_state_set(LINK_PHY_SEND_STATE_IDLE);
-					task_post_pure_msg(SL_LINK_MAC_ID, AC_LINK_MAC_FRAME_SEND_DONE);
-				}
+			if (link_frame_rev->header.sub_type == PHY_FRAME_SUB_TYPE_ACK_CUM && link_frame_rev->header.len >= 1) {
+				link_phy_send_window_ack_cum(link_frame_rev->data[0]);
 			}
+			link_phy_send_window_ack(link_frame_rev->header.seq_num);
+			link_phy_send_window_slide();
 		}
 			break;
 
 		case PHY_FRAME_TYPE_NACK: {
 			LINK_DBG("PHY_FRAME_TYPE_NACK\n");
-			if (link_phy_send_state_get() == LINK_PHY_SEND_STATE_SENDING) {
-				if (link_phy_send_seq_num == link_frame_rev->header.seq_num) {
-					timer_remove_attr(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_SEND_TO);
-
-					if (retry_counter_send >= link_phy_max_retry_val) {
-						link_phy_frame_send_max_retry();
-					}
-					else {
-						link_phy_frame_send();
-					}
-					retry_counter_send++;
+			uint8_t seq_num = link_frame_rev->header.seq_num;
+
+			if (LINK_PHY_SEQ_OFFSET(seq_num, link_phy_send_base) < link_phy_send_window_used()) {
+				link_phy_send_slot_t* slot = &link_phy_send_window[LINK_PHY_WINDOW_IDX(seq_num)];
+
+				if (slot->state == LINK_PHY_SLOT_SENT) {
+					link_phy_send_window_retry(slot, 0);
+				}
+			}
+		}
+			break;
+
+		case PHY_FRAME_TYPE_SYNC: {
+			LINK_DBG("PHY_FRAME_TYPE_SYNC\n");
+			if (link_frame_rev->header.len < 2) {
+				break;
+			}
+
+			if (link_frame_rev->header.sub_type == PHY_FRAME_SUB_TYPE_SYNC_REQ) {
+				/* peer (re)started, restart receiving from its announced base */
+				link_phy_rev_window_reset(link_frame_rev->data[1]);
+				link_phy_rev_synced = 1;
+
+				link_phy_sync_res();
+			}
+			else if (link_frame_rev->header.sub_type == PHY_FRAME_SUB_TYPE_SYNC_RES) {
+				/* peer base lags the frames delivered but not acknowledged yet,
+				 * they are acknowledged now instead of being received again */
+				if (link_phy_rev_synced && LINK_PHY_SEQ_OFFSET(link_phy_rev_base, link_frame_rev->data[1]) <= LINK_PHY_WINDOW_SIZE) {
+					link_phy_rev_ack_pending = 1;
+					link_phy_rev_ack_send();
+				}
+				else {
+					link_phy_rev_window_reset(link_frame_rev->data[1]);
+					link_phy_rev_synced = 1;
 				}
 			}
+			else {
+				break;
+			}
+
+			timer_remove_attr(SL_LINK_PHY_ID, AC_LINK_PHY_SYNC_TO);
+			link_phy_sync_set_window(link_frame_rev->data[0]);
+			link_phy_sync_set_fcs(link_frame_rev);
+			link_phy_sync_set_frame_data_size(link_frame_rev);
+			link_phy_sync_set_framing(link_frame_rev);
+			link_phy_sync_set_caps(link_frame_rev);
+			link_phy_sync_set_fec(link_frame_rev);
+
+			/* mac flow control restarts with the link */
+			task_post_pure_msg(SL_LINK_MAC_ID, AC_LINK_MAC_PHY_SYNCED);
+		}
+			break;
+
+		case PHY_FRAME_TYPE_POLL: {
+			LINK_DBG("PHY_FRAME_TYPE_POLL\n");
+			if (link_frame_rev->header.sub_type == PHY_FRAME_SUB_TYPE_POLL_REQ) {
+				link_phy_poll_turn_take();
+			}
 		}
 			break;
 
 		default:
 			break;
 		}
+
+		link_fbuf_free(fbuf);
 	}
 		break;
 
 	case AC_LINK_PHY_FRAME_REV_CS_ERR: {
 		LINK_DBG_SIG("AC_LINK_PHY_FRAME_REV_CS_ERR\n");
-		link_phy_frame_t* st_link_frame_rev = (link_phy_frame_t*)get_data_common_msg(msg);
+		uint32_t fbuf_id;
+		mem_cpy((uint8_t*)&fbuf_id, (uint8_t*)get_data_common_msg(msg), sizeof(uint32_t));
+
+		link_fbuf_t* fbuf = link_fbuf_get(fbuf_id);
+		link_phy_frame_t* st_link_frame_rev = (link_phy_frame_t*)link_fbuf_data(fbuf);
 
 		/* respond non-ack */
-		link_phy_frame_t st_link_phy_frame_non_ack;
-		st_link_phy_frame_non_ack.header.sof = LINK_PHY_SOF;
-		st_link_phy_frame_non_ack.header.des_addr = st_link_frame_rev->header.src_addr;
-		st_link_phy_frame_non_ack.header.src_addr = st_link_frame_rev->header.des_addr;
-		st_link_phy_frame_non_ack.header.type = PHY_FRAME_TYPE_NACK;
-		st_link_phy_frame_non_ack.header.sub_type = 0;
-		st_link_phy_frame_non_ack.header.seq_num = st_link_frame_rev->header.seq_num;
-		st_link_phy_frame_non_ack.header.len = 0;
-		st_link_phy_frame_non_ack.header.fcs = link_phy_frame_cals_checksum((link_phy_frame_t*)&st_link_phy_frame_non_ack);
-		link_phy_frame_write(&st_link_phy_frame_non_ack);
+		link_phy_frame_write_ctrl(link_phy_peer_addr, PHY_FRAME_TYPE_NACK, PHY_FRAME_SUB_TYPE_NACK_ERR, st_link_frame_rev->header.seq_num, NULL, 0);
+		link_fbuf_free(fbuf);
 	}
 		break;
 
 	case AC_LINK_PHY_FRAME_REV_TO: {
 		LINK_DBG_SIG("AC_LINK_PHY_FRAME_REV_TO\n");
 		link_phy_frame_parser_state_revc = PARSER_STATE_SOF;
+		link_phy_rev_to++;
+	}
+		break;
+
+	case AC_LINK_PHY_ACK_DELAY_TO: {
+		LINK_DBG_SIG("AC_LINK_PHY_ACK_DELAY_TO\n");
+		/* no reverse traffic to carry it */
+		if (link_phy_rev_ack_pending) {
+			link_phy_rev_ack_send();
+		}
+	}
+		break;
+
+	case AC_LINK_PHY_SYNC_TO: {
+		LINK_DBG_SIG("AC_LINK_PHY_SYNC_TO\n");
+		/* legacy peer does not answer, keep stop-and-wait */
+		if (link_phy_sync_retry < link_phy_max_retry_val) {
+			link_phy_sync_retry++;
+			link_phy_sync_req();
+		}
 	}
 		break;
 
@@ -312,6 +722,380 @@ void fsm_link_phy_state_handle(ak_msg_t* msg) {
 	}
 }
 
+uint8_t link_phy_send_window_used() {
+	return LINK_PHY_SEQ_OFFSET(link_phy_send_next, link_phy_send_base);
+}
+
+void link_phy_send_window_slot_send(link_phy_send_slot_t* slot) {
+	link_phy_frame_t* frame = (link_phy_frame_t*)link_fbuf_data(slot->fbuf);
+
+	/* retransmission timer starts when the frame is really on the bus */
+	if (!link_phy_tx_allowed()) {
+		slot->held = 1;
+		return;
+	}
+	slot->held = 0;
+
+	/* every data frame carries the current receiving base, also on retransmission */
+	if ((link_phy_caps & LINK_PHY_CAP_ACK_PIGGYBACK) && link_phy_rev_synced) {
+		frame->header.type |= PHY_FRAME_TYPE_ACK_CUM;
+		frame->header.sub_type = link_phy_rev_base;
+
+		if (link_phy_rev_ack_pending) {
+			link_phy_rev_ack_pending = 0;
+			timer_remove_attr(SL_LINK_PHY_ID, AC_LINK_PHY_ACK_DELAY_TO);
+		}
+	}
+	else {
+		frame->header.type &= ~PHY_FRAME_TYPE_ACK_CUM;
+		frame->header.sub_type = 0;
+	}
+
+	link_phy_frame_write(frame);
+	slot->sent_at = link_phy_millis();
+}
+
+void link_phy_send_window_ack(uint8_t seq_num) {
+	if (LINK_PHY_SEQ_OFFSET(seq_num, link_phy_send_base) < link_phy_send_window_used()) {
+		link_phy_send_slot_t* slot = &link_phy_send_window[LINK_PHY_WINDOW_IDX(seq_num)];
+
+		link_phy_send_window_acked(slot);
+	}
+}
+
+void link_phy_send_window_ack_cum(uint8_t next_seq_num) {
+	uint8_t acked = LINK_PHY_SEQ_OFFSET(next_seq_num, link_phy_send_base);
+
+	if (acked <= link_phy_send_window_used()) {
+		for (uint8_t i = 0; i < acked; i++) {
+			link_phy_send_window_acked(&link_phy_send_window[LINK_PHY_WINDOW_IDX((uint8_t)(link_phy_send_base + i))]);
+		}
+	}
+}
+
+void link_phy_send_window_slide() {
+	uint8_t released = 0;
+
+	while (link_phy_send_base != link_phy_send_next &&
+		   link_phy_send_window[LINK_PHY_WINDOW_IDX(link_phy_send_base)].state == LINK_PHY_SLOT_ACKED) {
+		link_phy_send_slot_t* slot = &link_phy_send_window[LINK_PHY_WINDOW_IDX(link_phy_send_base)];
+		link_fbuf_free(slot->fbuf);
+		slot->fbuf = LINK_FBUF_NULL;
+		slot->state = LINK_PHY_SLOT_FREE;
+		link_phy_send_base++;
+		released = 1;
+	}
+
+	if (!released) {
+		return;
+	}
+
+	if (link_phy_send_window_used() == 0) {
+		timer_remove_attr(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_SEND_TO);
+	}
+
+	if (link_phy_send_done_pending && link_phy_send_window_used() < link_phy_window_size) {
+		link_phy_send_done_pending = 0;
+		task_post_pure_msg(SL_LINK_MAC_ID, AC_LINK_MAC_FRAME_SEND_DONE);
+	}
+}
+
+void link_phy_send_window_acked(link_phy_send_slot_t* slot) {
+	if (slot->state == LINK_PHY_SLOT_SENT) {
+		slot->state = LINK_PHY_SLOT_ACKED;
+
+		/* Karn: a retransmitted frame gives an ambiguous sample */
+		if (slot->retry == 0) {
+			link_phy_rtt_sample(link_phy_millis() - slot->sent_at);
+		}
+	}
+}
+
+void link_phy_send_window_retry(link_phy_send_slot_t* slot, uint8_t is_timeout) {
+	if (slot->retry >= link_phy_max_retry_val) {
+		link_phy_frame_send_max_retry();
+	}
+	else {
+		if (is_timeout) {
+			/* exponential backoff, kept until next valid sample */
+			slot->rto = (slot->rto < LINK_PHY_RTO_MAX / 2) ? (slot->rto << 1) : LINK_PHY_RTO_MAX;
+			link_phy_rto = (link_phy_rto < LINK_PHY_RTO_MAX / 2) ? (link_phy_rto << 1) : LINK_PHY_RTO_MAX;
+			link_phy_retransmit++;
+		}
+		else {
+			link_phy_fast_retransmit++;
+		}
+
+		slot->retry++;
+		link_phy_send_window_slot_send(slot);
+	}
+}
+
+void link_phy_rtt_sample(uint32_t rtt) {
+	link_phy_rtt_last = rtt;
+
+	if (link_phy_srtt == 0) {
+		/* first measurement: SRTT = R, RTTVAR = R/2 (bit 0 marks a 0 ms sample as valid) */
+		link_phy_srtt = (rtt << 3) | 1;
+		link_phy_rttvar = rtt << 1;
+	}
+	else {
+		/* SRTT += (R - SRTT) / 8, RTTVAR += (|R - SRTT| - RTTVAR) / 4 */
+		int32_t delta = (int32_t)rtt - (int32_t)(link_phy_srtt >> 3);
+		link_phy_srtt = (uint32_t)((int32_t)link_phy_srtt + delta);
+		if (link_phy_srtt == 0) {
+			link_phy_srtt = 1;
+		}
+
+		if (delta < 0) {
+			delta = -delta;
+		}
+		delta -= (int32_t)(link_phy_rttvar >> 2);
+		link_phy_rttvar = (uint32_t)((int32_t)link_phy_rttvar + delta);
+	}
+
+	/* RTO = SRTT + max(G, 4 * RTTVAR) */
+	uint32_t var = (link_phy_rttvar > LINK_PHY_WINDOW_TICK_INTERVAL) ? link_phy_rttvar : LINK_PHY_WINDOW_TICK_INTERVAL;
+	uint32_t rto = (link_phy_srtt >> 3) + var;
+
+	if (rto < LINK_PHY_RTO_MIN) {
+		rto = LINK_PHY_RTO_MIN;
+	}
+	else if (rto > LINK_PHY_RTO_MAX) {
+		rto = LINK_PHY_RTO_MAX;
+	}
+	link_phy_rto = rto;
+}
+
+void link_phy_rev_window_reset(uint8_t base) {
+	link_phy_rev_base = base;
+	link_phy_rev_nack_sent = 0;
+
+	if (link_phy_rev_ack_pending) {
+		link_phy_rev_ack_pending = 0;
+		timer_remove_attr(SL_LINK_PHY_ID, AC_LINK_PHY_ACK_DELAY_TO);
+	}
+
+	for (uint8_t i = 0; i < LINK_PHY_WINDOW_SIZE; i++) {
+		if (link_phy_rev_window[i].fbuf != LINK_FBUF_NULL) {
+			link_fbuf_free(link_phy_rev_window[i].fbuf);
+			link_phy_rev_window[i].fbuf = LINK_FBUF_NULL;
+		}
+	}
+}
+
+void link_phy_rev_window_req(link_fbuf_t* fbuf) {
+	link_phy_frame_t* frame = (link_phy_frame_t*)link_fbuf_data(fbuf);
+	uint8_t seq_num = frame->header.seq_num;
+
+	/* legacy peer, no sequence agreement: deliver as stop-and-wait */
+	if (!link_phy_rev_synced) {
+		link_phy_frame_write_ctrl(link_phy_peer_addr, PHY_FRAME_TYPE_ACK, 0, seq_num, NULL, 0);
+		link_fbuf_ref(fbuf);
+		link_phy_rev_deliver(fbuf);
+		return;
+	}
+
+	if (LINK_PHY_SEQ_OFFSET(seq_num, link_phy_rev_base) < LINK_PHY_WINDOW_SIZE) {
+		link_phy_rev_slot_t* slot = &link_phy_rev_window[LINK_PHY_WINDOW_IDX(seq_num)];
+
+		if (slot->fbuf == LINK_FBUF_NULL) {
+			link_fbuf_ref(fbuf);
+			slot->fbuf = fbuf;
+		}
+
+		/* deliver in-order run to higher layer, slot reference moves with it */
+		while (link_phy_rev_window[LINK_PHY_WINDOW_IDX(link_phy_rev_base)].fbuf != LINK_FBUF_NULL) {
+			slot = &link_phy_rev_window[LINK_PHY_WINDOW_IDX(link_phy_rev_base)];
+			link_phy_rev_deliver(slot->fbuf);
+			slot->fbuf = LINK_FBUF_NULL;
+			link_phy_rev_base++;
+			link_phy_rev_nack_sent = 0;
+		}
+
+		/* hole in front of this frame, ask for it once instead of waiting sender timeout */
+		if (LINK_PHY_SEQ_OFFSET(seq_num, link_phy_rev_base) < LINK_PHY_WINDOW_SIZE) {
+			if (!link_phy_rev_nack_sent) {
+				link_phy_rev_nack_sent = 1;
+				link_phy_frame_write_ctrl(link_phy_peer_addr, PHY_FRAME_TYPE_NACK, PHY_FRAME_SUB_TYPE_NACK_TO, link_phy_rev_base, NULL, 0);
+			}
+		}
+		else if (link_phy_caps & LINK_PHY_CAP_ACK_PIGGYBACK) {
+			/* delivered in order, cumulative ack is enough */
+			link_phy_rev_ack_delay();
+			return;
+		}
+	}
+	else if (LINK_PHY_SEQ_OFFSET(link_phy_rev_base, seq_num) > LINK_PHY_WINDOW_SIZE) {
+		/* neither new nor recently delivered */
+		return;
+	}
+
+	/* selective ack of this frame + cumulative ack of everything delivered */
+	link_phy_frame_write_ctrl(link_phy_peer_addr, PHY_FRAME_TYPE_ACK, PHY_FRAME_SUB_TYPE_ACK_CUM, seq_num, &link_phy_rev_base, 1);
+
+	if (link_phy_rev_ack_pending) {
+		link_phy_rev_ack_pending = 0;
+		timer_remove_attr(SL_LINK_PHY_ID, AC_LINK_PHY_ACK_DELAY_TO);
+	}
+}
+
+void link_phy_rev_ack_delay() {
+	/* wait for a data frame to peer, a streaming peer still gets an ack every few frames */
+	if (++link_phy_rev_ack_pending >= LINK_PHY_ACK_DELAY_FRAMES) {
+		link_phy_rev_ack_send();
+	}
+	else if (link_phy_rev_ack_pending == 1) {
+		timer_set(SL_LINK_PHY_ID, AC_LINK_PHY_ACK_DELAY_TO, LINK_PHY_ACK_DELAY_INTERVAL, TIMER_ONE_SHOT);
+	}
+}
+
+void link_phy_rev_ack_send() {
+	/* stays pending until next turn */
+	if (!link_phy_tx_allowed()) {
+		return;
+	}
+
+	uint8_t last_seq_num = link_phy_rev_base - 1;
+	link_phy_frame_write_ctrl(link_phy_peer_addr, PHY_FRAME_TYPE_ACK, PHY_FRAME_SUB_TYPE_ACK_CUM, last_seq_num, &link_phy_rev_base, 1);
+
+	link_phy_rev_ack_pending = 0;
+	timer_remove_attr(SL_LINK_PHY_ID, AC_LINK_PHY_ACK_DELAY_TO);
+}
+
+void link_phy_rev_deliver(link_fbuf_t* fbuf) {
+	/* header bytes stay readable for the caller, only the data offset moves */
+	link_phy_frame_t* frame = (link_phy_frame_t*)link_fbuf_data(fbuf);
+	uint8_t len = frame->header.len;
+
+	link_fbuf_pull(fbuf, LINK_PHY_FRAME_HEADER_SIZE);
+	fbuf->len = len;
+
+	link_phy_frame_rev++;
+	link_phy_byte_rev += len;
+
+	uint32_t fbuf_id = fbuf->id;
+	task_post_common_msg(SL_LINK_MAC_ID, AC_LINK_MAC_FRAME_REV, (uint8_t*)&fbuf_id, sizeof(uint32_t));
+}
+
+void link_phy_sync_set_window(uint8_t peer_window) {
+	uint8_t window = (peer_window < LINK_PHY_WINDOW_SIZE) ? peer_window : LINK_PHY_WINDOW_SIZE;
+	link_phy_window_size = (window > 0) ? window : 1;
+	LINK_DBG("[PHY] window size -> %d\n", link_phy_window_size);
+
+	if (link_phy_send_done_pending && link_phy_send_window_used() < link_phy_window_size) {
+		link_phy_send_done_pending = 0;
+		task_post_pure_msg(SL_LINK_MAC_ID, AC_LINK_MAC_FRAME_SEND_DONE);
+	}
+}
+
+void link_phy_sync_set_fcs(link_phy_frame_t* sync_frame) {
+	/* peer without fcs field only knows XOR-8 */
+	uint8_t peer_algo = (sync_frame->header.len >= 3) ? sync_frame->data[2] : LINK_PHY_FCS_XOR8;
+	link_phy_fcs_algo = (peer_algo < LINK_PHY_FCS_ALGO) ? peer_algo : LINK_PHY_FCS_ALGO;
+	LINK_DBG("[PHY] fcs algorithm -> %d\n", link_phy_fcs_algo);
+}
+
+void link_phy_sync_set_frame_data_size(link_phy_frame_t* sync_frame) {
+	/* peer without size field parses frames into an AK common message */
+	uint8_t peer_size = (sync_frame->header.len >= 4) ? sync_frame->data[3] : LINK_PHY_FRAME_DATA_SIZE_LEGACY;
+	uint8_t size = (peer_size < LINK_PHY_FRAME_DATA_SIZE) ? peer_size : LINK_PHY_FRAME_DATA_SIZE;
+	link_phy_frame_data_size = (size > LINK_PHY_FRAME_DATA_SIZE_LEGACY) ? size : LINK_PHY_FRAME_DATA_SIZE_LEGACY;
+	LINK_DBG("[PHY] frame data size -> %d\n", link_phy_frame_data_size);
+}
+
+void link_phy_sync_set_framing(link_phy_frame_t* sync_frame) {
+	/* peer without framing field only parses SOF framing */
+	uint8_t peer_framing = (sync_frame->header.len >= 5) ? sync_frame->data[4] : LINK_PHY_FRAMING_SOF;
+	link_phy_framing = (peer_framing < LINK_PHY_FRAMING) ? peer_framing : LINK_PHY_FRAMING;
+	LINK_DBG("[PHY] framing -> %d\n", link_phy_framing);
+}
+
+void link_phy_sync_set_caps(link_phy_frame_t* sync_frame) {
+	/* peer without capability field has none */
+	uint8_t peer_caps = (sync_frame->header.len >= 6) ? sync_frame->data[5] : 0;
+	link_phy_caps = peer_caps & LINK_PHY_CAPS;
+	LINK_DBG("[PHY] capabilities -> 0x%02X\n", link_phy_caps);
+}
+
+void link_phy_sync_set_fec(link_phy_frame_t* sync_frame) {
+	/* peer without fec field sends no parity, parity is only stuffed with the frame */
+	uint8_t peer_parity = (sync_frame->header.len >= 7) ? sync_frame->data[6] : 0;
+	link_phy_fec_parity = (peer_parity < LINK_PHY_FEC_PARITY) ? peer_parity : LINK_PHY_FEC_PARITY;
+	if (link_phy_framing != LINK_PHY_FRAMING_COBS) {
+		link_phy_fec_parity = 0;
+	}
+	LINK_DBG("[PHY] fec parity -> %d\n", link_phy_fec_parity);
+}
+
+void link_phy_sync_req() {
+	uint8_t sync_req[7] = { LINK_PHY_WINDOW_SIZE, link_phy_send_base, LINK_PHY_FCS_ALGO, LINK_PHY_FRAME_DATA_SIZE, LINK_PHY_FRAMING, LINK_PHY_CAPS, LINK_PHY_FEC_PARITY };
+	link_phy_frame_write_ctrl(link_phy_peer_addr, PHY_FRAME_TYPE_SYNC, PHY_FRAME_SUB_TYPE_SYNC_REQ, 0, sync_req, sizeof(sync_req));
+	timer_set(SL_LINK_PHY_ID, AC_LINK_PHY_SYNC_TO, LINK_PHY_FRAME_SEND_TO_INTERVAL, TIMER_ONE_SHOT);
+}
+
+void link_phy_sync_res() {
+	uint8_t sync_res[7] = { LINK_PHY_WINDOW_SIZE, link_phy_send_base, LINK_PHY_FCS_ALGO, LINK_PHY_FRAME_DATA_SIZE, LINK_PHY_FRAMING, LINK_PHY_CAPS, LINK_PHY_FEC_PARITY };
+	link_phy_frame_write_ctrl(link_phy_peer_addr, PHY_FRAME_TYPE_SYNC, PHY_FRAME_SUB_TYPE_SYNC_RES, 0, sync_res, sizeof(sync_res));
+}
+
+uint8_t link_phy_tx_allowed() {
+#if (LINK_PHY_MULTI_DROP == 1)
+	return link_phy_poll_turn;
+#else
+	return 1;
+#endif
+}
+
+void link_phy_tx_flush() {
+	uint8_t sync_pending = link_phy_sync_pending;
+	link_phy_sync_pending = 0;
+
+	if (sync_pending == PHY_FRAME_SUB_TYPE_SYNC_REQ) {
+		link_phy_sync_req();
+	}
+	else if (sync_pending == PHY_FRAME_SUB_TYPE_SYNC_RES) {
+		link_phy_sync_res();
+	}
+
+	for (uint8_t seq_num = link_phy_send_base; seq_num != link_phy_send_next; seq_num++) {
+		link_phy_send_slot_t* slot = &link_phy_send_window[LINK_PHY_WINDOW_IDX(seq_num)];
+
+		if (slot->state == LINK_PHY_SLOT_SENT && slot->held) {
+			link_phy_send_window_slot_send(slot);
+		}
+	}
+
+	/* data frames above carried it when piggyback is agreed */
+	if (link_phy_rev_ack_pending) {
+		if (link_phy_rev_synced) {
+			link_phy_rev_ack_send();
+		}
+		else {
+			link_phy_rev_ack_pending = 0;
+		}
+	}
+}
+
+void link_phy_poll_turn_take() {
+	/* a turn writes at most sync, window and ack before its end, so it is bounded on the bus */
+	link_phy_poll_turn = 1;
+	link_phy_poll++;
+
+	link_phy_tx_flush();
+	link_phy_frame_write_ctrl(link_phy_peer_addr, PHY_FRAME_TYPE_POLL, PHY_FRAME_SUB_TYPE_POLL_END, 0, NULL, 0);
+
+	link_phy_poll_turn = 0;
+}
+
+void link_phy_addr_set(uint32_t addr) {
+	link_phy_addr = addr;
+}
+
+uint32_t link_phy_addr_get() {
+	return link_phy_addr;
+}
+
 void link_phy_max_retry_set(uint8_t max_retry) {
 	link_phy_max_retry_val = max_retry;
 }
@@ -320,79 +1104,165 @@ uint8_t link_phy_max_retry_get() {
 	return link_phy_max_retry_val;
 }
 
-uint8_t link_phy_frame_write_byte(uint8_t byte) {
-	link_put_c(byte);
-	
-	return byte;
+void link_phy_frame_rev_block(uint8_t* data, uint32_t len) {
+	while (len) {
+		/* body of a stuffed frame is taken up to the delimiter at once */
+		uint32_t span = link_phy_frame_rev_cobs_block(data, len);
+		if (span == 0) {
+			ac_link_phy_frame_rev_byte(*data);
+			span = 1;
+		}
+		data += span;
+		len -= span;
+	}
 }
 
 uint32_t link_phy_get_send_frame_to() {
-	uint32_t ret = ((link_phy_max_retry_val + 1) * LINK_PHY_FRAME_SEND_TO_INTERVAL);
+	/* worst case before SEND_ERR: every try times out with backoff */
+	uint32_t ret = 0;
+	uint32_t rto = link_phy_rto;
+
+	for (uint8_t i = 0; i <= link_phy_max_retry_val; i++) {
+		ret += rto;
+		rto = (rto < LINK_PHY_RTO_MAX / 2) ? (rto << 1) : LINK_PHY_RTO_MAX;
+	}
 	return ret;
 }
 
+uint8_t link_phy_get_frame_data_size() {
+	return link_phy_frame_data_size;
+}
+
+uint8_t link_phy_get_caps() {
+	return link_phy_caps;
+}
+
+void link_phy_get_stat(link_phy_stat_t* stat) {
+	stat->srtt = link_phy_srtt >> 3;
+	stat->rttvar = link_phy_rttvar >> 2;
+	stat->rto = link_phy_rto;
+	stat->rtt_last = link_phy_rtt_last;
+	stat->retransmit = link_phy_retransmit;
+	stat->fast_retransmit = link_phy_fast_retransmit;
+	stat->frame_sent = link_phy_frame_sent;
+	stat->frame_rev = link_phy_frame_rev;
+	stat->byte_sent = link_phy_byte_sent;
+	stat->byte_rev = link_phy_byte_rev;
+	stat->fcs_err = link_phy_fcs_err;
+	stat->rev_to = link_phy_rev_to;
+	stat->rev_drop = link_phy_rev_drop;
+	stat->send_fail = link_phy_send_fail;
+	stat->fec_fixed = link_phy_fec_fixed;
+	stat->fec_byte = link_phy_fec_byte;
+	stat->rev_foreign = link_phy_rev_foreign;
+	stat->poll = link_phy_poll;
+	stat->window_size = link_phy_window_size;
+	stat->fcs_algo = link_phy_fcs_algo;
+	stat->frame_data_size = link_phy_frame_data_size;
+	stat->framing = link_phy_framing;
+	stat->caps = link_phy_caps;
+	stat->fec_parity = link_phy_fec_parity;
+}
+
+uint32_t link_phy_millis() {
+	return AkCtl_Millis();
+}
+
 uint8_t ac_link_phy_frame_rev_byte(uint8_t c) {
 	static uint8_t link_phy_util_index;
 	uint8_t ret_handle = LINK_HAL_HANDLED;
+	link_phy_frame_parser_state_e state = link_phy_frame_parser_state_revc;
 
-	switch (link_phy_frame_parser_state_revc) {
+	/* running CRC over every wire byte of SOF framing, trailer excluded */
+	if (state == PARSER_STATE_SOF) {
+		link_phy_rev_crc = CRC16_CCITT_INIT;
+	}
+	if (state < PARSER_STATE_CRC) {
+		link_phy_rev_crc = CRC16_CCITT_UPDATE(link_phy_rev_crc, c);
+	}
+
+	switch (state) {
 	case PARSER_STATE_SOF: {
-		if (LINK_PHY_SOF == c) {
-			link_phy_util_index = 3;
+		if (LINK_PHY_SOF == c && rev_link_phy_fbuf == LINK_FBUF_NULL) {
+			rev_link_phy_fbuf = link_fbuf_malloc(0);
+			if (rev_link_phy_fbuf != LINK_FBUF_NULL) {
+				rev_link_phy_frame = (link_phy_frame_t*)link_fbuf_data(rev_link_phy_fbuf);
+			}
+			else {
+				link_phy_rev_drop++;
+			}
+		}
+
+		if (LINK_PHY_SOF == c && rev_link_phy_fbuf != LINK_FBUF_NULL) {
+			rev_link_phy_frame->header.sof = c;
+			link_phy_rev_skip = 0;
+			link_phy_util_index = 0;
 			link_phy_frame_parser_state_revc = PARSER_STATE_DES_ADDR;
 			timer_set(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_REV_TO, LINK_PHY_FRAME_REV_TO_INTERVAL, TIMER_ONE_SHOT);
 		}
+#if (LINK_PHY_FRAMING == LINK_PHY_FRAMING_COBS)
+		else if (COBS_DELIMITER == c) {
+			link_phy_rev_cobs_len = 0;
+			link_phy_frame_parser_state_revc = PARSER_STATE_COBS;
+		}
+#endif
 		else {
 			ret_handle = LINK_HAL_IGNORED;
 		}
 	}
 		break;
 
+	/* addresses are in memory order, as the header is written */
 	case PARSER_STATE_DES_ADDR: {
-		((uint8_t*)&rev_link_phy_frame.header.des_addr)[link_phy_util_index] = c;
-		if (link_phy_util_index == 0) {
-			link_phy_util_index = 3;
+		((uint8_t*)&rev_link_phy_frame->header.des_addr)[link_phy_util_index] = c;
+		if (link_phy_util_index == sizeof(uint32_t) - 1) {
+#if (LINK_PHY_MULTI_DROP == 1)
+			link_phy_frame_rev_addr_check(rev_link_phy_frame->header.des_addr);
+#endif
+			link_phy_util_index = 0;
 			link_phy_frame_parser_state_revc = PARSER_STATE_SRC_ADDR;
 		}
 		else {
-			link_phy_util_index--;
+			link_phy_util_index++;
 		}
 	}
 		break;
 
 	case PARSER_STATE_SRC_ADDR: {
-		((uint8_t*)&rev_link_phy_frame.header.src_addr)[link_phy_util_index] = c;
-		if (link_phy_util_index == 0) {
+		((uint8_t*)&rev_link_phy_frame->header.src_addr)[link_phy_util_index] = c;
+		if (link_phy_util_index == sizeof(uint32_t) - 1) {
 			link_phy_frame_parser_state_revc = PARSER_STATE_TYPE;
 		}
 		else {
-			link_phy_util_index--;
+			link_phy_util_index++;
 		}
 	}
 		break;
 
 	case PARSER_STATE_TYPE: {
-		rev_link_phy_frame.header.type = c;
+		rev_link_phy_frame->header.type = c;
 		link_phy_frame_parser_state_revc = PARSER_STATE_SUB_TYPE;
 	}
 		break;
 
 	case PARSER_STATE_SUB_TYPE: {
-		rev_link_phy_frame.header.sub_type = c;
+		rev_link_phy_frame->header.sub_type = c;
 		link_phy_frame_parser_state_revc = PARSER_STATE_SEQ_NUM;
 	}
 		break;
 
 	case PARSER_STATE_SEQ_NUM: {
-		rev_link_phy_frame.header.seq_num = c;
+		rev_link_phy_frame->header.seq_num = c;
 		link_phy_frame_parser_state_revc = PARSER_STATE_LEN;
 	}
 		break;
 
 	case PARSER_STATE_LEN: {
-		rev_link_phy_frame.header.len = c;
-		if (rev_link_phy_frame.header.len > LINK_PHY_FRAME_SIZE) {
+		rev_link_phy_frame->header.len = c;
+		/* data is parsed straight into the pooled buffer, never beyond it */
+		if (rev_link_phy_frame->header.len > LINK_PHY_FRAME_DATA_SIZE) {
 			link_phy_frame_parser_state_revc = PARSER_STATE_SOF;
+			link_phy_rev_drop++;
 			timer_remove_attr(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_REV_TO);
 			//FATAL("LK_PHY", 0x04); // Only for internal link layer testing
 
@@ -403,49 +1273,64 @@ uint8_t ac_link_phy_frame_rev_byte(uint8_t c) {
 		break;
 
 	case PARSER_STATE_FCS: {
-		rev_link_phy_frame.header.fcs = c;
+		rev_link_phy_frame->header.fcs = c;
 
-		if (rev_link_phy_frame.header.len > 0) {
+		if (rev_link_phy_frame->header.len > 0) {
 			link_phy_util_index = 0;
 			link_phy_frame_parser_state_revc = PARSER_STATE_DATA;
 		}
+		else if (rev_link_phy_frame->header.type & PHY_FRAME_TYPE_FCS_CRC16) {
+			link_phy_util_index = 0;
+			link_phy_frame_parser_state_revc = PARSER_STATE_CRC;
+		}
 		else {
+			link_phy_frame_rev_end(link_phy_frame_cals_checksum(rev_link_phy_frame) == rev_link_phy_frame->header.fcs);
+		}
+	}
+		break;
 
-			timer_remove_attr(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_REV_TO);
-
-			uint8_t cals_cs = link_phy_frame_cals_checksum(&rev_link_phy_frame);
+	case PARSER_STATE_DATA: {
+		/* payload of a frame for another station is only counted */
+		if (!link_phy_rev_skip) {
+			rev_link_phy_frame->data[link_phy_util_index] = c;
+		}
+		link_phy_util_index++;
 
-			if (cals_cs == rev_link_phy_frame.header.fcs) {
-				task_post_common_msg(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_REV, (uint8_t*)&rev_link_phy_frame, sizeof(link_phy_frame_t));
+		if (link_phy_util_index == rev_link_phy_frame->header.len) {
+			if (rev_link_phy_frame->header.type & PHY_FRAME_TYPE_FCS_CRC16) {
+				link_phy_util_index = 0;
+				link_phy_frame_parser_state_revc = PARSER_STATE_CRC;
 			}
 			else {
-				LINK_DBG("checksum incorrectly !\n");
-				task_post_common_msg(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_REV_CS_ERR, (uint8_t*)&rev_link_phy_frame, sizeof(link_phy_frame_t));
+				link_phy_frame_rev_end(link_phy_frame_cals_checksum(rev_link_phy_frame) == rev_link_phy_frame->header.fcs);
 			}
-
-			link_phy_frame_parser_state_revc = PARSER_STATE_SOF;
 		}
 	}
 		break;
 
-	case PARSER_STATE_DATA: {
-		rev_link_phy_frame.data[link_phy_util_index++] = c;
-
-		if (link_phy_util_index == rev_link_phy_frame.header.len) {
-
-			timer_remove_attr(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_REV_TO);
+	case PARSER_STATE_CRC: {
+		link_phy_rev_crc_trailer = (uint16_t)((link_phy_rev_crc_trailer << 8) | c);
 
-			uint8_t cals_cs = link_phy_frame_cals_checksum(&rev_link_phy_frame);
+		if (++link_phy_util_index == sizeof(uint16_t)) {
+			link_phy_frame_rev_end(link_phy_rev_crc_trailer == link_phy_rev_crc);
+		}
+	}
+		break;
 
-			if (cals_cs == rev_link_phy_frame.header.fcs) {
-				task_post_common_msg(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_REV, (uint8_t*)&rev_link_phy_frame, sizeof(link_phy_frame_t));
-			}
-			else {
-				LINK_DBG("checksum incorrectly !\n");
-				task_post_common_msg(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_REV_CS_ERR, (uint8_t*)&rev_link_phy_frame, sizeof(link_phy_frame_t));
+	case PARSER_STATE_COBS: {
+		if (COBS_DELIMITER == c) {
+			if (link_phy_rev_cobs_len != 0) {
+				link_phy_frame_rev_cobs_end();
 			}
-
+		}
+		else if (link_phy_rev_cobs_len == 0 && LINK_PHY_SOF == c) {
+			/* SOF framed sync between stuffed frames, a stuffed CRC-16 frame
+			 * starts with a code byte <= 14 (header fcs byte is 0) */
 			link_phy_frame_parser_state_revc = PARSER_STATE_SOF;
+			ret_handle = ac_link_phy_frame_rev_byte(c);
+		}
+		else {
+			link_phy_frame_rev_cobs_byte(c);
 		}
 	}
 		break;
@@ -458,14 +1343,241 @@ uint8_t ac_link_phy_frame_rev_byte(uint8_t c) {
 	return ret_handle;
 }
 
-void link_phy_frame_send_max_retry() {
-	link_phy_send_state_set(LINK_PHY_SEND_STATE_IDLE);
-	task_post_pure_msg(SL_LINK_MAC_ID, AC_LINK_MAC_FRAME_SEND_ERR);
+void link_phy_frame_rev_end(uint8_t fcs_ok) {
+	timer_remove_attr(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_REV_TO);
+
+	/* frame for another station, buffer is kept for the next one */
+	if (link_phy_rev_skip) {
+		link_phy_rev_skip = 0;
+		link_phy_frame_parser_state_revc = PARSER_STATE_SOF;
+		return;
+	}
+
+	/* hand the buffer over to the phy task, next frame takes a new one */
+	uint32_t fbuf_id = rev_link_phy_fbuf->id;
+	rev_link_phy_fbuf->len = LINK_PHY_FRAME_HEADER_SIZE + rev_link_phy_frame->header.len;
+	rev_link_phy_fbuf = LINK_FBUF_NULL;
+
+	if (fcs_ok) {
+		task_post_common_msg(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_REV, (uint8_t*)&fbuf_id, sizeof(uint32_t));
+	}
+	else {
+		LINK_DBG("checksum incorrectly !\n");
+		link_phy_fcs_err++;
+		task_post_common_msg(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_REV_CS_ERR, (uint8_t*)&fbuf_id, sizeof(uint32_t));
+	}
+
+	link_phy_frame_parser_state_revc = PARSER_STATE_SOF;
+}
+
+void link_phy_frame_rev_cobs_byte(uint8_t c) {
+	if (link_phy_rev_cobs_len >= LINK_FBUF_SIZE) {
+		if (link_phy_rev_cobs_len == LINK_FBUF_SIZE) {
+			link_phy_rev_drop++;
+			link_phy_rev_cobs_len = LINK_PHY_REV_COBS_DROP;
+		}
+		return;
+	}
+
+	if (link_phy_rev_cobs_len == 0) {
+		if (rev_link_phy_fbuf == LINK_FBUF_NULL) {
+			rev_link_phy_fbuf = link_fbuf_malloc(0);
+			if (rev_link_phy_fbuf == LINK_FBUF_NULL) {
+				link_phy_rev_cobs_len = LINK_PHY_REV_COBS_DROP;
+				link_phy_rev_drop++;
+				return;
+			}
+			rev_link_phy_frame = (link_phy_frame_t*)link_fbuf_data(rev_link_phy_fbuf);
+		}
+		timer_set(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_REV_TO, LINK_PHY_FRAME_REV_TO_INTERVAL, TIMER_ONE_SHOT);
+		link_phy_rev_skip = 0;
+#if (LINK_PHY_MULTI_DROP == 1)
+		link_phy_rev_addr_len = 0;
+		link_phy_rev_cobs_run = 0;
+#endif
+	}
+
+	((uint8_t*)rev_link_phy_frame)[link_phy_rev_cobs_len++] = c;
+
+#if (LINK_PHY_MULTI_DROP == 1)
+	if (link_phy_rev_addr_len <= sizeof(uint32_t)) {
+		link_phy_frame_rev_cobs_addr(c);
+		if (link_phy_rev_skip) {
+			link_phy_rev_cobs_len = LINK_PHY_REV_COBS_SKIP;
+		}
+	}
+#endif
+}
+
+uint32_t link_phy_frame_rev_cobs_block(uint8_t* data, uint32_t len) {
+	/* first byte takes the buffer and starts the timer, overrun is handled per byte */
+	if (link_phy_frame_parser_state_revc != PARSER_STATE_COBS ||
+			link_phy_rev_cobs_len == 0 || link_phy_rev_cobs_len >= LINK_FBUF_SIZE) {
+		return 0;
+	}
+
+#if (LINK_PHY_MULTI_DROP == 1)
+	/* destination address is decoded per byte */
+	if (link_phy_rev_addr_len <= sizeof(uint32_t)) {
+		return 0;
+	}
+#endif
+
+	uint8_t* delimiter = (uint8_t*)memchr(data, COBS_DELIMITER, len);
+	uint32_t span = delimiter ? (uint32_t)(delimiter - data) : len;
+
+	if (span > (uint32_t)(LINK_FBUF_SIZE - link_phy_rev_cobs_len)) {
+		return 0;
+	}
+
+	memcpy((uint8_t*)rev_link_phy_frame + link_phy_rev_cobs_len, data, span);
+	link_phy_rev_cobs_len += span;
+	return span;
+}
+
+#if (LINK_PHY_MULTI_DROP == 1)
+void link_phy_frame_rev_cobs_addr(uint8_t c) {
+	/* stuffed header is decoded on the fly up to the destination address,
+	 * a code byte is followed by its run and an implied zero unless 0xFF */
+	if (link_phy_rev_cobs_run == 0) {
+		link_phy_rev_cobs_code = c;
+		link_phy_rev_cobs_run = c;
+	}
+	else {
+		if (link_phy_rev_addr_len > 0) {
+			((uint8_t*)&link_phy_rev_addr)[link_phy_rev_addr_len - 1] = c;
+		}
+		link_phy_rev_addr_len++;
+	}
+
+	if (--link_phy_rev_cobs_run == 0 && link_phy_rev_cobs_code != 0xFF) {
+		if (link_phy_rev_addr_len > 0 && link_phy_rev_addr_len <= sizeof(uint32_t)) {
+			((uint8_t*)&link_phy_rev_addr)[link_phy_rev_addr_len - 1] = COBS_DELIMITER;
+		}
+		link_phy_rev_addr_len++;
+	}
+
+	/* sof and destination address decoded */
+	if (link_phy_rev_addr_len > sizeof(uint32_t)) {
+		link_phy_frame_rev_addr_check(link_phy_rev_addr);
+	}
+}
+
+void link_phy_frame_rev_addr_check(uint32_t des_addr) {
+	if (des_addr != link_phy_addr) {
+		link_phy_rev_skip = 1;
+		link_phy_rev_foreign++;
+	}
 }
+#endif
+
+void link_phy_frame_rev_cobs_end() {
+	uint32_t len = 0;
 
-void link_phy_frame_send() {
-	if (link_phy_send_state_get() == LINK_PHY_SEND_STATE_SENDING) {
-		link_phy_frame_write(&send_link_phy_frame);
-		timer_set(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_SEND_TO, LINK_PHY_FRAME_SEND_TO_INTERVAL, TIMER_ONE_SHOT);
+	if (link_phy_rev_cobs_len <= LINK_FBUF_SIZE) {
+		len = cobs_decode((uint8_t*)rev_link_phy_frame, link_phy_rev_cobs_len);
 	}
+	else if (link_phy_rev_cobs_len == LINK_PHY_REV_COBS_SKIP) {
+		/* counted when its address was seen */
+		link_phy_rev_cobs_len = 0;
+		timer_remove_attr(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_REV_TO);
+		link_phy_frame_parser_state_revc = PARSER_STATE_COBS;
+		return;
+	}
+	link_phy_rev_cobs_len = 0;
+
+	/* repaired before any check, CRC-16 still has the last word on it */
+	if (link_phy_fec_parity && len) {
+		len = link_phy_frame_fec_decode((uint8_t*)rev_link_phy_frame, len);
+	}
+
+	/* stuffed frames always carry CRC-16 */
+	link_phy_frame_header_t* header = &rev_link_phy_frame->header;
+	if (len >= LINK_PHY_FRAME_HEADER_SIZE + LINK_PHY_FRAME_TRAILER_SIZE &&
+			header->sof == LINK_PHY_SOF &&
+			(header->type & PHY_FRAME_TYPE_FCS_CRC16) &&
+			header->len <= LINK_PHY_FRAME_DATA_SIZE) {
+		uint8_t fcs_ok = 0;
+
+		/* a lost byte shows as length mismatch, answered like a bad checksum */
+		if (LINK_PHY_FRAME_HEADER_SIZE + header->len + LINK_PHY_FRAME_TRAILER_SIZE == len) {
+			uint8_t* trailer = &rev_link_phy_frame->data[header->len];
+			uint16_t crc = crc16_ccitt(CRC16_CCITT_INIT, (uint8_t*)rev_link_phy_frame, len - LINK_PHY_FRAME_TRAILER_SIZE);
+			fcs_ok = (crc == (uint16_t)((trailer[0] << 8) | trailer[1]));
+		}
+		link_phy_frame_rev_end(fcs_ok);
+	}
+	else {
+		timer_remove_attr(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_REV_TO);
+		link_phy_rev_drop++;
+	}
+
+	/* delimiter also opens the next frame, even if its leading one is lost */
+	link_phy_frame_parser_state_revc = PARSER_STATE_COBS;
+}
+
+uint32_t link_phy_frame_fec_decode(uint8_t* frame, uint32_t len) {
+	uint8_t parity_len = link_phy_fec_parity;
+	uint32_t block_size = LINK_PHY_FEC_BLOCK_SIZE(parity_len);
+	uint32_t frame_len = 0;
+
+	/* frame length is the one whose codeword count matches the parity received */
+	for (uint32_t parity_size = parity_len; parity_size < len; parity_size += parity_len) {
+		if (LINK_PHY_FEC_SIZE(len - parity_size, parity_len) == parity_size) {
+			frame_len = len - parity_size;
+			break;
+		}
+	}
+
+	/* too short for parity, fails the length check */
+	if (frame_len == 0) {
+		return len;
+	}
+
+	uint8_t* parity = frame + frame_len;
+	int32_t fixed = 0;
+
+	for (uint32_t i = 0; i < frame_len; i += block_size) {
+		uint32_t block = (frame_len - i < block_size) ? frame_len - i : block_size;
+		int32_t ret = rs_decode(frame + i, block, parity, parity_len);
+		if (ret > 0) {
+			fixed += ret;
+		}
+		parity += parity_len;
+	}
+
+	if (fixed) {
+		link_phy_fec_fixed++;
+		link_phy_fec_byte += fixed;
+	}
+
+	return frame_len;
+}
+
+void link_phy_frame_send_max_retry() {
+	link_phy_send_fail++;
+
+	/* drop whole window, peer receiving base is re-synced before next frame */
+	for (uint8_t i = 0; i < LINK_PHY_WINDOW_SIZE; i++) {
+		if (link_phy_send_window[i].fbuf != LINK_FBUF_NULL) {
+			link_fbuf_free(link_phy_send_window[i].fbuf);
+			link_phy_send_window[i].fbuf = LINK_FBUF_NULL;
+		}
+		link_phy_send_window[i].state = LINK_PHY_SLOT_FREE;
+	}
+	link_phy_send_base = link_phy_send_next;
+	timer_remove_attr(SL_LINK_PHY_ID, AC_LINK_PHY_FRAME_SEND_TO);
+
+	/* one answer per SEND_REQ: MAC is either waiting for it now or will send next */
+	if (link_phy_send_done_pending) {
+		link_phy_send_done_pending = 0;
+		task_post_pure_msg(SL_LINK_MAC_ID, AC_LINK_MAC_FRAME_SEND_ERR);
+	}
+	else {
+		link_phy_send_err_pending = 1;
+	}
+
+	link_phy_window_size = 1;
+	link_phy_sync_retry = 0;
+	link_phy_sync_req();
 }
@@ -0,0 +1,186 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "app.h"
+#include "app_dbg.h"
+#include "task_list.h"
+
+#include "ak.h"
+#include "message.h"
+#include "timer.h"
+
+#include "utils.h"
+
+#include "link.h"
+#include "link_config.h"
+#include "link_sig.h"
+#include "link_rpc.h"
+
+/* call waiting for its response, id LINK_RPC_ID_NONE is a free entry */
+typedef struct {
+	uint8_t id;
+	uint8_t task_id;
+	uint8_t done_sig;
+	uint32_t remain; /* ms */
+} link_rpc_call_t;
+
+static link_rpc_call_t link_rpc_table[LINK_RPC_CALL_MAX];
+static uint8_t link_rpc_table_len; /* calls waiting */
+static uint8_t link_rpc_id_last;
+
+/* request or response being built */
+static uint8_t link_rpc_buf[sizeof(link_rpc_header_t) + LINK_RPC_DATA_SIZE];
+
+static uint8_t link_rpc_find(uint8_t id);
+static void link_rpc_free(uint8_t i);
+static void link_rpc_send(link_rpc_header_t* header, uint8_t if_src_task_id, uint8_t if_src_type, uint8_t if_des_type, uint8_t if_des_task_id, uint8_t if_sig, uint8_t* data, uint32_t len);
+
+uint8_t link_rpc_call(uint8_t task_id, uint8_t done_sig, uint8_t if_des_type, uint8_t if_des_task_id, uint8_t if_sig, uint8_t* data, uint32_t len, uint32_t timeout) {
+	/* link is full, caller keeps its data and calls again later */
+	if (len > LINK_RPC_DATA_SIZE || link_rpc_table_len >= LINK_RPC_CALL_MAX || link_send_status() == LINK_SEND_STATUS_FULL) {
+		return LINK_RPC_ID_NONE;
+	}
+
+	/* ids go round, a late response meets a new call of its id only after 255 calls */
+	do {
+		link_rpc_id_last++;
+	} while (link_rpc_id_last == LINK_RPC_ID_NONE || link_rpc_find(link_rpc_id_last) < LINK_RPC_CALL_MAX);
+
+	link_rpc_call_t* call = &link_rpc_table[link_rpc_find(LINK_RPC_ID_NONE)];
+	call->id = link_rpc_id_last;
+	call->task_id = task_id;
+	call->done_sig = done_sig;
+	call->remain = timeout;
+
+	if (link_rpc_table_len++ == 0) {
+		timer_set(SL_LINK_ID, AC_LINK_RPC_TICK, LINK_RPC_TICK_INTERVAL, TIMER_PERIODIC);
+	}
+
+	/* response comes back to link task */
+	link_rpc_header_t header;
+	header.id = call->id;
+	header.res_sig = AC_LINK_RPC_RES;
+	header.status = LINK_RPC_STATUS_OK;
+	link_rpc_send(&header, SL_LINK_ID, IF_TYPE_CPU_SERIAL_SL, if_des_type, if_des_task_id, if_sig, data, len);
+
+	return call->id;
+}
+
+void link_rpc_cancel(uint8_t id) {
+	uint8_t i = link_rpc_find(id);
+
+	if (id != LINK_RPC_ID_NONE && i < LINK_RPC_CALL_MAX) {
+		link_rpc_free(i);
+	}
+}
+
+void link_rpc_reply(ak_msg_t* req, uint8_t* data, uint32_t len) {
+	link_rpc_header_t header;
+
+	link_rpc_get_data(req, &header, NULL, 0);
+	if (header.id == LINK_RPC_ID_NONE || len > LINK_RPC_DATA_SIZE) {
+		LINK_DBG("[LINK] rpc reply to sig %d dropped\n", req->sig);
+		return;
+	}
+
+	uint8_t res_sig = header.res_sig;
+	header.res_sig = 0;
+	header.status = LINK_RPC_STATUS_OK;
+	link_rpc_send(&header, req->if_des_task_id, req->if_des_type, req->if_src_type, req->if_src_task_id, res_sig, data, len);
+}
+
+uint32_t link_rpc_get_data(ak_msg_t* msg, link_rpc_header_t* header, uint8_t* data, uint32_t size) {
+	header->id = LINK_RPC_ID_NONE;
+
+	if (get_msg_type(msg) != DYNAMIC_MSG_TYPE || get_data_len_dynamic_msg(msg) < sizeof(link_rpc_header_t)) {
+		return 0;
+	}
+
+	uint8_t* msg_data = get_data_dynamic_msg(msg);
+	uint32_t len = get_data_len_dynamic_msg(msg) - sizeof(link_rpc_header_t);
+
+	if (len > size) {
+		len = size;
+	}
+	mem_cpy((uint8_t*)header, msg_data, sizeof(link_rpc_header_t));
+	mem_cpy(data, &msg_data[sizeof(link_rpc_header_t)], len);
+	return len;
+}
+
+void link_rpc_rev(ak_msg_t* msg) {
+	link_rpc_header_t header;
+
+	link_rpc_get_data(msg, &header, NULL, 0);
+	uint8_t i = link_rpc_find(header.id);
+
+	if (header.id == LINK_RPC_ID_NONE || i >= LINK_RPC_CALL_MAX) {
+		LINK_DBG("[LINK] rpc response %d without call, drop\n", header.id);
+		return;
+	}
+
+	/* response is the completion, caller reads it like the request */
+	msg_inc_ref_count(msg);
+	set_msg_sig(msg, link_rpc_table[i].done_sig);
+	set_msg_src_task_id(msg, SL_LINK_ID);
+	task_post(link_rpc_table[i].task_id, msg);
+
+	link_rpc_free(i);
+}
+
+void link_rpc_tick() {
+	for (uint8_t i = 0; i < LINK_RPC_CALL_MAX; i++) {
+		link_rpc_call_t* call = &link_rpc_table[i];
+
+		if (call->id == LINK_RPC_ID_NONE) {
+			continue;
+		}
+
+		if (call->remain > LINK_RPC_TICK_INTERVAL) {
+			call->remain -= LINK_RPC_TICK_INTERVAL;
+			continue;
+		}
+
+		link_rpc_header_t header;
+		header.id = call->id;
+		header.res_sig = 0;
+		header.status = LINK_RPC_STATUS_TIMEOUT;
+		task_post_dynamic_msg(call->task_id, call->done_sig, (uint8_t*)&header, sizeof(link_rpc_header_t));
+
+		link_rpc_free(i);
+	}
+}
+
+uint8_t link_rpc_find(uint8_t id) {
+	uint8_t i = 0;
+
+	while (i < LINK_RPC_CALL_MAX && link_rpc_table[i].id != id) {
+		i++;
+	}
+	return i;
+}
+
+void link_rpc_free(uint8_t i) {
+	link_rpc_table[i].id = LINK_RPC_ID_NONE;
+
+	if (--link_rpc_table_len == 0) {
+		timer_remove_attr(SL_LINK_ID, AC_LINK_RPC_TICK);
+	}
+}
+
+void link_rpc_send(link_rpc_header_t* header, uint8_t if_src_task_id, uint8_t if_src_type, uint8_t if_des_type, uint8_t if_des_task_id, uint8_t if_sig, uint8_t* data, uint32_t len) {
+	mem_cpy(link_rpc_buf, (uint8_t*)header, sizeof(link_rpc_header_t));
+	mem_cpy(&link_rpc_buf[sizeof(link_rpc_header_t)], data, len);
+
+	ak_msg_t* msg = get_dynamic_msg();
+	set_if_src_task_id(msg, if_src_task_id);
+	set_if_des_task_id(msg, if_des_task_id);
+	set_if_src_type(msg, if_src_type);
+	set_if_des_type(msg, if_des_type);
+	set_if_sig(msg, if_sig);
+	set_data_dynamic_msg(msg, link_rpc_buf, sizeof(link_rpc_header_t) + len);
+
+	set_msg_sig(msg, AC_LINK_SEND_DYNAMIC_MSG);
+
+	/* call checked link is not full, request of a reply is gone already */
+	link_send_post_over(msg);
+}
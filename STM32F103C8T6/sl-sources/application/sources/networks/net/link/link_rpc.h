@@ -0,0 +1,46 @@
+#ifndef __LINK_RPC_H__
+#define __LINK_RPC_H__
+
+#include <stdint.h>
+#include "ak.h"
+#include "message.h"
+
+#include "link_config.h"
+
+/* request/response calls to remote tasks. A request is a dynamic message to
+ * if_des_task_id, its data starts with link_rpc_header_t. The remote task
+ * answers with link_rpc_reply(), link matches the response by id and posts it
+ * to the caller with done_sig. A call without response completes with
+ * LINK_RPC_STATUS_TIMEOUT, a response after that is dropped. Data of request,
+ * response and completion is read by link_rpc_get_data() */
+#define LINK_RPC_ID_NONE			(0)
+
+#define LINK_RPC_STATUS_OK			(0)
+#define LINK_RPC_STATUS_TIMEOUT		(1)
+
+typedef struct {
+	uint8_t id; /* correlation id of the call */
+	uint8_t res_sig; /* request: if_sig of the response */
+	uint8_t status; /* response and completion: LINK_RPC_STATUS_* */
+} __AK_PACKETED link_rpc_header_t;
+
+/* return id of the call, LINK_RPC_ID_NONE when LINK_RPC_CALL_MAX calls are
+ * waiting, link is full (see link_send_wait()) or len is above
+ * LINK_RPC_DATA_SIZE. timeout in ms */
+extern uint8_t link_rpc_call(uint8_t task_id, uint8_t done_sig, uint8_t if_des_type, uint8_t if_des_task_id, uint8_t if_sig, uint8_t* data, uint32_t len, uint32_t timeout);
+
+/* call is forgotten, its completion is not posted */
+extern void link_rpc_cancel(uint8_t id);
+
+/* answer request req of the current handler */
+extern void link_rpc_reply(ak_msg_t* req, uint8_t* data, uint32_t len);
+
+/* return data length copied, at most size. header id is LINK_RPC_ID_NONE
+ * when msg does not carry one */
+extern uint32_t link_rpc_get_data(ak_msg_t* msg, link_rpc_header_t* header, uint8_t* data, uint32_t size);
+
+/* link task */
+extern void link_rpc_rev(ak_msg_t* msg);
+extern void link_rpc_tick();
+
+#endif //__LINK_RPC_H__
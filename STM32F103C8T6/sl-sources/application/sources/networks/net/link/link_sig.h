@@ -20,6 +20,8 @@ enum {
 	AC_LINK_PHY_FRAME_REV,
 	AC_LINK_PHY_FRAME_REV_TO,
 	AC_LINK_PHY_FRAME_REV_CS_ERR,
+	AC_LINK_PHY_SYNC_TO,
+	AC_LINK_PHY_ACK_DELAY_TO,
 };
 
 /*****************************************************************************/
@@ -34,13 +36,16 @@ enum {
 	AC_LINK_MAC_INIT = AK_USER_DEFINE_SIG,
 	AC_LINK_MAC_PHY_LAYER_STARTED,
 	AC_LINK_MAC_FRAME_SEND_REQ,
+	AC_LINK_MAC_REV_PDU_FREE,
 
 	/* private */
-	AC_LINK_MAC_FRAME_SEND_START,
 	AC_LINK_MAC_FRAME_SEND_DONE,
 	AC_LINK_MAC_FRAME_SEND_ERR,
 	AC_LINK_MAC_FRAME_REV,
 	AC_LINK_MAC_FRAME_REV_TO,
+	AC_LINK_MAC_PHY_SYNCED,
+	AC_LINK_MAC_CREDIT_TO,
+	AC_LINK_MAC_SEND_RESUME,
 };
 
 /*****************************************************************************/
@@ -59,10 +64,14 @@ enum {
 	AC_LINK_SEND_DYNAMIC_MSG,
 	AC_LINK_SEND_DATA,
 	AC_LINK_SEND_HANDLE_PDU_FULL,
+	AC_LINK_RPC_RES,
 
 	/* private */
 	AC_LINK_SEND_DONE,
 	AC_LINK_SEND_ERR,
+	AC_LINK_SEND_AGG_TO,
+	AC_LINK_SEND_RETRY_TO,
+	AC_LINK_RPC_TICK,
 
 	AC_LINK_REV_MSG,
 };
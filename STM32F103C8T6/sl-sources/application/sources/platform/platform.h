@@ -17,7 +17,9 @@ extern "C"
 #define ENABLE_INTERRUPTS()         enableInterrupts()
 #define DISABLE_INTERRUPTS()        disableInterrupts()
 
-#define LOG2LKUP(val)              ((uint_fast8_t)(32U - __builtin_clz(val)))
+/* 0 for 0 like CLZ of the Cortex-M3, __builtin_clz(0) is undefined on other
+ * targets (host build). gcc drops the test where CLZ defines it */
+#define LOG2LKUP(val)              ((uint_fast8_t)((val) ? (32U - __builtin_clz(val)) : 0U))
 
 /* Function prototypes -------------------------------------------------------*/
 extern void enableInterrupts(void);
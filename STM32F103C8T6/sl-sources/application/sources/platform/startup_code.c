@@ -101,6 +101,8 @@ void PendSV_Handler()       	__attribute__ ((weak, alias("Default_Handler")));
 void SysTick_Handler();
 
 /* Interrupt function prototypes ----------------------------------------------*/
+void TIM2_IRQHandler();
+void TIM2_IRQHandlerFrame(uint32_t* frame);
 void USART1_IRQHandler();
 void USART2_IRQHandler();
 void USART3_IRQHandler();
@@ -262,6 +264,31 @@ void SysTick_Handler() {
 /*------------------------------*/
 /* Cortex-M processor interrupt */
 /*------------------------------*/
+/*----------------------------------------------------------------------------*/
+/* Task run-time budget: pass the stacked exception frame to get interrupted PC */
+void __attribute__((naked)) TIM2_IRQHandler() {
+	__asm volatile (
+		"	tst		lr, #4					\n"
+		"	ite		eq						\n"
+		"	mrseq	r0, msp					\n"
+		"	mrsne	r0, psp					\n"
+		"	b		TIM2_IRQHandlerFrame	\n"
+		);
+}
+
+/* frame: r0, r1, r2, r3, r12, lr, pc, xpsr */
+void __attribute__((used)) TIM2_IRQHandlerFrame(uint32_t* frame) {
+	if (TIM_GetITStatus(TASK_BUDGET_TIMER, TIM_IT_Update) != RESET) {
+		TIM_ClearITPendingBit(TASK_BUDGET_TIMER, TIM_IT_Update);
+
+#if defined(AK_TASK_BUDGET_ENABLE)
+		task_budget_check(frame[6]);
+#else
+		(void)frame;
+#endif
+	}
+}
+
 /*----------------------------------------------------------------------------*/
 void USART1_IRQHandler() {
 	extern ringBufferChar_t systemConsoleRx;
@@ -213,6 +213,53 @@ void delayMilliseconds(uint32_t t) {
 	}
 }
 
+/*---------------------------------------------------------------------------*
+ *  DECLARE: Task run-time budget timer
+ *  Note: highest preemption priority, it has to interrupt the slow handler
+ *---------------------------------------------------------------------------*/
+void taskBudgetTimerInit() {
+	TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+	NVIC_InitTypeDef NVIC_InitStructure;
+
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
+
+	/* 10 KHz counter clock */
+	TIM_TimeBaseStructure.TIM_Prescaler = (SystemCoreClock / 10000) - 1;
+	TIM_TimeBaseStructure.TIM_Period = (TASK_BUDGET_TIMER_PERIOD * 10) - 1;
+	TIM_TimeBaseStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+	TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
+	TIM_TimeBaseStructure.TIM_RepetitionCounter = 0;
+	TIM_TimeBaseInit(TASK_BUDGET_TIMER, &TIM_TimeBaseStructure);
+
+	NVIC_InitStructure.NVIC_IRQChannel = TASK_BUDGET_TIMER_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+
+	TIM_ClearITPendingBit(TASK_BUDGET_TIMER, TIM_IT_Update);
+	TIM_ITConfig(TASK_BUDGET_TIMER, TIM_IT_Update, ENABLE);
+	TIM_Cmd(TASK_BUDGET_TIMER, ENABLE);
+}
+
+/*---------------------------------------------------------------------------*
+ *  DECLARE: DWT cycle counter
+ *  Note: DWT block is not described by this CMSIS version
+ *---------------------------------------------------------------------------*/
+#define DWT_CTRL							(*(volatile uint32_t*)0xE0001000)
+#define DWT_CYCCNT							(*(volatile uint32_t*)0xE0001004)
+#define DWT_CTRL_CYCCNTENA					(0x00000001)
+
+void cycleCounterEnable() {
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT_CYCCNT = 0;
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+}
+
+uint32_t cycleCounterGet() {
+	return DWT_CYCCNT;
+}
+
 /*---------------------------------------------------------------------------*
  *  DECLARE: System independent watchdog function
  *  Note:
@@ -28,6 +28,10 @@ extern "C"
 
 #define CONSOLE_BUFFER_RECEIVED_SIZE    	(32)
 
+#define TASK_BUDGET_TIMER					( TIM2 )
+#define TASK_BUDGET_TIMER_IRQn				( TIM2_IRQn )
+#define TASK_BUDGET_TIMER_PERIOD			( 10 ) /* ms */
+
 #define HSI_OSCILLATOR_EN					( 0 )
 #define LSI_OSCILLATOR_EN					( 0 )
 
@@ -63,6 +67,7 @@ extern void systemTickInit(uint32_t ticks);
 extern void systemCsInit(void);
 extern void updateInformationSystem(void);
 extern void watchdogInit(void);
+extern void taskBudgetTimerInit(void);
 
 #ifdef __cplusplus
 }
@@ -32,6 +32,10 @@ extern uint32_t microsTick(void);
 extern void delayMicroseconds(uint32_t t);
 extern void delayMilliseconds(uint32_t t);
 
+/* DWT cycle counter, used for profiling */
+extern void cycleCounterEnable(void);
+extern uint32_t cycleCounterGet(void);
+
 /* Internal flash function */
 extern void internalFlashUnlock(void);
 extern void internalFlashLock(void);
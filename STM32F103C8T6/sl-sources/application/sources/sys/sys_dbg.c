@@ -20,6 +20,7 @@
 
 /* Private variables ---------------------------------------------------------*/
 static fatalLog_t fatalLog;
+static overrunLog_t overrunLog __attribute__((section(".noinit")));
 
 /* Private function prototypes -----------------------------------------------*/
 
@@ -143,3 +144,45 @@ void fatalGet(fatalLog_t *params) {
 	flashRead(FLASH_DBG_FATAL_LOG_ADDR, (uint8_t *)&fatalLog, sizeof(fatalLog_t));
 	memcpy(params, &fatalLog, sizeof(fatalLog_t));
 }
+
+/*----------------------------------------------------------------------------*/
+void overrunLogInit(void) {
+	if (overrunLog.magicNum != OVERRUN_LOG_MAGIC_NUMBER) {
+		overrunLogClear();
+	}
+	else if (overrunLog.overrunTimes != 0) {
+		SYS_PRINT("-Overrun: %d, task: %d, sig: %d, pc: 0x%08X, %d/%d ms\n",
+				  overrunLog.overrunTimes, overrunLog.taskId, overrunLog.sig,
+				  overrunLog.pc, overrunLog.runTime, overrunLog.budget);
+	}
+}
+
+/* Called from interrupt, RAM only */
+void overrunLogRecord(uint8_t taskId, uint8_t sig, uint32_t pc, uint32_t runTime, uint16_t budget) {
+	ENTRY_CRITICAL();
+
+	if (overrunLog.magicNum != OVERRUN_LOG_MAGIC_NUMBER) {
+		memset(&overrunLog, 0, sizeof(overrunLog_t));
+		overrunLog.magicNum = OVERRUN_LOG_MAGIC_NUMBER;
+	}
+
+	++(overrunLog.overrunTimes);
+	overrunLog.taskId = taskId;
+	overrunLog.sig = sig;
+	overrunLog.budget = budget;
+	overrunLog.runTime = runTime;
+	overrunLog.pc = pc;
+
+	EXIT_CRITICAL();
+}
+
+overrunLog_t *overrunLogRead(void) {
+	return &overrunLog;
+}
+
+void overrunLogClear(void) {
+	ENTRY_CRITICAL();
+	memset(&overrunLog, 0, sizeof(overrunLog_t));
+	overrunLog.magicNum = OVERRUN_LOG_MAGIC_NUMBER;
+	EXIT_CRITICAL();
+}
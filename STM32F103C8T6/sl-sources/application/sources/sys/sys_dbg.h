@@ -19,6 +19,8 @@ extern "C" {
 #define FATAL_LOG_MAGIC_NUMBER      ( 0x123FA123 )
 #define FLASH_DBG_FATAL_LOG_ADDR    GET_FLASH_SECTOR_START_ADDR(0, 0)
 
+#define OVERRUN_LOG_MAGIC_NUMBER    ( 0x0BAD7A5C )
+
 #define FATAL(s, c)                 appFatal((const int8_t*)s, (uint8_t)c)
 
 /* Typedef -------------------------------------------------------------------*/
@@ -44,6 +46,19 @@ typedef struct {
     uint32_t restartTimes;
 } fatalLog_t;
 
+/* Task run-time budget overrun, kept in .noinit RAM through soft/watchdog reset */
+typedef struct {
+    uint32_t magicNum;
+    uint32_t overrunTimes;
+
+    /* Last overrun */
+    uint8_t taskId;
+    uint8_t sig;
+    uint16_t budget;
+    uint32_t runTime;
+    uint32_t pc;
+} overrunLog_t;
+
 /* Extern variables ----------------------------------------------------------*/
 
 /* Function prototypes -------------------------------------------------------*/
@@ -53,6 +68,11 @@ extern void appFatal(const int8_t* s, uint8_t c);
 extern fatalLog_t *fatalRead(void);
 extern void fatalGet(fatalLog_t *params);
 
+extern void overrunLogInit(void);
+extern void overrunLogRecord(uint8_t taskId, uint8_t sig, uint32_t pc, uint32_t runTime, uint16_t budget);
+extern overrunLog_t *overrunLogRead(void);
+extern void overrunLogClear(void);
+
 #ifdef __cplusplus
 }
 #endif